@@ -0,0 +1,666 @@
+#define _POSIX_C_SOURCE 200809L  // clock_gettime
+
+// Headless benchmark suite: environment steps, Q-updates, prioritized replay
+// sampling, greedy policy inference, run setup/teardown and end-to-end
+// training episodes. Every benchmark runs warmup
+// rounds, then repeated timed runs, and reports median/p90/p99/min/max.
+// Build and run with `make bench` (BENCH_ARGS="--quick --csv out.csv").
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../include/agent.h"
+#include "../include/memory_arena.h"
+#include "../include/replay_buffer.h"
+#include "../include/policy.h"
+#include "../include/environment.h"
+#include "../include/training.h"
+#include "../include/utils.h"
+
+#define BENCH_MAX_SIZES 8
+#define BENCH_SEED 12345u
+
+typedef struct {
+    int warmup;                       // Untimed runs before measuring
+    int runs;                         // Timed runs per benchmark
+    int grid_sizes[BENCH_MAX_SIZES];  // Square grid edge lengths to sweep
+    int num_grid_sizes;
+    bool quick;                       // Smaller workloads for CI smoke runs
+    const char* csv_path;             // Machine-readable results (NULL = none)
+    const char* only;                 // Run only the benchmark with this name
+} BenchOptions;
+
+typedef struct {
+    double mean;
+    double median;
+    double p90;
+    double p99;
+    double min;
+    double max;
+} BenchSummary;
+
+static FILE* g_csv = NULL;
+static volatile float g_sink = 0.0f;  // Keeps results observable so loops are not elided
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static int compare_doubles(const void* a, const void* b) {
+    double da = *(const double*)a;
+    double db = *(const double*)b;
+    return (da > db) - (da < db);
+}
+
+// Nearest-rank percentile of sorted samples
+static double percentile(const double* sorted, int count, double p) {
+    int rank = (int)(p * count + 0.999999);
+    if (rank < 1) rank = 1;
+    if (rank > count) rank = count;
+    return sorted[rank - 1];
+}
+
+// Sorts samples in place
+static BenchSummary summarize(double* samples, int count) {
+    BenchSummary summary = {0};
+    if (count <= 0) return summary;
+
+    qsort(samples, count, sizeof(double), compare_doubles);
+    double sum = 0.0;
+    for (int i = 0; i < count; i++) {
+        sum += samples[i];
+    }
+    summary.mean = sum / count;
+    summary.median = percentile(samples, count, 0.5);
+    summary.p90 = percentile(samples, count, 0.9);
+    summary.p99 = percentile(samples, count, 0.99);
+    summary.min = samples[0];
+    summary.max = samples[count - 1];
+    return summary;
+}
+
+static void report(const char* benchmark, const char* variant, int param, const char* unit,
+                   double* samples, int count) {
+    BenchSummary s = summarize(samples, count);
+    printf("%-12s %-12s %8d  %-10s median %12.1f  p90 %12.1f  p99 %12.1f  min %12.1f  max %12.1f  (n=%d)\n",
+           benchmark, variant, param, unit, s.median, s.p90, s.p99, s.min, s.max, count);
+    if (g_csv) {
+        fprintf(g_csv, "%s,%s,%d,%s,%d,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f\n",
+                benchmark, variant, param, unit, count, s.mean, s.median, s.p90, s.p99, s.min, s.max);
+        fflush(g_csv);
+    }
+}
+
+static bool selected(const BenchOptions* opts, const char* name) {
+    return !opts->only || strcmp(opts->only, name) == 0;
+}
+
+// Open grid with the default start (top-left) and goal (bottom-right)
+static GridWorld* create_bench_world(int size) {
+    GridWorld* world = create_grid_world(size, size);
+    if (world) {
+        seed_environment(world, BENCH_SEED);
+    }
+    return world;
+}
+
+// ============================================================================
+// ENVIRONMENT STEPS
+// ============================================================================
+
+static void bench_env_steps(const BenchOptions* opts, int size, bool compiled) {
+    GridWorld* world = create_bench_world(size);
+    if (!world) return;
+    if (compiled && !set_transition_table(world, true)) {
+        destroy_grid_world(world);
+        return;
+    }
+
+    int steps_per_run = opts->quick ? 200000 : 1000000;
+    RandomState rng;
+    seed_random(&rng, BENCH_SEED);
+    double* samples = (double*)malloc(opts->runs * sizeof(double));
+    if (!samples) {
+        destroy_grid_world(world);
+        return;
+    }
+
+    float reward_sum = 0.0f;
+    reset_environment(world);
+    for (int run = -opts->warmup; run < opts->runs; run++) {
+        double start = now_seconds();
+        for (int i = 0; i < steps_per_run; i++) {
+            StepResult result = step_environment(world, (Action)random_next_bounded(&rng, NUM_ACTIONS));
+            reward_sum += result.reward;
+            if (result.done) {
+                reset_environment(world);
+            }
+        }
+        double elapsed = now_seconds() - start;
+        if (run >= 0) {
+            samples[run] = steps_per_run / elapsed;
+        }
+    }
+    g_sink += reward_sum;
+
+    report("env_step", compiled ? "compiled" : "random", size, "steps/s", samples, opts->runs);
+    free(samples);
+    destroy_grid_world(world);
+}
+
+// ============================================================================
+// Q-UPDATES
+// ============================================================================
+
+#define TRANSITION_POOL 65536  // Pre-drawn transitions so RNG cost stays out of the timing
+
+static void bench_q_updates(const BenchOptions* opts, int size, QTableStorage storage) {
+    int num_states = size * size;
+    QLearningAgent* agent = create_agent_with_storage(num_states, NUM_ACTIONS, 0.1f, 0.9f, 0.1f, storage);
+    if (!agent) return;
+
+    int* states = (int*)malloc(TRANSITION_POOL * sizeof(int));
+    int* next_states = (int*)malloc(TRANSITION_POOL * sizeof(int));
+    Action* actions = (Action*)malloc(TRANSITION_POOL * sizeof(Action));
+    float* rewards = (float*)malloc(TRANSITION_POOL * sizeof(float));
+    double* samples = (double*)malloc(opts->runs * sizeof(double));
+    if (!states || !next_states || !actions || !rewards || !samples) {
+        free(samples);
+        free(states);
+        free(next_states);
+        free(actions);
+        free(rewards);
+        destroy_agent(agent);
+        return;
+    }
+
+    RandomState rng;
+    seed_random(&rng, BENCH_SEED);
+    for (int i = 0; i < TRANSITION_POOL; i++) {
+        states[i] = (int)random_next_bounded(&rng, (uint32_t)num_states);
+        next_states[i] = (int)random_next_bounded(&rng, (uint32_t)num_states);
+        actions[i] = (Action)random_next_bounded(&rng, NUM_ACTIONS);
+        rewards[i] = random_bool(&rng, 0.01f) ? 100.0f : -1.0f;
+    }
+
+    int updates_per_run = opts->quick ? 500000 : 2000000;
+    for (int run = -opts->warmup; run < opts->runs; run++) {
+        double start = now_seconds();
+        for (int i = 0; i < updates_per_run; i++) {
+            int t = i & (TRANSITION_POOL - 1);
+            update_q_value(agent, states[t], actions[t], rewards[t], next_states[t], rewards[t] > 0.0f);
+        }
+        double elapsed = now_seconds() - start;
+        if (run >= 0) {
+            samples[run] = updates_per_run / elapsed;
+        }
+    }
+    g_sink += get_max_q_value(agent, 0);
+
+    report("q_update", storage == QTABLE_STORAGE_OPTIMIZED ? "optimized" : "rows", num_states, "updates/s",
+           samples, opts->runs);
+    free(samples);
+    free(states);
+    free(next_states);
+    free(actions);
+    free(rewards);
+    destroy_agent(agent);
+}
+
+// ============================================================================
+// PRIORITIZED REPLAY SAMPLING
+// ============================================================================
+
+static void bench_replay_sample(const BenchOptions* opts, int capacity, bool stratified) {
+    const int batch_size = 32;
+    ReplayConfig config = create_default_replay_config();
+    config.buffer_size = capacity;
+    config.batch_size = batch_size;
+    config.stratified_sampling = stratified;
+
+    PriorityExperienceBuffer* buffer = create_priority_buffer(capacity, config);
+    if (!buffer) return;
+    seed_priority_buffer(buffer, BENCH_SEED);
+
+    RandomState rng;
+    seed_random(&rng, BENCH_SEED);
+    for (int i = 0; i < capacity; i++) {
+        add_priority_experience(buffer, (int)random_next_bounded(&rng, 10000), (Action)random_next_bounded(&rng, NUM_ACTIONS),
+                                -1.0f, (int)random_next_bounded(&rng, 10000), false, random_range(&rng, 0.0f, 10.0f));
+    }
+
+    // One sample is a full replay round trip: draw a batch, then write back new priorities
+    int calls_per_run = opts->quick ? 2000 : 10000;
+    int total = calls_per_run * opts->runs;
+    double* samples = (double*)malloc(total * sizeof(double));
+    if (!samples) {
+        destroy_priority_buffer(buffer);
+        return;
+    }
+    int indices[32];
+    float weights[32];
+    float td_errors[32];
+
+    for (int run = -opts->warmup; run < opts->runs; run++) {
+        for (int c = 0; c < calls_per_run; c++) {
+            for (int i = 0; i < batch_size; i++) {
+                td_errors[i] = random_range(&rng, 0.0f, 10.0f);
+            }
+            double start = now_seconds();
+            PriorityExperience* batch = sample_priority_batch(buffer, batch_size, indices, weights);
+            update_experience_priorities(buffer, indices, td_errors, batch_size);
+            double elapsed = now_seconds() - start;
+            if (batch) {
+                g_sink += weights[0];
+            }
+            if (run >= 0) {
+                samples[run * calls_per_run + c] = elapsed * 1e6;
+            }
+        }
+    }
+
+    report("replay", stratified ? "stratified" : "independent", capacity, "us/batch", samples, total);
+    free(samples);
+    destroy_priority_buffer(buffer);
+}
+
+typedef enum {
+    REPLAY_RECORDS,   // sample_priority_batch + replay_batch_experiences + calculate_td_error
+    REPLAY_SOA,       // sample_replay_batch + replay_priority_batch
+    REPLAY_COMPACT    // CompactReplayBuffer slots + replay_compact_batch
+} ReplayPath;
+
+static const char* replay_path_name(ReplayPath path) {
+    switch (path) {
+        case REPLAY_SOA: return "soa";
+        case REPLAY_COMPACT: return "compact";
+        default: return "records";
+    }
+}
+
+// Full replay round trip (sample, update, write back priorities): the record
+// path (replay, then one calculate_td_error per record) against the SoA
+// kernel, fed from a record buffer or from the compact column buffer
+static void bench_replay_update(const BenchOptions* opts, int num_states, ReplayPath path) {
+    const int batch_size = 64;
+    const int capacity = 100000;
+    ReplayConfig config = create_default_replay_config();
+    PriorityExperienceBuffer* buffer = create_priority_buffer(capacity, config);
+    CompactReplayBuffer* compact = create_compact_replay_buffer(capacity, num_states, NUM_ACTIONS, config);
+    QLearningAgent* agent = create_agent_with_storage(num_states, NUM_ACTIONS, 0.1f, 0.9f, 0.1f,
+                                                      QTABLE_STORAGE_OPTIMIZED);
+    ReplayBatch* soa_batch = create_replay_batch(batch_size);
+    int calls_per_run = opts->quick ? 2000 : 10000;
+    int total = calls_per_run * opts->runs;
+    double* samples = (double*)malloc(total * sizeof(double));
+    if (!buffer || !compact || !agent || !soa_batch || !samples) {
+        free(samples);
+        destroy_replay_batch(soa_batch);
+        destroy_compact_replay_buffer(compact);
+        destroy_agent(agent);
+        destroy_priority_buffer(buffer);
+        return;
+    }
+    seed_priority_buffer(buffer, BENCH_SEED);
+    seed_compact_replay_buffer(compact, BENCH_SEED);
+
+    RandomState rng;
+    seed_random(&rng, BENCH_SEED);
+    for (int i = 0; i < capacity; i++) {
+        int state = (int)random_next_bounded(&rng, (uint32_t)num_states);
+        Action action = (Action)random_next_bounded(&rng, NUM_ACTIONS);
+        int next_state = (int)random_next_bounded(&rng, (uint32_t)num_states);
+        bool done = random_bool(&rng, 0.05f);
+        float td_error = random_range(&rng, 0.0f, 10.0f);
+        add_priority_experience(buffer, state, action, -1.0f, next_state, done, td_error);
+        add_compact_experience(compact, state, action, -1.0f, next_state, done, td_error);
+    }
+
+    int indices[64];
+    float weights[64];
+    float td_errors[64];
+
+    for (int run = -opts->warmup; run < opts->runs; run++) {
+        for (int c = 0; c < calls_per_run; c++) {
+            double start = now_seconds();
+            if (path == REPLAY_COMPACT) {
+                sample_compact_batch(compact, batch_size, indices, weights);
+                replay_compact_batch(agent, compact, indices, weights, batch_size, NULL);
+            } else if (path == REPLAY_SOA) {
+                sample_replay_batch(buffer, batch_size, soa_batch);
+                replay_priority_batch(agent, buffer, soa_batch);
+            } else {
+                PriorityExperience* batch = sample_priority_batch(buffer, batch_size, indices, weights);
+                replay_batch_experiences(agent, batch, weights, batch_size);
+                for (int i = 0; i < batch_size; i++) {
+                    td_errors[i] = calculate_td_error(agent, &batch[i]);
+                }
+                update_experience_priorities(buffer, indices, td_errors, batch_size);
+            }
+            double elapsed = now_seconds() - start;
+            if (run >= 0) {
+                samples[run * calls_per_run + c] = elapsed * 1e6;
+            }
+        }
+    }
+    g_sink += get_max_q_value(agent, 0);
+
+    report("replay_update", replay_path_name(path), num_states, "us/batch", samples, total);
+    free(samples);
+    destroy_replay_batch(soa_batch);
+    destroy_compact_replay_buffer(compact);
+    destroy_agent(agent);
+    destroy_priority_buffer(buffer);
+}
+
+// ============================================================================
+// GREEDY POLICY INFERENCE
+// ============================================================================
+
+#define POLICY_BATCH 1024
+
+// Random-state greedy lookups: select_greedy_action on the Q-table against
+// policy_act batches on the compiled 2-bit policy
+static void bench_policy_inference(const BenchOptions* opts, int num_states, bool compiled) {
+    QLearningAgent* agent = create_agent(num_states, NUM_ACTIONS, 0.1f, 0.9f, 0.1f);
+    if (!agent) return;
+
+    RandomState rng;
+    seed_random(&rng, BENCH_SEED);
+    for (int s = 0; s < num_states; s++) {
+        for (int a = 0; a < NUM_ACTIONS; a++) {
+            set_q_value(agent, s, (Action)a, random_range(&rng, -1.0f, 1.0f));
+        }
+    }
+    CompiledPolicy* policy = compiled ? compile_policy(agent) : NULL;
+    if (compiled && !policy) {
+        destroy_agent(agent);
+        return;
+    }
+
+    int* states = (int*)malloc(TRANSITION_POOL * sizeof(int));
+    int actions[POLICY_BATCH];
+    double* samples = (double*)malloc(opts->runs * sizeof(double));
+    if (!states || !samples) {
+        free(samples);
+        free(states);
+        destroy_compiled_policy(policy);
+        destroy_agent(agent);
+        return;
+    }
+    for (int i = 0; i < TRANSITION_POOL; i++) {
+        states[i] = (int)random_next_bounded(&rng, (uint32_t)num_states);
+    }
+
+    int queries_per_run = opts->quick ? 2000000 : 10000000;
+    long long action_sum = 0;
+    for (int run = -opts->warmup; run < opts->runs; run++) {
+        double start = now_seconds();
+        for (int done = 0; done < queries_per_run; done += POLICY_BATCH) {
+            const int* batch = states + (done & (TRANSITION_POOL - 1));
+            if (compiled) {
+                policy_act(policy, batch, actions, POLICY_BATCH);
+            } else {
+                for (int i = 0; i < POLICY_BATCH; i++) {
+                    actions[i] = (int)select_greedy_action(agent, batch[i]);
+                }
+            }
+            action_sum += actions[done & (POLICY_BATCH - 1)];
+        }
+        double elapsed = now_seconds() - start;
+        if (run >= 0) {
+            samples[run] = queries_per_run / elapsed;
+        }
+    }
+    g_sink += (float)action_sum;
+
+    report("policy", compiled ? "compiled" : "q_table", num_states, "queries/s", samples, opts->runs);
+    free(samples);
+    free(states);
+    destroy_compiled_policy(policy);
+    destroy_agent(agent);
+}
+
+// ============================================================================
+// RUN SETUP AND TEARDOWN
+// ============================================================================
+
+// Build and tear down one short run (world, agent, stats, replay, visit
+// tracker) the way a sweep does, on the heap or inside a reset arena
+static void bench_run_setup(const BenchOptions* opts, int size, bool arena) {
+    MemoryArena* run_arena = arena ? create_memory_arena(0, 0) : NULL;
+    if (arena && !run_arena) return;
+
+    int runs_per_sample = opts->quick ? 50 : 200;
+    int num_states = size * size;
+    ReplayConfig replay_config = create_default_replay_config();
+    double* samples = (double*)malloc(opts->runs * sizeof(double));
+    if (!samples) {
+        destroy_memory_arena(run_arena);
+        return;
+    }
+
+    for (int run = -opts->warmup; run < opts->runs; run++) {
+        double start = now_seconds();
+        for (int i = 0; i < runs_per_sample; i++) {
+            MemoryArena* previous = set_memory_arena(run_arena);
+            GridWorld* world = create_bench_world(size);
+            QLearningAgent* agent = create_agent(num_states, NUM_ACTIONS, 0.1f, 0.95f, 0.1f);
+            TrainingStats* stats = create_training_stats(1000);
+            PriorityExperienceBuffer* replay = create_priority_buffer(1000, replay_config);
+            StateVisitTracker* visits = create_state_visit_tracker(num_states, true, true);
+            g_sink += agent ? get_q_value(agent, 0, ACTION_UP) : 0.0f;
+
+            if (arena) {
+                reset_memory_arena(run_arena);  // Drops the whole run at once
+            } else {
+                destroy_state_visit_tracker(visits);
+                destroy_priority_buffer(replay);
+                destroy_training_stats(stats);
+                destroy_agent(agent);
+                destroy_grid_world(world);
+            }
+            set_memory_arena(previous);
+        }
+        double elapsed = now_seconds() - start;
+        if (run >= 0) {
+            samples[run] = runs_per_sample / elapsed;
+        }
+    }
+
+    report("run_setup", arena ? "arena" : "heap", size, "runs/s", samples, opts->runs);
+    free(samples);
+    destroy_memory_arena(run_arena);
+}
+
+// ============================================================================
+// END-TO-END TRAINING EPISODES
+// ============================================================================
+
+// The headless run_training loop: the same step and bookkeeping calls, minus printing
+static void bench_training_episodes(const BenchOptions* opts, int size, QTableStorage storage) {
+    GridWorld* world = create_bench_world(size);
+    if (!world) return;
+    QLearningAgent* agent = create_agent_with_storage(size * size, NUM_ACTIONS, 0.1f, 0.9f, 1.0f, storage);
+    if (!agent) {
+        destroy_grid_world(world);
+        return;
+    }
+    agent->epsilon_decay = 0.995f;
+    agent->epsilon_min = 0.01f;
+    seed_agent(agent, BENCH_SEED);
+
+    int episodes_per_run = opts->quick ? 100 : 500;
+    int max_steps = 200;
+    double* episode_rates = (double*)malloc(opts->runs * sizeof(double));
+    double* step_rates = (double*)malloc(opts->runs * sizeof(double));
+    if (!episode_rates || !step_rates) {
+        free(episode_rates);
+        free(step_rates);
+        destroy_agent(agent);
+        destroy_grid_world(world);
+        return;
+    }
+
+    for (int run = -opts->warmup; run < opts->runs; run++) {
+        reset_q_table(agent);
+        agent->epsilon = 1.0f;
+        TrainingStats* stats = create_training_stats(episodes_per_run);
+        long long steps = 0;
+
+        double start = now_seconds();
+        for (int episode = 0; episode < episodes_per_run; episode++) {
+            EpisodeProgress progress = begin_training_episode(world);
+            while (training_episode_running(world, &progress, max_steps)) {
+                training_step(world, agent, &progress, NULL);
+            }
+            finish_training_episode(world, agent, stats, episode, &progress);
+            steps += progress.steps_taken;
+        }
+        double elapsed = now_seconds() - start;
+
+        if (run >= 0) {
+            episode_rates[run] = episodes_per_run / elapsed;
+            step_rates[run] = steps / elapsed;
+        }
+        destroy_training_stats(stats);
+    }
+
+    const char* variant = storage == QTABLE_STORAGE_OPTIMIZED ? "optimized" : "rows";
+    report("episodes", variant, size, "episodes/s", episode_rates, opts->runs);
+    report("train_steps", variant, size, "steps/s", step_rates, opts->runs);
+    free(episode_rates);
+    free(step_rates);
+    destroy_agent(agent);
+    destroy_grid_world(world);
+}
+
+// ============================================================================
+// DRIVER
+// ============================================================================
+
+static int parse_sizes(const char* text, int* sizes) {
+    int count = 0;
+    char buffer[128];
+    strncpy(buffer, text, sizeof(buffer) - 1);
+    buffer[sizeof(buffer) - 1] = '\0';
+    for (char* token = strtok(buffer, ","); token && count < BENCH_MAX_SIZES; token = strtok(NULL, ",")) {
+        int size = atoi(token);
+        if (size >= 2) {
+            sizes[count++] = size;
+        }
+    }
+    return count;
+}
+
+static void print_usage(void) {
+    printf("Usage: bench_training [options]\n");
+    printf("  --quick           Smaller workloads and fewer runs\n");
+    printf("  --runs N          Timed runs per benchmark (default: 7)\n");
+    printf("  --warmup N        Untimed warmup runs (default: 2)\n");
+    printf("  --sizes A,B,...   Grid edge lengths to sweep (default: 5,10,20,50)\n");
+    printf("  --only NAME       env_step, q_update, replay, policy, run_setup or episodes\n");
+    printf("  --csv FILE        Write results as CSV\n");
+}
+
+int main(int argc, char* argv[]) {
+    BenchOptions opts = {
+        .warmup = 2,
+        .runs = 7,
+        .grid_sizes = {5, 10, 20, 50},
+        .num_grid_sizes = 4,
+        .quick = false,
+        .csv_path = NULL,
+        .only = NULL
+    };
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--quick") == 0) {
+            opts.quick = true;
+            opts.runs = 3;
+            opts.warmup = 1;
+            opts.num_grid_sizes = parse_sizes("5,10,20", opts.grid_sizes);
+        } else if (strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+            opts.runs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc) {
+            opts.warmup = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--sizes") == 0 && i + 1 < argc) {
+            opts.num_grid_sizes = parse_sizes(argv[++i], opts.grid_sizes);
+        } else if (strcmp(argv[i], "--only") == 0 && i + 1 < argc) {
+            opts.only = argv[++i];
+        } else if (strcmp(argv[i], "--csv") == 0 && i + 1 < argc) {
+            opts.csv_path = argv[++i];
+        } else {
+            print_usage();
+            return strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+    if (opts.runs < 1) opts.runs = 1;
+    if (opts.warmup < 0) opts.warmup = 0;
+    if (opts.num_grid_sizes == 0) {
+        fprintf(stderr, "Error: No valid grid sizes\n");
+        return 1;
+    }
+
+    if (opts.csv_path) {
+        g_csv = fopen(opts.csv_path, "w");
+        if (!g_csv) {
+            fprintf(stderr, "Error: Could not open %s for writing\n", opts.csv_path);
+            return 1;
+        }
+        fprintf(g_csv, "benchmark,variant,param,unit,samples,mean,median,p90,p99,min,max\n");
+    }
+
+    srand(BENCH_SEED);
+    set_environment_verbose(false);
+    set_qtable_verbose(false);
+    printf("RL benchmark suite: %d warmup + %d timed runs%s\n", opts.warmup, opts.runs, opts.quick ? " (quick)" : "");
+
+    for (int i = 0; i < opts.num_grid_sizes && selected(&opts, "env_step"); i++) {
+        bench_env_steps(&opts, opts.grid_sizes[i], false);
+        bench_env_steps(&opts, opts.grid_sizes[i], true);
+    }
+    for (int i = 0; i < opts.num_grid_sizes && selected(&opts, "q_update"); i++) {
+        bench_q_updates(&opts, opts.grid_sizes[i], QTABLE_STORAGE_ROWS);
+        bench_q_updates(&opts, opts.grid_sizes[i], QTABLE_STORAGE_OPTIMIZED);
+    }
+    if (selected(&opts, "replay")) {
+        int capacities[3] = {10000, 100000, 1000000};
+        int num_capacities = opts.quick ? 2 : 3;
+        for (int i = 0; i < num_capacities; i++) {
+            bench_replay_sample(&opts, capacities[i], true);
+            bench_replay_sample(&opts, capacities[i], false);
+        }
+        int state_counts[2] = {10000, 1 << 20};
+        for (int i = 0; i < 2; i++) {
+            bench_replay_update(&opts, state_counts[i], REPLAY_RECORDS);
+            bench_replay_update(&opts, state_counts[i], REPLAY_SOA);
+            bench_replay_update(&opts, state_counts[i], REPLAY_COMPACT);
+        }
+    }
+    if (selected(&opts, "policy")) {
+        int state_counts[2] = {100000, opts.quick ? 1000000 : 10000000};
+        for (int i = 0; i < 2; i++) {
+            bench_policy_inference(&opts, state_counts[i], false);
+            bench_policy_inference(&opts, state_counts[i], true);
+        }
+    }
+    for (int i = 0; i < opts.num_grid_sizes && selected(&opts, "run_setup"); i++) {
+        bench_run_setup(&opts, opts.grid_sizes[i], false);
+        bench_run_setup(&opts, opts.grid_sizes[i], true);
+    }
+    for (int i = 0; i < opts.num_grid_sizes && selected(&opts, "episodes"); i++) {
+        bench_training_episodes(&opts, opts.grid_sizes[i], QTABLE_STORAGE_ROWS);
+        bench_training_episodes(&opts, opts.grid_sizes[i], QTABLE_STORAGE_OPTIMIZED);
+    }
+
+    if (g_csv) {
+        fclose(g_csv);
+        printf("Results written to %s\n", opts.csv_path);
+    }
+    return 0;
+}
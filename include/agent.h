@@ -2,6 +2,9 @@
 #define AGENT_H
 
 #include <stdbool.h>
+#include "q_table_optimized.h"
+#include "sum_tree.h"
+#include "utils.h"
 
 // Action enumeration for the agent
 typedef enum {
@@ -12,15 +15,74 @@ typedef enum {
     NUM_ACTIONS = 4
 } Action;
 
+// Q-table storage backends
+typedef enum {
+    QTABLE_STORAGE_ROWS = 0,    // One heap-allocated row per state
+    QTABLE_STORAGE_OPTIMIZED,   // Flat aligned OptimizedQTable with cached max/argmax
+    QTABLE_STORAGE_MAPPED       // OptimizedQTable backed by an mmap'd file (create_agent_mapped)
+} QTableStorage;
+
+// Storage used by create_agent(); build with -DUSE_OPTIMIZED_QTABLE to switch it
+#ifdef USE_OPTIMIZED_QTABLE
+#define DEFAULT_QTABLE_STORAGE QTABLE_STORAGE_OPTIMIZED
+#else
+#define DEFAULT_QTABLE_STORAGE QTABLE_STORAGE_ROWS
+#endif
+
 // Action-value pair for Q-learning
 typedef struct {
     Action action;
     float q_value;
 } ActionValue;
 
+// Running Q-value range (display normalization). Tracking starts with the
+// first get_q_value_bounds() call. From then on writes widen the range in
+// O(1); a write that moves an extreme inward only marks it stale, and the
+// next query rescans once.
+typedef struct {
+    float min_q;
+    float max_q;
+    bool stale;             // Range must be rescanned before use
+    bool tracking;          // Writes maintain the range (headless runs never pay for it)
+} QValueBounds;
+
+// Running mean and centred sum of squares over every Q-value (see
+// calculate_q_value_variance). Tracking starts with the first variance query;
+// each write then replaces one sample Welford-style in O(1). Bulk writes mark
+// the moments stale, as does a spread that has shrunk so far below the
+// updates applied since the last scan that rounding could show.
+typedef struct {
+    double mean;
+    double m2;              // Sum of squared deviations from the mean
+    double churn;           // Sum of |m2 updates| since the last scan
+    bool stale;             // Moments must be recomputed before use
+    bool tracking;          // Writes maintain the moments
+} QValueMoments;
+
+#define Q_MOMENTS_MAX_CHURN 1e9  // churn / m2 ratio that forces a rescan (~1e-7 relative error)
+
+// Watkins Q(lambda) eligibility traces (see enable_eligibility_traces). Only
+// pairs whose trace is still above min_trace are kept, as an unordered list,
+// so a step costs O(count) rather than O(num_states * num_actions).
+typedef struct {
+    int* states;            // Pair i is (states[i], actions[i]) with trace values[i]
+    int* actions;
+    float* values;          // In [min_trace, 1]; a visit resets its pair to 1 (replacing traces)
+    int count;
+    int capacity;           // Full list: a new pair replaces the smallest trace
+    float lambda;
+    float min_trace;        // Traces decayed below this are dropped
+} EligibilityTraces;
+
+#define ELIGIBILITY_MIN_TRACE 0.01f
+#define ELIGIBILITY_MAX_TRACES 4096  // Default capacity when gamma * lambda is 1
+
 // Q-Learning Agent structure
 typedef struct {
-    float** q_table;        // Q(state, action) values
+    float** q_table;        // Q(state, action) values (QTABLE_STORAGE_ROWS only)
+    QTableWrapper* optimized_table; // Flat Q-table (QTABLE_STORAGE_OPTIMIZED and _MAPPED)
+    MappedQTable* mapped_table; // File mapping behind optimized_table (QTABLE_STORAGE_MAPPED only)
+    QTableStorage storage;  // Which backend holds the Q-values
     int num_states;         // Total number of states
     int num_actions;        // Total number of actions
     float learning_rate;    // Alpha (α)
@@ -30,6 +92,10 @@ typedef struct {
     float epsilon_min;      // Minimum epsilon value
     int current_state;      // Current state index
     Action last_action;     // Last action taken
+    RandomState rng;        // Exploration randomness (see seed_agent)
+    QValueBounds q_bounds;  // Global min/max Q-value (see get_q_value_bounds)
+    QValueMoments q_moments; // Global Q-value mean/spread (see calculate_q_value_variance)
+    EligibilityTraces* traces; // Q(lambda) traces, NULL = one-step Q-learning
 } QLearningAgent;
 
 // Experience structure for experience replay
@@ -59,13 +125,33 @@ typedef struct {
     int capacity;
     int size;
     int current_index;
+    RandomState rng;         // Sampling randomness
 } ExperienceBuffer;
 
+// States sharing a visit count. Buckets form a list sorted by count, so a
+// visit moves its state to the next bucket in O(1) and the minimum and
+// maximum counts are the two ends of the list.
+typedef struct {
+    int count;                   // Visit count shared by every state in the bucket
+    int head;                    // Most recent arrival, which holds the bucket's largest bonus
+    int size;                    // States in the bucket
+    int prev;                    // Bucket with the next lower count, -1 if none
+    int next;                    // Bucket with the next higher count, -1 if none
+} VisitBucket;
+
 // State visit tracking for priority exploration
 typedef struct {
     int* visit_counts;           // Number of times each state has been visited
-    float* visit_priorities;     // Priority scores for state visits
-    float* exploration_bonuses;  // Exploration bonus for each state
+    float* visit_priorities;     // Priority scores, refreshed by update_state_priorities()
+    float* exploration_bonuses;  // Bonus at the last visit divided by bonus_scale at that time
+    float bonus_scale;           // Product of every decay since the bonuses were last folded in
+    VisitBucket* buckets;        // Pool of num_states + 1 buckets
+    int* state_bucket;           // Bucket holding each state
+    int* next_in_bucket;         // Older arrival in the same bucket, -1 at the tail
+    int* prev_in_bucket;         // Newer arrival in the same bucket, -1 at the head
+    int first_bucket;            // Lowest visit count
+    int last_bucket;             // Highest visit count
+    int free_bucket;             // Unused buckets chained through next, -1 if none
     float* state_epsilons;       // Adaptive epsilon per state
     float* state_learning_rates; // Adaptive learning rate per state
     int num_states;              // Total number of states
@@ -77,23 +163,39 @@ typedef struct {
     bool adaptive_learning_rate; // Enable adaptive learning rate per state
 } StateVisitTracker;
 
-// Priority-based experience buffer with heap-based sampling
+// Priority-based experience buffer with sum-tree proportional sampling
 typedef struct {
     PriorityExperience* experiences;
-    float* priorities;        // Priority values for efficient access
-    int* heap;               // Priority queue heap indices
+    SumTree* priority_tree;  // Per-slot priorities with running sum/min/max
+    bool stratified;         // Draw one sample from each of batch_size equal priority segments
     int capacity;
     int size;
     int current_index;
     float alpha;             // Priority exponent (0 = uniform, 1 = full priority)
     float beta;              // Importance sampling exponent (anneals to 1.0)
     float beta_increment;    // Beta annealing rate
-    float max_priority;      // Maximum priority seen (for new experiences)
+    float max_priority;      // Maximum priority currently in the buffer
     float min_priority;      // Minimum priority to prevent zero sampling
     int replay_batch_size;   // Batch size for replay
     int global_step;         // Global step counter for timestamps
+    RandomState rng;         // Sampling randomness
 } PriorityExperienceBuffer;
 
+// Structure-of-arrays replay batch: element i of every array describes one
+// sampled transition, so the update kernel streams each field on its own
+typedef struct {
+    int* indices;            // Buffer slot each transition was drawn from
+    int* states;
+    int* actions;
+    float* rewards;
+    int* next_states;
+    bool* dones;
+    float* weights;          // Importance sampling weights
+    float* td_errors;        // Written by replay_priority_batch()
+    int size;                // Transitions currently in the batch
+    int capacity;
+} ReplayBatch;
+
 // Replay configuration
 typedef struct {
     bool enabled;               // Enable/disable experience replay
@@ -105,6 +207,7 @@ typedef struct {
     float priority_beta_end;   // Final importance sampling exponent
     int beta_anneal_steps;     // Steps to anneal beta from start to end
     float min_priority;        // Minimum priority value
+    bool stratified_sampling;  // Stratified segment sampling instead of independent draws
 } ReplayConfig;
 
 // Episode statistics for tracking performance
@@ -116,22 +219,40 @@ typedef struct {
     float avg_q_value;
 } EpisodeStats;
 
-// Performance metrics for convergence analysis
+// Episodes of per-episode statistics kept in memory. Older episodes are only
+// available through a StatsSink log; the windows below must fit in this.
+#define TRAINING_STATS_HISTORY 256
+
+// Performance metrics for convergence analysis. Every array is a ring of
+// history_size entries indexed by episode % history_size.
 typedef struct {
     float* moving_avg_rewards;    // Moving average of rewards
     float* moving_avg_steps;      // Moving average of steps
-    int* success_episodes;        // Episodes where goal was reached
+    int* success_episodes;        // 1 where the goal was reached
     float* q_value_variance;      // Variance in Q-values over time
     float* epsilon_history;       // Epsilon values over time
+    int history_size;             // Ring length (> window_size and convergence_threshold, so the
+                                  // episode leaving each window is still in the ring)
     int window_size;              // Window size for moving averages
     int convergence_threshold;    // Episodes to check for convergence
     bool has_converged;           // Whether training has converged
     int convergence_episode;      // Episode where convergence was detected
+    // Rolling sums ending at last_episode, kept by update_performance_metrics
+    // so neither it nor check_convergence depends on the window length
+    int last_episode;             // Newest episode in the sums (-1 before the first)
+    double window_reward_sum;     // Rewards over the last window_size episodes
+    double window_steps_sum;      // Steps over the last window_size episodes
+    double conv_avg_sum;          // moving_avg_rewards over the last convergence_threshold episodes
+    double conv_avg_sq_sum;       // ... and their squares
+    int conv_success_count;       // Successes over the last convergence_threshold episodes
 } PerformanceMetrics;
 
-// Training statistics structure
+// Training statistics structure. Memory is bounded by history_size, not by
+// the number of episodes: episodes is a ring of the most recent ones, and
+// the run-wide figures are running totals.
 typedef struct {
-    EpisodeStats* episodes;
+    EpisodeStats* episodes;       // Ring indexed by episode % history_size
+    int history_size;
     int max_episodes;
     int current_episode;
     float best_reward;
@@ -141,28 +262,56 @@ typedef struct {
     int total_successful_episodes;
     float avg_reward_all_episodes;
     float avg_steps_all_episodes;
+    double total_reward_sum;      // Running sums behind the averages above
+    long long total_steps_sum;
     PerformanceMetrics* metrics;  // Advanced performance tracking
 } TrainingStats;
 
 // Function declarations
 QLearningAgent* create_agent(int num_states, int num_actions, float learning_rate, float discount_factor, float epsilon);
+QLearningAgent* create_agent_with_storage(int num_states, int num_actions, float learning_rate, float discount_factor,
+                                          float epsilon, QTableStorage storage);
+QLearningAgent* create_agent_mapped(const char* filename, int num_states, int num_actions, float learning_rate,
+                                    float discount_factor, float epsilon, bool create_new);
+bool sync_agent_q_table(QLearningAgent* agent);
+bool optimize_agent_memory_layout(QLearningAgent* agent, int* visit_counts);
 void destroy_agent(QLearningAgent* agent);
+void seed_agent(QLearningAgent* agent, unsigned int seed);
 Action select_action(QLearningAgent* agent, int state);
 Action select_greedy_action(QLearningAgent* agent, int state);
 void update_q_value(QLearningAgent* agent, int state, Action action, float reward, int next_state, bool done);
 void decay_epsilon(QLearningAgent* agent);
+
+// Q(lambda) mode: update_q_value also credits every pair still on the trace
+// list with its decayed share of the TD error, so a reward reaches back up
+// to ~log(min_trace) / log(gamma * lambda) steps at once. Traces are cut
+// when select_action explores and cleared at the end of an episode
+// (finish_training_episode or clear_eligibility_traces) and whenever the
+// table is replaced (reset_q_table, load_q_table). They are per agent
+// and single-threaded: do not enable them on a table shared by hogwild
+// workers. max_traces 0 = room for every trace above ELIGIBILITY_MIN_TRACE.
+bool enable_eligibility_traces(QLearningAgent* agent, float lambda, int max_traces);
+void disable_eligibility_traces(QLearningAgent* agent);
+void clear_eligibility_traces(QLearningAgent* agent);
 float get_q_value(QLearningAgent* agent, int state, Action action);
 void set_q_value(QLearningAgent* agent, int state, Action action, float value);
+float get_max_q_value(QLearningAgent* agent, int state);
+void get_q_value_bounds(QLearningAgent* agent, float* min_q, float* max_q);
+void reset_q_table(QLearningAgent* agent);
+bool copy_q_table(QLearningAgent* dst, QLearningAgent* src);
+bool average_q_tables(QLearningAgent* dst, QLearningAgent** srcs, int count, int state_begin, int state_end);
 
 // Experience buffer functions
 ExperienceBuffer* create_experience_buffer(int capacity);
 void destroy_experience_buffer(ExperienceBuffer* buffer);
 void add_experience(ExperienceBuffer* buffer, int state, Action action, float reward, int next_state, bool done);
 Experience* sample_experience(ExperienceBuffer* buffer);
+void seed_experience_buffer(ExperienceBuffer* buffer, unsigned int seed);
 
 // Priority experience replay functions
 PriorityExperienceBuffer* create_priority_buffer(int capacity, ReplayConfig config);
 void destroy_priority_buffer(PriorityExperienceBuffer* buffer);
+void seed_priority_buffer(PriorityExperienceBuffer* buffer, unsigned int seed);
 void add_priority_experience(PriorityExperienceBuffer* buffer, int state, Action action, float reward, int next_state, bool done, float td_error);
 PriorityExperience* sample_priority_batch(PriorityExperienceBuffer* buffer, int batch_size, int* indices, float* weights);
 void update_experience_priorities(PriorityExperienceBuffer* buffer, int* indices, float* td_errors, int count);
@@ -173,26 +322,34 @@ void update_beta(PriorityExperienceBuffer* buffer);
 void replay_batch_experiences(QLearningAgent* agent, PriorityExperience* batch, float* importance_weights, int batch_size);
 float calculate_td_error(QLearningAgent* agent, PriorityExperience* exp);
 
+// Structure-of-arrays replay. replay_update_batch() is the kernel: TD targets
+// use next-state rows read before the updates of each 64-transition pass,
+// each update reads the current Q(s, a), and weights/td_errors may be NULL. The TD errors it
+// writes are the ones update_experience_priorities() expects.
+ReplayBatch* create_replay_batch(int capacity);
+void destroy_replay_batch(ReplayBatch* batch);
+bool sample_replay_batch(PriorityExperienceBuffer* buffer, int batch_size, ReplayBatch* batch);
+void replay_update_batch(QLearningAgent* agent, const int* states, const int* actions, const float* rewards,
+                         const int* next_states, const bool* dones, const float* weights, int count,
+                         float* td_errors);
+// Update the agent from batch and write its TD errors back as priorities
+void replay_priority_batch(QLearningAgent* agent, PriorityExperienceBuffer* buffer, ReplayBatch* batch);
+
 // Replay configuration helpers
 ReplayConfig create_default_replay_config();
 ReplayConfig create_replay_config(bool enabled, int buffer_size, int batch_size, int replay_frequency, 
                                  float priority_alpha, float priority_beta_start, float priority_beta_end, 
                                  int beta_anneal_steps, float min_priority);
 
-// Priority queue helpers (internal)
-void heapify_up(PriorityExperienceBuffer* buffer, int index);
-void heapify_down(PriorityExperienceBuffer* buffer, int index);
-int heap_extract_max(PriorityExperienceBuffer* buffer);
-void heap_insert(PriorityExperienceBuffer* buffer, int experience_index, float priority);
-
 // Training statistics functions
 TrainingStats* create_training_stats(int max_episodes);
 void destroy_training_stats(TrainingStats* stats);
 void record_episode(TrainingStats* stats, int episode, float total_reward, int steps_taken, float epsilon_used, float avg_q_value);
 void print_training_summary(TrainingStats* stats);
+EpisodeStats* get_episode_stats(TrainingStats* stats, int episode);   // NULL once it left the history
 
 // Performance metrics functions
-PerformanceMetrics* create_performance_metrics(int max_episodes, int window_size, int convergence_threshold);
+PerformanceMetrics* create_performance_metrics(int history_size, int window_size, int convergence_threshold);
 void destroy_performance_metrics(PerformanceMetrics* metrics);
 void update_performance_metrics(PerformanceMetrics* metrics, TrainingStats* stats, int episode, bool goal_reached, float q_variance);
 bool check_convergence(PerformanceMetrics* metrics, int current_episode);
@@ -200,10 +357,12 @@ float calculate_moving_average(float* values, int start, int count);
 float calculate_q_value_variance(QLearningAgent* agent);
 void print_learning_curves(TrainingStats* stats, int last_n_episodes);
 void print_convergence_analysis(PerformanceMetrics* metrics, int current_episode);
-void save_performance_data(TrainingStats* stats, const char* filename);
+void save_performance_data(TrainingStats* stats, const char* filename);   // Episodes still in the history
 
 // Q-table save/load functions
 bool save_q_table(QLearningAgent* agent, const char* filename);
+bool save_q_table_compressed(QLearningAgent* agent, const char* filename);  // RLE rows, not mappable
+bool write_q_table_file(QLearningAgent* agent, const char* filename, bool compress, bool sync);  // Silent; sync = fsync
 bool load_q_table(QLearningAgent* agent, const char* filename);
 
 // State visit tracking functions
@@ -211,6 +370,7 @@ StateVisitTracker* create_state_visit_tracker(int num_states, bool adaptive_epsi
 void destroy_state_visit_tracker(StateVisitTracker* tracker);
 void update_state_visit(StateVisitTracker* tracker, int state);
 float get_exploration_bonus(StateVisitTracker* tracker, int state);
+float get_state_priority(StateVisitTracker* tracker, int state);
 float get_state_epsilon(StateVisitTracker* tracker, int state, float base_epsilon);
 float get_state_learning_rate(StateVisitTracker* tracker, int state, float base_learning_rate);
 void decay_exploration_bonuses(StateVisitTracker* tracker);
@@ -0,0 +1,56 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdbool.h>
+#include <pthread.h>
+#include "agent.h"
+
+// Background Q-table checkpoints. The training thread copies the table into
+// a private snapshot (a memcpy per row, no disk access) and a writer thread
+// saves it, so a slow disk never stalls training. Each checkpoint is written
+// to filename.tmp, synced, and renamed over filename; the previous keep - 1
+// checkpoints survive as filename.1 (newest) .. filename.(keep-1). filename
+// always names a complete checkpoint, even if the process dies mid-write.
+
+typedef struct {
+    char* filename;             // Newest checkpoint
+    char* temp_filename;        // filename.tmp, renamed into place once synced
+    int keep;                   // Checkpoints kept, including filename
+    bool compress;              // Save with save_q_table_compressed's encoding
+    int interval_episodes;      // Episodes between periodic checkpoints (0 = off)
+    double interval_seconds;    // Seconds between periodic checkpoints (0 = off)
+    int last_episode;           // Episode count of the last snapshot
+    double last_time;           // Monotonic time of the last snapshot
+
+    QLearningAgent* snapshot;   // Table copy owned by the writer while pending
+    pthread_mutex_t mutex;
+    pthread_cond_t has_work;    // Signalled when a snapshot is queued or on close
+    pthread_cond_t idle;        // Signalled after the writer finishes a snapshot
+    pthread_t writer;
+    bool pending;               // A snapshot is queued or being written
+    bool closing;
+    bool write_failed;
+    long long written;          // Checkpoints completed
+    long long skipped;          // Requests dropped because the writer was still busy
+} Checkpointer;
+
+// keep >= 1. Intervals only affect checkpoint_if_due(); either may be 0.
+Checkpointer* create_checkpointer(const char* filename, int keep, bool compress,
+                                  int interval_episodes, double interval_seconds);
+
+// Snapshot agent and hand it to the writer. Never waits for the disk: if the
+// previous checkpoint is still being written the request is skipped and false returned.
+bool request_checkpoint(Checkpointer* checkpointer, QLearningAgent* agent, int episode);
+
+// Request a checkpoint if interval_episodes or interval_seconds has passed since the last one
+bool checkpoint_if_due(Checkpointer* checkpointer, QLearningAgent* agent, int episode);
+
+// Block until the queued checkpoint (if any) is on disk; false if any write failed
+bool wait_for_checkpoint(Checkpointer* checkpointer);
+
+// Finish the queued checkpoint, stop the writer and free the snapshot
+void close_checkpointer(Checkpointer* checkpointer);
+
+long long checkpoints_written(Checkpointer* checkpointer);
+
+#endif // CHECKPOINT_H
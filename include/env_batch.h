@@ -0,0 +1,54 @@
+#ifndef ENV_BATCH_H
+#define ENV_BATCH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "environment.h"
+
+// Batch of independent grid world episodes stored as structure-of-arrays.
+// All environments share one layout (walkability bitmap, start, goal and
+// rewards) copied from a template GridWorld; only positions, step counters
+// and done flags are per environment.
+typedef struct {
+    int num_envs;               // Number of environments in the batch
+    int capacity;               // Per-env array length (num_envs rounded up to a SIMD multiple)
+    int width, height;          // Shared grid dimensions
+
+    // Per-environment state (SoA, 16-byte aligned)
+    int32_t* agent_x;           // Agent x coordinate
+    int32_t* agent_y;           // Agent y coordinate
+    int32_t* episode_steps;     // Steps taken in the current episode
+    int32_t* done;              // Episode finished flags (0 or 1)
+    float* total_rewards;       // Reward accumulated this episode
+
+    // Shared layout
+    uint64_t* walkable_bits;    // One bit per cell, row-major, 1 = walkable
+    int words_per_row;          // Bitmap words per grid row
+    Position start_pos;         // Starting position for every environment
+    Position goal_pos;          // Goal position for every environment
+    int max_steps;              // Maximum steps per episode
+    float step_penalty;         // Reward for a valid non-goal move
+    float goal_reward;          // Reward for reaching the goal
+    float wall_penalty;         // Reward for bumping into a wall or the border
+} GridWorldBatch;
+
+// Batch lifecycle
+GridWorldBatch* create_grid_world_batch(GridWorld* world, int num_envs);
+void destroy_grid_world_batch(GridWorldBatch* batch);
+void reset_grid_world_batch(GridWorldBatch* batch);
+void reset_batch_env(GridWorldBatch* batch, int env);
+int reset_done_envs(GridWorldBatch* batch);
+
+// Step every environment with one action each. Semantics match
+// step_environment(): finished environments return reward 0 and stay done,
+// invalid actions leave the agent in place with reward 0.
+// rewards, next_states and dones may each be NULL if not needed.
+void step_grid_world_batch(GridWorldBatch* batch, const int* actions,
+                           float* rewards, int* next_states, bool* dones);
+
+// State queries
+void get_batch_states(GridWorldBatch* batch, int* states);
+bool batch_is_walkable(GridWorldBatch* batch, int x, int y);
+int count_done_envs(GridWorldBatch* batch);
+
+#endif // ENV_BATCH_H
@@ -2,7 +2,9 @@
 #define ENVIRONMENT_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include "agent.h"
+#include "grid_layout.h"
 
 // Basic position structure
 typedef struct {
@@ -14,20 +16,31 @@ typedef struct {
     float x, y;
 } Vector2f;
 
-// Cell types in the grid world
+// Outcome of one compiled transition, indexing TransitionTable::outcome_reward
 typedef enum {
-    CELL_EMPTY = 0,
-    CELL_WALL = 1,
-    CELL_GOAL = 2,
-    CELL_AGENT = 3,
-    CELL_OBSTACLE = 4,
-    CELL_START = 5
-} CellType;
+    TRANSITION_STEP = 0,       // Moved to a non-goal cell
+    TRANSITION_BLOCKED = 1,    // Border, wall or obstacle; agent stays put
+    TRANSITION_GOAL = 2,       // Moved onto the goal (terminal)
+    NUM_TRANSITION_OUTCOMES = 3
+} TransitionOutcome;
+
+// Compiled transition model: one lookup per step instead of the move,
+// bounds, walkability and reward logic (5 bytes per state-action).
+// set_cell() marks it dirty; goal and reward changes are picked up
+// automatically on the next step.
+typedef struct {
+    int32_t* next_state;       // [state * NUM_ACTIONS + action]; equals state for blocked moves
+    uint8_t* outcome;          // TransitionOutcome for the same index
+    float outcome_reward[NUM_TRANSITION_OUTCOMES]; // step_penalty, wall_penalty, goal_reward
+    int num_states;            // width * height at build time
+    int goal_state;            // Goal the outcomes were classified against
+    bool dirty;                // Layout changed since the last build
+} TransitionTable;
 
 // Grid world environment structure
 typedef struct {
     int width, height;          // Grid dimensions
-    CellType** grid;           // 2D grid of cell types
+    GridLayout* layout;        // Bit-packed cells; shared by clones until one writes (use get_cell/set_cell)
     Position agent_pos;        // Current agent position
     Position goal_pos;         // Goal position
     Position start_pos;        // Starting position
@@ -38,6 +51,10 @@ typedef struct {
     float step_penalty;        // Penalty for each step (-1.0 typical)
     float goal_reward;         // Reward for reaching goal (+100.0 typical)
     float wall_penalty;        // Penalty for hitting wall (-10.0 typical)
+    bool stochastic;           // Whether actions are replaced at random with probability action_noise
+    float action_noise;        // Probability of a random action when stochastic (0.0-1.0)
+    RandomState rng;           // Environment randomness (placement, action noise; see seed_environment)
+    TransitionTable* transitions; // Compiled step model, or NULL (see set_transition_table)
 } GridWorld;
 
 // Environment configuration
@@ -70,12 +87,19 @@ typedef struct {
 // Function declarations for environment management
 GridWorld* create_grid_world(int width, int height);
 GridWorld* create_grid_world_from_config(EnvironmentConfig config);
+GridWorld* clone_grid_world(GridWorld* world);
 void destroy_grid_world(GridWorld* world);
 void reset_environment(GridWorld* world);
+void seed_environment(GridWorld* world, unsigned int seed);
 StepResult step_environment(GridWorld* world, Action action);
 int step(GridWorld* world, Action action, float* reward);
 int get_state_index(GridWorld* world);
 
+// Compiled transitions (per world; clones rebuild their own on first step)
+bool set_transition_table(GridWorld* world, bool enabled);
+bool has_transition_table(GridWorld* world);
+TransitionTable* get_transition_table(GridWorld* world);
+
 // Grid manipulation functions
 void set_cell(GridWorld* world, int x, int y, CellType type);
 CellType get_cell(GridWorld* world, int x, int y);
@@ -118,4 +142,8 @@ void get_reward_values(GridWorld* world, float* goal_reward, float* wall_penalty
 bool validate_environment(GridWorld* world);
 void print_environment_info(GridWorld* world);
 
+// Console output on creation and per episode (reset/destroy); disable for headless or threaded runs
+void set_environment_verbose(bool verbose);
+bool is_environment_verbose(void);
+
 #endif // ENVIRONMENT_H
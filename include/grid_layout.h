@@ -0,0 +1,80 @@
+#ifndef GRID_LAYOUT_H
+#define GRID_LAYOUT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Cell types in the grid world
+typedef enum {
+    CELL_EMPTY = 0,
+    CELL_WALL = 1,
+    CELL_GOAL = 2,
+    CELL_AGENT = 3,
+    CELL_OBSTACLE = 4,
+    CELL_START = 5
+} CellType;
+
+// Non-empty cell kept outside the bitset (goal, start, agent, obstacles)
+typedef struct {
+    int index;                  // y * width + x
+    CellType type;
+} GridSpecialCell;
+
+// Bit-packed grid layout. Walkability is one bit per cell (row-major, each
+// row starting on a 64-bit word), so the step hot path is one load and a
+// mask. The few cells whose exact type matters beyond walkability live in a
+// small side table sorted by index. A 4096x4096 grid needs 2 MB of bits.
+//
+// Layouts are reference counted so cloned worlds (e.g. parallel workers)
+// share one read-only copy; GridWorld copies it on the first write.
+typedef struct {
+    int width, height;
+    int words_per_row;          // Bitset words per grid row
+    uint64_t* blocked;          // Bit set = wall or obstacle (not walkable)
+    GridSpecialCell* specials;  // Sorted by index
+    int num_specials;
+    int special_capacity;
+    int ref_count;              // Owners; modified atomically
+    uint64_t revision;          // Unique across all layouts; changes on every write
+} GridLayout;
+
+// Lifecycle
+GridLayout* create_grid_layout(int width, int height);   // All cells empty
+GridLayout* copy_grid_layout(const GridLayout* layout);  // Private copy with ref_count 1
+GridLayout* retain_grid_layout(GridLayout* layout);      // Add an owner; returns layout
+void release_grid_layout(GridLayout* layout);            // Drop an owner; frees on the last one
+bool grid_layout_is_shared(const GridLayout* layout);
+
+// Caches derived from a layout (e.g. render textures) compare revisions to
+// detect changes; copies keep the revision of their source until written
+
+// Cell access (coordinates must be in bounds)
+void grid_layout_set(GridLayout* layout, int x, int y, CellType type);
+CellType grid_layout_get(const GridLayout* layout, int x, int y);
+
+static inline bool grid_layout_blocked(const GridLayout* layout, int x, int y) {
+    uint64_t word = layout->blocked[(size_t)y * layout->words_per_row + (x >> 6)];
+    return (word >> (x & 63)) & 1u;
+}
+
+// Bulk writes for level generators. grid_layout_fill sets every cell to
+// CELL_EMPTY or CELL_WALL and drops the side table; grid_layout_set_blocked
+// flips one walkability bit and leaves the side table and revision alone,
+// so it must not touch special cells and needs a fill before it or
+// grid_layout_mark_changed after it.
+void grid_layout_fill(GridLayout* layout, CellType type);
+void grid_layout_mark_changed(GridLayout* layout);
+
+static inline void grid_layout_set_blocked(GridLayout* layout, int x, int y, bool blocked) {
+    uint64_t* word = &layout->blocked[(size_t)y * layout->words_per_row + (x >> 6)];
+    uint64_t mask = (uint64_t)1 << (x & 63);
+    *word = blocked ? (*word | mask) : (*word & ~mask);
+}
+
+// Statistics
+int grid_layout_count(const GridLayout* layout, CellType type);
+int grid_layout_walkable_count(const GridLayout* layout);
+size_t grid_layout_bytes(const GridLayout* layout);
+
+#endif // GRID_LAYOUT_H
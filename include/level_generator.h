@@ -0,0 +1,37 @@
+#ifndef LEVEL_GENERATOR_H
+#define LEVEL_GENERATOR_H
+
+#include <stdbool.h>
+#include "environment.h"
+
+// Layout generators available to batch generation
+typedef enum {
+    LEVEL_SIMPLE_MAZE = 0,      // generate_simple_maze (binary tree)
+    LEVEL_RANDOM_MAZE,          // generate_random_maze, parameter = complexity
+    LEVEL_CORRIDORS,            // create_corridor_maze
+    LEVEL_RANDOM_WALLS          // clear_environment + add_random_walls, parameter = wall density
+} LevelType;
+
+// Batch generation settings
+typedef struct {
+    LevelType type;
+    float parameter;            // Complexity or wall density, depending on type
+    unsigned int seed;          // World i is reseeded with seed + i before generating
+    int num_threads;            // Threads sharing the batch (1 = run on the caller)
+    bool random_endpoints;      // Move start and goal to random free cells afterwards
+} LevelBatchConfig;
+
+// Defaults: complexity/density 0.3, single-threaded, fixed endpoints
+LevelBatchConfig create_default_level_batch_config(LevelType type);
+const char* level_type_name(LevelType type);
+bool parse_level_type(const char* name, LevelType* type);
+
+// Generate one level in world from its current generator state
+void generate_level(GridWorld* world, LevelType type, float parameter, bool random_endpoints);
+
+// Fill count distinct worlds (any sizes; clones sharing a layout each get
+// their own copy). Threads claim worlds one at a time, and every world is
+// seeded from its index, so the batch is identical for any thread count.
+bool generate_level_batch(GridWorld** worlds, int count, const LevelBatchConfig* config);
+
+#endif // LEVEL_GENERATOR_H
@@ -0,0 +1,71 @@
+#ifndef MEMORY_ARENA_H
+#define MEMORY_ARENA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Allocation layer for the per-run objects (agents, Q-tables, worlds,
+// layouts, stats, replay buffers, visit trackers). Their constructors call
+// memory_alloc() with a subsystem tag; each thread routes those calls either
+// to the heap (the default) or to its current arena (set_memory_arena).
+//
+// An arena hands out memory by bumping a pointer through large blocks and
+// never frees individual allocations, so building a run costs a few block
+// mallocs and resetting it is O(blocks). Destroy functions remain valid on
+// arena objects (memory_free is a no-op there). Reset or destroy the arena
+// only once its objects are destroyed or abandoned; abandoning is fine for
+// everything except huge-page and file-mapped Q-tables, which own mappings.
+
+typedef enum {
+    MEMORY_AGENT = 0,           // Agents and Q-tables
+    MEMORY_ENVIRONMENT,         // Grid worlds, layouts and transition tables
+    MEMORY_STATS,               // Training stats and performance metrics
+    MEMORY_REPLAY,              // Experience and priority replay buffers, sum trees
+    MEMORY_VISITS,              // State visit trackers
+    NUM_MEMORY_SUBSYSTEMS
+} MemorySubsystem;
+
+typedef struct MemoryArenaBlock {
+    struct MemoryArenaBlock* next;
+    size_t size;                // Usable bytes in data
+    size_t used;
+    unsigned char data[];
+} MemoryArenaBlock;
+
+// An arena belongs to one thread at a time
+typedef struct {
+    MemoryArenaBlock* first;
+    MemoryArenaBlock* current;  // Block allocations are served from; later blocks are empty
+    size_t block_size;          // Size of new blocks (larger for a bigger request)
+    size_t limit;               // Cap on block bytes, 0 = none; allocations past it fail
+    size_t reserved;            // Bytes held in blocks
+    size_t used[NUM_MEMORY_SUBSYSTEMS]; // Bytes handed out per subsystem since the last reset
+    size_t allocations;         // Allocations since the last reset
+    size_t peak_used;           // Largest total handed out between resets
+} MemoryArena;
+
+// Lifecycle (block_size 0 = 1 MB)
+MemoryArena* create_memory_arena(size_t block_size, size_t limit);
+void destroy_memory_arena(MemoryArena* arena);
+void reset_memory_arena(MemoryArena* arena);    // Keeps the blocks for the next run
+
+// Route this thread's allocations to arena (NULL = heap); returns the previous arena
+MemoryArena* set_memory_arena(MemoryArena* arena);
+MemoryArena* get_memory_arena(void);
+
+// Allocation. Pointers are 16-byte aligned (or alignment, a power of two)
+// and must be released with memory_free, never free.
+void* memory_alloc(MemorySubsystem subsystem, size_t size);
+void* memory_calloc(MemorySubsystem subsystem, size_t count, size_t size);
+void* memory_alloc_aligned(MemorySubsystem subsystem, size_t size, size_t alignment);
+void* memory_realloc(MemorySubsystem subsystem, void* ptr, size_t size);
+void memory_free(void* ptr);
+bool memory_from_arena(const void* ptr);
+
+// Reporting
+size_t memory_heap_bytes(MemorySubsystem subsystem);   // Live heap bytes, all threads
+size_t memory_arena_used(const MemoryArena* arena);    // All subsystems
+const char* memory_subsystem_name(MemorySubsystem subsystem);
+void print_memory_usage(const MemoryArena* arena);     // Heap totals, plus the arena if given
+
+#endif // MEMORY_ARENA_H
@@ -0,0 +1,72 @@
+#ifndef PARALLEL_TRAINING_H
+#define PARALLEL_TRAINING_H
+
+#include <stdbool.h>
+#include <pthread.h>
+#include "agent.h"
+#include "environment.h"
+
+// How worker threads share the Q-table
+typedef enum {
+    PARALLEL_MODE_HOGWILD = 0,  // All workers update the shared table without locks
+    PARALLEL_MODE_MERGE         // Private per-worker tables averaged into the shared table periodically
+} ParallelTrainingMode;
+
+// Parallel training configuration
+typedef struct {
+    int num_threads;            // Worker threads (each owns a cloned GridWorld)
+    int num_episodes;           // Total episodes across all workers
+    int max_steps_per_episode;  // Step limit per episode
+    ParallelTrainingMode mode;  // Q-table sharing strategy
+    int merge_interval;         // Episodes per worker between merges (PARALLEL_MODE_MERGE)
+    unsigned int seed;          // Run seed; worker i uses its stream jumped i times
+    bool print_progress;        // Print a summary line when training finishes
+} ParallelTrainingConfig;
+
+// Aggregate results of one parallel training run
+typedef struct {
+    int num_threads;
+    int episodes_completed;
+    int successful_episodes;
+    long long total_steps;
+    float avg_reward;
+    double elapsed_seconds;     // Wall-clock time
+    double episodes_per_second;
+    double steps_per_second;
+} ParallelTrainingResult;
+
+// Reusable thread barrier (pthread_barrier_t is an optional POSIX feature and missing on macOS)
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    int count;                  // Threads that must arrive before release
+    int waiting;                // Threads currently waiting
+    unsigned int generation;    // Incremented on every release
+    bool aborted;               // Set by worker_barrier_abort; waits return false from then on
+} WorkerBarrier;
+
+void worker_barrier_init(WorkerBarrier* barrier, int count);
+void worker_barrier_destroy(WorkerBarrier* barrier);
+// Returns false once the barrier is aborted; the caller should stop its work and return
+bool worker_barrier_wait(WorkerBarrier* barrier);
+// Release current and future waiters, e.g. when only part of a thread team started
+void worker_barrier_abort(WorkerBarrier* barrier);
+
+// Configuration helpers
+ParallelTrainingConfig create_default_parallel_config(void);
+const char* parallel_mode_name(ParallelTrainingMode mode);
+bool parse_parallel_mode(const char* name, ParallelTrainingMode* mode);
+
+// Train agent on world with config->num_threads workers. The agent's learning
+// rate, discount factor and epsilon schedule are used; epsilon is decayed once
+// per completed episode across all workers and written back to the agent.
+ParallelTrainingResult run_parallel_training(GridWorld* world, QLearningAgent* agent,
+                                             const ParallelTrainingConfig* config);
+
+// Train from the agent's current Q-table with 1, 2, 4, ... max_threads workers
+// and print episodes/sec, speedup and efficiency for each. The agent ends with
+// the table learned by the max_threads run.
+void run_parallel_scaling_report(GridWorld* world, QLearningAgent* agent,
+                                 const ParallelTrainingConfig* config, int max_threads);
+
+#endif // PARALLEL_TRAINING_H
@@ -0,0 +1,38 @@
+#ifndef PLANNING_H
+#define PLANNING_H
+
+#include <stdbool.h>
+#include "agent.h"
+#include "environment.h"
+
+// Value iteration settings
+typedef struct {
+    float discount_factor;      // Gamma used for the Bellman backup
+    float tolerance;            // Stop once no state value changes by more than this in a sweep
+    int max_iterations;         // Sweep limit
+    int num_threads;            // Threads sharing each sweep (1 = run on the caller)
+    bool print_progress;        // Print a summary line when planning finishes
+} PlanningConfig;
+
+// Outcome of one planning run
+typedef struct {
+    int iterations;             // Sweeps performed
+    float max_delta;            // Largest value change in the last sweep
+    bool converged;             // max_delta fell below the tolerance
+    double elapsed_seconds;     // Wall-clock time
+    double backups_per_second;  // State-action backups per second
+} PlanningResult;
+
+// Defaults: the agent's discount factor, 1e-4 tolerance, single-threaded
+PlanningConfig create_default_planning_config(const QLearningAgent* agent);
+
+// Synchronous value iteration over the world's transition table (compiled
+// temporarily if the world has none). Action noise is modelled exactly: with
+// probability action_noise the action is uniform. Episodes are treated as
+// unbounded (max_steps is ignored) and the goal is absorbing with value 0.
+// The resulting Q(s, a) overwrites agent's Q-table, so anything that reads
+// the table (greedy policy, save_policy_to_file, draw_q_values) sees the
+// planned values. Walls and obstacles get Q = 0.
+PlanningResult run_value_iteration(GridWorld* world, QLearningAgent* agent, const PlanningConfig* config);
+
+#endif // PLANNING_H
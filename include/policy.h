@@ -0,0 +1,59 @@
+#ifndef POLICY_H
+#define POLICY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "agent.h"
+
+// Greedy policy compiled out of a Q-table for serving: the argmax action of
+// every state packed into 2 bits, four states per byte (state s sits in
+// byte s / 4 at bit 2 * (s % 4)). A 10^7-state policy takes 2.5 MB, small
+// enough to stay in L2/L3 where the Q-table it came from would not.
+//
+// A compiled policy is immutable, so any number of threads can query it
+// at once (select_greedy_action on an optimized table updates its cache and
+// cannot be shared that way). To serve a retrained table, compile a new
+// policy and swap the pointer.
+
+#define POLICY_MAX_ACTIONS 4
+
+// File artifact: this header, then the packed bytes
+#define POLICY_FILE_MAGIC   0x4F504C52u   // "RLPO" little-endian
+#define POLICY_FILE_VERSION 1
+
+typedef struct {
+    uint32_t magic;             // POLICY_FILE_MAGIC
+    uint32_t version;           // POLICY_FILE_VERSION
+    int32_t num_states;
+    int32_t num_actions;
+    uint64_t data_size;         // Packed bytes after the header
+    uint32_t data_crc;          // CRC-32 of the packed bytes
+    uint32_t reserved;
+} PolicyFileHeader;
+
+typedef struct {
+    int num_states;
+    int num_actions;
+    size_t packed_bytes;        // (num_states + 3) / 4
+    uint8_t* packed;            // 64-byte aligned, padded to a whole cache line
+} CompiledPolicy;
+
+// Ties go to the lowest action, states outside the table act ACTION_UP,
+// both as in select_greedy_action(). Needs num_actions <= 4.
+CompiledPolicy* compile_policy(QLearningAgent* agent);
+void destroy_compiled_policy(CompiledPolicy* policy);
+size_t compiled_policy_bytes(const CompiledPolicy* policy);
+
+// actions[i] = greedy action of states[i], for n states
+void policy_act(const CompiledPolicy* policy, const int* states, int* actions, int n);
+
+bool save_compiled_policy(const CompiledPolicy* policy, const char* filename);
+CompiledPolicy* load_compiled_policy(const char* filename);
+
+// Single lookup; state must lie in [0, num_states)
+static inline Action policy_action(const CompiledPolicy* policy, int state) {
+    return (Action)((policy->packed[(unsigned)state >> 2] >> (((unsigned)state & 3u) << 1)) & 3u);
+}
+
+#endif // POLICY_H
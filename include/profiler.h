@@ -0,0 +1,87 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Hot-path instrumentation: per-thread call counters and scoped timers
+// around the stages of a training step. The PROFILE_* macros compile to
+// nothing unless ENABLE_PROFILING is defined (make PROFILE=1), so regular
+// builds pay nothing. Timestamps are rdtsc ticks on x86 and CLOCK_MONOTONIC
+// nanoseconds elsewhere, converted to seconds only when reporting.
+//
+// Each thread registers on its first record and then updates its own
+// counters without locks; summaries add up every thread. When tracing is
+// enabled a thread also keeps its first trace_events timings, which
+// profile_write_trace() dumps in the Chrome trace event format
+// (chrome://tracing or ui.perfetto.dev).
+//
+//     PROFILE_BEGIN(PROFILE_ENV_STEP);
+//     StepResult result = step_environment(world, action);
+//     PROFILE_END(PROFILE_ENV_STEP);
+
+typedef enum {
+    PROFILE_ENV_STEP = 0,
+    PROFILE_ACTION_SELECT,
+    PROFILE_Q_UPDATE,
+    PROFILE_REPLAY,             // Batch sampling and the replay update kernel
+    PROFILE_RENDER,
+    PROFILE_STATS,              // Episode bookkeeping and the stats log
+    NUM_PROFILE_ZONES
+} ProfileZone;
+
+#define PROFILE_MAX_THREADS 256  // Threads past this are not recorded
+
+typedef struct {
+    uint64_t calls;
+    uint64_t ticks;
+    uint64_t max_ticks;         // Longest single call
+} ProfileCounter;
+
+// Totals over all threads, in seconds
+typedef struct {
+    uint64_t calls[NUM_PROFILE_ZONES];
+    double seconds[NUM_PROFILE_ZONES];
+    double max_seconds[NUM_PROFILE_ZONES];  // Longest call since init, even for intervals
+    double wall_seconds;        // Covered by the summary (since init or the last interval)
+    int num_threads;
+    uint64_t dropped_events;    // Trace events lost to full buffers
+} ProfileSummary;
+
+// Set the epoch and the per-thread trace capacity (0 = counters only).
+// Call before worker threads start; threads that have already recorded
+// keep their buffers. Without it the first record sets the epoch.
+void profile_init(size_t trace_events);
+void profile_shutdown(void);    // Once no other thread is recording
+
+void profile_record(ProfileZone zone, uint64_t start, uint64_t end);
+uint64_t profile_clock_ticks(void);
+
+// Totals since profile_init, or since the previous interval summary
+ProfileSummary profile_collect(bool interval);
+void profile_print_summary(const char* title, bool interval);
+bool profile_write_trace(const char* filename);
+const char* profile_zone_name(ProfileZone zone);
+
+static inline uint64_t profile_ticks(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    return profile_clock_ticks();
+#endif
+}
+
+#ifdef ENABLE_PROFILING
+#define PROFILE_ENABLED 1
+#define PROFILE_BEGIN(zone) uint64_t profile_start_##zone = profile_ticks()
+#define PROFILE_END(zone) profile_record((zone), profile_start_##zone, profile_ticks())
+#define PROFILE_INTERVAL_REPORT() profile_print_summary("Interval profile", true)
+#else
+#define PROFILE_ENABLED 0
+#define PROFILE_BEGIN(zone) ((void)0)
+#define PROFILE_END(zone) ((void)0)
+#define PROFILE_INTERVAL_REPORT() ((void)0)
+#endif
+
+#endif // PROFILER_H
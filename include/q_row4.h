@@ -0,0 +1,75 @@
+#ifndef Q_ROW4_H
+#define Q_ROW4_H
+
+#include <stdint.h>
+
+// Kernels for Q-rows of exactly four actions, the grid world's configuration.
+// A row is one 128-bit vector: max is two shuffled maxes and argmax is a
+// compare mask, with no per-action loop or branch.
+//
+// Rows must be 16-byte aligned. Every Q-table backing qualifies when its
+// stride is four floats: memory_alloc hands out 16-byte aligned blocks,
+// OptimizedQTable data is SIMD aligned and mapped tables start page aligned.
+//
+// Ties go to the lowest action, as in the scalar loops. If the row holds a
+// NaN, the result is unspecified but still a valid action.
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+#define Q_ROW4_WIDTH 4
+#define Q_ROW4_ALIGNMENT 16
+
+#if defined(__SSE2__)
+
+// Every lane holds the row maximum
+static inline __m128 q_row4_broadcast_max(__m128 row) {
+    __m128 max = _mm_max_ps(row, _mm_shuffle_ps(row, row, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_max_ps(max, _mm_shuffle_ps(max, max, _MM_SHUFFLE(1, 0, 3, 2)));
+}
+
+static inline float q_row4_max(const float* row) {
+    return _mm_cvtss_f32(q_row4_broadcast_max(_mm_load_ps(row)));
+}
+
+static inline int q_row4_argmax(const float* row) {
+    __m128 values = _mm_load_ps(row);
+    int mask = _mm_movemask_ps(_mm_cmpeq_ps(values, q_row4_broadcast_max(values)));
+    return __builtin_ctz((unsigned)mask | 0x10u) & 3;  // No lane equal (NaN) -> action 0
+}
+
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+
+static inline float q_row4_max(const float* row) {
+    return vmaxvq_f32(vld1q_f32(row));
+}
+
+static inline int q_row4_argmax(const float* row) {
+    static const uint32_t lane_bits[4] = {1, 2, 4, 8};
+    float32x4_t values = vld1q_f32(row);
+    uint32x4_t equal = vceqq_f32(values, vdupq_n_f32(vmaxvq_f32(values)));
+    uint32_t mask = vaddvq_u32(vandq_u32(equal, vld1q_u32(lane_bits)));
+    return __builtin_ctz(mask | 0x10u) & 3;
+}
+
+#else
+
+// Portable version: selects the compiler can turn into conditional moves
+static inline float q_row4_max(const float* row) {
+    float low = row[1] > row[0] ? row[1] : row[0];
+    float high = row[3] > row[2] ? row[3] : row[2];
+    return high > low ? high : low;
+}
+
+static inline int q_row4_argmax(const float* row) {
+    int low = row[1] > row[0] ? 1 : 0;
+    int high = row[3] > row[2] ? 3 : 2;
+    return row[high] > row[low] ? high : low;
+}
+
+#endif
+
+#endif // Q_ROW4_H
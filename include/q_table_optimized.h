@@ -5,6 +5,20 @@
 #include <stdint.h>
 #include <stddef.h>
 
+// Memory allocation strategies
+typedef enum {
+    ALLOC_STANDARD,                 // Standard malloc
+    ALLOC_ALIGNED,                  // Aligned allocation for SIMD
+    ALLOC_HUGE_PAGES,              // Use huge pages if available
+    ALLOC_NUMA_LOCAL               // NUMA-aware allocation
+} QTableAllocStrategy;
+
+// How the row data was actually placed (OptimizedQTable.alloc_flags)
+#define QTABLE_ALLOC_HUGETLB      0x1u  // Explicit MAP_HUGETLB pages
+#define QTABLE_ALLOC_THP          0x2u  // 2 MB aligned region advised for transparent huge pages
+#define QTABLE_ALLOC_MBIND        0x4u  // Pages given a preferred NUMA node with mbind
+#define QTABLE_ALLOC_FIRST_TOUCH  0x8u  // Pages faulted in by the creating thread
+
 // Optimized Q-table structure for improved memory access patterns
 typedef struct {
     float* data;                    // Flattened 1D array for better cache locality
@@ -28,16 +42,21 @@ typedef struct {
     // SIMD optimization support
     bool simd_enabled;              // Whether SIMD operations are available
     int simd_alignment;             // Memory alignment for SIMD (16 or 32 bytes)
+    
+    // Allocation actually applied; huge page and NUMA requests fall back to
+    // ALLOC_ALIGNED when the platform cannot honor them
+    QTableAllocStrategy alloc_strategy;
+    unsigned alloc_flags;           // QTABLE_ALLOC_* details
+    int numa_node;                  // Node the rows were placed on (-1 if unknown)
+    void* alloc_base;               // Start of the mmap'd region (NULL for heap allocations)
+    size_t alloc_size;              // Bytes mapped at alloc_base
+    
+    // Row permutation installed by optimize_memory_layout(); NULL means state s
+    // lives in row s. All accessors translate, so callers keep using state ids.
+    int* state_slots;               // Logical state -> physical row
+    int* slot_states;               // Physical row -> logical state
 } OptimizedQTable;
 
-// Memory allocation strategies
-typedef enum {
-    ALLOC_STANDARD,                 // Standard malloc
-    ALLOC_ALIGNED,                  // Aligned allocation for SIMD
-    ALLOC_HUGE_PAGES,              // Use huge pages if available
-    ALLOC_NUMA_LOCAL               // NUMA-aware allocation
-} QTableAllocStrategy;
-
 // Access pattern hints for optimization
 typedef struct {
     bool frequent_max_queries;      // Frequently query max Q-values
@@ -59,25 +78,47 @@ typedef struct {
 OptimizedQTable* create_optimized_qtable(int num_states, int num_actions, 
                                          QTableAllocStrategy strategy,
                                          AccessPatternHints hints);
+// ALLOC_NUMA_LOCAL on an explicit node instead of the calling thread's node
+OptimizedQTable* create_optimized_qtable_on_node(int num_states, int num_actions,
+                                                 AccessPatternHints hints, int numa_node);
 void destroy_optimized_qtable(OptimizedQTable* qtable);
+const char* qtable_alloc_strategy_name(QTableAllocStrategy strategy);
+const char* qtable_alloc_description(const OptimizedQTable* qtable);  // e.g. "huge pages (THP)"
+
+// Creation message on stdout; disable for benchmarks that build many tables
+void set_qtable_verbose(bool verbose);
+bool is_qtable_verbose(void);
 
 // Fast inline access functions (defined in header for inlining)
+static inline int qtable_state_slot(const OptimizedQTable* qtable, int state) {
+    return qtable->state_slots ? qtable->state_slots[state] : state;
+}
+
 static inline float* get_state_row_fast(OptimizedQTable* qtable, int state) {
     if (qtable->use_row_cache && state < 256) {
         return qtable->state_rows[state];
     }
-    return qtable->data + (state * qtable->state_stride);
+    return qtable->data + ((size_t)qtable_state_slot(qtable, state) * qtable->state_stride);
 }
 
 static inline float get_q_value_fast(OptimizedQTable* qtable, int state, int action) {
-    return qtable->data[state * qtable->state_stride + action];
+    if (!qtable) return 0.0f;
+    return qtable->data[(size_t)qtable_state_slot(qtable, state) * qtable->state_stride + action];
 }
 
 static inline void set_q_value_fast(OptimizedQTable* qtable, int state, int action, float value) {
-    qtable->data[state * qtable->state_stride + action] = value;
-    // Invalidate cache for this state
-    if (qtable->cache_valid) {
-        qtable->cache_valid[state] = false;
+    qtable->data[(size_t)qtable_state_slot(qtable, state) * qtable->state_stride + action] = value;
+    // Keep a valid max/argmax cache current in O(1); only a write that lowers
+    // the cached best action forces a rescan on the next query
+    if (qtable->cache_valid && qtable->cache_valid[state]) {
+        int best = qtable->best_action_cache[state];
+        float max_q = qtable->max_q_cache[state];
+        if (value > max_q || (value == max_q && action < best)) {
+            qtable->max_q_cache[state] = value;
+            qtable->best_action_cache[state] = action;
+        } else if (action == best) {
+            qtable->cache_valid[state] = false;
+        }
     }
 }
 
@@ -100,8 +141,12 @@ void simd_update_state_row(OptimizedQTable* qtable, int state, float* new_values
 float simd_max_in_row(OptimizedQTable* qtable, int state);
 int simd_argmax_in_row(OptimizedQTable* qtable, int state);
 
-// Memory layout optimization
-void optimize_memory_layout(OptimizedQTable* qtable, int* access_frequency);
+// Memory layout optimization. Rows are physically permuted in place; cached
+// max/argmax values stay valid because they are keyed by logical state.
+// Not for MappedQTable bases, whose file must stay in state order.
+bool apply_state_layout(OptimizedQTable* qtable, const int* state_slots);  // NULL = identity
+void optimize_memory_layout(OptimizedQTable* qtable, int* access_frequency); // Hottest states first
+bool optimize_memory_layout_morton(OptimizedQTable* qtable, int width, int height); // Z-order over y*width+x
 void prefetch_state_data(OptimizedQTable* qtable, int state);
 void warm_up_caches(OptimizedQTable* qtable, int* likely_states, int count);
 
@@ -131,23 +176,106 @@ typedef struct {
     size_t mapped_size;
     char* filename;
     bool read_only;
+    bool reseal_crc;                // File was checksummed; restore it on destroy
 } MappedQTable;
 
+// On-disk Q-table layout, shared by mapped tables and save_q_table()
+// checkpoints: this header at offset 0, then num_states * state_stride floats
+// (row-major) at data_offset. The data offset is page aligned so the file can
+// be mapped and its rows handed straight to SIMD code. Version 1 files (no
+// checksum or parameters) are still accepted.
+#define QTABLE_FILE_MAGIC       0x54514C52u   // "RLQT" little-endian
+#define QTABLE_FILE_VERSION     2
+#define QTABLE_FILE_DATA_OFFSET 4096
+#define QTABLE_FILE_BYTE_ORDER  0x01020304u   // Reads back swapped on a host of the other endianness
+
+// QTableFileHeader.flags
+#define QTABLE_FILE_CRC          0x1u  // data_crc and header_crc are valid
+#define QTABLE_FILE_RLE          0x2u  // Data is run-length encoded (load only, cannot be mapped)
+#define QTABLE_FILE_AGENT_PARAMS 0x4u  // learning_rate .. epsilon_min hold the saving agent's values
+
+typedef struct {
+    uint32_t magic;                 // QTABLE_FILE_MAGIC
+    uint32_t version;               // QTABLE_FILE_VERSION
+    uint32_t header_size;           // sizeof(QTableFileHeader) when written
+    uint32_t flags;                 // QTABLE_FILE_* bits
+    int32_t num_states;
+    int32_t num_actions;
+    int32_t state_stride;           // Floats per row (>= num_actions)
+    uint32_t byte_order;            // QTABLE_FILE_BYTE_ORDER (0 in version 1)
+    uint64_t data_offset;           // Byte offset of the first row
+    uint64_t data_size;             // Bytes of Q-value data once decoded
+    uint64_t checkpoint_count;      // Incremented by every sync_mapped_qtable()
+    // Version 2
+    uint64_t stored_size;           // Bytes at data_offset (data_size unless QTABLE_FILE_RLE)
+    uint32_t data_crc;              // CRC-32 of the stored bytes
+    uint32_t header_crc;            // CRC-32 of this header with header_crc zeroed
+    float learning_rate;
+    float discount_factor;
+    float epsilon;
+    float epsilon_decay;
+    float epsilon_min;
+    uint32_t reserved;
+} QTableFileHeader;
+
+// create_new truncates/creates the file (zero-filled, sparse). Otherwise the
+// existing file is validated and mapped without reading it; pass 0 for
+// num_states/num_actions to accept the file's dimensions. Falls back to a
+// read-only mapping when the file cannot be opened for writing.
+// Rows change in place while mapped, so a checksummed file opened for writing
+// drops QTABLE_FILE_CRC (a crash mid-run leaves it loadable, unchecked);
+// destroy_mapped_qtable recomputes the checksum and sets the flag again.
 MappedQTable* create_mapped_qtable(const char* filename, int num_states, 
                                   int num_actions, bool create_new);
 void destroy_mapped_qtable(MappedQTable* qtable);
-bool sync_mapped_qtable(MappedQTable* qtable);
+bool sync_mapped_qtable(MappedQTable* qtable);        // Blocking checkpoint (msync MS_SYNC)
+bool sync_mapped_qtable_async(MappedQTable* qtable);  // Schedule write-back (msync MS_ASYNC)
 
-// Compression for storage efficiency
+// Q-table file helpers. The validator checks a header read from a file of
+// file_size bytes (0 dimensions accept any) and fills in version 1 defaults.
+bool validate_qtable_file_header(QTableFileHeader* header, uint64_t file_size, const char* filename,
+                                 int num_states, int num_actions);
+void seal_qtable_file_header(QTableFileHeader* header);          // Set header_crc
+uint32_t qtable_crc32(uint32_t crc, const void* data, size_t size);  // Start with crc = 0
+
+// Word-level run-length coding: a token with the high bit set repeats the
+// next word (token & 0x7fffffff) times, any other token is followed by that
+// many literal words. Runs of unvisited (zero) states cost two words.
+size_t qtable_rle_bound(size_t words);   // Worst-case encoded words
+size_t qtable_rle_encode(const uint32_t* words, size_t count, uint32_t* out);
+bool qtable_rle_decode(const uint32_t* in, size_t in_words, uint32_t* out, size_t out_words);
+
+// Compression for storage efficiency.
+// Each value is stored as an unsigned code: value = offset + code * scale.
+// States are grouped into blocks of states_per_block rows that share one
+// scale/offset, so a block with a narrow value range keeps full code
+// resolution. A positive scale keeps codes monotonic within a row, which lets
+// greedy lookups compare codes directly without dequantizing.
 typedef struct {
-    uint16_t* compressed_data;      // Quantized Q-values
-    float scale_factor;             // Scaling factor for quantization
-    float offset;                   // Offset for quantization
+    void* compressed_data;          // Quantized Q-values (uint8_t or uint16_t), row-major
+    float* block_scales;            // Per-block quantization step
+    float* block_offsets;           // Per-block minimum value
+    float scale_factor;             // Largest block step (worst-case error is half of it)
+    float offset;                   // Minimum value over the whole table
     int compression_bits;           // Bits per value (8 or 16)
+    int num_states;
+    int num_actions;
+    int states_per_block;           // Rows sharing one scale/offset (num_states = per-table)
+    int num_blocks;
 } CompressedQTable;
 
+// Quantize with a single table-wide scale/offset
 CompressedQTable* compress_qtable(OptimizedQTable* qtable, int target_bits);
+// Quantize with one scale/offset per states_per_block consecutive states
+CompressedQTable* compress_qtable_blocked(OptimizedQTable* qtable, int target_bits, int states_per_block);
 OptimizedQTable* decompress_qtable(CompressedQTable* compressed);
 void destroy_compressed_qtable(CompressedQTable* qtable);
 
+// Read-only inference directly on the quantized codes
+float compressed_get_q_value(const CompressedQTable* qtable, int state, int action);
+float compressed_get_max_q_value(const CompressedQTable* qtable, int state);
+int compressed_get_best_action(const CompressedQTable* qtable, int state);
+void compressed_batch_best_actions(const CompressedQTable* qtable, const int* states, int* actions, int count);
+size_t compressed_qtable_bytes(const CompressedQTable* qtable);  // Codes plus block parameters
+
 #endif // Q_TABLE_OPTIMIZED_H
@@ -0,0 +1,88 @@
+#ifndef RENDER_SNAPSHOT_H
+#define RENDER_SNAPSHOT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "agent.h"
+#include "environment.h"
+
+// Hand-off between a training thread running at full speed and the raylib
+// thread drawing at display rate. Neither side ever blocks on the other:
+// snapshots go through a triple buffer and user commands through a
+// single-producer/single-consumer ring. Nothing here touches raylib.
+
+// What the renderer needs from the trainer for one frame
+typedef struct {
+    Position agent_pos;
+    Action last_action;
+    int episode;                // Zero-based episode in progress
+    int step;                   // Steps taken in that episode
+    float episode_reward;
+    float epsilon;
+    bool paused;
+    long long total_steps;      // Steps since training (re)started
+    double steps_per_second;
+    float min_q, max_q;         // Q-table bounds for colour normalisation
+    int num_states;
+    float* state_max_q;         // max_a Q(s, a) per state
+    uint8_t* best_action;       // Greedy action per state
+    uint64_t sequence;          // Publish counter (0 = nothing published yet)
+} RenderSnapshot;
+
+// Three snapshots: one being written, one being read and one ready to swap.
+// publish and acquire exchange a slot index with the ready slot, so the
+// writer never overwrites the slot the reader holds.
+typedef struct {
+    RenderSnapshot slots[3];
+    int write_slot;             // Owned by the training thread
+    int read_slot;              // Owned by the render thread
+    int ready;                  // Ready slot index, SNAPSHOT_FRESH set when unread
+    uint64_t published;         // Training-thread publish counter
+} SnapshotBuffer;
+
+#define SNAPSHOT_FRESH 4
+
+SnapshotBuffer* create_snapshot_buffer(int num_states);
+void destroy_snapshot_buffer(SnapshotBuffer* buffer);
+
+// Training side: fill the slot returned by snapshot_begin_write, then publish it
+RenderSnapshot* snapshot_begin_write(SnapshotBuffer* buffer);
+void snapshot_publish(SnapshotBuffer* buffer);
+
+// Copy the agent's tracked bounds and the per-state greedy value and action into snapshot
+void snapshot_capture_q_values(RenderSnapshot* snapshot, QLearningAgent* agent);
+
+// Render side: newest published snapshot, or the previous one when nothing
+// new arrived. Valid until the next call; NULL before the first publish.
+const RenderSnapshot* snapshot_acquire(SnapshotBuffer* buffer);
+
+// Commands forwarded from the input handler to the training thread
+typedef enum {
+    TRAINING_CMD_SET_PAUSED = 0,    // value: 1 = pause, 0 = resume
+    TRAINING_CMD_RESET,
+    TRAINING_CMD_SAVE,
+    TRAINING_CMD_LOAD,
+    TRAINING_CMD_EXIT
+} TrainingCommandType;
+
+typedef struct {
+    TrainingCommandType type;
+    int value;
+} TrainingCommand;
+
+// Power of two so head and tail can wrap freely
+#define TRAINING_COMMAND_CAPACITY 64
+
+typedef struct {
+    TrainingCommand commands[TRAINING_COMMAND_CAPACITY];
+    unsigned int head;          // Next slot to read (consumer)
+    unsigned int tail;          // Next slot to write (producer)
+} TrainingCommandQueue;
+
+void init_command_queue(TrainingCommandQueue* queue);
+// One producer thread; returns false when the queue is full
+bool push_training_command(TrainingCommandQueue* queue, TrainingCommand command);
+// One consumer thread; returns false when the queue is empty
+bool pop_training_command(TrainingCommandQueue* queue, TrainingCommand* command);
+
+#endif // RENDER_SNAPSHOT_H
@@ -5,6 +5,7 @@
 #include "raylib.h"
 #include "environment.h"
 #include "agent.h"
+#include "render_snapshot.h"
 
 // Rendering configuration structure
 typedef struct {
@@ -19,6 +20,7 @@ typedef struct {
     float animation_speed;      // Speed of animations (0.0-1.0)
     int fps_target;             // Target FPS
     bool vsync_enabled;         // Whether VSync is enabled
+    bool batched_rendering;     // Draw cells and heatmap as one textured quad per layer
 } RenderConfig;
 
 // Color scheme for visualization
@@ -73,6 +75,26 @@ typedef struct {
     bool font_loaded;           // Whether custom font is loaded
 } TextRenderer;
 
+// One texel per grid cell, drawn as a single scaled quad. pixels mirrors
+// the texture so only rows whose colour changed are uploaded.
+typedef struct {
+    Texture2D texture;
+    Color* pixels;
+    int width, height;
+    bool loaded;
+    int dirty_y0, dirty_y1;     // Rows [y0, y1) changed since the last upload
+} LayerTexture;
+
+// Textures behind batched rendering, created on first use
+typedef struct {
+    LayerTexture cells;         // Full cell colours (draw_grid_world)
+    LayerTexture walls;         // Walls only, rest transparent (draw_walls)
+    LayerTexture q_values;      // Greedy-value heatmap, walls transparent (draw_q_values)
+    uint64_t layout_revision;   // GridLayout revision the cell layers were built from
+    Texture2D arrows;           // Policy arrow atlas: one square tile per action
+    bool arrows_loaded;
+} BatchedRenderCache;
+
 // Visualization state
 typedef struct {
     RenderConfig config;        // Rendering configuration
@@ -83,6 +105,7 @@ typedef struct {
     TextRenderer text;          // Text rendering
     Camera2D camera;            // 2D camera for zooming/panning
     bool camera_enabled;        // Whether camera controls are active
+    BatchedRenderCache batch;   // Used when config.batched_rendering is set
 } VisualizationState;
 
 // Function declarations for rendering system
@@ -106,6 +129,7 @@ void draw_walls(VisualizationState* vis, GridWorld* world);
 
 // Q-value visualization
 void draw_q_values(VisualizationState* vis, GridWorld* world, QLearningAgent* agent);
+void draw_snapshot_q_values(VisualizationState* vis, GridWorld* world, const RenderSnapshot* snapshot);
 void draw_q_value_arrows(VisualizationState* vis, GridWorld* world, QLearningAgent* agent);
 void draw_q_value_heatmap(VisualizationState* vis, GridWorld* world, QLearningAgent* agent);
 void draw_policy_arrows(VisualizationState* vis, GridWorld* world, QLearningAgent* agent);
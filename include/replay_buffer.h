@@ -0,0 +1,85 @@
+#ifndef REPLAY_BUFFER_H
+#define REPLAY_BUFFER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "agent.h"
+#include "sum_tree.h"
+
+// Prioritized replay stored as one column per field, each sized to the
+// problem: state ids take 16 bits when num_states <= 65536 (32 otherwise),
+// the action and done flag share a byte, and priorities live only in the
+// sum tree leaves. A transition costs 9 bytes instead of the 32 of a
+// PriorityExperience (13 with 32-bit states). Sampling returns slot indices;
+// callers read fields through the accessors below, nothing is copied.
+
+#define COMPACT_REPLAY_DONE 0x80u       // Done flag in the action byte
+#define COMPACT_REPLAY_ACTION_MASK 0x7Fu
+#define COMPACT_REPLAY_NARROW_STATES 65536
+
+typedef struct {
+    int capacity;
+    int size;
+    int current_index;          // Slot the next transition overwrites
+    int num_states;
+    int num_actions;
+    bool wide_states;           // uint32_t state columns instead of uint16_t
+    void* states;
+    void* next_states;
+    uint8_t* actions;           // Action in the low 7 bits, COMPACT_REPLAY_DONE on terminal transitions
+    float* rewards;
+    SumTree* priority_tree;     // Per-slot priorities with running sum/min/max
+    bool stratified;            // Draw one sample from each of batch_size equal priority segments
+    float alpha;                // Priority exponent (0 = uniform, 1 = full priority)
+    float beta;                 // Importance sampling exponent (anneals to 1.0)
+    float beta_increment;
+    float min_priority;         // Added to |TD error| so no slot becomes unsampleable
+    RandomState rng;            // Sampling randomness
+} CompactReplayBuffer;
+
+// States must lie in [0, num_states) and num_actions <= 127
+CompactReplayBuffer* create_compact_replay_buffer(int capacity, int num_states, int num_actions, ReplayConfig config);
+void destroy_compact_replay_buffer(CompactReplayBuffer* buffer);
+void seed_compact_replay_buffer(CompactReplayBuffer* buffer, unsigned int seed);
+size_t compact_replay_bytes(const CompactReplayBuffer* buffer);  // Columns plus priority tree
+
+// Out-of-range states or actions are rejected (false)
+bool add_compact_experience(CompactReplayBuffer* buffer, int state, Action action, float reward,
+                            int next_state, bool done, float td_error);
+
+// Draw batch_size slots in proportion to priority, with importance weights
+// normalized so the largest possible weight is 1 (as sample_priority_batch)
+bool sample_compact_batch(CompactReplayBuffer* buffer, int batch_size, int* indices, float* weights);
+void update_compact_priorities(CompactReplayBuffer* buffer, const int* indices, const float* td_errors, int count);
+void update_compact_beta(CompactReplayBuffer* buffer);
+
+// Run replay_update_batch() over the sampled slots and write the TD errors
+// back as priorities. td_errors (count entries) may be NULL.
+void replay_compact_batch(QLearningAgent* agent, CompactReplayBuffer* buffer, const int* indices,
+                          const float* weights, int count, float* td_errors);
+
+// Field accessors for a slot returned by sample_compact_batch()
+static inline int compact_replay_state(const CompactReplayBuffer* buffer, int slot) {
+    return buffer->wide_states ? (int)((const uint32_t*)buffer->states)[slot]
+                               : (int)((const uint16_t*)buffer->states)[slot];
+}
+
+static inline int compact_replay_next_state(const CompactReplayBuffer* buffer, int slot) {
+    return buffer->wide_states ? (int)((const uint32_t*)buffer->next_states)[slot]
+                               : (int)((const uint16_t*)buffer->next_states)[slot];
+}
+
+static inline Action compact_replay_action(const CompactReplayBuffer* buffer, int slot) {
+    return (Action)(buffer->actions[slot] & COMPACT_REPLAY_ACTION_MASK);
+}
+
+static inline bool compact_replay_done(const CompactReplayBuffer* buffer, int slot) {
+    return (buffer->actions[slot] & COMPACT_REPLAY_DONE) != 0;
+}
+
+static inline float compact_replay_reward(const CompactReplayBuffer* buffer, int slot) {
+    return buffer->rewards[slot];
+}
+
+#endif // REPLAY_BUFFER_H
@@ -0,0 +1,77 @@
+#ifndef STATS_SINK_H
+#define STATS_SINK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <pthread.h>
+#include "agent.h"
+
+// Streaming per-episode log. Records are appended to a fixed-size ring and
+// written by a background thread, so training keeps only TrainingStats'
+// rolling history in memory and a crash loses at most the last flush
+// interval of records.
+
+typedef enum {
+    STATS_SINK_CSV = 0,         // Same columns as save_performance_data
+    STATS_SINK_BINARY           // StatsFileHeader followed by raw StatsRecords
+} StatsSinkFormat;
+
+// One episode, fixed size
+typedef struct {
+    int32_t episode;            // One-based, as in the CSV
+    float total_reward;
+    int32_t steps_taken;
+    int32_t success;            // 1 if the goal was reached
+    float moving_avg_reward;
+    float moving_avg_steps;
+    float epsilon;
+    float q_variance;
+} StatsRecord;
+
+#define STATS_FILE_MAGIC 0x5453514Cu    // "LQST" little-endian
+#define STATS_FILE_VERSION 1
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t record_size;       // sizeof(StatsRecord)
+    uint32_t reserved;
+} StatsFileHeader;
+
+typedef struct {
+    FILE* file;
+    char* filename;
+    StatsSinkFormat format;
+    StatsRecord* ring;
+    int capacity;               // Ring slots
+    long long head;             // Records appended (producer)
+    long long tail;             // Records written (writer thread)
+    double flush_interval;      // Seconds between writes when the ring is not filling up
+    bool closing;
+    bool write_failed;
+    pthread_mutex_t mutex;
+    pthread_cond_t has_work;    // Signalled when the ring passes half full or on flush/close
+    pthread_cond_t has_space;   // Signalled after the writer retires records
+    pthread_t writer;
+    long long flush_requested;  // Record count a flush waits for
+} StatsSink;
+
+// Open filename (truncated) and start the writer. capacity is the ring size in records.
+StatsSink* create_stats_sink(const char* filename, StatsSinkFormat format, int capacity);
+
+// Queue one record; waits only if the writer has fallen a full ring behind
+bool stats_sink_append(StatsSink* sink, const StatsRecord* record);
+
+// Queue the episode just recorded in stats (record_episode + update_performance_metrics)
+bool stats_sink_record_episode(StatsSink* sink, TrainingStats* stats, int episode);
+
+// Block until every appended record is written and flushed to the file
+bool stats_sink_flush(StatsSink* sink);
+
+// Flush, stop the writer and close the file
+void close_stats_sink(StatsSink* sink);
+
+long long stats_sink_records_written(StatsSink* sink);
+
+#endif // STATS_SINK_H
@@ -0,0 +1,44 @@
+#ifndef SUM_TREE_H
+#define SUM_TREE_H
+
+#include <stdbool.h>
+
+// Segment tree over per-item priorities for proportional sampling.
+// Nodes are stored implicitly (root at 1, children of i at 2i and 2i+1,
+// leaves at leaf_base + index). Each node keeps the sum, minimum and maximum
+// of its subtree, so updates, prefix-sum lookups and global min/max are all
+// O(log n) or better. Unused leaves hold priority 0 and do not affect min/max.
+typedef struct {
+    int capacity;           // Number of addressable items
+    int leaf_base;          // Smallest power of two >= capacity
+    double* sums;           // Subtree sums (double so 1M-entry totals stay accurate)
+    float* mins;            // Subtree minimum over used leaves (FLT_MAX if none)
+    float* maxs;            // Subtree maximum over used leaves (0 if none)
+} SumTree;
+
+// Lifecycle
+SumTree* create_sum_tree(int capacity);
+void destroy_sum_tree(SumTree* tree);
+void sum_tree_clear(SumTree* tree);
+
+// Set the priority of one item (O(log n)). A priority <= 0 marks the leaf unused.
+void sum_tree_update(SumTree* tree, int index, float priority);
+float sum_tree_get(SumTree* tree, int index);
+
+// Aggregates over all used leaves (O(1))
+double sum_tree_total(SumTree* tree);
+float sum_tree_min(SumTree* tree);
+float sum_tree_max(SumTree* tree);
+
+// Index of the item whose cumulative priority range contains prefix, for
+// prefix in [0, total). Always returns a leaf with non-zero priority when the
+// total is positive; returns -1 for an empty tree.
+int sum_tree_find(SumTree* tree, double prefix);
+
+// Draw i of a batch of batch_size proportional samples, from a uniform u in
+// [0, 1) and the tree's total. Stratified draws split the total into
+// batch_size equal segments and take u within segment i. The index is
+// clamped to the used items [0, size), so rounding never escapes them.
+int sum_tree_sample(SumTree* tree, double total, double u, int i, int batch_size, bool stratified, int size);
+
+#endif // SUM_TREE_H
@@ -0,0 +1,119 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <stdbool.h>
+#include <stdio.h>
+#include "agent.h"
+#include "environment.h"
+#include "utils.h"
+
+// Hyperparameter sweeps: many independent training runs of one world,
+// spread over a pool of worker threads. Each trial trains a fresh agent on
+// its own clone of the world, with its own seed, and stops early once
+// check_convergence fires or its Q-values diverge. Every worker allocates
+// its trials from a private memory arena that is reset between trials.
+//
+// A spec is a ConfigFile (see load_config):
+//
+//     search = grid                    # or random
+//     learning_rate = 0.05, 0.1, 0.2   # a list, or min:max (random only)
+//     discount_factor = 0.9, 0.99
+//     epsilon_decay = 0.99, 0.995
+//     episodes = 2000                  # per trial, upper bound
+//     threads = 0                      # 0 = every online core
+//
+// Grid search runs every combination of the lists; random search draws
+// trials values, each uniformly from its list or range.
+
+#define SWEEP_MAX_VALUES 16             // Values in one list
+#define SWEEP_DIVERGENCE_LIMIT 1e6f     // |mean Q| past this ends a trial as diverged
+
+typedef enum {
+    SWEEP_SEARCH_GRID = 0,
+    SWEEP_SEARCH_RANDOM
+} SweepSearch;
+
+// Swept hyperparameters, in spec and results-column order
+typedef enum {
+    SWEEP_LEARNING_RATE = 0,
+    SWEEP_DISCOUNT_FACTOR,
+    SWEEP_EPSILON_DECAY,
+    NUM_SWEEP_PARAMETERS
+} SweepParameter;
+
+// Values one hyperparameter takes: a list, or a range (random search)
+typedef struct {
+    float values[SWEEP_MAX_VALUES];
+    int count;                  // Values in the list (unused for a range)
+    bool is_range;
+    float min;                  // Range bounds, min <= max
+    float max;
+} SweepValues;
+
+typedef struct {
+    SweepSearch search;
+    SweepValues parameters[NUM_SWEEP_PARAMETERS];
+    int random_trials;          // Trials drawn by random search ("trials")
+    int num_episodes;           // Episode cap per trial ("episodes")
+    int max_steps_per_episode;  // ("max_steps")
+    float epsilon;              // Initial exploration rate ("epsilon")
+    float epsilon_min;          // ("epsilon_min")
+    QTableStorage storage;      // Q-table layout of every trial
+    bool stop_on_convergence;   // ("stop_on_convergence")
+    int num_threads;            // Worker threads, 0 = every online core ("threads")
+    unsigned int seed;          // Trial i is seeded from seed and i ("seed")
+    char output_filename[256];  // Results file, "" = the caller's stream ("output")
+} SweepSpec;
+
+typedef enum {
+    SWEEP_TRIAL_COMPLETED = 0,  // Ran every episode
+    SWEEP_TRIAL_CONVERGED,      // Stopped by check_convergence
+    SWEEP_TRIAL_DIVERGED,       // Stopped on non-finite or exploding Q-values
+    SWEEP_TRIAL_FAILED          // Could not allocate its world or agent
+} SweepTrialStatus;
+
+typedef struct {
+    int trial;
+    float parameters[NUM_SWEEP_PARAMETERS];
+    SweepTrialStatus status;
+    int episodes_run;
+    int convergence_episode;    // -1 unless converged
+    float success_rate;         // Over every episode run
+    float final_avg_reward;     // Moving average at the last episode
+    long long total_steps;
+    double elapsed_seconds;
+} SweepTrialResult;
+
+typedef struct {
+    int num_trials;
+    int num_threads;
+    int status_counts[SWEEP_TRIAL_FAILED + 1];
+    int best_trial;             // Earliest convergence, else highest final reward (-1 = none)
+    long long total_steps;
+    double elapsed_seconds;     // Wall-clock time of the whole sweep
+} SweepSummary;
+
+// Spec defaults: a single trial with the trainer's learning rate 0.1,
+// discount 0.9 and decay 0.995, 1000 episodes of at most 200 steps
+SweepSpec create_default_sweep_spec(void);
+
+// Keys missing from config keep the value already in spec
+bool parse_sweep_spec(ConfigFile* config, SweepSpec* spec);
+bool load_sweep_spec(const char* filename, SweepSpec* spec);
+
+int sweep_trial_count(const SweepSpec* spec);
+// Hyperparameters of trial (depend only on the spec and the index)
+void sweep_trial_parameters(const SweepSpec* spec, int trial, float parameters[NUM_SWEEP_PARAMETERS]);
+const char* sweep_parameter_name(SweepParameter parameter);
+const char* sweep_trial_status_name(SweepTrialStatus status);
+
+// Train one trial on a private clone of world
+SweepTrialResult run_sweep_trial(GridWorld* world, const SweepSpec* spec, int trial);
+
+// Run every trial and write a CSV header plus one line per trial to output
+// (NULL = none) as trials finish. results, when non-NULL, receives the
+// sweep_trial_count(spec) results in trial order. Apart from timings the
+// results are identical for any thread count; only the line order changes.
+SweepSummary run_sweep(GridWorld* world, const SweepSpec* spec, FILE* output, SweepTrialResult* results);
+
+#endif // SWEEP_H
@@ -0,0 +1,43 @@
+#ifndef TRAINING_H
+#define TRAINING_H
+
+#include <stdbool.h>
+#include "agent.h"
+#include "environment.h"
+
+// Running totals for one training episode
+typedef struct {
+    float total_reward;
+    int steps_taken;
+    float total_q_value;        // Sum of per-step average Q-values (for EpisodeStats.avg_q_value)
+    int q_value_count;
+    bool goal_reached;          // Set by finish_training_episode
+} EpisodeProgress;
+
+// Training loop building blocks shared by the interactive trainer in main.c
+// and the headless benchmarks. None of them touch raylib.
+
+// Mean Q-value over all actions of a state
+float calculate_avg_q_value(QLearningAgent* agent, int state);
+
+// Reset the environment and return zeroed episode totals
+EpisodeProgress begin_training_episode(GridWorld* world);
+
+// One epsilon-greedy Q-learning step from the current state. Counts the
+// visit in visit_counts when it is non-NULL and returns the action taken.
+Action training_step(GridWorld* world, QLearningAgent* agent, EpisodeProgress* progress, int* visit_counts);
+
+// Whether the episode should take another step
+static inline bool training_episode_running(const GridWorld* world, const EpisodeProgress* progress, int max_steps) {
+    return !world->episode_done && progress->steps_taken < max_steps;
+}
+
+// Episode bookkeeping: decay epsilon, clear eligibility traces, record
+// statistics and performance metrics. Returns true when the metrics report convergence.
+bool finish_training_episode(GridWorld* world, QLearningAgent* agent, TrainingStats* stats,
+                             int episode, EpisodeProgress* progress);
+
+// begin + steps until done or max_steps (no bookkeeping)
+EpisodeProgress run_training_episode(GridWorld* world, QLearningAgent* agent, int max_steps, int* visit_counts);
+
+#endif // TRAINING_H
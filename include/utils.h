@@ -2,18 +2,27 @@
 #define UTILS_H
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <time.h>
 
-// Math constants and utilities
+// Math constants and utilities (raylib/raymath may already define PI and EPSILON)
+#ifndef PI
 #define PI 3.14159265359f
+#endif
+#ifndef EPSILON
 #define EPSILON 1e-6f
+#endif
 #define MAX_PATH_LENGTH 256
 #define MAX_FILENAME_LENGTH 128
 
-// Random number generation
+// Random number generation (xoshiro256**, seeded through splitmix64).
+// Each owner (agent, buffer, environment, worker thread) embeds its own state,
+// so sampling is lock-free and reproducible from the seed.
 typedef struct {
-    unsigned int seed;
+    uint64_t s[4];              // Generator state; never all zero once seeded
+    unsigned int seed;          // Seed the state was derived from
     bool initialized;
 } RandomState;
 
@@ -86,15 +95,59 @@ typedef struct {
     char y_label[64];
 } Dataset;
 
+// Fast inline generator step (defined in header for inlining on hot paths)
+static inline uint64_t random_rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+static inline uint64_t random_next_u64(RandomState* rng) {
+    uint64_t* s = rng->s;
+    uint64_t result = random_rotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = random_rotl(s[3], 45);
+    return result;
+}
+
+// Uniform float in [0, 1) with full 24-bit mantissa resolution
+static inline float random_next_float(RandomState* rng) {
+    return (float)(random_next_u64(rng) >> 40) * (1.0f / 16777216.0f);
+}
+
+// Uniform integer in [0, bound) without modulo bias (Lemire's multiply-shift)
+static inline uint32_t random_next_bounded(RandomState* rng, uint32_t bound) {
+    uint64_t m = (random_next_u64(rng) >> 32) * (uint64_t)bound;
+    uint32_t low = (uint32_t)m;
+    if (low < bound) {
+        uint32_t threshold = (uint32_t)(-bound) % bound;
+        while (low < threshold) {
+            m = (random_next_u64(rng) >> 32) * (uint64_t)bound;
+            low = (uint32_t)m;
+        }
+    }
+    return (uint32_t)(m >> 32);
+}
+
 // Function declarations for random number generation
 RandomState* init_random(unsigned int seed);
 void destroy_random(RandomState* rng);
+void seed_random(RandomState* rng, unsigned int seed);
+void random_jump(RandomState* rng);
 float random_float(RandomState* rng);
+double random_double(RandomState* rng);
 float random_range(RandomState* rng, float min, float max);
 int random_int(RandomState* rng, int min, int max);
 bool random_bool(RandomState* rng, float probability);
 void shuffle_array(RandomState* rng, void* array, size_t element_size, size_t count);
 
+// Bulk generation for batches
+void random_fill_floats(RandomState* rng, float* out, int count);
+void random_fill_ints(RandomState* rng, int* out, int count, int min, int max);
+
 // Math utility functions
 float clamp(float value, float min, float max);
 float lerp(float a, float b, float t);
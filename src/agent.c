@@ -1,14 +1,153 @@
+#define _POSIX_C_SOURCE 200809L  // mmap, pread, writev, posix_madvise
+
 #include "agent.h"
+#include "memory_arena.h"
+#include "profiler.h"
+#include "q_row4.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <math.h>
 #include <string.h>
 #include <time.h>
 #include <limits.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Internal Q-table accessors shared by both storage backends.
+// Callers are expected to have validated state/action ranges already.
+static inline float agent_q(QLearningAgent* agent, int state, int action) {
+    if (agent->optimized_table) {
+        return get_q_value_fast(agent->optimized_table->qtable, state, action);
+    }
+    return agent->q_table[state][action];
+}
+
+// Widen the running Q range for a write of value over old_value; a write
+// that moves an extreme inward only marks the range for a rescan
+static inline void agent_track_bounds(QLearningAgent* agent, float old_value, float value) {
+    QValueBounds* bounds = &agent->q_bounds;
+    if (value < bounds->min_q) {
+        bounds->min_q = value;
+    } else if (old_value == bounds->min_q && value > old_value && !bounds->stale) {
+        bounds->stale = true;
+    }
+    if (value > bounds->max_q) {
+        bounds->max_q = value;
+    } else if (old_value == bounds->max_q && value < old_value && !bounds->stale) {
+        bounds->stale = true;
+    }
+}
+
+// Replace old_value by value in the running moments. The table size is
+// fixed, so this is Welford's update for a sample swapped in place.
+static inline void agent_track_moments(QLearningAgent* agent, float old_value, float value) {
+    QValueMoments* moments = &agent->q_moments;
+    double delta = (double)value - old_value;
+    double old_mean = moments->mean;
+    moments->mean += delta / ((double)agent->num_states * agent->num_actions);
+    double step = delta * ((value - moments->mean) + (old_value - old_mean));
+    moments->m2 += step;
+    moments->churn += fabs(step);
+    if (moments->churn > Q_MOMENTS_MAX_CHURN * moments->m2) {
+        moments->stale = true;
+    }
+}
+
+// Store value over old_value (the cell's current contents), keeping the Q range and moments current
+static inline void agent_replace_q(QLearningAgent* agent, int state, int action, float old_value, float value) {
+    if (agent->q_bounds.tracking) {
+        agent_track_bounds(agent, old_value, value);
+    }
+    if (agent->q_moments.tracking && !agent->q_moments.stale) {
+        agent_track_moments(agent, old_value, value);
+    }
+    if (agent->optimized_table) {
+        set_q_value_fast(agent->optimized_table->qtable, state, action, value);
+        return;
+    }
+    agent->q_table[state][action] = value;
+}
+
+static inline void agent_set_q(QLearningAgent* agent, int state, int action, float value) {
+    agent_replace_q(agent, state, action, agent_q(agent, state, action), value);
+}
+
+static inline float agent_max_q(QLearningAgent* agent, int state) {
+    if (agent->optimized_table) {
+        return get_max_q_value_cached(agent->optimized_table->qtable, state);
+    }
+
+    float* row = agent->q_table[state];
+    if (agent->num_actions == Q_ROW4_WIDTH) {
+        return q_row4_max(row);  // The NUM_ACTIONS grid case
+    }
+    float max_q = row[0];
+    for (int a = 1; a < agent->num_actions; a++) {
+        if (row[a] > max_q) {
+            max_q = row[a];
+        }
+    }
+    return max_q;
+}
+
+static inline int agent_best_action(QLearningAgent* agent, int state) {
+    if (agent->optimized_table) {
+        return get_best_action_cached(agent->optimized_table->qtable, state);
+    }
+
+    float* row = agent->q_table[state];
+    if (agent->num_actions == Q_ROW4_WIDTH) {
+        return q_row4_argmax(row);  // The NUM_ACTIONS grid case
+    }
+    int best_action = 0;
+    float best_q_value = row[0];
+    for (int a = 1; a < agent->num_actions; a++) {
+        if (row[a] > best_q_value) {
+            best_q_value = row[a];
+            best_action = a;
+        }
+    }
+    return best_action;
+}
+
+// Contiguous Q-values for one state. Writers must invalidate the state's cache afterwards.
+static inline float* agent_row(QLearningAgent* agent, int state) {
+    if (agent->optimized_table) {
+        OptimizedQTable* qtable = agent->optimized_table->qtable;
+        return qtable->data + (size_t)qtable_state_slot(qtable, state) * qtable->state_stride;
+    }
+    return agent->q_table[state];
+}
+
+// Default generator seed for new agents and buffers. Drawing it from rand()
+// keeps programs that call srand() reproducible without extra setup.
+static unsigned int default_rng_seed(void) {
+    return (unsigned int)rand();
+}
 
-// Create a new Q-learning agent
+// Create a new Q-learning agent using the default Q-table storage
 QLearningAgent* create_agent(int num_states, int num_actions, float learning_rate, float discount_factor, float epsilon) {
-    QLearningAgent* agent = (QLearningAgent*)malloc(sizeof(QLearningAgent));
+    return create_agent_with_storage(num_states, num_actions, learning_rate, discount_factor, epsilon,
+                                     DEFAULT_QTABLE_STORAGE);
+}
+
+// Create a new Q-learning agent backed by the requested Q-table storage
+QLearningAgent* create_agent_with_storage(int num_states, int num_actions, float learning_rate, float discount_factor,
+                                          float epsilon, QTableStorage storage) {
+    if (num_states <= 0 || num_actions <= 0) {
+        fprintf(stderr, "Error: Invalid agent dimensions (states=%d, actions=%d)\n", num_states, num_actions);
+        return NULL;
+    }
+
+    QLearningAgent* agent = (QLearningAgent*)memory_alloc(MEMORY_AGENT, sizeof(QLearningAgent));
     if (!agent) {
         fprintf(stderr, "Error: Failed to allocate memory for agent\n");
         return NULL;
@@ -23,43 +162,260 @@ QLearningAgent* create_agent(int num_states, int num_actions, float learning_rat
     agent->epsilon_min = 0.01f;     // Minimum exploration rate
     agent->current_state = 0;
     agent->last_action = ACTION_UP;
+    agent->q_table = NULL;
+    agent->optimized_table = NULL;
+    agent->mapped_table = NULL;
+    agent->storage = storage;
+    agent->q_bounds = (QValueBounds){0.0f, 0.0f, true, false};
+    agent->q_moments = (QValueMoments){0.0, 0.0, 0.0, true, false};
+    agent->traces = NULL;
+    seed_random(&agent->rng, default_rng_seed());
+
+    if (storage == QTABLE_STORAGE_MAPPED) {
+        fprintf(stderr, "Error: Mapped Q-tables need a file; use create_agent_mapped()\n");
+        memory_free(agent);
+        return NULL;
+    }
 
-    // Allocate Q-table
-    agent->q_table = (float**)malloc(num_states * sizeof(float*));
-    if (!agent->q_table) {
+    if (storage == QTABLE_STORAGE_OPTIMIZED) {
+        // Flat aligned table, zero-initialized, with max/argmax caches enabled
+        agent->optimized_table = wrap_qtable_for_agent(num_states, num_actions);
+        if (!agent->optimized_table) {
+            fprintf(stderr, "Error: Failed to allocate optimized Q-table\n");
+            memory_free(agent);
+            return NULL;
+        }
+        return agent;
+    }
+
+    // Row pointers into one zeroed block rather than an allocation per state
+    agent->q_table = (float**)memory_alloc(MEMORY_AGENT, (size_t)num_states * sizeof(float*));
+    float* rows = (float*)memory_calloc(MEMORY_AGENT, (size_t)num_states * num_actions, sizeof(float));
+    if (!agent->q_table || !rows) {
         fprintf(stderr, "Error: Failed to allocate memory for Q-table\n");
-        free(agent);
+        memory_free(agent->q_table);
+        memory_free(rows);
+        memory_free(agent);
         return NULL;
     }
 
     for (int i = 0; i < num_states; i++) {
-        agent->q_table[i] = (float*)calloc(num_actions, sizeof(float));
-        if (!agent->q_table[i]) {
-            fprintf(stderr, "Error: Failed to allocate memory for Q-table row %d\n", i);
-            // Clean up previously allocated rows
-            for (int j = 0; j < i; j++) {
-                free(agent->q_table[j]);
-            }
-            free(agent->q_table);
-            free(agent);
-            return NULL;
-        }
+        agent->q_table[i] = rows + (size_t)i * num_actions;
     }
 
     return agent;
 }
 
+// Create an agent whose Q-table lives in a memory-mapped file. With create_new
+// the file is (re)created zero-filled; otherwise an existing table is mapped
+// in place and pages load on first access. Pass 0 dimensions to use the file's.
+QLearningAgent* create_agent_mapped(const char* filename, int num_states, int num_actions, float learning_rate,
+                                    float discount_factor, float epsilon, bool create_new) {
+    MappedQTable* mapped = create_mapped_qtable(filename, num_states, num_actions, create_new);
+    if (!mapped) {
+        return NULL;
+    }
+    if (mapped->read_only) {
+        fprintf(stderr, "Error: %s is read-only and cannot back a training agent\n", filename);
+        destroy_mapped_qtable(mapped);
+        return NULL;
+    }
+
+    QLearningAgent* agent = (QLearningAgent*)memory_alloc(MEMORY_AGENT, sizeof(QLearningAgent));
+    QTableWrapper* wrapper = (QTableWrapper*)memory_alloc(MEMORY_AGENT, sizeof(QTableWrapper));
+    QTablePerfCounters* counters = (QTablePerfCounters*)memory_calloc(MEMORY_AGENT, 1, sizeof(QTablePerfCounters));
+    if (!agent || !wrapper || !counters) {
+        fprintf(stderr, "Error: Failed to allocate memory for mapped agent\n");
+        memory_free(agent);
+        memory_free(wrapper);
+        memory_free(counters);
+        destroy_mapped_qtable(mapped);
+        return NULL;
+    }
+    wrapper->qtable = &mapped->base;
+    wrapper->counters = counters;
+
+    agent->num_states = mapped->base.num_states;
+    agent->num_actions = mapped->base.num_actions;
+    agent->learning_rate = learning_rate;
+    agent->discount_factor = discount_factor;
+    agent->epsilon = epsilon;
+    agent->epsilon_decay = 0.995f;  // Default decay rate
+    agent->epsilon_min = 0.01f;     // Minimum exploration rate
+    agent->current_state = 0;
+    agent->last_action = ACTION_UP;
+    agent->q_table = NULL;
+    agent->optimized_table = wrapper;
+    agent->mapped_table = mapped;
+    agent->storage = QTABLE_STORAGE_MAPPED;
+    agent->q_bounds = (QValueBounds){0.0f, 0.0f, true, false};
+    agent->q_moments = (QValueMoments){0.0, 0.0, 0.0, true, false};
+    agent->traces = NULL;
+    seed_random(&agent->rng, default_rng_seed());
+
+    return agent;
+}
+
+// Checkpoint a mapped Q-table to its file (no-op success for in-memory storage)
+bool sync_agent_q_table(QLearningAgent* agent) {
+    if (!agent) return false;
+    if (!agent->mapped_table) return true;
+    return sync_mapped_qtable(agent->mapped_table);
+}
+
+// Reorder the flat Q-table so the most visited states share cache lines.
+// Row storage has no contiguous layout to improve, and a mapped file must
+// keep its rows in state order, so only QTABLE_STORAGE_OPTIMIZED qualifies.
+bool optimize_agent_memory_layout(QLearningAgent* agent, int* visit_counts) {
+    if (!agent || !visit_counts) return false;
+    if (agent->storage != QTABLE_STORAGE_OPTIMIZED) {
+        fprintf(stderr, "Error: Memory layout optimization needs the optimized Q-table storage\n");
+        return false;
+    }
+
+    optimize_memory_layout(agent->optimized_table->qtable, visit_counts);
+    return true;
+}
+
 // Destroy the agent and free memory
 void destroy_agent(QLearningAgent* agent) {
     if (!agent) return;
 
+    disable_eligibility_traces(agent);
     if (agent->q_table) {
-        for (int i = 0; i < agent->num_states; i++) {
-            free(agent->q_table[i]);
+        memory_free(agent->q_table[0]);  // All rows share one block
+        memory_free(agent->q_table);
+    }
+    if (agent->mapped_table) {
+        // The wrapper only borrows the mapping's embedded table
+        memory_free(agent->optimized_table->counters);
+        memory_free(agent->optimized_table);
+        destroy_mapped_qtable(agent->mapped_table);
+    } else {
+        destroy_qtable_wrapper(agent->optimized_table);
+    }
+    memory_free(agent);
+}
+
+// Reseed the agent's exploration generator for reproducible runs
+void seed_agent(QLearningAgent* agent, unsigned int seed) {
+    if (!agent) return;
+    seed_random(&agent->rng, seed);
+}
+
+// ============================================================================
+// ELIGIBILITY TRACES
+// ============================================================================
+
+bool enable_eligibility_traces(QLearningAgent* agent, float lambda, int max_traces) {
+    if (!agent || !(lambda >= 0.0f && lambda <= 1.0f) || max_traces < 0) {
+        fprintf(stderr, "Error: Invalid eligibility trace parameters (lambda must lie in [0, 1])\n");
+        return false;
+    }
+
+    // Traces fall below the threshold after log(min) / log(gamma * lambda) decays
+    int capacity = max_traces;
+    if (capacity == 0) {
+        double decay = (double)agent->discount_factor * lambda;
+        capacity = decay <= 0.0 ? 1
+                 : decay >= 1.0 ? ELIGIBILITY_MAX_TRACES
+                 : (int)fmin(ceil(log(ELIGIBILITY_MIN_TRACE) / log(decay)) + 1.0, ELIGIBILITY_MAX_TRACES);
+    }
+    long long pairs = (long long)agent->num_states * agent->num_actions;
+    if (capacity > pairs) capacity = (int)pairs;
+
+    disable_eligibility_traces(agent);
+    EligibilityTraces* traces = (EligibilityTraces*)memory_calloc(MEMORY_AGENT, 1, sizeof(EligibilityTraces));
+    if (traces) {
+        traces->states = (int*)memory_alloc(MEMORY_AGENT, capacity * sizeof(int));
+        traces->actions = (int*)memory_alloc(MEMORY_AGENT, capacity * sizeof(int));
+        traces->values = (float*)memory_alloc(MEMORY_AGENT, capacity * sizeof(float));
+    }
+    if (!traces || !traces->states || !traces->actions || !traces->values) {
+        fprintf(stderr, "Error: Failed to allocate %d eligibility traces\n", capacity);
+        if (traces) {
+            memory_free(traces->states);
+            memory_free(traces->actions);
+            memory_free(traces->values);
+        }
+        memory_free(traces);
+        return false;
+    }
+    traces->capacity = capacity;
+    traces->lambda = lambda;
+    traces->min_trace = ELIGIBILITY_MIN_TRACE;
+    agent->traces = traces;
+    return true;
+}
+
+void disable_eligibility_traces(QLearningAgent* agent) {
+    if (!agent || !agent->traces) return;
+
+    memory_free(agent->traces->states);
+    memory_free(agent->traces->actions);
+    memory_free(agent->traces->values);
+    memory_free(agent->traces);
+    agent->traces = NULL;
+}
+
+void clear_eligibility_traces(QLearningAgent* agent) {
+    if (agent && agent->traces) {
+        agent->traces->count = 0;
+    }
+}
+
+// Watkins cut: the return after an exploratory action is not the greedy one.
+// Values are compared so that a random pick tied with the best still counts as greedy.
+static inline void cut_traces_if_exploratory(QLearningAgent* agent, int state, Action action) {
+    if (agent->traces && agent->traces->count > 0 &&
+        agent_q(agent, state, action) < agent_q(agent, state, agent_best_action(agent, state))) {
+        agent->traces->count = 0;
+    }
+}
+
+// Q(lambda) step: set the trace of (state, action) to 1, move every traced
+// pair by alpha * td_error * trace, then decay the traces by gamma * lambda
+static void update_traced_q_values(QLearningAgent* agent, int state, Action action, float td_error) {
+    EligibilityTraces* traces = agent->traces;
+
+    int slot = 0;
+    while (slot < traces->count && (traces->states[slot] != state || traces->actions[slot] != (int)action)) {
+        slot++;
+    }
+    if (slot == traces->count) {
+        if (traces->count < traces->capacity) {
+            traces->count++;
+        } else {
+            // Full list: the new pair takes the place of the weakest trace
+            slot = 0;
+            for (int i = 1; i < traces->count; i++) {
+                if (traces->values[i] < traces->values[slot]) slot = i;
+            }
+        }
+        traces->states[slot] = state;
+        traces->actions[slot] = (int)action;
+    }
+    traces->values[slot] = 1.0f;
+
+    float step = agent->learning_rate * td_error;
+    float decay = agent->discount_factor * traces->lambda;
+    for (int i = 0; i < traces->count;) {
+        int s = traces->states[i];
+        int a = traces->actions[i];
+        float q = agent_q(agent, s, a);
+        agent_replace_q(agent, s, a, q, q + step * traces->values[i]);
+
+        traces->values[i] *= decay;
+        if (traces->values[i] < traces->min_trace) {
+            // Unordered list: fill the hole with the last pair
+            traces->count--;
+            traces->states[i] = traces->states[traces->count];
+            traces->actions[i] = traces->actions[traces->count];
+            traces->values[i] = traces->values[traces->count];
+        } else {
+            i++;
         }
-        free(agent->q_table);
     }
-    free(agent);
 }
 
 // Select action using epsilon-greedy strategy
@@ -71,11 +427,13 @@ Action select_action(QLearningAgent* agent, int state) {
     agent->current_state = state;
 
     // Epsilon-greedy action selection
-    float random_value = (float)rand() / RAND_MAX;
+    float random_value = random_next_float(&agent->rng);
     
     if (random_value < agent->epsilon) {
         // Explore: choose random action
-        return (Action)(rand() % agent->num_actions);
+        Action action = (Action)random_next_bounded(&agent->rng, (uint32_t)agent->num_actions);
+        cut_traces_if_exploratory(agent, state, action);
+        return action;
     } else {
         // Exploit: choose greedy action
         return select_greedy_action(agent, state);
@@ -88,18 +446,7 @@ Action select_greedy_action(QLearningAgent* agent, int state) {
         return ACTION_UP; // Default action
     }
 
-    Action best_action = ACTION_UP;
-    float best_q_value = agent->q_table[state][0];
-
-    // Find action with highest Q-value
-    for (int action = 1; action < agent->num_actions; action++) {
-        if (agent->q_table[state][action] > best_q_value) {
-            best_q_value = agent->q_table[state][action];
-            best_action = (Action)action;
-        }
-    }
-
-    return best_action;
+    return (Action)agent_best_action(agent, state);
 }
 
 // Update Q-value using Q-learning formula
@@ -110,23 +457,25 @@ void update_q_value(QLearningAgent* agent, int state, Action action, float rewar
         return;
     }
 
-    float current_q = agent->q_table[state][action];
+    float current_q = agent_q(agent, state, action);
     float max_next_q = 0.0f;
 
     // If not terminal state, find maximum Q-value for next state
     if (!done) {
-        max_next_q = agent->q_table[next_state][0];
-        for (int a = 1; a < agent->num_actions; a++) {
-            if (agent->q_table[next_state][a] > max_next_q) {
-                max_next_q = agent->q_table[next_state][a];
-            }
-        }
+        max_next_q = agent_max_q(agent, next_state);
     }
 
     // Q-learning update formula: Q(s,a) = Q(s,a) + α[r + γ*max(Q(s',a')) - Q(s,a)]
     float td_target = reward + agent->discount_factor * max_next_q;
     float td_error = td_target - current_q;
-    agent->q_table[state][action] = current_q + agent->learning_rate * td_error;
+    if (agent->traces) {
+        update_traced_q_values(agent, state, action, td_error);
+        if (done) {
+            agent->traces->count = 0;
+        }
+    } else {
+        agent_replace_q(agent, state, action, current_q, current_q + agent->learning_rate * td_error);
+    }
 
     // Store last action for reference
     agent->last_action = action;
@@ -148,7 +497,7 @@ float get_q_value(QLearningAgent* agent, int state, Action action) {
         (int)action < 0 || (int)action >= agent->num_actions) {
         return 0.0f;
     }
-    return agent->q_table[state][action];
+    return agent_q(agent, state, action);
 }
 
 // Set Q-value for a specific state-action pair
@@ -157,35 +506,159 @@ void set_q_value(QLearningAgent* agent, int state, Action action, float value) {
         (int)action < 0 || (int)action >= agent->num_actions) {
         return;
     }
-    agent->q_table[state][action] = value;
+    agent_set_q(agent, state, action, value);
+}
+
+// Get the maximum Q-value over all actions for a state
+float get_max_q_value(QLearningAgent* agent, int state) {
+    if (!agent || state < 0 || state >= agent->num_states) {
+        return 0.0f;
+    }
+    return agent_max_q(agent, state);
+}
+
+// Global min/max over the whole table. The first call scans the table and
+// switches on tracking; later calls are O(1) unless a write moved an extreme
+// inward, in which case the table is rescanned once.
+void get_q_value_bounds(QLearningAgent* agent, float* min_q, float* max_q) {
+    if (!agent) {
+        if (min_q) *min_q = 0.0f;
+        if (max_q) *max_q = 0.0f;
+        return;
+    }
+
+    QValueBounds* bounds = &agent->q_bounds;
+    bounds->tracking = true;
+    if (bounds->stale) {
+        float lo = INFINITY, hi = -INFINITY;
+        for (int s = 0; s < agent->num_states; s++) {
+            const float* row = agent_row(agent, s);
+            for (int a = 0; a < agent->num_actions; a++) {
+                if (row[a] < lo) lo = row[a];
+                if (row[a] > hi) hi = row[a];
+            }
+        }
+        bounds->min_q = agent->num_states > 0 ? lo : 0.0f;
+        bounds->max_q = agent->num_states > 0 ? hi : 0.0f;
+        bounds->stale = false;
+    }
+    if (min_q) *min_q = bounds->min_q;
+    if (max_q) *max_q = bounds->max_q;
+}
+
+// Zero every Q-value (used when training is restarted)
+void reset_q_table(QLearningAgent* agent) {
+    if (!agent) return;
+    clear_eligibility_traces(agent);
+    agent->q_bounds.min_q = 0.0f;
+    agent->q_bounds.max_q = 0.0f;
+    agent->q_bounds.stale = false;
+    agent->q_moments.mean = 0.0;
+    agent->q_moments.m2 = 0.0;
+    agent->q_moments.churn = 0.0;
+    agent->q_moments.stale = false;
+
+    if (agent->optimized_table) {
+        OptimizedQTable* qtable = agent->optimized_table->qtable;
+        memset(qtable->data, 0, (size_t)qtable->num_states * qtable->state_stride * sizeof(float));
+        invalidate_all_caches(qtable);
+        return;
+    }
+
+    for (int s = 0; s < agent->num_states; s++) {
+        memset(agent->q_table[s], 0, agent->num_actions * sizeof(float));
+    }
+}
+
+// Copy every Q-value from src into dst (storage backends may differ)
+bool copy_q_table(QLearningAgent* dst, QLearningAgent* src) {
+    if (!dst || !src) return false;
+    if (dst->num_states != src->num_states || dst->num_actions != src->num_actions) {
+        fprintf(stderr, "Error: Cannot copy Q-table between agents of different dimensions\n");
+        return false;
+    }
+
+    size_t row_bytes = (size_t)src->num_actions * sizeof(float);
+    for (int s = 0; s < src->num_states; s++) {
+        memcpy(agent_row(dst, s), agent_row(src, s), row_bytes);
+    }
+
+    if (dst->optimized_table) {
+        invalidate_all_caches(dst->optimized_table->qtable);
+    }
+    dst->q_bounds.stale = true;
+    dst->q_moments.stale = true;
+    return true;
+}
+
+// Store the element-wise mean of count source tables into dst for states [state_begin, state_end).
+// dst may also appear in srcs. Splitting the state range lets several threads merge in parallel.
+bool average_q_tables(QLearningAgent* dst, QLearningAgent** srcs, int count, int state_begin, int state_end) {
+    if (!dst || !srcs || count <= 0) return false;
+    if (state_begin < 0) state_begin = 0;
+    if (state_end > dst->num_states) state_end = dst->num_states;
+
+    for (int i = 0; i < count; i++) {
+        if (!srcs[i] || srcs[i]->num_states != dst->num_states || srcs[i]->num_actions != dst->num_actions) {
+            fprintf(stderr, "Error: Cannot average Q-tables of different dimensions\n");
+            return false;
+        }
+    }
+
+    float scale = 1.0f / count;
+    float sums[64];                 // Per-row accumulator, processed in 64-action chunks
+    int num_actions = dst->num_actions;
+    for (int s = state_begin; s < state_end; s++) {
+        for (int a0 = 0; a0 < num_actions; a0 += 64) {
+            int chunk = num_actions - a0 < 64 ? num_actions - a0 : 64;
+            memset(sums, 0, chunk * sizeof(float));
+            for (int i = 0; i < count; i++) {
+                const float* row = agent_row(srcs[i], s) + a0;
+                for (int a = 0; a < chunk; a++) {
+                    sums[a] += row[a];
+                }
+            }
+            float* out = agent_row(dst, s) + a0;
+            for (int a = 0; a < chunk; a++) {
+                out[a] = sums[a] * scale;
+            }
+        }
+        if (dst->optimized_table) {
+            invalidate_state_cache(dst->optimized_table->qtable, s);
+        }
+    }
+    dst->q_bounds.stale = true;
+    dst->q_moments.stale = true;
+    return true;
 }
 
 // Experience buffer functions
 ExperienceBuffer* create_experience_buffer(int capacity) {
-    ExperienceBuffer* buffer = (ExperienceBuffer*)malloc(sizeof(ExperienceBuffer));
+    ExperienceBuffer* buffer = (ExperienceBuffer*)memory_alloc(MEMORY_REPLAY, sizeof(ExperienceBuffer));
     if (!buffer) {
         fprintf(stderr, "Error: Failed to allocate memory for experience buffer\n");
         return NULL;
     }
 
-    buffer->experiences = (Experience*)malloc(capacity * sizeof(Experience));
+    buffer->experiences = (Experience*)memory_alloc(MEMORY_REPLAY, capacity * sizeof(Experience));
     if (!buffer->experiences) {
         fprintf(stderr, "Error: Failed to allocate memory for experiences\n");
-        free(buffer);
+        memory_free(buffer);
         return NULL;
     }
 
     buffer->capacity = capacity;
     buffer->size = 0;
     buffer->current_index = 0;
+    seed_random(&buffer->rng, default_rng_seed());
 
     return buffer;
 }
 
 void destroy_experience_buffer(ExperienceBuffer* buffer) {
     if (!buffer) return;
-    free(buffer->experiences);
-    free(buffer);
+    memory_free(buffer->experiences);
+    memory_free(buffer);
 }
 
 void add_experience(ExperienceBuffer* buffer, int state, Action action, float reward, int next_state, bool done) {
@@ -207,23 +680,35 @@ void add_experience(ExperienceBuffer* buffer, int state, Action action, float re
 Experience* sample_experience(ExperienceBuffer* buffer) {
     if (!buffer || buffer->size == 0) return NULL;
     
-    int index = rand() % buffer->size;
+    int index = (int)random_next_bounded(&buffer->rng, (uint32_t)buffer->size);
     return &buffer->experiences[index];
 }
 
+void seed_experience_buffer(ExperienceBuffer* buffer, unsigned int seed) {
+    if (!buffer) return;
+    seed_random(&buffer->rng, seed);
+}
+
 // Performance metrics functions
-PerformanceMetrics* create_performance_metrics(int max_episodes, int window_size, int convergence_threshold) {
-    PerformanceMetrics* metrics = (PerformanceMetrics*)malloc(sizeof(PerformanceMetrics));
+PerformanceMetrics* create_performance_metrics(int history_size, int window_size, int convergence_threshold) {
+    if (window_size <= 0 || convergence_threshold <= 0 ||
+        history_size <= window_size || history_size <= convergence_threshold) {
+        fprintf(stderr, "Error: Metrics history (%d) must exceed the window (%d) and convergence threshold (%d)\n",
+                history_size, window_size, convergence_threshold);
+        return NULL;
+    }
+
+    PerformanceMetrics* metrics = (PerformanceMetrics*)memory_alloc(MEMORY_STATS, sizeof(PerformanceMetrics));
     if (!metrics) {
         fprintf(stderr, "Error: Failed to allocate memory for performance metrics\n");
         return NULL;
     }
 
-    metrics->moving_avg_rewards = (float*)calloc(max_episodes, sizeof(float));
-    metrics->moving_avg_steps = (float*)calloc(max_episodes, sizeof(float));
-    metrics->success_episodes = (int*)calloc(max_episodes, sizeof(int));
-    metrics->q_value_variance = (float*)calloc(max_episodes, sizeof(float));
-    metrics->epsilon_history = (float*)calloc(max_episodes, sizeof(float));
+    metrics->moving_avg_rewards = (float*)memory_calloc(MEMORY_STATS, history_size, sizeof(float));
+    metrics->moving_avg_steps = (float*)memory_calloc(MEMORY_STATS, history_size, sizeof(float));
+    metrics->success_episodes = (int*)memory_calloc(MEMORY_STATS, history_size, sizeof(int));
+    metrics->q_value_variance = (float*)memory_calloc(MEMORY_STATS, history_size, sizeof(float));
+    metrics->epsilon_history = (float*)memory_calloc(MEMORY_STATS, history_size, sizeof(float));
 
     if (!metrics->moving_avg_rewards || !metrics->moving_avg_steps || 
         !metrics->success_episodes || !metrics->q_value_variance || !metrics->epsilon_history) {
@@ -232,10 +717,17 @@ PerformanceMetrics* create_performance_metrics(int max_episodes, int window_size
         return NULL;
     }
 
+    metrics->history_size = history_size;
     metrics->window_size = window_size;
     metrics->convergence_threshold = convergence_threshold;
     metrics->has_converged = false;
     metrics->convergence_episode = -1;
+    metrics->last_episode = -1;
+    metrics->window_reward_sum = 0.0;
+    metrics->window_steps_sum = 0.0;
+    metrics->conv_avg_sum = 0.0;
+    metrics->conv_avg_sq_sum = 0.0;
+    metrics->conv_success_count = 0;
 
     return metrics;
 }
@@ -243,12 +735,12 @@ PerformanceMetrics* create_performance_metrics(int max_episodes, int window_size
 void destroy_performance_metrics(PerformanceMetrics* metrics) {
     if (!metrics) return;
     
-    free(metrics->moving_avg_rewards);
-    free(metrics->moving_avg_steps);
-    free(metrics->success_episodes);
-    free(metrics->q_value_variance);
-    free(metrics->epsilon_history);
-    free(metrics);
+    memory_free(metrics->moving_avg_rewards);
+    memory_free(metrics->moving_avg_steps);
+    memory_free(metrics->success_episodes);
+    memory_free(metrics->q_value_variance);
+    memory_free(metrics->epsilon_history);
+    memory_free(metrics);
 }
 
 float calculate_moving_average(float* values, int start, int count) {
@@ -261,93 +753,144 @@ float calculate_moving_average(float* values, int start, int count) {
     return sum / count;
 }
 
+// Variance over the whole table. The first call scans the table and switches
+// on tracking; later calls are O(1) unless a bulk write (copy, merge, load)
+// marked the moments stale, in which case the table is scanned once more.
 float calculate_q_value_variance(QLearningAgent* agent) {
     if (!agent) return 0.0f;
     
-    // Calculate mean Q-value
-    float sum = 0.0f;
     int total_entries = agent->num_states * agent->num_actions;
-    
-    for (int s = 0; s < agent->num_states; s++) {
-        for (int a = 0; a < agent->num_actions; a++) {
-            sum += agent->q_table[s][a];
+    if (total_entries <= 0) return 0.0f;
+    
+    QValueMoments* moments = &agent->q_moments;
+    moments->tracking = true;
+    if (moments->stale) {
+        // Two passes: the mean first, then deviations from it
+        double sum = 0.0;
+        for (int s = 0; s < agent->num_states; s++) {
+            const float* row = agent_row(agent, s);
+            for (int a = 0; a < agent->num_actions; a++) {
+                sum += row[a];
+            }
         }
-    }
-    float mean = sum / total_entries;
-    
-    // Calculate variance
-    float variance_sum = 0.0f;
-    for (int s = 0; s < agent->num_states; s++) {
-        for (int a = 0; a < agent->num_actions; a++) {
-            float diff = agent->q_table[s][a] - mean;
-            variance_sum += diff * diff;
+        double mean = sum / total_entries;
+        double m2 = 0.0;
+        for (int s = 0; s < agent->num_states; s++) {
+            const float* row = agent_row(agent, s);
+            for (int a = 0; a < agent->num_actions; a++) {
+                double d = row[a] - mean;
+                m2 += d * d;
+            }
         }
+        moments->mean = mean;
+        moments->m2 = m2;
+        moments->churn = 0.0;
+        moments->stale = false;
     }
     
-    return variance_sum / total_entries;
+    double variance = moments->m2 / total_entries;
+    return variance > 0.0 ? (float)variance : 0.0f;
 }
 
-void update_performance_metrics(PerformanceMetrics* metrics, TrainingStats* stats, int episode, bool goal_reached, float q_variance) {
-    if (!metrics || !stats || episode >= stats->max_episodes) return;
-    
-    EpisodeStats* ep_stats = &stats->episodes[episode];
-    
-    // Store raw values
-    metrics->success_episodes[episode] = goal_reached ? 1 : 0;
-    metrics->q_value_variance[episode] = q_variance;
-    metrics->epsilon_history[episode] = ep_stats->epsilon_used;
-    
-    // Calculate moving averages
+// Recompute the rolling sums for the windows ending at episode. Only needed
+// when episodes are not recorded one after another.
+static void rebuild_metric_windows(PerformanceMetrics* metrics, TrainingStats* stats, int episode) {
     int window_start = (episode >= metrics->window_size) ? episode - metrics->window_size + 1 : 0;
-    int window_count = episode - window_start + 1;
-    
-    // Calculate moving average of rewards
-    float reward_sum = 0.0f;
+    metrics->window_reward_sum = 0.0;
+    metrics->window_steps_sum = 0.0;
     for (int i = window_start; i <= episode; i++) {
-        reward_sum += stats->episodes[i].total_reward;
+        metrics->window_reward_sum += stats->episodes[i % stats->history_size].total_reward;
+        metrics->window_steps_sum += stats->episodes[i % stats->history_size].steps_taken;
     }
-    metrics->moving_avg_rewards[episode] = reward_sum / window_count;
     
-    // Calculate moving average of steps
-    float steps_sum = 0.0f;
-    for (int i = window_start; i <= episode; i++) {
-        steps_sum += stats->episodes[i].steps_taken;
+    // Excludes episode itself: its moving average is added by the caller
+    int conv_start = (episode >= metrics->convergence_threshold) ? episode - metrics->convergence_threshold + 1 : 0;
+    metrics->conv_avg_sum = 0.0;
+    metrics->conv_avg_sq_sum = 0.0;
+    metrics->conv_success_count = 0;
+    for (int i = conv_start; i < episode; i++) {
+        int slot = i % metrics->history_size;
+        metrics->conv_avg_sum += metrics->moving_avg_rewards[slot];
+        metrics->conv_avg_sq_sum += (double)metrics->moving_avg_rewards[slot] * metrics->moving_avg_rewards[slot];
+        metrics->conv_success_count += metrics->success_episodes[slot];
     }
-    metrics->moving_avg_steps[episode] = steps_sum / window_count;
 }
 
-bool check_convergence(PerformanceMetrics* metrics, int current_episode) {
-    if (!metrics || metrics->has_converged || current_episode < metrics->convergence_threshold) {
-        return metrics->has_converged;
-    }
-    
-    // Check if reward variance is low over the last convergence_threshold episodes
-    int start_episode = current_episode - metrics->convergence_threshold + 1;
-    float reward_variance = 0.0f;
-    float mean_reward = 0.0f;
+void update_performance_metrics(PerformanceMetrics* metrics, TrainingStats* stats, int episode, bool goal_reached, float q_variance) {
+    if (!metrics || !stats || episode >= stats->max_episodes) return;
     
-    // Calculate mean reward over convergence window
-    for (int i = start_episode; i <= current_episode; i++) {
-        mean_reward += metrics->moving_avg_rewards[i];
+    EpisodeStats* ep_stats = get_episode_stats(stats, episode);
+    if (!ep_stats) return;
+    int slot = episode % metrics->history_size;
+    
+    // Slide both windows forward by one episode: O(1) whatever their length
+    if (episode == metrics->last_episode + 1) {
+        metrics->window_reward_sum += ep_stats->total_reward;
+        metrics->window_steps_sum += ep_stats->steps_taken;
+        if (episode >= metrics->window_size) {
+            const EpisodeStats* leaving = &stats->episodes[(episode - metrics->window_size) % stats->history_size];
+            metrics->window_reward_sum -= leaving->total_reward;
+            metrics->window_steps_sum -= leaving->steps_taken;
+        }
+        if (episode >= metrics->convergence_threshold) {
+            int leaving = (episode - metrics->convergence_threshold) % metrics->history_size;
+            metrics->conv_avg_sum -= metrics->moving_avg_rewards[leaving];
+            metrics->conv_avg_sq_sum -= (double)metrics->moving_avg_rewards[leaving] * metrics->moving_avg_rewards[leaving];
+            metrics->conv_success_count -= metrics->success_episodes[leaving];
+        }
+    } else {
+        rebuild_metric_windows(metrics, stats, episode);
     }
-    mean_reward /= metrics->convergence_threshold;
     
-    // Calculate variance of rewards over convergence window
-    for (int i = start_episode; i <= current_episode; i++) {
-        float diff = metrics->moving_avg_rewards[i] - mean_reward;
-        reward_variance += diff * diff;
+    // Store raw values
+    metrics->success_episodes[slot] = goal_reached ? 1 : 0;
+    metrics->q_value_variance[slot] = q_variance;
+    metrics->epsilon_history[slot] = ep_stats->epsilon_used;
+    if (goal_reached) {
+        stats->total_successful_episodes++;
+    }
+    
+    // Moving averages over the last window_size episodes
+    int window_count = episode < metrics->window_size ? episode + 1 : metrics->window_size;
+    metrics->moving_avg_rewards[slot] = (float)(metrics->window_reward_sum / window_count);
+    metrics->moving_avg_steps[slot] = (float)(metrics->window_steps_sum / window_count);
+    
+    float avg = metrics->moving_avg_rewards[slot];
+    metrics->conv_avg_sum += avg;
+    metrics->conv_avg_sq_sum += (double)avg * avg;
+    metrics->conv_success_count += metrics->success_episodes[slot];
+    metrics->last_episode = episode;
+}
+
+bool check_convergence(PerformanceMetrics* metrics, int current_episode) {
+    if (!metrics || metrics->has_converged || current_episode < metrics->convergence_threshold) {
+        return metrics && metrics->has_converged;
     }
-    reward_variance /= metrics->convergence_threshold;
     
-    // Check convergence criteria (low variance and high success rate)
-    float success_rate = 0.0f;
-    for (int i = start_episode; i <= current_episode; i++) {
-        success_rate += metrics->success_episodes[i];
+    // Mean and variance of the moving average over the last convergence_threshold episodes
+    double mean_reward, reward_variance, success_rate;
+    int n = metrics->convergence_threshold;
+    if (current_episode == metrics->last_episode) {
+        mean_reward = metrics->conv_avg_sum / n;
+        reward_variance = metrics->conv_avg_sq_sum / n - mean_reward * mean_reward;
+        success_rate = (double)metrics->conv_success_count / n;
+    } else {
+        // Asked about an episode other than the last one recorded: scan its window
+        double sum = 0.0, sum_sq = 0.0;
+        int successes = 0;
+        for (int i = current_episode - n + 1; i <= current_episode; i++) {
+            int slot = i % metrics->history_size;
+            sum += metrics->moving_avg_rewards[slot];
+            sum_sq += (double)metrics->moving_avg_rewards[slot] * metrics->moving_avg_rewards[slot];
+            successes += metrics->success_episodes[slot];
+        }
+        mean_reward = sum / n;
+        reward_variance = sum_sq / n - mean_reward * mean_reward;
+        success_rate = (double)successes / n;
     }
-    success_rate /= metrics->convergence_threshold;
     
     // Convergence criteria: low reward variance and high success rate
-    if (reward_variance < 5.0f && success_rate > 0.8f) {
+    if (reward_variance < 5.0 && success_rate > 0.8) {
         metrics->has_converged = true;
         metrics->convergence_episode = current_episode;
         return true;
@@ -359,6 +902,9 @@ bool check_convergence(PerformanceMetrics* metrics, int current_episode) {
 void print_learning_curves(TrainingStats* stats, int last_n_episodes) {
     if (!stats || !stats->metrics) return;
     
+    if (last_n_episodes > stats->history_size) {
+        last_n_episodes = stats->history_size;
+    }
     printf("\n=== Learning Curves (Last %d Episodes) ===\n", last_n_episodes);
     
     int start_episode = (stats->current_episode > last_n_episodes) ? 
@@ -368,17 +914,18 @@ void print_learning_curves(TrainingStats* stats, int last_n_episodes) {
     printf("--------|--------|--------|-------|---------|---------|-------\n");
     
     for (int i = start_episode; i < stats->current_episode; i++) {
-        EpisodeStats* ep = &stats->episodes[i];
+        EpisodeStats* ep = get_episode_stats(stats, i);
         PerformanceMetrics* metrics = stats->metrics;
+        int slot = i % metrics->history_size;
         
         printf("%7d | %6.1f | %6.1f | %5d | %7s | %7.3f | %6.2f\n",
                ep->episode + 1,
                ep->total_reward,
-               metrics->moving_avg_rewards[i],
+               metrics->moving_avg_rewards[slot],
                ep->steps_taken,
-               metrics->success_episodes[i] ? "Yes" : "No",
-               metrics->epsilon_history[i],
-               metrics->q_value_variance[i]);
+               metrics->success_episodes[slot] ? "Yes" : "No",
+               metrics->epsilon_history[slot],
+               metrics->q_value_variance[slot]);
     }
     printf("===============================================\n");
 }
@@ -401,21 +948,22 @@ void print_convergence_analysis(PerformanceMetrics* metrics, int current_episode
         // Success rate over window
         float success_rate = 0.0f;
         for (int i = window_start; i <= current_episode; i++) {
-            success_rate += metrics->success_episodes[i];
+            success_rate += metrics->success_episodes[i % metrics->history_size];
         }
         success_rate /= metrics->window_size;
         
         // Average performance over window
-        float avg_reward = metrics->moving_avg_rewards[current_episode];
-        float avg_steps = metrics->moving_avg_steps[current_episode];
-        float current_q_var = metrics->q_value_variance[current_episode];
+        int slot = current_episode % metrics->history_size;
+        float avg_reward = metrics->moving_avg_rewards[slot];
+        float avg_steps = metrics->moving_avg_steps[slot];
+        float current_q_var = metrics->q_value_variance[slot];
         
         printf("Recent Performance (Window size: %d):\n", metrics->window_size);
         printf("  Success Rate: %.1f%%\n", success_rate * 100.0f);
         printf("  Avg Reward: %.2f\n", avg_reward);
         printf("  Avg Steps: %.1f\n", avg_steps);
         printf("  Q-Value Variance: %.3f\n", current_q_var);
-        printf("  Current Epsilon: %.3f\n", metrics->epsilon_history[current_episode]);
+        printf("  Current Epsilon: %.3f\n", metrics->epsilon_history[slot]);
     }
     
     printf("=============================\n");
@@ -433,19 +981,22 @@ void save_performance_data(TrainingStats* stats, const char* filename) {
     fprintf(file, "# Q-Learning Performance Data\n");
     fprintf(file, "# Episode,Reward,Steps,Success,MovAvgReward,MovAvgSteps,Epsilon,QVariance\n");
     
-    for (int i = 0; i < stats->current_episode; i++) {
-        EpisodeStats* ep = &stats->episodes[i];
+    // Only the retained history; use a StatsSink to log every episode
+    int first = stats->current_episode > stats->history_size ? stats->current_episode - stats->history_size : 0;
+    for (int i = first; i < stats->current_episode; i++) {
+        EpisodeStats* ep = get_episode_stats(stats, i);
         PerformanceMetrics* metrics = stats->metrics;
+        int slot = i % metrics->history_size;
         
         fprintf(file, "%d,%.2f,%d,%d,%.2f,%.2f,%.4f,%.4f\n",
                 ep->episode + 1,
                 ep->total_reward,
                 ep->steps_taken,
-                metrics->success_episodes[i],
-                metrics->moving_avg_rewards[i],
-                metrics->moving_avg_steps[i],
-                metrics->epsilon_history[i],
-                metrics->q_value_variance[i]);
+                metrics->success_episodes[slot],
+                metrics->moving_avg_rewards[slot],
+                metrics->moving_avg_steps[slot],
+                metrics->epsilon_history[slot],
+                metrics->q_value_variance[slot]);
     }
     
     fclose(file);
@@ -454,16 +1005,17 @@ void save_performance_data(TrainingStats* stats, const char* filename) {
 
 // Training statistics functions
 TrainingStats* create_training_stats(int max_episodes) {
-    TrainingStats* stats = (TrainingStats*)malloc(sizeof(TrainingStats));
+    TrainingStats* stats = (TrainingStats*)memory_alloc(MEMORY_STATS, sizeof(TrainingStats));
     if (!stats) {
         fprintf(stderr, "Error: Failed to allocate memory for training stats\n");
         return NULL;
     }
 
-    stats->episodes = (EpisodeStats*)calloc(max_episodes, sizeof(EpisodeStats));
+    stats->history_size = TRAINING_STATS_HISTORY;
+    stats->episodes = (EpisodeStats*)memory_calloc(MEMORY_STATS, stats->history_size, sizeof(EpisodeStats));
     if (!stats->episodes) {
         fprintf(stderr, "Error: Failed to allocate memory for episode stats\n");
-        free(stats);
+        memory_free(stats);
         return NULL;
     }
 
@@ -477,13 +1029,15 @@ TrainingStats* create_training_stats(int max_episodes) {
     stats->total_successful_episodes = 0;
     stats->avg_reward_all_episodes = 0.0f;
     stats->avg_steps_all_episodes = 0.0f;
+    stats->total_reward_sum = 0.0;
+    stats->total_steps_sum = 0;
     
     // Create performance metrics with default parameters
-    stats->metrics = create_performance_metrics(max_episodes, 100, 50); // Window size: 100, Convergence threshold: 50
+    stats->metrics = create_performance_metrics(stats->history_size, 100, 50); // Window size: 100, Convergence threshold: 50
     if (!stats->metrics) {
         fprintf(stderr, "Error: Failed to create performance metrics\n");
-        free(stats->episodes);
-        free(stats);
+        memory_free(stats->episodes);
+        memory_free(stats);
         return NULL;
     }
 
@@ -496,14 +1050,14 @@ void destroy_training_stats(TrainingStats* stats) {
     if (stats->metrics) {
         destroy_performance_metrics(stats->metrics);
     }
-    free(stats->episodes);
-    free(stats);
+    memory_free(stats->episodes);
+    memory_free(stats);
 }
 
 void record_episode(TrainingStats* stats, int episode, float total_reward, int steps_taken, float epsilon_used, float avg_q_value) {
     if (!stats || episode >= stats->max_episodes) return;
 
-    EpisodeStats* ep_stats = &stats->episodes[episode];
+    EpisodeStats* ep_stats = &stats->episodes[episode % stats->history_size];
     ep_stats->episode = episode;
     ep_stats->total_reward = total_reward;
     ep_stats->steps_taken = steps_taken;
@@ -516,7 +1070,26 @@ void record_episode(TrainingStats* stats, int episode, float total_reward, int s
         stats->best_episode = episode;
     }
 
+    if (total_reward < stats->worst_reward) {
+        stats->worst_reward = total_reward;
+        stats->worst_episode = episode;
+    }
+
+    // Run-wide averages without keeping every episode
+    stats->total_reward_sum += total_reward;
+    stats->total_steps_sum += steps_taken;
     stats->current_episode = episode + 1;
+    stats->avg_reward_all_episodes = (float)(stats->total_reward_sum / stats->current_episode);
+    stats->avg_steps_all_episodes = (float)stats->total_steps_sum / stats->current_episode;
+}
+
+// Stats of a recorded episode, or NULL if it is not (or no longer) held
+EpisodeStats* get_episode_stats(TrainingStats* stats, int episode) {
+    if (!stats || episode < 0 || episode >= stats->current_episode ||
+        episode < stats->current_episode - stats->history_size) {
+        return NULL;
+    }
+    return &stats->episodes[episode % stats->history_size];
 }
 
 void print_training_summary(TrainingStats* stats) {
@@ -527,25 +1100,15 @@ void print_training_summary(TrainingStats* stats) {
     printf("Best Episode: %d (Reward: %.2f)\n", stats->best_episode, stats->best_reward);
 
     if (stats->current_episode > 0) {
-        // Calculate average reward over all episodes
-        float total_reward = 0.0f;
-        int total_steps = 0;
-        for (int i = 0; i < stats->current_episode; i++) {
-            total_reward += stats->episodes[i].total_reward;
-            total_steps += stats->episodes[i].steps_taken;
-        }
-        
-        float avg_reward = total_reward / stats->current_episode;
-        float avg_steps = (float)total_steps / stats->current_episode;
-        
-        printf("Average Reward: %.2f\n", avg_reward);
-        printf("Average Steps per Episode: %.1f\n", avg_steps);
+        // Averages over all episodes from the running totals
+        printf("Average Reward: %.2f\n", stats->avg_reward_all_episodes);
+        printf("Average Steps per Episode: %.1f\n", stats->avg_steps_all_episodes);
 
         // Show last few episodes
         printf("\nLast 5 Episodes:\n");
         int start_episode = (stats->current_episode > 5) ? stats->current_episode - 5 : 0;
         for (int i = start_episode; i < stats->current_episode; i++) {
-            EpisodeStats* ep = &stats->episodes[i];
+            EpisodeStats* ep = get_episode_stats(stats, i);
             printf("Episode %d: Reward=%.1f, Steps=%d, Epsilon=%.3f\n", 
                    ep->episode, ep->total_reward, ep->steps_taken, ep->epsilon_used);
         }
@@ -553,77 +1116,278 @@ void print_training_summary(TrainingStats* stats) {
     printf("========================\n\n");
 }
 
-// Save Q-table to binary file
-bool save_q_table(QLearningAgent* agent, const char* filename) {
-    if (!agent || !filename) {
-        fprintf(stderr, "Error: Invalid parameters for save_q_table\n");
+// Files written before the versioned header: dimensions and parameters, then the rows
+static bool load_legacy_q_table(QLearningAgent* agent, const char* filename) {
+    FILE* file = fopen(filename, "rb");
+    if (!file) {
+        fprintf(stderr, "Error: Could not open file %s for reading\n", filename);
         return false;
     }
 
-    FILE* file = fopen(filename, "wb");
-    if (!file) {
-        fprintf(stderr, "Error: Could not open file %s for writing\n", filename);
+    // Read header information
+    int num_states, num_actions;
+    fread(&num_states, sizeof(int), 1, file);
+    fread(&num_actions, sizeof(int), 1, file);
+
+    // Verify compatibility
+    if (num_states != agent->num_states || num_actions != agent->num_actions) {
+        fprintf(stderr, "Error: Q-table dimensions mismatch. Expected %dx%d, got %dx%d\n",
+                agent->num_states, agent->num_actions, num_states, num_actions);
+        fclose(file);
         return false;
     }
 
-    // Write header information
-    fwrite(&agent->num_states, sizeof(int), 1, file);
-    fwrite(&agent->num_actions, sizeof(int), 1, file);
-    fwrite(&agent->learning_rate, sizeof(float), 1, file);
-    fwrite(&agent->discount_factor, sizeof(float), 1, file);
-    fwrite(&agent->epsilon, sizeof(float), 1, file);
-    fwrite(&agent->epsilon_decay, sizeof(float), 1, file);
-    fwrite(&agent->epsilon_min, sizeof(float), 1, file);
+    // Load agent parameters
+    fread(&agent->learning_rate, sizeof(float), 1, file);
+    fread(&agent->discount_factor, sizeof(float), 1, file);
+    fread(&agent->epsilon, sizeof(float), 1, file);
+    fread(&agent->epsilon_decay, sizeof(float), 1, file);
+    fread(&agent->epsilon_min, sizeof(float), 1, file);
 
-    // Write Q-table data
-    for (int state = 0; state < agent->num_states; state++) {
-        fwrite(agent->q_table[state], sizeof(float), agent->num_actions, file);
+    // Load Q-table data
+    if (agent->optimized_table) {
+        OptimizedQTable* qtable = agent->optimized_table->qtable;
+        if (qtable->state_slots) {
+            for (int state = 0; state < agent->num_states; state++) {
+                fread(agent_row(agent, state), sizeof(float), agent->num_actions, file);
+            }
+        } else {
+            fread(qtable->data, sizeof(float), (size_t)agent->num_states * agent->num_actions, file);
+        }
+        invalidate_all_caches(qtable);
+    } else {
+        for (int state = 0; state < agent->num_states; state++) {
+            fread(agent->q_table[state], sizeof(float), agent->num_actions, file);
+        }
     }
+    agent->q_bounds.stale = true;
+    agent->q_moments.stale = true;
+    clear_eligibility_traces(agent);  // Traced pairs refer to the replaced values
 
     fclose(file);
+    printf("Q-table loaded from %s\n", filename);
+    return true;
+}
+
+// Q-table files use the versioned QTableFileHeader layout (q_table_optimized.h):
+// a checksummed header page, then the rows, optionally run-length encoded.
+
+// Write every iovec, resuming after short writes
+static bool write_all_parts(int fd, struct iovec* parts, int count) {
+    while (count > 0) {
+        ssize_t written = writev(fd, parts, count);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        while (count > 0 && (size_t)written >= parts->iov_len) {
+            written -= (ssize_t)parts->iov_len;
+            parts++;
+            count--;
+        }
+        if (count > 0) {
+            parts->iov_base = (char*)parts->iov_base + written;
+            parts->iov_len -= (size_t)written;
+        }
+    }
+    return true;
+}
+
+// Write the Q-table file without reporting it. With sync the file is on disk before returning.
+bool write_q_table_file(QLearningAgent* agent, const char* filename, bool compress, bool sync) {
+    if (!agent || !filename) {
+        fprintf(stderr, "Error: Invalid parameters for save_q_table\n");
+        return false;
+    }
+
+    // Truncating the file behind a live mapping would fault; checkpoint it in place instead
+    if (agent->mapped_table && strcmp(agent->mapped_table->filename, filename) == 0) {
+        return sync_mapped_qtable(agent->mapped_table);
+    }
+
+    size_t count = (size_t)agent->num_states * agent->num_actions;
+    size_t data_bytes = count * sizeof(float);
+
+    // A flat table in state order is written straight from its rows
+    const float* rows = NULL;
+    float* gathered = NULL;
+    OptimizedQTable* qtable = agent->optimized_table ? agent->optimized_table->qtable : NULL;
+    if (qtable && !qtable->state_slots && qtable->state_stride == agent->num_actions) {
+        rows = qtable->data;
+    } else {
+        gathered = (float*)malloc(data_bytes);
+        if (!gathered) {
+            fprintf(stderr, "Error: Failed to allocate memory for Q-table checkpoint\n");
+            return false;
+        }
+        for (int state = 0; state < agent->num_states; state++) {
+            memcpy(gathered + (size_t)state * agent->num_actions, agent_row(agent, state),
+                   agent->num_actions * sizeof(float));
+        }
+        rows = gathered;
+    }
+
+    const void* stored = rows;
+    size_t stored_bytes = data_bytes;
+    uint32_t* encoded = NULL;
+    if (compress) {
+        encoded = (uint32_t*)malloc(qtable_rle_bound(count) * sizeof(uint32_t));
+        if (!encoded) {
+            fprintf(stderr, "Error: Failed to allocate memory for Q-table compression\n");
+            free(gathered);
+            return false;
+        }
+        stored = encoded;
+        stored_bytes = qtable_rle_encode((const uint32_t*)rows, count, encoded) * sizeof(uint32_t);
+    }
+
+    QTableFileHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = QTABLE_FILE_MAGIC;
+    header.version = QTABLE_FILE_VERSION;
+    header.header_size = sizeof(QTableFileHeader);
+    header.flags = QTABLE_FILE_CRC | QTABLE_FILE_AGENT_PARAMS | (compress ? QTABLE_FILE_RLE : 0);
+    header.num_states = agent->num_states;
+    header.num_actions = agent->num_actions;
+    header.state_stride = agent->num_actions;
+    header.byte_order = QTABLE_FILE_BYTE_ORDER;
+    header.data_offset = QTABLE_FILE_DATA_OFFSET;
+    header.data_size = data_bytes;
+    header.stored_size = stored_bytes;
+    header.data_crc = qtable_crc32(0, stored, stored_bytes);
+    header.learning_rate = agent->learning_rate;
+    header.discount_factor = agent->discount_factor;
+    header.epsilon = agent->epsilon;
+    header.epsilon_decay = agent->epsilon_decay;
+    header.epsilon_min = agent->epsilon_min;
+    seal_qtable_file_header(&header);
+
+    unsigned char page[QTABLE_FILE_DATA_OFFSET];
+    memset(page, 0, sizeof(page));
+    memcpy(page, &header, sizeof(header));
+
+    bool ok = false;
+    int fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "Error: Could not open file %s for writing\n", filename);
+    } else {
+        // Header page and rows go out in a single writev
+        struct iovec parts[2] = {
+            {page, sizeof(page)},
+            {(void*)stored, stored_bytes}
+        };
+        ok = write_all_parts(fd, parts, 2);
+        if (ok && sync && fsync(fd) != 0) ok = false;
+        if (close(fd) != 0) ok = false;
+        if (!ok) {
+            fprintf(stderr, "Error: Failed to write Q-table to %s: %s\n", filename, strerror(errno));
+        }
+    }
+
+    free(encoded);
+    free(gathered);
+    return ok;
+}
+
+// Save Q-table to binary file. Uncompressed files can be opened directly with create_agent_mapped().
+bool save_q_table(QLearningAgent* agent, const char* filename) {
+    if (!write_q_table_file(agent, filename, false, false)) return false;
     printf("Q-table saved to %s\n", filename);
     return true;
 }
 
-// Load Q-table from binary file
+// Save with run-length encoded rows (smaller for sparsely visited tables, not mappable)
+bool save_q_table_compressed(QLearningAgent* agent, const char* filename) {
+    if (!write_q_table_file(agent, filename, true, false)) return false;
+    printf("Q-table saved to %s (compressed)\n", filename);
+    return true;
+}
+
+// Load Q-table from binary file (versioned, mapped-table or legacy layout)
 bool load_q_table(QLearningAgent* agent, const char* filename) {
     if (!agent || !filename) {
         fprintf(stderr, "Error: Invalid parameters for load_q_table\n");
         return false;
     }
 
-    FILE* file = fopen(filename, "rb");
-    if (!file) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
         fprintf(stderr, "Error: Could not open file %s for reading\n", filename);
         return false;
     }
 
-    // Read header information
-    int num_states, num_actions;
-    fread(&num_states, sizeof(int), 1, file);
-    fread(&num_actions, sizeof(int), 1, file);
+    struct stat st;
+    QTableFileHeader header;
+    memset(&header, 0, sizeof(header));
+    ssize_t header_bytes = fstat(fd, &st) == 0 ? pread(fd, &header, sizeof(header), 0) : -1;
+    if (header_bytes < (ssize_t)sizeof(uint32_t) ||
+        (header.magic != QTABLE_FILE_MAGIC && header.magic != __builtin_bswap32(QTABLE_FILE_MAGIC))) {
+        close(fd);
+        return load_legacy_q_table(agent, filename);
+    }
+    if (header_bytes < (ssize_t)sizeof(header)) {
+        fprintf(stderr, "Error: %s is truncated (incomplete header)\n", filename);
+        close(fd);
+        return false;
+    }
+    if (!validate_qtable_file_header(&header, (uint64_t)st.st_size, filename,
+                                     agent->num_states, agent->num_actions)) {
+        close(fd);
+        return false;
+    }
 
-    // Verify compatibility
-    if (num_states != agent->num_states || num_actions != agent->num_actions) {
-        fprintf(stderr, "Error: Q-table dimensions mismatch. Expected %dx%d, got %dx%d\n",
-                agent->num_states, agent->num_actions, num_states, num_actions);
-        fclose(file);
+    // Read through a private mapping: the checksum and the copy into the
+    // table each stream the file once without a staging buffer
+    size_t mapped_size = (size_t)(header.data_offset + header.stored_size);
+    void* mapped = mmap(NULL, mapped_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        fprintf(stderr, "Error: Could not map %s: %s\n", filename, strerror(errno));
         return false;
     }
+    posix_madvise(mapped, mapped_size, POSIX_MADV_SEQUENTIAL);
 
-    // Load agent parameters
-    fread(&agent->learning_rate, sizeof(float), 1, file);
-    fread(&agent->discount_factor, sizeof(float), 1, file);
-    fread(&agent->epsilon, sizeof(float), 1, file);
-    fread(&agent->epsilon_decay, sizeof(float), 1, file);
-    fread(&agent->epsilon_min, sizeof(float), 1, file);
+    const unsigned char* stored = (const unsigned char*)mapped + header.data_offset;
+    if ((header.flags & QTABLE_FILE_CRC) && qtable_crc32(0, stored, header.stored_size) != header.data_crc) {
+        fprintf(stderr, "Error: %s failed its checksum (corrupt or partially written)\n", filename);
+        munmap(mapped, mapped_size);
+        return false;
+    }
+
+    const float* rows = (const float*)stored;
+    float* decoded = NULL;
+    if (header.flags & QTABLE_FILE_RLE) {
+        decoded = (float*)malloc(header.data_size);
+        if (!decoded || !qtable_rle_decode((const uint32_t*)stored, header.stored_size / sizeof(uint32_t),
+                                           (uint32_t*)decoded, header.data_size / sizeof(uint32_t))) {
+            fprintf(stderr, "Error: Could not decode compressed Q-table in %s\n", filename);
+            free(decoded);
+            munmap(mapped, mapped_size);
+            return false;
+        }
+        rows = decoded;
+    }
 
-    // Load Q-table data
     for (int state = 0; state < agent->num_states; state++) {
-        fread(agent->q_table[state], sizeof(float), agent->num_actions, file);
+        memcpy(agent_row(agent, state), rows + (size_t)state * header.state_stride,
+               agent->num_actions * sizeof(float));
+    }
+    if (agent->optimized_table) {
+        invalidate_all_caches(agent->optimized_table->qtable);
     }
+    if (header.flags & QTABLE_FILE_AGENT_PARAMS) {
+        agent->learning_rate = header.learning_rate;
+        agent->discount_factor = header.discount_factor;
+        agent->epsilon = header.epsilon;
+        agent->epsilon_decay = header.epsilon_decay;
+        agent->epsilon_min = header.epsilon_min;
+    }
+    agent->q_bounds.stale = true;
+    agent->q_moments.stale = true;
+    clear_eligibility_traces(agent);
 
-    fclose(file);
+    free(decoded);
+    munmap(mapped, mapped_size);
     printf("Q-table loaded from %s\n", filename);
     return true;
 }
@@ -643,7 +1407,8 @@ ReplayConfig create_default_replay_config() {
         .priority_beta_start = 0.4f,
         .priority_beta_end = 1.0f,
         .beta_anneal_steps = 100000,
-        .min_priority = 1e-6f
+        .min_priority = 1e-6f,
+        .stratified_sampling = true
     };
     return config;
 }
@@ -661,93 +1426,24 @@ ReplayConfig create_replay_config(bool enabled, int buffer_size, int batch_size,
         .priority_beta_start = priority_beta_start,
         .priority_beta_end = priority_beta_end,
         .beta_anneal_steps = beta_anneal_steps,
-        .min_priority = min_priority
+        .min_priority = min_priority,
+        .stratified_sampling = true
     };
     return config;
 }
 
-// Priority queue helper functions
-void heapify_up(PriorityExperienceBuffer* buffer, int index) {
-    if (index == 0) return;
-    
-    int parent = (index - 1) / 2;
-    int heap_idx = buffer->heap[index];
-    int parent_heap_idx = buffer->heap[parent];
-    
-    if (buffer->priorities[heap_idx] > buffer->priorities[parent_heap_idx]) {
-        // Swap heap indices
-        buffer->heap[index] = parent_heap_idx;
-        buffer->heap[parent] = heap_idx;
-        heapify_up(buffer, parent);
-    }
-}
-
-void heapify_down(PriorityExperienceBuffer* buffer, int index) {
-    int left_child = 2 * index + 1;
-    int right_child = 2 * index + 2;
-    int largest = index;
-    
-    if (left_child < buffer->size) {
-        int left_heap_idx = buffer->heap[left_child];
-        int largest_heap_idx = buffer->heap[largest];
-        if (buffer->priorities[left_heap_idx] > buffer->priorities[largest_heap_idx]) {
-            largest = left_child;
-        }
-    }
-    
-    if (right_child < buffer->size) {
-        int right_heap_idx = buffer->heap[right_child];
-        int largest_heap_idx = buffer->heap[largest];
-        if (buffer->priorities[right_heap_idx] > buffer->priorities[largest_heap_idx]) {
-            largest = right_child;
-        }
-    }
-    
-    if (largest != index) {
-        // Swap heap indices
-        int temp = buffer->heap[index];
-        buffer->heap[index] = buffer->heap[largest];
-        buffer->heap[largest] = temp;
-        heapify_down(buffer, largest);
-    }
-}
-
-void heap_insert(PriorityExperienceBuffer* buffer, int experience_index, float priority) {
-    if (buffer->size >= buffer->capacity) return;
-    
-    buffer->priorities[experience_index] = priority;
-    buffer->heap[buffer->size] = experience_index;
-    heapify_up(buffer, buffer->size);
-    buffer->size++;
-}
-
-int heap_extract_max(PriorityExperienceBuffer* buffer) {
-    if (buffer->size == 0) return -1;
-    
-    int max_idx = buffer->heap[0];
-    buffer->heap[0] = buffer->heap[buffer->size - 1];
-    buffer->size--;
-    
-    if (buffer->size > 0) {
-        heapify_down(buffer, 0);
-    }
-    
-    return max_idx;
-}
-
 // Create priority experience buffer
 PriorityExperienceBuffer* create_priority_buffer(int capacity, ReplayConfig config) {
-    PriorityExperienceBuffer* buffer = (PriorityExperienceBuffer*)malloc(sizeof(PriorityExperienceBuffer));
+    PriorityExperienceBuffer* buffer = (PriorityExperienceBuffer*)memory_calloc(MEMORY_REPLAY, 1, sizeof(PriorityExperienceBuffer));
     if (!buffer) {
         fprintf(stderr, "Error: Failed to allocate memory for priority experience buffer\n");
         return NULL;
     }
 
-    buffer->experiences = (PriorityExperience*)malloc(capacity * sizeof(PriorityExperience));
-    buffer->priorities = (float*)malloc(capacity * sizeof(float));
-    buffer->heap = (int*)malloc(capacity * sizeof(int));
+    buffer->experiences = (PriorityExperience*)memory_alloc(MEMORY_REPLAY, capacity * sizeof(PriorityExperience));
+    buffer->priority_tree = create_sum_tree(capacity);
     
-    if (!buffer->experiences || !buffer->priorities || !buffer->heap) {
+    if (!buffer->experiences || !buffer->priority_tree) {
         fprintf(stderr, "Error: Failed to allocate memory for priority buffer components\n");
         destroy_priority_buffer(buffer);
         return NULL;
@@ -756,6 +1452,7 @@ PriorityExperienceBuffer* create_priority_buffer(int capacity, ReplayConfig conf
     buffer->capacity = capacity;
     buffer->size = 0;
     buffer->current_index = 0;
+    buffer->stratified = config.stratified_sampling;
     buffer->alpha = config.priority_alpha;
     buffer->beta = config.priority_beta_start;
     buffer->beta_increment = (config.priority_beta_end - config.priority_beta_start) / config.beta_anneal_steps;
@@ -763,23 +1460,24 @@ PriorityExperienceBuffer* create_priority_buffer(int capacity, ReplayConfig conf
     buffer->min_priority = config.min_priority;
     buffer->replay_batch_size = config.batch_size;
     buffer->global_step = 0;
-
-    // Initialize priorities to minimum value
-    for (int i = 0; i < capacity; i++) {
-        buffer->priorities[i] = buffer->min_priority;
-    }
+    seed_random(&buffer->rng, default_rng_seed());
 
     return buffer;
 }
 
+// Reseed the buffer's sampling generator for reproducible replay
+void seed_priority_buffer(PriorityExperienceBuffer* buffer, unsigned int seed) {
+    if (!buffer) return;
+    seed_random(&buffer->rng, seed);
+}
+
 // Destroy priority experience buffer
 void destroy_priority_buffer(PriorityExperienceBuffer* buffer) {
     if (!buffer) return;
     
-    free(buffer->experiences);
-    free(buffer->priorities);
-    free(buffer->heap);
-    free(buffer);
+    memory_free(buffer->experiences);
+    destroy_sum_tree(buffer->priority_tree);
+    memory_free(buffer);
 }
 
 // Add experience with priority
@@ -800,21 +1498,9 @@ void add_priority_experience(PriorityExperienceBuffer* buffer, int state, Action
     float priority = powf(fabsf(td_error) + buffer->min_priority, buffer->alpha);
     exp->priority = priority;
     
-    // Update priority in the priority array
-    buffer->priorities[buffer->current_index] = priority;
-    
-    // Update max priority (recalculate if this is the first experience or if we're overwriting)
-    if (buffer->size == 0 || priority > buffer->max_priority) {
-        buffer->max_priority = priority;
-    } else if (buffer->size >= buffer->capacity && buffer->current_index < buffer->size) {
-        // We might be overwriting the max priority experience, recalculate max
-        buffer->max_priority = buffer->priorities[0];
-        for (int i = 1; i < buffer->size; i++) {
-            if (buffer->priorities[i] > buffer->max_priority) {
-                buffer->max_priority = buffer->priorities[i];
-            }
-        }
-    }
+    // Overwriting a slot replaces its leaf, so the tree max stays exact without a rescan
+    sum_tree_update(buffer->priority_tree, buffer->current_index, priority);
+    buffer->max_priority = sum_tree_max(buffer->priority_tree);
 
     buffer->current_index = (buffer->current_index + 1) % buffer->capacity;
     if (buffer->size < buffer->capacity) {
@@ -822,15 +1508,17 @@ void add_priority_experience(PriorityExperienceBuffer* buffer, int state, Action
     }
 }
 
-// Calculate importance sampling weight
+// Calculate importance sampling weight w_i = (N * P(i))^-beta, normalized by the
+// largest weight in the buffer (that of the minimum priority) so weights are <= 1
 float calculate_importance_weight(PriorityExperienceBuffer* buffer, int index) {
     if (!buffer || index < 0 || index >= buffer->size) return 1.0f;
     
-    float priority = buffer->priorities[index];
-    float prob = priority / buffer->max_priority;  // Simplified probability calculation
-    float weight = powf(prob * buffer->size, -buffer->beta);
-    
-    return weight;
+    float priority = sum_tree_get(buffer->priority_tree, index);
+    float min_priority = sum_tree_min(buffer->priority_tree);
+    if (priority <= 0.0f || min_priority <= 0.0f) return 1.0f;
+
+    // (N * p_i / total)^-beta / (N * p_min / total)^-beta
+    return powf(priority / min_priority, -buffer->beta);
 }
 
 // Update beta for importance sampling annealing
@@ -840,7 +1528,17 @@ void update_beta(PriorityExperienceBuffer* buffer) {
     buffer->beta = fminf(buffer->beta + buffer->beta_increment, 1.0f);
 }
 
-// Sample priority batch with importance weights
+// Buffer slot for draw i of a batch of batch_size: a prefix-sum descent of
+// the priority tree, one uniform draw per segment in stratified mode
+static int draw_priority_index(PriorityExperienceBuffer* buffer, int i, int batch_size, double total_priority) {
+    return sum_tree_sample(buffer->priority_tree, total_priority, random_double(&buffer->rng), i, batch_size,
+                           buffer->stratified, buffer->size);
+}
+
+// Sample priority batch with importance weights. Each draw is an O(log n)
+// prefix-sum descent of the priority tree. In stratified mode the total is
+// split into batch_size equal segments with one uniform draw per segment,
+// which lowers sampling variance and guarantees coverage of the range.
 PriorityExperience* sample_priority_batch(PriorityExperienceBuffer* buffer, int batch_size, 
                                         int* indices, float* weights) {
     if (!buffer || buffer->size == 0 || batch_size <= 0) return NULL;
@@ -854,34 +1552,90 @@ PriorityExperience* sample_priority_batch(PriorityExperienceBuffer* buffer, int
         batch_capacity = batch_size;
     }
     
-    // Calculate total priority sum for sampling
-    float total_priority = 0.0f;
-    for (int i = 0; i < buffer->size; i++) {
-        total_priority += buffer->priorities[i];
-    }
+    PROFILE_BEGIN(PROFILE_REPLAY);
+    double total_priority = sum_tree_total(buffer->priority_tree);
     
-    // Sample experiences based on priority
     for (int i = 0; i < batch_size; i++) {
-        float random_value = ((float)rand() / RAND_MAX) * total_priority;
-        float cumulative_priority = 0.0f;
-        int selected_index = 0;
-        
-        for (int j = 0; j < buffer->size; j++) {
-            cumulative_priority += buffer->priorities[j];
-            if (cumulative_priority >= random_value) {
-                selected_index = j;
-                break;
-            }
-        }
-        
+        int selected_index = draw_priority_index(buffer, i, batch_size, total_priority);
         indices[i] = selected_index;
         batch[i] = buffer->experiences[selected_index];
         weights[i] = calculate_importance_weight(buffer, selected_index);
     }
+    PROFILE_END(PROFILE_REPLAY);
     
     return batch;
 }
 
+// Create an empty structure-of-arrays batch holding up to capacity transitions
+ReplayBatch* create_replay_batch(int capacity) {
+    if (capacity <= 0) {
+        fprintf(stderr, "Error: Invalid replay batch capacity\n");
+        return NULL;
+    }
+
+    ReplayBatch* batch = (ReplayBatch*)memory_calloc(MEMORY_REPLAY, 1, sizeof(ReplayBatch));
+    if (!batch) {
+        fprintf(stderr, "Error: Failed to allocate memory for replay batch\n");
+        return NULL;
+    }
+
+    batch->indices = (int*)memory_alloc(MEMORY_REPLAY, capacity * sizeof(int));
+    batch->states = (int*)memory_alloc(MEMORY_REPLAY, capacity * sizeof(int));
+    batch->actions = (int*)memory_alloc(MEMORY_REPLAY, capacity * sizeof(int));
+    batch->rewards = (float*)memory_alloc(MEMORY_REPLAY, capacity * sizeof(float));
+    batch->next_states = (int*)memory_alloc(MEMORY_REPLAY, capacity * sizeof(int));
+    batch->dones = (bool*)memory_alloc(MEMORY_REPLAY, capacity * sizeof(bool));
+    batch->weights = (float*)memory_alloc(MEMORY_REPLAY, capacity * sizeof(float));
+    batch->td_errors = (float*)memory_alloc(MEMORY_REPLAY, capacity * sizeof(float));
+    if (!batch->indices || !batch->states || !batch->actions || !batch->rewards ||
+        !batch->next_states || !batch->dones || !batch->weights || !batch->td_errors) {
+        fprintf(stderr, "Error: Failed to allocate memory for replay batch arrays\n");
+        destroy_replay_batch(batch);
+        return NULL;
+    }
+
+    batch->capacity = capacity;
+    return batch;
+}
+
+void destroy_replay_batch(ReplayBatch* batch) {
+    if (!batch) return;
+
+    memory_free(batch->indices);
+    memory_free(batch->states);
+    memory_free(batch->actions);
+    memory_free(batch->rewards);
+    memory_free(batch->next_states);
+    memory_free(batch->dones);
+    memory_free(batch->weights);
+    memory_free(batch->td_errors);
+    memory_free(batch);
+}
+
+// Same draws as sample_priority_batch, scattered straight into the batch's arrays
+bool sample_replay_batch(PriorityExperienceBuffer* buffer, int batch_size, ReplayBatch* batch) {
+    if (!buffer || !batch || buffer->size == 0 || batch_size <= 0 || batch_size > batch->capacity) {
+        return false;
+    }
+
+    PROFILE_BEGIN(PROFILE_REPLAY);
+    double total_priority = sum_tree_total(buffer->priority_tree);
+    for (int i = 0; i < batch_size; i++) {
+        int selected_index = draw_priority_index(buffer, i, batch_size, total_priority);
+        const PriorityExperience* exp = &buffer->experiences[selected_index];
+        batch->indices[i] = selected_index;
+        batch->states[i] = exp->state;
+        batch->actions[i] = (int)exp->action;
+        batch->rewards[i] = exp->reward;
+        batch->next_states[i] = exp->next_state;
+        batch->dones[i] = exp->done;
+        batch->weights[i] = calculate_importance_weight(buffer, selected_index);
+    }
+    batch->size = batch_size;
+    PROFILE_END(PROFILE_REPLAY);
+    return true;
+}
+
 // Update experience priorities based on new TD errors
 void update_experience_priorities(PriorityExperienceBuffer* buffer, int* indices, float* td_errors, int count) {
     if (!buffer || !indices || !td_errors) return;
@@ -890,16 +1644,12 @@ void update_experience_priorities(PriorityExperienceBuffer* buffer, int* indices
         int idx = indices[i];
         if (idx >= 0 && idx < buffer->size) {
             float new_priority = powf(fabsf(td_errors[i]) + buffer->min_priority, buffer->alpha);
-            buffer->priorities[idx] = new_priority;
+            sum_tree_update(buffer->priority_tree, idx, new_priority);
             buffer->experiences[idx].td_error = td_errors[i];
             buffer->experiences[idx].priority = new_priority;
-            
-            // Update max priority
-            if (new_priority > buffer->max_priority) {
-                buffer->max_priority = new_priority;
-            }
         }
     }
+    buffer->max_priority = sum_tree_max(buffer->priority_tree);
 }
 
 // Calculate TD error for an experience
@@ -909,52 +1659,139 @@ float calculate_td_error(QLearningAgent* agent, PriorityExperience* exp) {
     float current_q = get_q_value(agent, exp->state, exp->action);
     float max_next_q = 0.0f;
     
-    if (!exp->done) {
-        // Find maximum Q-value for next state
-        for (int a = 0; a < agent->num_actions; a++) {
-            float q_val = get_q_value(agent, exp->next_state, a);
-            if (a == 0 || q_val > max_next_q) {
-                max_next_q = q_val;
-            }
-        }
+    if (!exp->done && exp->next_state >= 0 && exp->next_state < agent->num_states) {
+        max_next_q = agent_max_q(agent, exp->next_state);
     }
     
     float td_target = exp->reward + agent->discount_factor * max_next_q;
     return td_target - current_q;
 }
 
-// Replay batch of experiences with importance sampling
+// Transitions per pass of the replay kernel: enough to keep many row loads
+// in flight, small enough for the per-pass arrays to live on the stack
+#define REPLAY_CHUNK 64
+
+#ifdef __SSE2__
+static inline __m128 load_next_row(const float* row) {
+    return row ? _mm_loadu_ps(row) : _mm_setzero_ps();
+}
+#endif
+
+// targets[i] = rewards[i] + discount * max_a Q(next_states[i], a), with 0 for
+// terminal transitions. All rows are gathered (and prefetched) before any is
+// read; with four actions, four rows are transposed so one max per lane
+// yields four samples' max-Q.
+static void replay_targets(QLearningAgent* agent, const int* next_states, const float* rewards,
+                           const bool* dones, int count, float* targets) {
+    const float* rows[REPLAY_CHUNK];
+    for (int i = 0; i < count; i++) {
+        int next_state = next_states[i];
+        bool has_next = !dones[i] && next_state >= 0 && next_state < agent->num_states;
+        rows[i] = has_next ? agent_row(agent, next_state) : NULL;
+        if (rows[i]) {
+            __builtin_prefetch(rows[i], 0, 1);
+        }
+    }
+
+    int i = 0;
+#ifdef __SSE2__
+    if (agent->num_actions == 4) {
+        const __m128 discount = _mm_set1_ps(agent->discount_factor);
+        for (; i + 4 <= count; i += 4) {
+            __m128 q0 = load_next_row(rows[i]);
+            __m128 q1 = load_next_row(rows[i + 1]);
+            __m128 q2 = load_next_row(rows[i + 2]);
+            __m128 q3 = load_next_row(rows[i + 3]);
+            _MM_TRANSPOSE4_PS(q0, q1, q2, q3);  // qa = Q(s'_i .. s'_i+3, a)
+            __m128 max_q = _mm_max_ps(_mm_max_ps(q0, q1), _mm_max_ps(q2, q3));
+            _mm_storeu_ps(targets + i, _mm_add_ps(_mm_loadu_ps(rewards + i), _mm_mul_ps(discount, max_q)));
+        }
+    }
+#endif
+    for (; i < count; i++) {
+        float max_q = 0.0f;
+        if (rows[i]) {
+            max_q = rows[i][0];
+            for (int a = 1; a < agent->num_actions; a++) {
+                if (rows[i][a] > max_q) max_q = rows[i][a];
+            }
+        }
+        targets[i] = rewards[i] + agent->discount_factor * max_q;
+    }
+}
+
+// Importance-weighted Q-learning updates for a structure-of-arrays batch.
+// Transitions with an out-of-range state or action are skipped (TD error 0).
+void replay_update_batch(QLearningAgent* agent, const int* states, const int* actions, const float* rewards,
+                         const int* next_states, const bool* dones, const float* weights, int count,
+                         float* td_errors) {
+    if (!agent || !states || !actions || !rewards || !next_states || !dones) return;
+
+    PROFILE_BEGIN(PROFILE_REPLAY);
+    float targets[REPLAY_CHUNK];
+    for (int begin = 0; begin < count; begin += REPLAY_CHUNK) {
+        int n = count - begin < REPLAY_CHUNK ? count - begin : REPLAY_CHUNK;
+        const int* chunk_states = states + begin;
+        const int* chunk_actions = actions + begin;
+
+        for (int i = 0; i < n; i++) {
+            if (chunk_states[i] >= 0 && chunk_states[i] < agent->num_states) {
+                __builtin_prefetch(agent_row(agent, chunk_states[i]), 1, 1);
+            }
+        }
+        replay_targets(agent, next_states + begin, rewards + begin, dones + begin, n, targets);
+
+        // Sequential so a transition drawn twice steps from the first update's result
+        for (int i = 0; i < n; i++) {
+            int state = chunk_states[i];
+            int action = chunk_actions[i];
+            float td_error = 0.0f;
+            if (state >= 0 && state < agent->num_states && action >= 0 && action < agent->num_actions &&
+                (dones[begin + i] || (next_states[begin + i] >= 0 && next_states[begin + i] < agent->num_states))) {
+                float current_q = agent_q(agent, state, action);
+                float weighted_lr = agent->learning_rate * (weights ? weights[begin + i] : 1.0f);
+                td_error = targets[i] - current_q;
+                agent_replace_q(agent, state, action, current_q, current_q + weighted_lr * td_error);
+            }
+            if (td_errors) {
+                td_errors[begin + i] = td_error;
+            }
+        }
+    }
+    PROFILE_END(PROFILE_REPLAY);
+}
+
+void replay_priority_batch(QLearningAgent* agent, PriorityExperienceBuffer* buffer, ReplayBatch* batch) {
+    if (!agent || !buffer || !batch) return;
+
+    replay_update_batch(agent, batch->states, batch->actions, batch->rewards, batch->next_states,
+                        batch->dones, batch->weights, batch->size, batch->td_errors);
+    update_experience_priorities(buffer, batch->indices, batch->td_errors, batch->size);
+}
+
+// Replay batch of experiences with importance sampling. The records are
+// split into fields a chunk at a time and handed to the batch kernel.
 void replay_batch_experiences(QLearningAgent* agent, PriorityExperience* batch, 
                             float* importance_weights, int batch_size) {
     if (!agent || !batch || !importance_weights) return;
     
-    for (int i = 0; i < batch_size; i++) {
-        PriorityExperience* exp = &batch[i];
-        
-        // Calculate current Q-value
-        float current_q = get_q_value(agent, exp->state, exp->action);
-        float max_next_q = 0.0f;
-        
-        // Find maximum Q-value for next state (if not terminal)
-        if (!exp->done) {
-            for (int a = 0; a < agent->num_actions; a++) {
-                float q_val = get_q_value(agent, exp->next_state, a);
-                if (a == 0 || q_val > max_next_q) {
-                    max_next_q = q_val;
-                }
-            }
+    int states[REPLAY_CHUNK];
+    int actions[REPLAY_CHUNK];
+    float rewards[REPLAY_CHUNK];
+    int next_states[REPLAY_CHUNK];
+    bool dones[REPLAY_CHUNK];
+    for (int begin = 0; begin < batch_size; begin += REPLAY_CHUNK) {
+        int n = batch_size - begin < REPLAY_CHUNK ? batch_size - begin : REPLAY_CHUNK;
+        for (int i = 0; i < n; i++) {
+            const PriorityExperience* exp = &batch[begin + i];
+            states[i] = exp->state;
+            actions[i] = (int)exp->action;
+            rewards[i] = exp->reward;
+            next_states[i] = exp->next_state;
+            dones[i] = exp->done;
         }
-        
-        // Calculate TD target and error
-        float td_target = exp->reward + agent->discount_factor * max_next_q;
-        float td_error = td_target - current_q;
-        
-        // Apply importance sampling weight to learning rate
-        float weighted_lr = agent->learning_rate * importance_weights[i];
-        
-        // Update Q-value
-        float new_q = current_q + weighted_lr * td_error;
-        set_q_value(agent, exp->state, exp->action, new_q);
+        replay_update_batch(agent, states, actions, rewards, next_states, dones,
+                            importance_weights + begin, n, NULL);
     }
 }
 
@@ -962,22 +1799,133 @@ void replay_batch_experiences(QLearningAgent* agent, PriorityExperience* batch,
 // STATE VISIT TRACKING IMPLEMENTATION
 // ============================================================================
 
+// Below this the decay scale is folded into the stored bonuses before it underflows
+#define BONUS_SCALE_FLOOR 1e-20f
+
+// Bonus a state receives on reaching count visits; later decay only lowers it
+static float visit_bonus(const StateVisitTracker* tracker, int count) {
+    return fmaxf(tracker->min_exploration_bonus, 1.0f / sqrtf((float)count + 1));
+}
+
+// Current bonus: the stored value scaled by every decay since it was set
+static float current_bonus(const StateVisitTracker* tracker, int state) {
+    return fmaxf(tracker->min_exploration_bonus, tracker->exploration_bonuses[state] * tracker->bonus_scale);
+}
+
+// Put every state in a single count-0 bucket, state 0 at the head
+static void init_visit_buckets(StateVisitTracker* tracker) {
+    int n = tracker->num_states;
+    for (int i = 0; i < n; i++) {
+        tracker->state_bucket[i] = 0;
+        tracker->prev_in_bucket[i] = i - 1;
+        tracker->next_in_bucket[i] = i + 1 < n ? i + 1 : -1;
+    }
+    tracker->buckets[0] = (VisitBucket){0, 0, n, -1, -1};
+    for (int b = 1; b <= n; b++) {
+        tracker->buckets[b].next = b < n ? b + 1 : -1;
+    }
+    tracker->first_bucket = 0;
+    tracker->last_bucket = 0;
+    tracker->free_bucket = n > 0 ? 1 : -1;
+}
+
+// Take a bucket from the pool and link it in after bucket prev
+static int insert_bucket_after(StateVisitTracker* tracker, int prev, int count) {
+    int b = tracker->free_bucket;
+    VisitBucket* bucket = &tracker->buckets[b];
+    tracker->free_bucket = bucket->next;
+
+    bucket->count = count;
+    bucket->head = -1;
+    bucket->size = 0;
+    bucket->prev = prev;
+    bucket->next = tracker->buckets[prev].next;
+    tracker->buckets[prev].next = b;
+    if (bucket->next >= 0) {
+        tracker->buckets[bucket->next].prev = b;
+    } else {
+        tracker->last_bucket = b;
+    }
+    return b;
+}
+
+// Unlink an empty bucket and return it to the pool
+static void release_bucket(StateVisitTracker* tracker, int b) {
+    VisitBucket* bucket = &tracker->buckets[b];
+    if (bucket->prev >= 0) {
+        tracker->buckets[bucket->prev].next = bucket->next;
+    } else {
+        tracker->first_bucket = bucket->next;
+    }
+    if (bucket->next >= 0) {
+        tracker->buckets[bucket->next].prev = bucket->prev;
+    } else {
+        tracker->last_bucket = bucket->prev;
+    }
+    bucket->next = tracker->free_bucket;
+    tracker->free_bucket = b;
+}
+
+// Move state from its bucket to the head of the bucket for one more visit.
+// The count just went up by one, so that bucket is the next one or a new one.
+static void advance_visit_bucket(StateVisitTracker* tracker, int state) {
+    int from = tracker->state_bucket[state];
+    int to = tracker->buckets[from].next;
+    if (to < 0 || tracker->buckets[to].count != tracker->visit_counts[state]) {
+        to = insert_bucket_after(tracker, from, tracker->visit_counts[state]);
+    }
+
+    int prev = tracker->prev_in_bucket[state];
+    int next = tracker->next_in_bucket[state];
+    if (prev >= 0) {
+        tracker->next_in_bucket[prev] = next;
+    } else {
+        tracker->buckets[from].head = next;
+    }
+    if (next >= 0) {
+        tracker->prev_in_bucket[next] = prev;
+    }
+    if (--tracker->buckets[from].size == 0) {
+        release_bucket(tracker, from);
+    }
+
+    VisitBucket* bucket = &tracker->buckets[to];
+    tracker->prev_in_bucket[state] = -1;
+    tracker->next_in_bucket[state] = bucket->head;
+    if (bucket->head >= 0) {
+        tracker->prev_in_bucket[bucket->head] = state;
+    }
+    bucket->head = state;
+    bucket->size++;
+    tracker->state_bucket[state] = to;
+}
+
 // Create state visit tracker
 StateVisitTracker* create_state_visit_tracker(int num_states, bool adaptive_epsilon, bool adaptive_learning_rate) {
-    StateVisitTracker* tracker = (StateVisitTracker*)malloc(sizeof(StateVisitTracker));
+    if (num_states <= 0) {
+        fprintf(stderr, "Error: Invalid number of states for state visit tracker\n");
+        return NULL;
+    }
+
+    StateVisitTracker* tracker = (StateVisitTracker*)memory_calloc(MEMORY_VISITS, 1, sizeof(StateVisitTracker));
     if (!tracker) {
         fprintf(stderr, "Error: Failed to allocate memory for state visit tracker\n");
         return NULL;
     }
 
-    tracker->visit_counts = (int*)calloc(num_states, sizeof(int));
-    tracker->visit_priorities = (float*)calloc(num_states, sizeof(float));
-    tracker->exploration_bonuses = (float*)malloc(num_states * sizeof(float));
-    tracker->state_epsilons = (float*)malloc(num_states * sizeof(float));
-    tracker->state_learning_rates = (float*)malloc(num_states * sizeof(float));
+    tracker->visit_counts = (int*)memory_calloc(MEMORY_VISITS, num_states, sizeof(int));
+    tracker->visit_priorities = (float*)memory_calloc(MEMORY_VISITS, num_states, sizeof(float));
+    tracker->exploration_bonuses = (float*)memory_alloc(MEMORY_VISITS, num_states * sizeof(float));
+    tracker->state_epsilons = (float*)memory_alloc(MEMORY_VISITS, num_states * sizeof(float));
+    tracker->state_learning_rates = (float*)memory_alloc(MEMORY_VISITS, num_states * sizeof(float));
+    tracker->buckets = (VisitBucket*)memory_alloc(MEMORY_VISITS, (num_states + 1) * sizeof(VisitBucket));
+    tracker->state_bucket = (int*)memory_alloc(MEMORY_VISITS, num_states * sizeof(int));
+    tracker->next_in_bucket = (int*)memory_alloc(MEMORY_VISITS, num_states * sizeof(int));
+    tracker->prev_in_bucket = (int*)memory_alloc(MEMORY_VISITS, num_states * sizeof(int));
 
     if (!tracker->visit_counts || !tracker->visit_priorities || !tracker->exploration_bonuses ||
-        !tracker->state_epsilons || !tracker->state_learning_rates) {
+        !tracker->state_epsilons || !tracker->state_learning_rates || !tracker->buckets ||
+        !tracker->state_bucket || !tracker->next_in_bucket || !tracker->prev_in_bucket) {
         fprintf(stderr, "Error: Failed to allocate memory for state visit tracker arrays\n");
         destroy_state_visit_tracker(tracker);
         return NULL;
@@ -991,14 +1939,7 @@ StateVisitTracker* create_state_visit_tracker(int num_states, bool adaptive_epsi
     tracker->adaptive_epsilon = adaptive_epsilon;
     tracker->adaptive_learning_rate = adaptive_learning_rate;
 
-    // Initialize arrays
-    for (int i = 0; i < num_states; i++) {
-        tracker->exploration_bonuses[i] = 1.0f;    // Start with high exploration bonus
-        tracker->state_epsilons[i] = 1.0f;        // Start with high exploration
-        tracker->state_learning_rates[i] = 1.0f;  // Start with normal learning rate
-        tracker->visit_priorities[i] = 1.0f;      // Equal priority initially
-    }
-
+    reset_state_visit_tracker(tracker);
     return tracker;
 }
 
@@ -1006,49 +1947,61 @@ StateVisitTracker* create_state_visit_tracker(int num_states, bool adaptive_epsi
 void destroy_state_visit_tracker(StateVisitTracker* tracker) {
     if (!tracker) return;
     
-    free(tracker->visit_counts);
-    free(tracker->visit_priorities);
-    free(tracker->exploration_bonuses);
-    free(tracker->state_epsilons);
-    free(tracker->state_learning_rates);
-    free(tracker);
+    memory_free(tracker->visit_counts);
+    memory_free(tracker->visit_priorities);
+    memory_free(tracker->exploration_bonuses);
+    memory_free(tracker->state_epsilons);
+    memory_free(tracker->state_learning_rates);
+    memory_free(tracker->buckets);
+    memory_free(tracker->state_bucket);
+    memory_free(tracker->next_in_bucket);
+    memory_free(tracker->prev_in_bucket);
+    memory_free(tracker);
 }
 
-// Update state visit count and derived metrics
+// Update state visit count and derived metrics in O(1)
 void update_state_visit(StateVisitTracker* tracker, int state) {
     if (!tracker || state < 0 || state >= tracker->num_states) return;
     
     tracker->visit_counts[state]++;
     tracker->total_visits++;
     
-    // Update exploration bonus (decreases with visits)
-    tracker->exploration_bonuses[state] = fmaxf(
-        tracker->min_exploration_bonus,
-        1.0f / sqrtf((float)tracker->visit_counts[state] + 1)
-    );
+    // Update exploration bonus (decreases with visits). Stored relative to the
+    // current decay scale, so get_exploration_bonus() sees it undecayed.
+    float bonus = visit_bonus(tracker, tracker->visit_counts[state]);
+    tracker->exploration_bonuses[state] = bonus / tracker->bonus_scale;
     
     // Update state-specific epsilon (less exploration for well-visited states)
     if (tracker->adaptive_epsilon) {
-        tracker->state_epsilons[state] = tracker->exploration_bonuses[state];
+        tracker->state_epsilons[state] = bonus;
     }
     
     // Update state-specific learning rate (faster learning in new states)
     if (tracker->adaptive_learning_rate) {
-        tracker->state_learning_rates[state] = fminf(
-            2.0f,
-            1.0f + tracker->exploration_bonuses[state]
-        );
+        tracker->state_learning_rates[state] = fminf(2.0f, 1.0f + bonus);
     }
     
-    // Update visit priorities
-    update_state_priorities(tracker);
+    advance_visit_bucket(tracker, state);
 }
 
 // Get exploration bonus for a state
 float get_exploration_bonus(StateVisitTracker* tracker, int state) {
     if (!tracker || state < 0 || state >= tracker->num_states) return 0.0f;
     
-    return tracker->exploration_bonuses[state];
+    return current_bonus(tracker, state);
+}
+
+// Priority of a state: 1 - (visits - min) / (max - min) plus its current
+// bonus, or 1.0 for every state while all visit counts are equal
+float get_state_priority(StateVisitTracker* tracker, int state) {
+    if (!tracker || state < 0 || state >= tracker->num_states) return 0.0f;
+    
+    int min_visits = tracker->buckets[tracker->first_bucket].count;
+    int max_visits = tracker->buckets[tracker->last_bucket].count;
+    if (max_visits == min_visits) return 1.0f;
+    
+    float visit_norm = 1.0f - ((float)(tracker->visit_counts[state] - min_visits) / (max_visits - min_visits));
+    return visit_norm + current_bonus(tracker, state);
 }
 
 // Get adaptive epsilon for a state
@@ -1069,58 +2022,59 @@ float get_state_learning_rate(StateVisitTracker* tracker, int state, float base_
     return base_learning_rate * tracker->state_learning_rates[state];
 }
 
-// Decay exploration bonuses over time
+// Decay exploration bonuses over time. Every bonus shrinks by the same
+// factor, so only the global scale changes; the minimum is applied on read.
 void decay_exploration_bonuses(StateVisitTracker* tracker) {
     if (!tracker) return;
     
+    tracker->bonus_scale *= tracker->exploration_bonus_decay;
+    if (tracker->bonus_scale >= BONUS_SCALE_FLOOR) return;
+    
+    // Every ~46000 decays: fold the scale in before stored bonuses overflow
     for (int i = 0; i < tracker->num_states; i++) {
-        tracker->exploration_bonuses[i] *= tracker->exploration_bonus_decay;
-        tracker->exploration_bonuses[i] = fmaxf(
-            tracker->exploration_bonuses[i], 
-            tracker->min_exploration_bonus
-        );
+        tracker->exploration_bonuses[i] = current_bonus(tracker, i);
     }
+    tracker->bonus_scale = 1.0f;
 }
 
-// Select state with highest priority (least visited or highest exploration bonus)
+// Select state with highest priority (least visited or highest exploration bonus).
+// Within a bucket the newest arrival has the largest bonus, so only bucket
+// heads compete, and the walk up the counts stops once neither the falling
+// visit term nor the largest bonus a bucket can hold could beat the best so far.
 int select_priority_state(StateVisitTracker* tracker) {
     if (!tracker) return 0;
     
-    int best_state = 0;
-    float best_priority = tracker->visit_priorities[0];
+    const VisitBucket* buckets = tracker->buckets;
+    int first = tracker->first_bucket;
+    if (first == tracker->last_bucket) {
+        return buckets[first].head;  // Equal priority if all same
+    }
+    
+    int min_visits = buckets[first].count;
+    float range = (float)(buckets[tracker->last_bucket].count - min_visits);
+    int best_state = buckets[first].head;
+    float best_priority = 1.0f + current_bonus(tracker, best_state);
     
-    for (int i = 1; i < tracker->num_states; i++) {
-        if (tracker->visit_priorities[i] > best_priority) {
-            best_priority = tracker->visit_priorities[i];
-            best_state = i;
+    for (int b = buckets[first].next; b >= 0; b = buckets[b].next) {
+        float visit_norm = 1.0f - (buckets[b].count - min_visits) / range;
+        if (visit_norm + visit_bonus(tracker, buckets[b].count) < best_priority) break;
+
+        float priority = visit_norm + current_bonus(tracker, buckets[b].head);
+        if (priority > best_priority) {
+            best_priority = priority;
+            best_state = buckets[b].head;
         }
     }
     
     return best_state;
 }
 
-// Update state priorities based on visit counts and exploration bonuses
+// Refresh visit_priorities for reporting; selection does not depend on it
 void update_state_priorities(StateVisitTracker* tracker) {
     if (!tracker) return;
     
-    // Find min and max visit counts for normalization
-    int min_visits = tracker->visit_counts[0];
-    int max_visits = tracker->visit_counts[0];
-    
-    for (int i = 1; i < tracker->num_states; i++) {
-        if (tracker->visit_counts[i] < min_visits) min_visits = tracker->visit_counts[i];
-        if (tracker->visit_counts[i] > max_visits) max_visits = tracker->visit_counts[i];
-    }
-    
-    // Calculate priorities (higher for less visited states)
     for (int i = 0; i < tracker->num_states; i++) {
-        if (max_visits == min_visits) {
-            tracker->visit_priorities[i] = 1.0f;  // Equal priority if all same
-        } else {
-            // Inverse relationship: fewer visits = higher priority
-            float visit_norm = 1.0f - ((float)(tracker->visit_counts[i] - min_visits) / (max_visits - min_visits));
-            tracker->visit_priorities[i] = visit_norm + tracker->exploration_bonuses[i];
-        }
+        tracker->visit_priorities[i] = get_state_priority(tracker, i);
     }
 }
 
@@ -1131,14 +2085,16 @@ void reset_state_visit_tracker(StateVisitTracker* tracker) {
     // Reset all counters and arrays
     memset(tracker->visit_counts, 0, tracker->num_states * sizeof(int));
     tracker->total_visits = 0;
+    tracker->bonus_scale = 1.0f;
     
     // Reset to initial values
     for (int i = 0; i < tracker->num_states; i++) {
-        tracker->exploration_bonuses[i] = 1.0f;
-        tracker->state_epsilons[i] = 1.0f;
-        tracker->state_learning_rates[i] = 1.0f;
-        tracker->visit_priorities[i] = 1.0f;
+        tracker->exploration_bonuses[i] = 1.0f;    // Start with high exploration bonus
+        tracker->state_epsilons[i] = 1.0f;        // Start with high exploration
+        tracker->state_learning_rates[i] = 1.0f;  // Start with normal learning rate
+        tracker->visit_priorities[i] = 1.0f;      // Equal priority initially
     }
+    init_visit_buckets(tracker);
 }
 
 // Enhanced action selection with state visit priority
@@ -1161,11 +2117,13 @@ Action select_action_with_priority(QLearningAgent* agent, StateVisitTracker* tra
     }
 
     // Epsilon-greedy action selection with state-adaptive epsilon
-    float random_value = (float)rand() / RAND_MAX;
+    float random_value = random_next_float(&agent->rng);
     
     if (random_value < epsilon) {
         // Explore: choose random action (higher chance in less-visited states)
-        return (Action)(rand() % agent->num_actions);
+        Action action = (Action)random_next_bounded(&agent->rng, (uint32_t)agent->num_actions);
+        cut_traces_if_exploratory(agent, state, action);
+        return action;
     } else {
         // Exploit: choose greedy action
         return select_greedy_action(agent, state);
@@ -1193,23 +2151,18 @@ void update_q_value_with_priority(QLearningAgent* agent, StateVisitTracker* trac
         enhanced_reward += get_exploration_bonus(tracker, state);
     }
 
-    float current_q = agent->q_table[state][action];
+    float current_q = agent_q(agent, state, action);
     float max_next_q = 0.0f;
 
     // If not terminal state, find maximum Q-value for next state
     if (!done) {
-        max_next_q = agent->q_table[next_state][0];
-        for (int a = 1; a < agent->num_actions; a++) {
-            if (agent->q_table[next_state][a] > max_next_q) {
-                max_next_q = agent->q_table[next_state][a];
-            }
-        }
+        max_next_q = agent_max_q(agent, next_state);
     }
 
     // Q-learning update formula with adaptive learning rate and exploration bonus
     float td_target = enhanced_reward + agent->discount_factor * max_next_q;
     float td_error = td_target - current_q;
-    agent->q_table[state][action] = current_q + learning_rate * td_error;
+    agent_replace_q(agent, state, action, current_q, current_q + learning_rate * td_error);
 
     // Store last action for reference
     agent->last_action = action;
@@ -1242,7 +2195,7 @@ void print_state_visit_analysis(StateVisitTracker* tracker) {
             unvisited_states++;
         }
         if (tracker->visit_counts[i] > max_visits) max_visits = tracker->visit_counts[i];
-        total_exploration_bonus += tracker->exploration_bonuses[i];
+        total_exploration_bonus += current_bonus(tracker, i);
     }
     
     if (visited_states == 0) min_visits = 0;
@@ -1267,12 +2220,12 @@ void print_state_visit_analysis(StateVisitTracker* tracker) {
     printf("\nState Extremes:\n");
     printf("  Least visited state: %d (%d visits, bonus: %.3f)\n", 
            least_visited, tracker->visit_counts[least_visited], 
-           tracker->exploration_bonuses[least_visited]);
+           current_bonus(tracker, least_visited));
     printf("  Most visited state: %d (%d visits, bonus: %.3f)\n", 
            most_visited, tracker->visit_counts[most_visited], 
-           tracker->exploration_bonuses[most_visited]);
+           current_bonus(tracker, most_visited));
     printf("  Highest priority state: %d (priority: %.3f)\n", 
-           highest_priority, tracker->visit_priorities[highest_priority]);
+           highest_priority, get_state_priority(tracker, highest_priority));
     
     // Configuration information
     printf("\nConfiguration:\n");
@@ -1297,10 +2250,11 @@ void save_state_visit_data(StateVisitTracker* tracker, const char* filename) {
     fprintf(file, "# State Visit Tracking Data\n");
     fprintf(file, "# State,Visits,Priority,ExplorationBonus,StateEpsilon,StateLearningRate\n");
     
+    update_state_priorities(tracker);
     for (int i = 0; i < tracker->num_states; i++) {
         fprintf(file, "%d,%d,%.4f,%.4f,%.4f,%.4f\n",
                 i, tracker->visit_counts[i], tracker->visit_priorities[i],
-                tracker->exploration_bonuses[i], tracker->state_epsilons[i],
+                current_bonus(tracker, i), tracker->state_epsilons[i],
                 tracker->state_learning_rates[i]);
     }
     
@@ -1312,12 +2266,9 @@ void save_state_visit_data(StateVisitTracker* tracker, const char* filename) {
 float calculate_exploration_coverage(StateVisitTracker* tracker) {
     if (!tracker) return 0.0f;
     
-    int visited_states = 0;
-    for (int i = 0; i < tracker->num_states; i++) {
-        if (tracker->visit_counts[i] > 0) {
-            visited_states++;
-        }
-    }
+    // Only the lowest bucket can hold unvisited states
+    const VisitBucket* lowest = &tracker->buckets[tracker->first_bucket];
+    int visited_states = tracker->num_states - (lowest->count == 0 ? lowest->size : 0);
     
     return (float)visited_states / tracker->num_states * 100.0f;
 }
@@ -1326,32 +2277,12 @@ float calculate_exploration_coverage(StateVisitTracker* tracker) {
 int get_least_visited_state(StateVisitTracker* tracker) {
     if (!tracker) return 0;
     
-    int least_visited = 0;
-    int min_visits = tracker->visit_counts[0];
-    
-    for (int i = 1; i < tracker->num_states; i++) {
-        if (tracker->visit_counts[i] < min_visits) {
-            min_visits = tracker->visit_counts[i];
-            least_visited = i;
-        }
-    }
-    
-    return least_visited;
+    return tracker->buckets[tracker->first_bucket].head;
 }
 
 // Get most visited state
 int get_most_visited_state(StateVisitTracker* tracker) {
     if (!tracker) return 0;
     
-    int most_visited = 0;
-    int max_visits = tracker->visit_counts[0];
-    
-    for (int i = 1; i < tracker->num_states; i++) {
-        if (tracker->visit_counts[i] > max_visits) {
-            max_visits = tracker->visit_counts[i];
-            most_visited = i;
-        }
-    }
-    
-    return most_visited;
+    return tracker->buckets[tracker->last_bucket].head;
 }
@@ -0,0 +1,285 @@
+#define _POSIX_C_SOURCE 200809L  // clock_gettime, fsync, link, strdup
+
+#include "checkpoint.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+
+#define CHECKPOINT_NAME_MAX 1024
+
+static double monotonic_seconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+// filename for index 0, filename.index for the older checkpoints
+static void checkpoint_name(const Checkpointer* checkpointer, int index, char* out) {
+    if (index == 0) {
+        snprintf(out, CHECKPOINT_NAME_MAX, "%s", checkpointer->filename);
+    } else {
+        snprintf(out, CHECKPOINT_NAME_MAX, "%s.%d", checkpointer->filename, index);
+    }
+}
+
+// Make the renames durable: fsync the directory holding filename
+static void sync_parent_directory(const char* filename) {
+    char directory[CHECKPOINT_NAME_MAX];
+    const char* slash = strrchr(filename, '/');
+    if (!slash) {
+        snprintf(directory, sizeof(directory), ".");
+    } else if (slash == filename) {
+        snprintf(directory, sizeof(directory), "/");
+    } else {
+        snprintf(directory, sizeof(directory), "%.*s", (int)(slash - filename), filename);
+    }
+
+    int fd = open(directory, O_RDONLY);
+    if (fd >= 0) {
+        fsync(fd);
+        close(fd);
+    }
+}
+
+// Copy source to destination through destination.tmp, so neither file is
+// ever seen half written. Used where hard links are not supported.
+static bool copy_checkpoint(const char* source, const char* destination) {
+    char temp[CHECKPOINT_NAME_MAX + 8];
+    snprintf(temp, sizeof(temp), "%s.tmp", destination);
+
+    int in = open(source, O_RDONLY);
+    if (in < 0) return errno == ENOENT;  // No current checkpoint yet
+    int out = open(temp, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (out < 0) {
+        close(in);
+        return false;
+    }
+
+    char buffer[65536];
+    bool ok = true;
+    ssize_t got;
+    while (ok && (got = read(in, buffer, sizeof(buffer))) != 0) {
+        if (got < 0) {
+            ok = errno == EINTR;
+            continue;
+        }
+        for (ssize_t done = 0; ok && done < got;) {
+            ssize_t put = write(out, buffer + done, (size_t)(got - done));
+            if (put < 0) {
+                ok = errno == EINTR;
+            } else {
+                done += put;
+            }
+        }
+    }
+    ok = ok && fsync(out) == 0;
+    close(in);
+    ok = close(out) == 0 && ok;
+    ok = ok && rename(temp, destination) == 0;
+    if (!ok) unlink(temp);
+    return ok;
+}
+
+// Shift filename.1 .. filename.(keep-2) up by one, keep the current checkpoint
+// as filename.1 through a hard link (or a copy), then rename the new one over
+// filename. filename is replaced in a single rename, so it never goes missing.
+static bool rotate_checkpoints(Checkpointer* checkpointer) {
+    char older[CHECKPOINT_NAME_MAX];
+    char newer[CHECKPOINT_NAME_MAX];
+
+    for (int i = checkpointer->keep - 1; i >= 2; i--) {
+        checkpoint_name(checkpointer, i - 1, newer);
+        checkpoint_name(checkpointer, i, older);
+        if (rename(newer, older) != 0 && errno != ENOENT) return false;
+    }
+    if (checkpointer->keep >= 2) {
+        checkpoint_name(checkpointer, 1, older);
+        unlink(older);
+        if (link(checkpointer->filename, older) != 0 && errno != ENOENT) {
+            // No hard links on this filesystem: copy, since moving it aside would leave no filename
+            if (!copy_checkpoint(checkpointer->filename, older)) return false;
+        }
+    }
+    if (rename(checkpointer->temp_filename, checkpointer->filename) != 0) return false;
+
+    sync_parent_directory(checkpointer->filename);
+    return true;
+}
+
+static void* checkpoint_writer_main(void* arg) {
+    Checkpointer* checkpointer = (Checkpointer*)arg;
+
+    pthread_mutex_lock(&checkpointer->mutex);
+    for (;;) {
+        while (!checkpointer->pending && !checkpointer->closing) {
+            pthread_cond_wait(&checkpointer->has_work, &checkpointer->mutex);
+        }
+        if (!checkpointer->pending) break;  // Closing with nothing queued
+        pthread_mutex_unlock(&checkpointer->mutex);
+
+        // The training thread leaves the snapshot alone while pending is set
+        bool ok = write_q_table_file(checkpointer->snapshot, checkpointer->temp_filename,
+                                     checkpointer->compress, true) &&
+                  rotate_checkpoints(checkpointer);
+        if (!ok) {
+            unlink(checkpointer->temp_filename);
+        }
+
+        pthread_mutex_lock(&checkpointer->mutex);
+        if (ok) {
+            checkpointer->written++;
+        } else {
+            if (!checkpointer->write_failed) {
+                fprintf(stderr, "Error: Failed to write checkpoint %s: %s\n",
+                        checkpointer->filename, strerror(errno));
+            }
+            checkpointer->write_failed = true;
+        }
+        checkpointer->pending = false;
+        pthread_cond_broadcast(&checkpointer->idle);
+    }
+    pthread_mutex_unlock(&checkpointer->mutex);
+    return NULL;
+}
+
+Checkpointer* create_checkpointer(const char* filename, int keep, bool compress,
+                                  int interval_episodes, double interval_seconds) {
+    if (!filename || keep < 1 || interval_episodes < 0 || interval_seconds < 0.0) {
+        fprintf(stderr, "Error: Invalid parameters for checkpointer\n");
+        return NULL;
+    }
+    if (strlen(filename) + 16 > CHECKPOINT_NAME_MAX) {
+        fprintf(stderr, "Error: Checkpoint filename is too long\n");
+        return NULL;
+    }
+
+    Checkpointer* checkpointer = (Checkpointer*)calloc(1, sizeof(Checkpointer));
+    if (!checkpointer) {
+        fprintf(stderr, "Error: Failed to allocate memory for checkpointer\n");
+        return NULL;
+    }
+    checkpointer->filename = strdup(filename);
+    checkpointer->temp_filename = (char*)malloc(strlen(filename) + 5);
+    if (!checkpointer->filename || !checkpointer->temp_filename) {
+        fprintf(stderr, "Error: Failed to allocate checkpoint filenames\n");
+        free(checkpointer->filename);
+        free(checkpointer->temp_filename);
+        free(checkpointer);
+        return NULL;
+    }
+    sprintf(checkpointer->temp_filename, "%s.tmp", filename);
+
+    checkpointer->keep = keep;
+    checkpointer->compress = compress;
+    checkpointer->interval_episodes = interval_episodes;
+    checkpointer->interval_seconds = interval_seconds;
+    checkpointer->last_episode = 0;
+    checkpointer->last_time = monotonic_seconds();
+    pthread_mutex_init(&checkpointer->mutex, NULL);
+    pthread_cond_init(&checkpointer->has_work, NULL);
+    pthread_cond_init(&checkpointer->idle, NULL);
+    if (pthread_create(&checkpointer->writer, NULL, checkpoint_writer_main, checkpointer) != 0) {
+        fprintf(stderr, "Error: Failed to start checkpoint writer thread\n");
+        pthread_cond_destroy(&checkpointer->idle);
+        pthread_cond_destroy(&checkpointer->has_work);
+        pthread_mutex_destroy(&checkpointer->mutex);
+        free(checkpointer->filename);
+        free(checkpointer->temp_filename);
+        free(checkpointer);
+        return NULL;
+    }
+    return checkpointer;
+}
+
+bool request_checkpoint(Checkpointer* checkpointer, QLearningAgent* agent, int episode) {
+    if (!checkpointer || !agent) return false;
+
+    pthread_mutex_lock(&checkpointer->mutex);
+    bool busy = checkpointer->pending || checkpointer->closing;
+    if (busy) {
+        checkpointer->skipped++;
+    }
+    pthread_mutex_unlock(&checkpointer->mutex);
+    if (busy) return false;
+
+    // The writer is idle, so the snapshot can be refilled without the lock
+    QLearningAgent* snapshot = checkpointer->snapshot;
+    if (!snapshot || snapshot->num_states != agent->num_states || snapshot->num_actions != agent->num_actions) {
+        destroy_agent(snapshot);
+        snapshot = create_agent_with_storage(agent->num_states, agent->num_actions, agent->learning_rate,
+                                             agent->discount_factor, agent->epsilon, QTABLE_STORAGE_OPTIMIZED);
+        checkpointer->snapshot = snapshot;
+        if (!snapshot) return false;
+    }
+    if (!copy_q_table(snapshot, agent)) return false;
+    snapshot->learning_rate = agent->learning_rate;
+    snapshot->discount_factor = agent->discount_factor;
+    snapshot->epsilon = agent->epsilon;
+    snapshot->epsilon_decay = agent->epsilon_decay;
+    snapshot->epsilon_min = agent->epsilon_min;
+    checkpointer->last_episode = episode;
+    checkpointer->last_time = monotonic_seconds();
+
+    pthread_mutex_lock(&checkpointer->mutex);
+    checkpointer->pending = true;
+    pthread_cond_signal(&checkpointer->has_work);
+    pthread_mutex_unlock(&checkpointer->mutex);
+    return true;
+}
+
+bool checkpoint_if_due(Checkpointer* checkpointer, QLearningAgent* agent, int episode) {
+    if (!checkpointer) return false;
+
+    if (episode < checkpointer->last_episode) {
+        checkpointer->last_episode = 0;     // Training was restarted
+    }
+    bool due = checkpointer->interval_episodes > 0 &&
+               episode - checkpointer->last_episode >= checkpointer->interval_episodes;
+    if (!due && checkpointer->interval_seconds > 0.0) {
+        due = monotonic_seconds() - checkpointer->last_time >= checkpointer->interval_seconds;
+    }
+    return due && request_checkpoint(checkpointer, agent, episode);
+}
+
+bool wait_for_checkpoint(Checkpointer* checkpointer) {
+    if (!checkpointer) return false;
+
+    pthread_mutex_lock(&checkpointer->mutex);
+    while (checkpointer->pending) {
+        pthread_cond_wait(&checkpointer->idle, &checkpointer->mutex);
+    }
+    bool ok = !checkpointer->write_failed;
+    pthread_mutex_unlock(&checkpointer->mutex);
+    return ok;
+}
+
+void close_checkpointer(Checkpointer* checkpointer) {
+    if (!checkpointer) return;
+
+    pthread_mutex_lock(&checkpointer->mutex);
+    checkpointer->closing = true;
+    pthread_cond_signal(&checkpointer->has_work);
+    pthread_mutex_unlock(&checkpointer->mutex);
+    pthread_join(checkpointer->writer, NULL);
+
+    pthread_cond_destroy(&checkpointer->idle);
+    pthread_cond_destroy(&checkpointer->has_work);
+    pthread_mutex_destroy(&checkpointer->mutex);
+    destroy_agent(checkpointer->snapshot);
+    free(checkpointer->filename);
+    free(checkpointer->temp_filename);
+    free(checkpointer);
+}
+
+long long checkpoints_written(Checkpointer* checkpointer) {
+    if (!checkpointer) return 0;
+
+    pthread_mutex_lock(&checkpointer->mutex);
+    long long written = checkpointer->written;
+    pthread_mutex_unlock(&checkpointer->mutex);
+    return written;
+}
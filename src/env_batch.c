@@ -0,0 +1,311 @@
+#define _POSIX_C_SOURCE 200112L  // posix_memalign
+
+#include "env_batch.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define BATCH_SIMD_WIDTH 4
+#define BATCH_ALIGNMENT 16
+
+static void* batch_aligned_alloc(size_t size) {
+    void* ptr = NULL;
+    if (posix_memalign(&ptr, BATCH_ALIGNMENT, size) != 0) {
+        return NULL;
+    }
+    memset(ptr, 0, size);
+    return ptr;
+}
+
+// Check walkability of an in-bounds cell in the shared bitmap
+static inline bool bitmap_walkable(const GridWorldBatch* batch, int x, int y) {
+    const uint64_t word = batch->walkable_bits[y * batch->words_per_row + (x >> 6)];
+    return (word >> (x & 63)) & 1u;
+}
+
+// Create a batch of num_envs environments sharing the layout of world
+GridWorldBatch* create_grid_world_batch(GridWorld* world, int num_envs) {
+    if (!world || num_envs <= 0) {
+        fprintf(stderr, "Error: Invalid parameters for create_grid_world_batch\n");
+        return NULL;
+    }
+
+    GridWorldBatch* batch = (GridWorldBatch*)calloc(1, sizeof(GridWorldBatch));
+    if (!batch) {
+        fprintf(stderr, "Error: Failed to allocate GridWorldBatch structure\n");
+        return NULL;
+    }
+
+    batch->num_envs = num_envs;
+    batch->capacity = (num_envs + BATCH_SIMD_WIDTH - 1) / BATCH_SIMD_WIDTH * BATCH_SIMD_WIDTH;
+    batch->width = world->width;
+    batch->height = world->height;
+    batch->start_pos = world->start_pos;
+    batch->goal_pos = world->goal_pos;
+    batch->max_steps = world->max_steps;
+    batch->step_penalty = world->step_penalty;
+    batch->goal_reward = world->goal_reward;
+    batch->wall_penalty = world->wall_penalty;
+
+    size_t lane_bytes = (size_t)batch->capacity * sizeof(int32_t);
+    batch->agent_x = (int32_t*)batch_aligned_alloc(lane_bytes);
+    batch->agent_y = (int32_t*)batch_aligned_alloc(lane_bytes);
+    batch->episode_steps = (int32_t*)batch_aligned_alloc(lane_bytes);
+    batch->done = (int32_t*)batch_aligned_alloc(lane_bytes);
+    batch->total_rewards = (float*)batch_aligned_alloc((size_t)batch->capacity * sizeof(float));
+
+    batch->words_per_row = (world->width + 63) / 64;
+    batch->walkable_bits = (uint64_t*)calloc((size_t)batch->words_per_row * world->height, sizeof(uint64_t));
+
+    if (!batch->agent_x || !batch->agent_y || !batch->episode_steps || !batch->done ||
+        !batch->total_rewards || !batch->walkable_bits) {
+        fprintf(stderr, "Error: Failed to allocate GridWorldBatch arrays\n");
+        destroy_grid_world_batch(batch);
+        return NULL;
+    }
+
+    // Pack walkability of the template layout into the shared bitmap
+    for (int y = 0; y < world->height; y++) {
+        for (int x = 0; x < world->width; x++) {
+            if (is_walkable(world, x, y)) {
+                batch->walkable_bits[y * batch->words_per_row + (x >> 6)] |= (uint64_t)1 << (x & 63);
+            }
+        }
+    }
+
+    reset_grid_world_batch(batch);
+    return batch;
+}
+
+// Destroy a batch and free its arrays
+void destroy_grid_world_batch(GridWorldBatch* batch) {
+    if (!batch) return;
+
+    free(batch->agent_x);
+    free(batch->agent_y);
+    free(batch->episode_steps);
+    free(batch->done);
+    free(batch->total_rewards);
+    free(batch->walkable_bits);
+    free(batch);
+}
+
+// Reset a single environment to the start position
+void reset_batch_env(GridWorldBatch* batch, int env) {
+    if (!batch || env < 0 || env >= batch->num_envs) return;
+
+    batch->agent_x[env] = batch->start_pos.x;
+    batch->agent_y[env] = batch->start_pos.y;
+    batch->episode_steps[env] = 0;
+    batch->done[env] = 0;
+    batch->total_rewards[env] = 0.0f;
+}
+
+// Reset every environment (padding lanes included so SIMD loads stay defined)
+void reset_grid_world_batch(GridWorldBatch* batch) {
+    if (!batch) return;
+
+    for (int i = 0; i < batch->capacity; i++) {
+        batch->agent_x[i] = batch->start_pos.x;
+        batch->agent_y[i] = batch->start_pos.y;
+        batch->episode_steps[i] = 0;
+        batch->done[i] = 0;
+        batch->total_rewards[i] = 0.0f;
+    }
+}
+
+// Reset only the environments whose episode has finished; returns how many
+int reset_done_envs(GridWorldBatch* batch) {
+    if (!batch) return 0;
+
+    int reset_count = 0;
+    for (int i = 0; i < batch->num_envs; i++) {
+        if (batch->done[i]) {
+            reset_batch_env(batch, i);
+            reset_count++;
+        }
+    }
+    return reset_count;
+}
+
+// Scalar step for one environment (tail lanes and non-SSE2 builds)
+static void step_batch_env_scalar(GridWorldBatch* batch, int i, int action,
+                                  float* rewards, int* next_states, bool* dones) {
+    int x = batch->agent_x[i];
+    int y = batch->agent_y[i];
+    float reward = 0.0f;
+
+    if (!batch->done[i] && action >= 0 && action < NUM_ACTIONS) {
+        int nx = x + (action == ACTION_RIGHT) - (action == ACTION_LEFT);
+        int ny = y + (action == ACTION_DOWN) - (action == ACTION_UP);
+        bool valid_move = nx >= 0 && nx < batch->width && ny >= 0 && ny < batch->height &&
+                          bitmap_walkable(batch, nx, ny);
+
+        if (valid_move) {
+            x = nx;
+            y = ny;
+            batch->agent_x[i] = x;
+            batch->agent_y[i] = y;
+        }
+
+        bool at_goal = (x == batch->goal_pos.x && y == batch->goal_pos.y);
+        reward = !valid_move ? batch->wall_penalty : (at_goal ? batch->goal_reward : batch->step_penalty);
+
+        batch->total_rewards[i] += reward;
+        batch->episode_steps[i]++;
+        batch->done[i] = at_goal || batch->episode_steps[i] >= batch->max_steps;
+    }
+
+    if (rewards) rewards[i] = reward;
+    if (next_states) next_states[i] = y * batch->width + x;
+    if (dones) dones[i] = batch->done[i] != 0;
+}
+
+#ifdef __SSE2__
+// 32-bit lane-wise multiply (SSE4.1 _mm_mullo_epi32 is not available in SSE2)
+static inline __m128i mullo_epi32_sse2(__m128i a, __m128i b) {
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+// Blend: mask ? a : b
+static inline __m128i select_epi32(__m128i mask, __m128i a, __m128i b) {
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+static inline __m128 select_ps(__m128 mask, __m128 a, __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+#endif
+
+// Step all environments in one call
+void step_grid_world_batch(GridWorldBatch* batch, const int* actions,
+                           float* rewards, int* next_states, bool* dones) {
+    if (!batch || !actions) return;
+
+    int i = 0;
+
+#ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi32(1);
+    const __m128i minus_one = _mm_set1_epi32(-1);
+    const __m128i width = _mm_set1_epi32(batch->width);
+    const __m128i height = _mm_set1_epi32(batch->height);
+    const __m128i goal_x = _mm_set1_epi32(batch->goal_pos.x);
+    const __m128i goal_y = _mm_set1_epi32(batch->goal_pos.y);
+    const __m128i max_steps = _mm_set1_epi32(batch->max_steps);
+    const __m128i num_actions = _mm_set1_epi32(NUM_ACTIONS);
+    const __m128 step_penalty = _mm_set1_ps(batch->step_penalty);
+    const __m128 goal_reward = _mm_set1_ps(batch->goal_reward);
+    const __m128 wall_penalty = _mm_set1_ps(batch->wall_penalty);
+
+    int simd_end = batch->num_envs / BATCH_SIMD_WIDTH * BATCH_SIMD_WIDTH;
+    for (; i < simd_end; i += BATCH_SIMD_WIDTH) {
+        __m128i x = _mm_load_si128((const __m128i*)&batch->agent_x[i]);
+        __m128i y = _mm_load_si128((const __m128i*)&batch->agent_y[i]);
+        __m128i steps = _mm_load_si128((const __m128i*)&batch->episode_steps[i]);
+        __m128i done = _mm_load_si128((const __m128i*)&batch->done[i]);
+        __m128i action = _mm_loadu_si128((const __m128i*)&actions[i]);
+
+        // Lanes that actually take a step: not done and a known action
+        __m128i action_ok = _mm_and_si128(_mm_cmpgt_epi32(action, minus_one),
+                                          _mm_cmplt_epi32(action, num_actions));
+        __m128i active = _mm_andnot_si128(_mm_cmpgt_epi32(done, zero), action_ok);
+
+        // Movement deltas from compare masks (true lanes are -1)
+        __m128i dx = _mm_sub_epi32(_mm_cmpeq_epi32(action, _mm_set1_epi32(ACTION_LEFT)),
+                                   _mm_cmpeq_epi32(action, _mm_set1_epi32(ACTION_RIGHT)));
+        __m128i dy = _mm_sub_epi32(_mm_cmpeq_epi32(action, _mm_set1_epi32(ACTION_UP)),
+                                   _mm_cmpeq_epi32(action, _mm_set1_epi32(ACTION_DOWN)));
+        __m128i nx = _mm_add_epi32(x, dx);
+        __m128i ny = _mm_add_epi32(y, dy);
+
+        __m128i in_bounds = _mm_and_si128(
+            _mm_and_si128(_mm_cmpgt_epi32(nx, minus_one), _mm_cmplt_epi32(nx, width)),
+            _mm_and_si128(_mm_cmpgt_epi32(ny, minus_one), _mm_cmplt_epi32(ny, height)));
+
+        // Bitmap lookups are a gather; SSE2 has none, so do the four loads scalar
+        int32_t cx[BATCH_SIMD_WIDTH], cy[BATCH_SIMD_WIDTH], inb[BATCH_SIMD_WIDTH];
+        int32_t walk[BATCH_SIMD_WIDTH];
+        _mm_storeu_si128((__m128i*)cx, nx);
+        _mm_storeu_si128((__m128i*)cy, ny);
+        _mm_storeu_si128((__m128i*)inb, in_bounds);
+        for (int lane = 0; lane < BATCH_SIMD_WIDTH; lane++) {
+            walk[lane] = (inb[lane] && bitmap_walkable(batch, cx[lane], cy[lane])) ? -1 : 0;
+        }
+        __m128i valid = _mm_and_si128(_mm_loadu_si128((const __m128i*)walk), active);
+
+        x = select_epi32(valid, nx, x);
+        y = select_epi32(valid, ny, y);
+
+        __m128i at_goal = _mm_and_si128(_mm_cmpeq_epi32(x, goal_x), _mm_cmpeq_epi32(y, goal_y));
+
+        // Reward: wall penalty for blocked moves, goal reward or step penalty otherwise
+        __m128 reward = select_ps(_mm_castsi128_ps(valid),
+                                  select_ps(_mm_castsi128_ps(at_goal), goal_reward, step_penalty),
+                                  wall_penalty);
+        reward = _mm_and_ps(reward, _mm_castsi128_ps(active));
+
+        steps = _mm_sub_epi32(steps, active);  // active lanes are -1
+        __m128i finished = _mm_or_si128(at_goal, _mm_cmpgt_epi32(steps, _mm_sub_epi32(max_steps, one)));
+        done = _mm_or_si128(done, _mm_and_si128(_mm_and_si128(active, finished), one));
+
+        _mm_store_si128((__m128i*)&batch->agent_x[i], x);
+        _mm_store_si128((__m128i*)&batch->agent_y[i], y);
+        _mm_store_si128((__m128i*)&batch->episode_steps[i], steps);
+        _mm_store_si128((__m128i*)&batch->done[i], done);
+        _mm_store_ps(&batch->total_rewards[i],
+                     _mm_add_ps(_mm_load_ps(&batch->total_rewards[i]), reward));
+
+        if (rewards) {
+            _mm_storeu_ps(&rewards[i], reward);
+        }
+        if (next_states) {
+            _mm_storeu_si128((__m128i*)&next_states[i], _mm_add_epi32(mullo_epi32_sse2(y, width), x));
+        }
+        if (dones) {
+            for (int lane = 0; lane < BATCH_SIMD_WIDTH; lane++) {
+                dones[i + lane] = batch->done[i + lane] != 0;
+            }
+        }
+    }
+#endif
+
+    for (; i < batch->num_envs; i++) {
+        step_batch_env_scalar(batch, i, actions[i], rewards, next_states, dones);
+    }
+}
+
+// Write the 1D state index of every environment
+void get_batch_states(GridWorldBatch* batch, int* states) {
+    if (!batch || !states) return;
+
+    for (int i = 0; i < batch->num_envs; i++) {
+        states[i] = batch->agent_y[i] * batch->width + batch->agent_x[i];
+    }
+}
+
+// Check walkability against the shared bitmap (out of bounds is not walkable)
+bool batch_is_walkable(GridWorldBatch* batch, int x, int y) {
+    if (!batch || x < 0 || x >= batch->width || y < 0 || y >= batch->height) {
+        return false;
+    }
+    return bitmap_walkable(batch, x, y);
+}
+
+// Count environments whose episode has finished
+int count_done_envs(GridWorldBatch* batch) {
+    if (!batch) return 0;
+
+    int count = 0;
+    for (int i = 0; i < batch->num_envs; i++) {
+        count += batch->done[i] != 0;
+    }
+    return count;
+}
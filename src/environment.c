@@ -1,7 +1,20 @@
 #include "../include/environment.h"
+#include "../include/memory_arena.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <math.h>
+
+// Controls the creation and per-episode reset/destroy messages
+static bool g_environment_verbose = true;
+
+void set_environment_verbose(bool verbose) {
+    g_environment_verbose = verbose;
+}
+
+bool is_environment_verbose(void) {
+    return g_environment_verbose;
+}
 
 // Create a new grid world environment
 GridWorld* create_grid_world(int width, int height) {
@@ -12,7 +25,7 @@ GridWorld* create_grid_world(int width, int height) {
     }
     
     // Allocate memory for the GridWorld structure
-    GridWorld* world = (GridWorld*)malloc(sizeof(GridWorld));
+    GridWorld* world = (GridWorld*)memory_alloc(MEMORY_ENVIRONMENT, sizeof(GridWorld));
     if (!world) {
         fprintf(stderr, "Error: Failed to allocate memory for GridWorld structure\n");
         return NULL;
@@ -22,34 +35,13 @@ GridWorld* create_grid_world(int width, int height) {
     world->width = width;
     world->height = height;
     
-    // Allocate memory for the 2D grid
-    world->grid = (CellType**)malloc(height * sizeof(CellType*));
-    if (!world->grid) {
-        fprintf(stderr, "Error: Failed to allocate memory for grid rows\n");
-        free(world);
+    // Allocate the bit-packed layout (all cells empty)
+    world->layout = create_grid_layout(width, height);
+    if (!world->layout) {
+        memory_free(world);
         return NULL;
     }
     
-    // Allocate memory for each row and initialize to empty
-    for (int y = 0; y < height; y++) {
-        world->grid[y] = (CellType*)malloc(width * sizeof(CellType));
-        if (!world->grid[y]) {
-            fprintf(stderr, "Error: Failed to allocate memory for grid row %d\n", y);
-            // Clean up previously allocated rows
-            for (int cleanup_y = 0; cleanup_y < y; cleanup_y++) {
-                free(world->grid[cleanup_y]);
-            }
-            free(world->grid);
-            free(world);
-            return NULL;
-        }
-        
-        // Initialize all cells to empty
-        for (int x = 0; x < width; x++) {
-            world->grid[y][x] = CELL_EMPTY;
-        }
-    }
-    
     // Initialize positions (default: agent at top-left, goal at bottom-right)
     world->agent_pos.x = 0;
     world->agent_pos.y = 0;
@@ -59,8 +51,8 @@ GridWorld* create_grid_world(int width, int height) {
     world->goal_pos.y = height - 1;
     
     // Mark the start and goal positions in the grid
-    world->grid[world->start_pos.y][world->start_pos.x] = CELL_START;
-    world->grid[world->goal_pos.y][world->goal_pos.x] = CELL_GOAL;
+    grid_layout_set(world->layout, world->start_pos.x, world->start_pos.y, CELL_START);
+    grid_layout_set(world->layout, world->goal_pos.x, world->goal_pos.y, CELL_GOAL);
     
     // Initialize episode tracking variables
     world->episode_steps = 0;
@@ -72,10 +64,16 @@ GridWorld* create_grid_world(int width, int height) {
     world->step_penalty = -1.0f;            // Small penalty for each step
     world->goal_reward = 100.0f;            // Large reward for reaching goal
     world->wall_penalty = -10.0f;           // Penalty for hitting walls
-    
-    printf("Created grid world: %dx%d, agent at (%d,%d), goal at (%d,%d)\n", 
-           width, height, world->agent_pos.x, world->agent_pos.y, 
-           world->goal_pos.x, world->goal_pos.y);
+    world->stochastic = false;
+    world->action_noise = 0.0f;
+    seed_random(&world->rng, (unsigned int)rand());
+    world->transitions = NULL;
+    
+    if (g_environment_verbose) {
+        printf("Created grid world: %dx%d, agent at (%d,%d), goal at (%d,%d)\n", 
+               width, height, world->agent_pos.x, world->agent_pos.y, 
+               world->goal_pos.x, world->goal_pos.y);
+    }
     
     return world;
 }
@@ -105,6 +103,8 @@ GridWorld* create_grid_world_from_config(EnvironmentConfig config) {
     world->goal_reward = config.goal_reward;
     world->wall_penalty = config.wall_penalty;
     world->max_steps = config.max_steps;
+    world->stochastic = config.stochastic;
+    world->action_noise = config.action_noise < 0.0f ? 0.0f : (config.action_noise > 1.0f ? 1.0f : config.action_noise);
     
     // Validate reward values
     if (!validate_reward_values(world)) {
@@ -117,6 +117,91 @@ GridWorld* create_grid_world_from_config(EnvironmentConfig config) {
     return world;
 }
 
+// Create an independent copy of a grid world (layout, rewards and episode state)
+GridWorld* clone_grid_world(GridWorld* world) {
+    if (!world) {
+        fprintf(stderr, "Error: Cannot clone NULL GridWorld\n");
+        return NULL;
+    }
+    
+    GridWorld* copy = (GridWorld*)memory_alloc(MEMORY_ENVIRONMENT, sizeof(GridWorld));
+    if (!copy) {
+        fprintf(stderr, "Error: Failed to allocate memory for GridWorld clone\n");
+        return NULL;
+    }
+    *copy = *world;
+    
+    // Share the layout read-only; set_cell() gives the clone its own copy on first write
+    copy->layout = retain_grid_layout(world->layout);
+    
+    // Each world owns its transition table; build a fresh one for the clone
+    copy->transitions = NULL;
+    if (world->transitions) {
+        set_transition_table(copy, true);
+    }
+    
+    return copy;
+}
+
+// Reseed the environment's generator (clones share the parent's stream until reseeded)
+void seed_environment(GridWorld* world, unsigned int seed) {
+    if (!world) return;
+    seed_random(&world->rng, seed);
+}
+
+// Pick a uniformly random walkable cell other than exclude; false if none exists
+static bool pick_random_free_cell(GridWorld* world, Position exclude, Position* out) {
+    int candidates = grid_layout_walkable_count(world->layout);
+    if (is_walkable(world, exclude.x, exclude.y)) {
+        candidates--;
+    }
+    if (candidates <= 0) return false;
+
+    int target = random_int(&world->rng, 0, candidates - 1);
+    for (int y = 0; y < world->height; y++) {
+        for (int x = 0; x < world->width; x++) {
+            if (is_walkable(world, x, y) && !(x == exclude.x && y == exclude.y) && target-- == 0) {
+                out->x = x;
+                out->y = y;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Move the goal to a random walkable cell
+void set_random_goal(GridWorld* world) {
+    if (!world) return;
+
+    Position goal;
+    if (!pick_random_free_cell(world, world->start_pos, &goal)) {
+        fprintf(stderr, "Warning: No free cell available for a random goal\n");
+        return;
+    }
+    if (get_cell(world, world->goal_pos.x, world->goal_pos.y) == CELL_GOAL) {
+        set_cell(world, world->goal_pos.x, world->goal_pos.y, CELL_EMPTY);
+    }
+    world->goal_pos = goal;
+    set_cell(world, goal.x, goal.y, CELL_GOAL);
+}
+
+// Move the start to a random walkable cell
+void set_random_start(GridWorld* world) {
+    if (!world) return;
+
+    Position start;
+    if (!pick_random_free_cell(world, world->goal_pos, &start)) {
+        fprintf(stderr, "Warning: No free cell available for a random start\n");
+        return;
+    }
+    if (get_cell(world, world->start_pos.x, world->start_pos.y) == CELL_START) {
+        set_cell(world, world->start_pos.x, world->start_pos.y, CELL_EMPTY);
+    }
+    world->start_pos = start;
+    set_cell(world, start.x, start.y, CELL_START);
+}
+
 // Reset the environment to its initial state
 void reset_environment(GridWorld* world) {
     if (!world) {
@@ -133,8 +218,10 @@ void reset_environment(GridWorld* world) {
     world->episode_done = false;
     world->total_reward = 0.0f;
     
-    printf("Environment reset: agent at (%d,%d), episode ready\n", 
-           world->agent_pos.x, world->agent_pos.y);
+    if (g_environment_verbose) {
+        printf("Environment reset: agent at (%d,%d), episode ready\n", 
+               world->agent_pos.x, world->agent_pos.y);
+    }
 }
 
 // Convert 2D position to 1D state index
@@ -158,6 +245,141 @@ bool is_terminal_state(GridWorld* world, Position pos) {
     return positions_equal(pos, world->goal_pos);
 }
 
+static void free_transition_table(TransitionTable* table) {
+    if (!table) return;
+    memory_free(table->next_state);
+    memory_free(table->outcome);
+    memory_free(table);
+}
+
+// Classify every transition against the world's current goal
+static void classify_transitions(GridWorld* world, TransitionTable* table) {
+    int goal_state = world->goal_pos.y * world->width + world->goal_pos.x;
+    size_t count = (size_t)table->num_states * NUM_ACTIONS;
+
+    for (size_t i = 0; i < count; i++) {
+        int next = table->next_state[i];
+        // Mirrors calculate_reward(): blocked beats goal beats step
+        table->outcome[i] = next == (int)(i / NUM_ACTIONS) ? TRANSITION_BLOCKED
+                          : (next == goal_state ? TRANSITION_GOAL : TRANSITION_STEP);
+    }
+    table->goal_state = goal_state;
+}
+
+// Recompute next_state from the layout, then the outcomes
+static void build_transition_table(GridWorld* world, TransitionTable* table) {
+    for (int y = 0; y < world->height; y++) {
+        for (int x = 0; x < world->width; x++) {
+            int state = y * world->width + x;
+            int32_t* next = table->next_state + (size_t)state * NUM_ACTIONS;
+            Position here = {x, y};
+            for (int a = 0; a < NUM_ACTIONS; a++) {
+                Position moved = get_new_position(here, (Action)a);
+                next[a] = is_walkable(world, moved.x, moved.y) ? moved.y * world->width + moved.x : state;
+            }
+        }
+    }
+    classify_transitions(world, table);
+    table->dirty = false;
+}
+
+// Compile (or drop) the world's transition table. Returns false if it could not be allocated.
+bool set_transition_table(GridWorld* world, bool enabled) {
+    if (!world) return false;
+
+    if (!enabled) {
+        free_transition_table(world->transitions);
+        world->transitions = NULL;
+        return true;
+    }
+    if (world->transitions) {
+        build_transition_table(world, world->transitions);
+        return true;
+    }
+
+    size_t count = (size_t)world->width * world->height * NUM_ACTIONS;
+    TransitionTable* table = (TransitionTable*)memory_calloc(MEMORY_ENVIRONMENT, 1, sizeof(TransitionTable));
+    if (table) {
+        table->next_state = (int32_t*)memory_alloc(MEMORY_ENVIRONMENT, count * sizeof(int32_t));
+        table->outcome = (uint8_t*)memory_alloc(MEMORY_ENVIRONMENT, count * sizeof(uint8_t));
+    }
+    if (!table || !table->next_state || !table->outcome) {
+        fprintf(stderr, "Error: Failed to allocate transition table for %dx%d grid\n",
+                world->width, world->height);
+        free_transition_table(table);
+        return false;
+    }
+    table->num_states = world->width * world->height;
+
+    build_transition_table(world, table);
+    world->transitions = table;
+    return true;
+}
+
+bool has_transition_table(GridWorld* world) {
+    return world && world->transitions;
+}
+
+// Bring the table in line with the layout, goal and rewards before a lookup
+static inline void refresh_transition_table(GridWorld* world, TransitionTable* table) {
+    if (table->dirty) {
+        build_transition_table(world, table);
+    } else if (table->goal_state != world->goal_pos.y * world->width + world->goal_pos.x) {
+        classify_transitions(world, table);
+    }
+    table->outcome_reward[TRANSITION_STEP] = world->step_penalty;
+    table->outcome_reward[TRANSITION_BLOCKED] = world->wall_penalty;
+    table->outcome_reward[TRANSITION_GOAL] = world->goal_reward;
+}
+
+// Current compiled table (rebuilt first if stale), or NULL when none is enabled
+TransitionTable* get_transition_table(GridWorld* world) {
+    if (!world || !world->transitions) return NULL;
+    refresh_transition_table(world, world->transitions);
+    return world->transitions;
+}
+
+// Apply one (already validated) action: action noise, movement, reward and
+// episode bookkeeping. Returns the reward.
+static float advance_agent(GridWorld* world, int action, bool* valid_move) {
+    // With probability action_noise the intended action is replaced by a uniform one
+    if (world->stochastic && world->action_noise > 0.0f &&
+        random_next_float(&world->rng) < world->action_noise) {
+        action = (int)random_next_bounded(&world->rng, NUM_ACTIONS);
+    }
+
+    float reward;
+    bool reached_goal;
+    TransitionTable* table = world->transitions;
+    if (table) {
+        refresh_transition_table(world, table);
+        int state = world->agent_pos.y * world->width + world->agent_pos.x;
+        size_t i = (size_t)state * NUM_ACTIONS + action;
+        int next = table->next_state[i];
+        *valid_move = next != state;
+        world->agent_pos.x = next % world->width;
+        world->agent_pos.y = next / world->width;
+        reward = table->outcome_reward[table->outcome[i]];
+        reached_goal = next == table->goal_state;
+    } else {
+        Position old_pos = world->agent_pos;
+        Position new_pos = get_new_position(old_pos, (Action)action);
+        
+        // Check if new position is valid and walkable
+        *valid_move = is_walkable(world, new_pos.x, new_pos.y);
+        if (*valid_move) {
+            world->agent_pos = new_pos;
+        }
+        reward = calculate_reward(world, old_pos, world->agent_pos, *valid_move);
+        reached_goal = is_terminal_state(world, world->agent_pos);
+    }
+
+    world->total_reward += reward;
+    world->episode_steps++;
+    world->episode_done = reached_goal || (world->episode_steps >= world->max_steps);
+    return reward;
+}
+
 // Execute an action and return the next state
 int step(GridWorld* world, Action action, float* reward) {
     if (!world || !reward) {
@@ -171,49 +393,14 @@ int step(GridWorld* world, Action action, float* reward) {
         return get_state_index(world);
     }
     
-    // Save current position
-    Position old_pos = world->agent_pos;
-    Position new_pos = old_pos;
-    
-    // Calculate new position based on action
-    switch (action) {
-        case ACTION_UP:
-            new_pos.y = old_pos.y - 1;
-            break;
-        case ACTION_DOWN:
-            new_pos.y = old_pos.y + 1;
-            break;
-        case ACTION_LEFT:
-            new_pos.x = old_pos.x - 1;
-            break;
-        case ACTION_RIGHT:
-            new_pos.x = old_pos.x + 1;
-            break;
-        default:
-            fprintf(stderr, "Warning: Invalid action %d\n", action);
-            *reward = 0.0f;
-            return get_state_index(world);
-    }
-    
-    // Check if new position is valid and walkable
-    bool valid_move = is_valid_position(world, new_pos.x, new_pos.y) && 
-                      is_walkable(world, new_pos.x, new_pos.y);
-    
-    if (valid_move) {
-        // Move agent to new position
-        world->agent_pos = new_pos;
+    if (action < 0 || action >= NUM_ACTIONS) {
+        fprintf(stderr, "Warning: Invalid action %d\n", action);
+        *reward = 0.0f;
+        return get_state_index(world);
     }
     
-    // Calculate reward
-    *reward = calculate_reward(world, old_pos, world->agent_pos, valid_move);
-    world->total_reward += *reward;
-    
-    // Increment step counter
-    world->episode_steps++;
-    
-    // Check if episode is done
-    world->episode_done = is_terminal_state(world, world->agent_pos) || 
-                          (world->episode_steps >= world->max_steps);
+    bool valid_move;
+    *reward = advance_agent(world, action, &valid_move);
     
     return get_state_index(world);
 }
@@ -241,52 +428,17 @@ StepResult step_environment(GridWorld* world, Action action) {
         return result;
     }
     
-    // Save current position
-    Position old_pos = world->agent_pos;
-    Position new_pos = old_pos;
-    
-    // Calculate new position based on action
-    switch (action) {
-        case ACTION_UP:
-            new_pos.y = old_pos.y - 1;
-            break;
-        case ACTION_DOWN:
-            new_pos.y = old_pos.y + 1;
-            break;
-        case ACTION_LEFT:
-            new_pos.x = old_pos.x - 1;
-            break;
-        case ACTION_RIGHT:
-            new_pos.x = old_pos.x + 1;
-            break;
-        default:
-            fprintf(stderr, "Warning: Invalid action %d in step_environment\n", action);
-            result.next_state = get_current_state(world);
-            result.reward = 0.0f;
-            result.done = world->episode_done;
-            result.valid_action = false;
-            return result;
-    }
-    
-    // Check if new position is valid and walkable
-    bool valid_move = is_valid_position(world, new_pos.x, new_pos.y) && 
-                      is_walkable(world, new_pos.x, new_pos.y);
-    
-    if (valid_move) {
-        // Move agent to new position
-        world->agent_pos = new_pos;
+    if (action < 0 || action >= NUM_ACTIONS) {
+        fprintf(stderr, "Warning: Invalid action %d in step_environment\n", action);
+        result.next_state = get_current_state(world);
+        result.reward = 0.0f;
+        result.done = world->episode_done;
+        result.valid_action = false;
+        return result;
     }
     
-    // Calculate reward
-    result.reward = calculate_reward(world, old_pos, world->agent_pos, valid_move);
-    world->total_reward += result.reward;
-    
-    // Increment step counter
-    world->episode_steps++;
-    
-    // Check if episode is done
-    world->episode_done = is_terminal_state(world, world->agent_pos) || 
-                          (world->episode_steps >= world->max_steps);
+    bool valid_move;
+    result.reward = advance_agent(world, action, &valid_move);
     
     // Fill result structure
     result.next_state = get_current_state(world);
@@ -302,20 +454,16 @@ void destroy_grid_world(GridWorld* world) {
         return; // Nothing to destroy
     }
     
-    // Free the 2D grid
-    if (world->grid) {
-        for (int y = 0; y < world->height; y++) {
-            if (world->grid[y]) {
-                free(world->grid[y]);
-            }
-        }
-        free(world->grid);
-    }
+    // Drop this world's reference to the layout
+    release_grid_layout(world->layout);
+    free_transition_table(world->transitions);
     
     // Free the main structure
-    free(world);
+    memory_free(world);
     
-    printf("GridWorld destroyed and memory freed\n");
+    if (g_environment_verbose) {
+        printf("GridWorld destroyed and memory freed\n");
+    }
 }
 
 // Helper function implementations that are referenced above
@@ -332,8 +480,7 @@ bool is_walkable(GridWorld* world, int x, int y) {
         return false;
     }
     
-    CellType cell = world->grid[y][x];
-    return (cell != CELL_WALL && cell != CELL_OBSTACLE);
+    return !grid_layout_blocked(world->layout, x, y);
 }
 
 // Calculate reward based on the move
@@ -359,6 +506,28 @@ bool positions_equal(Position a, Position b) {
     return (a.x == b.x && a.y == b.y);
 }
 
+// Position one move away in the given direction (unchecked; invalid actions stay put)
+Position get_new_position(Position current, Action action) {
+    Position next = current;
+    switch (action) {
+        case ACTION_UP:
+            next.y = current.y - 1;
+            break;
+        case ACTION_DOWN:
+            next.y = current.y + 1;
+            break;
+        case ACTION_LEFT:
+            next.x = current.x - 1;
+            break;
+        case ACTION_RIGHT:
+            next.x = current.x + 1;
+            break;
+        default:
+            break;
+    }
+    return next;
+}
+
 // Convert 2D position to 1D state index
 int position_to_state(GridWorld* world, Position pos) {
     if (!world) return -1;
@@ -395,12 +564,33 @@ State get_current_state(GridWorld* world) {
     return state;
 }
 
+// Give the world a private layout (copy on write when it is shared with
+// clones) and invalidate its compiled transitions ahead of a change
+static bool begin_layout_write(GridWorld* world) {
+    if (grid_layout_is_shared(world->layout)) {
+        GridLayout* own = copy_grid_layout(world->layout);
+        if (!own) {
+            fprintf(stderr, "Error: Failed to copy shared grid layout\n");
+            return false;
+        }
+        release_grid_layout(world->layout);
+        world->layout = own;
+    }
+    if (world->transitions) {
+        world->transitions->dirty = true;
+    }
+    return true;
+}
+
 // Set cell type at specified position
 void set_cell(GridWorld* world, int x, int y, CellType type) {
     if (!world || !is_valid_position(world, x, y)) {
         return;
     }
-    world->grid[y][x] = type;
+    
+    if (begin_layout_write(world)) {
+        grid_layout_set(world->layout, x, y, type);
+    }
 }
 
 // Get cell type at specified position
@@ -408,7 +598,368 @@ CellType get_cell(GridWorld* world, int x, int y) {
     if (!world || !is_valid_position(world, x, y)) {
         return CELL_WALL; // Safe default for out-of-bounds
     }
-    return world->grid[y][x];
+    return grid_layout_get(world->layout, x, y);
+}
+
+// Level generation. Generators write the layout bitset directly and draw
+// only from world->rng, so a world seeded with seed_environment() always
+// produces the same level. Mazes open cells at even coordinates and carve
+// passages through the odd rows and columns between them.
+
+#define MAZE_JOIN_PROBABILITY 0.5f   // Eller's: chance to join a horizontal or vertical neighbour
+#define MAZE_MAX_BRAID 0.3f          // Share of loop-closing walls opened at complexity 0
+#define MAX_WALL_DENSITY 0.9f
+
+// Union-find root with path halving
+static int find_region(int* parent, int i) {
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+static void join_regions(int* parent, int a, int b) {
+    a = find_region(parent, a);
+    b = find_region(parent, b);
+    if (a != b) {
+        parent[a < b ? b : a] = a < b ? a : b;
+    }
+}
+
+// Lowest-right maze cell, the farthest corner from the start at (0, 0)
+static Position maze_far_corner(GridWorld* world) {
+    Position corner = {(world->width - 1) & ~1, (world->height - 1) & ~1};
+    return corner;
+}
+
+// Mark start and goal after a fill dropped every special cell
+static void place_endpoints(GridWorld* world, Position start, Position goal) {
+    world->start_pos = start;
+    world->goal_pos = goal;
+    world->agent_pos = start;
+    grid_layout_set(world->layout, start.x, start.y, CELL_START);
+    grid_layout_set(world->layout, goal.x, goal.y, CELL_GOAL);
+}
+
+// Remove every wall and obstacle, keeping the start and goal
+void clear_environment(GridWorld* world) {
+    if (!world || !begin_layout_write(world)) return;
+
+    grid_layout_fill(world->layout, CELL_EMPTY);
+    place_endpoints(world, world->start_pos, world->goal_pos);
+}
+
+// Binary-tree maze: each cell opens a passage up or left at random (the top
+// row and left column have only one choice). A perfect maze in one pass with
+// no extra memory, biased towards long corridors along the top and left.
+void generate_simple_maze(GridWorld* world) {
+    if (!world || !begin_layout_write(world)) return;
+
+    GridLayout* layout = world->layout;
+    grid_layout_fill(layout, CELL_WALL);
+    for (int y = 0; y < world->height; y += 2) {
+        for (int x = 0; x < world->width; x += 2) {
+            grid_layout_set_blocked(layout, x, y, false);
+            if (y > 0 && (x == 0 || random_next_bounded(&world->rng, 2) == 0)) {
+                grid_layout_set_blocked(layout, x, y - 1, false);
+            } else if (x > 0) {
+                grid_layout_set_blocked(layout, x - 1, y, false);
+            }
+        }
+    }
+    place_endpoints(world, (Position){0, 0}, maze_far_corner(world));
+}
+
+// Eller's algorithm: one maze row at a time, tracking only which cells of
+// the current row are already connected (union-find over its columns), so
+// memory is O(width) however tall the grid. complexity 1 gives a perfect
+// maze; lower values reopen up to MAZE_MAX_BRAID of the remaining walls
+// between cells afterwards, each of which adds a loop.
+void generate_random_maze(GridWorld* world, float complexity) {
+    if (!world) return;
+
+    int cols = (world->width + 1) / 2;
+    int rows = (world->height + 1) / 2;
+    float braid = (1.0f - fminf(fmaxf(complexity, 0.0f), 1.0f)) * MAZE_MAX_BRAID;
+
+    int* scratch = (int*)malloc((size_t)cols * 4 * sizeof(int));
+    uint8_t* flags = (uint8_t*)malloc((size_t)cols * 2);
+    if (!scratch || !flags) {
+        fprintf(stderr, "Error: Failed to allocate maze generator rows\n");
+        free(scratch);
+        free(flags);
+        return;
+    }
+    int* parent = scratch;              // Sets of the current row, indexed by column
+    int* row_root = scratch + cols;     // Set of each column before the next row relabels them
+    int* members = scratch + 2 * cols;  // Per set: columns seen so far
+    int* chosen = scratch + 3 * cols;   // Per set: column kept open downwards if none is drawn
+    uint8_t* down = flags;              // Column continues into the next row
+    uint8_t* has_down = flags + cols;   // Per set: some column continues
+
+    if (!begin_layout_write(world)) {
+        free(scratch);
+        free(flags);
+        return;
+    }
+    GridLayout* layout = world->layout;
+    grid_layout_fill(layout, CELL_WALL);
+    for (int i = 0; i < cols; i++) {
+        parent[i] = i;
+    }
+
+    for (int r = 0; r < rows; r++) {
+        int y = 2 * r;
+        bool last_row = r == rows - 1;
+        for (int i = 0; i < cols; i++) {
+            grid_layout_set_blocked(layout, 2 * i, y, false);
+        }
+
+        // Join neighbours in different sets at random (all of them on the last row)
+        for (int i = 0; i + 1 < cols; i++) {
+            int a = find_region(parent, i);
+            int b = find_region(parent, i + 1);
+            if (a != b && (last_row || random_next_float(&world->rng) < MAZE_JOIN_PROBABILITY)) {
+                join_regions(parent, a, b);
+                grid_layout_set_blocked(layout, 2 * i + 1, y, false);
+            }
+        }
+        if (last_row) break;
+
+        // Every set continues down through at least one column (reservoir-picked
+        // when no column was drawn), otherwise it would be sealed off
+        for (int i = 0; i < cols; i++) {
+            members[i] = 0;
+            has_down[i] = 0;
+        }
+        for (int i = 0; i < cols; i++) {
+            int root = find_region(parent, i);
+            row_root[i] = root;
+            down[i] = random_next_float(&world->rng) < MAZE_JOIN_PROBABILITY;
+            has_down[root] |= down[i];
+            if (random_next_bounded(&world->rng, (uint32_t)++members[root]) == 0) {
+                chosen[root] = i;
+            }
+        }
+
+        // Columns going down keep their set in the next row; the rest start new ones
+        for (int i = 0; i < cols; i++) {
+            int root = row_root[i];
+            if (!has_down[root] && chosen[root] == i) {
+                down[i] = 1;
+            }
+            members[i] = -1;  // Reused: first column of each set in the next row
+        }
+        for (int i = 0; i < cols; i++) {
+            parent[i] = i;
+            if (!down[i]) continue;
+            grid_layout_set_blocked(layout, 2 * i, y + 1, false);
+            int root = row_root[i];
+            if (members[root] < 0) {
+                members[root] = i;
+            } else {
+                parent[i] = members[root];
+            }
+        }
+    }
+
+    // Braid: passages between two cells that the tree left closed
+    if (braid > 0.0f) {
+        for (int y = 0; y < world->height; y++) {
+            for (int x = (y & 1) ? 0 : 1; x < world->width; x += 2) {
+                bool between_cells = (y & 1) ? y + 1 < world->height : x + 1 < world->width;
+                if (between_cells && random_next_float(&world->rng) < braid) {
+                    grid_layout_set_blocked(layout, x, y, false);
+                }
+            }
+        }
+    }
+
+    free(scratch);
+    free(flags);
+    place_endpoints(world, (Position){0, 0}, maze_far_corner(world));
+}
+
+// Horizontal corridors on the even rows, each linked to the next through a
+// single random gap in the wall row between them: one long winding route
+void create_corridor_maze(GridWorld* world) {
+    if (!world || !begin_layout_write(world)) return;
+
+    GridLayout* layout = world->layout;
+    grid_layout_fill(layout, CELL_EMPTY);
+    for (int y = 1; y < world->height; y += 2) {
+        // A wall row on the bottom edge has no corridor below, so no gap
+        int gap = y + 1 < world->height ? (int)random_next_bounded(&world->rng, (uint32_t)world->width) : -1;
+        for (int x = 0; x < world->width; x++) {
+            grid_layout_set_blocked(layout, x, y, x != gap);
+        }
+    }
+    Position goal = {world->width - 1, (world->height - 1) & ~1};
+    place_endpoints(world, (Position){0, 0}, goal);
+}
+
+// Union-find regions of walkable cells, 4-connected
+static void build_regions(GridWorld* world, int* parent) {
+    const GridLayout* layout = world->layout;
+    for (int y = 0; y < world->height; y++) {
+        for (int x = 0; x < world->width; x++) {
+            int index = y * world->width + x;
+            parent[index] = index;
+            if (grid_layout_blocked(layout, x, y)) continue;
+            if (x > 0 && !grid_layout_blocked(layout, x - 1, y)) join_regions(parent, index, index - 1);
+            if (y > 0 && !grid_layout_blocked(layout, x, y - 1)) join_regions(parent, index, index - world->width);
+        }
+    }
+}
+
+// Open the fewest new walls (placed[] set) separating start from goal:
+// breadth-first by walls crossed, flooding each level through open cells
+// first. Pre-existing walls are never removed. false if no such path exists.
+static bool carve_cheapest_path(GridWorld* world, const uint8_t* placed, int* from, int start, int goal) {
+    int num_cells = world->width * world->height;
+    int* levels = (int*)malloc((size_t)num_cells * 2 * sizeof(int));
+    if (!levels) {
+        fprintf(stderr, "Error: Failed to allocate wall carving queue\n");
+        return false;
+    }
+    int* frontier = levels;
+    int* next = levels + num_cells;
+    static const int dx[4] = {0, 0, -1, 1};
+    static const int dy[4] = {-1, 1, 0, 0};
+
+    for (int i = 0; i < num_cells; i++) {
+        from[i] = -1;
+    }
+    from[start] = start;
+    int frontier_size = 0;
+    frontier[frontier_size++] = start;
+    while (frontier_size > 0 && from[goal] < 0) {
+        int next_size = 0;
+        // Each cell is claimed once: open cells join the current level, new walls the next
+        while (frontier_size > 0 && from[goal] < 0) {
+            int cell = frontier[--frontier_size];
+            int cx = cell % world->width;
+            int cy = cell / world->width;
+            for (int d = 0; d < 4; d++) {
+                int nx = cx + dx[d];
+                int ny = cy + dy[d];
+                if (!is_valid_position(world, nx, ny)) continue;
+                int neighbour = ny * world->width + nx;
+                if (from[neighbour] >= 0) continue;
+                if (!grid_layout_blocked(world->layout, nx, ny)) {
+                    from[neighbour] = cell;
+                    frontier[frontier_size++] = neighbour;
+                } else if (placed[neighbour]) {
+                    from[neighbour] = cell;
+                    next[next_size++] = neighbour;
+                }
+            }
+        }
+        int* swap = frontier;
+        frontier = next;
+        next = swap;
+        frontier_size = next_size;
+    }
+
+    bool found = from[goal] >= 0;
+    for (int cell = goal; found && cell != start; cell = from[cell]) {
+        grid_layout_set_blocked(world->layout, cell % world->width, cell / world->width, false);
+    }
+    free(levels);
+    return found;
+}
+
+// Turn empty cells into walls with probability wall_density (at most 0.9),
+// then repair connectivity: new walls that split two regions are reopened,
+// the cheapest set of new walls on a start-goal route is opened if the goal
+// was cut off, and empty cells still unreachable from the start are walled
+// in so random starts and goals never land in a sealed pocket. Start, goal
+// and other marked cells are left alone.
+void add_random_walls(GridWorld* world, float wall_density) {
+    if (!world || wall_density <= 0.0f) return;
+
+    float density = fminf(wall_density, MAX_WALL_DENSITY);
+    int num_cells = world->width * world->height;
+    int* parent = (int*)malloc((size_t)num_cells * sizeof(int));
+    uint8_t* placed = (uint8_t*)calloc((size_t)num_cells, sizeof(uint8_t));
+    if (!parent || !placed) {
+        fprintf(stderr, "Error: Failed to allocate random wall generator state\n");
+        free(parent);
+        free(placed);
+        return;
+    }
+    if (!begin_layout_write(world)) {
+        free(parent);
+        free(placed);
+        return;
+    }
+    GridLayout* layout = world->layout;
+
+    for (int y = 0; y < world->height; y++) {
+        for (int x = 0; x < world->width; x++) {
+            // One draw per cell keeps the stream independent of the existing layout
+            bool wall = random_next_float(&world->rng) < density;
+            if (wall && !grid_layout_blocked(layout, x, y) && grid_layout_get(layout, x, y) == CELL_EMPTY) {
+                grid_layout_set_blocked(layout, x, y, true);
+                placed[y * world->width + x] = 1;
+            }
+        }
+    }
+
+    // Reopen new walls whose open neighbours belong to different regions
+    build_regions(world, parent);
+    for (int y = 0; y < world->height; y++) {
+        for (int x = 0; x < world->width; x++) {
+            int index = y * world->width + x;
+            if (!placed[index]) continue;
+            int neighbours[4];
+            int count = 0;
+            if (x > 0 && !grid_layout_blocked(layout, x - 1, y)) neighbours[count++] = index - 1;
+            if (x + 1 < world->width && !grid_layout_blocked(layout, x + 1, y)) neighbours[count++] = index + 1;
+            if (y > 0 && !grid_layout_blocked(layout, x, y - 1)) neighbours[count++] = index - world->width;
+            if (y + 1 < world->height && !grid_layout_blocked(layout, x, y + 1)) neighbours[count++] = index + world->width;
+            bool splits = false;
+            for (int i = 1; i < count && !splits; i++) {
+                splits = find_region(parent, neighbours[i]) != find_region(parent, neighbours[0]);
+            }
+            if (!splits) continue;
+            grid_layout_set_blocked(layout, x, y, false);
+            placed[index] = 0;
+            for (int i = 0; i < count; i++) {
+                join_regions(parent, index, neighbours[i]);
+            }
+        }
+    }
+
+    int start = position_to_state(world, world->start_pos);
+    int goal = position_to_state(world, world->goal_pos);
+    bool endpoints_open = is_walkable(world, world->start_pos.x, world->start_pos.y) &&
+                          is_walkable(world, world->goal_pos.x, world->goal_pos.y);
+    if (endpoints_open && find_region(parent, start) != find_region(parent, goal)) {
+        if (carve_cheapest_path(world, placed, parent, start, goal)) {
+            build_regions(world, parent);
+        } else {
+            fprintf(stderr, "Warning: Goal was already unreachable before adding random walls\n");
+        }
+    }
+
+    if (endpoints_open) {
+        int start_region = find_region(parent, start);
+        for (int y = 0; y < world->height; y++) {
+            for (int x = 0; x < world->width; x++) {
+                int index = y * world->width + x;
+                if (!grid_layout_blocked(layout, x, y) && find_region(parent, index) != start_region &&
+                    grid_layout_get(layout, x, y) == CELL_EMPTY) {
+                    grid_layout_set_blocked(layout, x, y, true);
+                }
+            }
+        }
+    }
+
+    grid_layout_mark_changed(layout);
+    free(parent);
+    free(placed);
 }
 
 // Print environment information
@@ -433,15 +984,11 @@ void print_environment_info(GridWorld* world) {
     printf("Total reward this episode: %.2f\n", world->total_reward);
     
     // Count different cell types
-    int wall_count = 0, obstacle_count = 0;
-    for (int y = 0; y < world->height; y++) {
-        for (int x = 0; x < world->width; x++) {
-            CellType cell = world->grid[y][x];
-            if (cell == CELL_WALL) wall_count++;
-            else if (cell == CELL_OBSTACLE) obstacle_count++;
-        }
-    }
+    int wall_count = grid_layout_count(world->layout, CELL_WALL);
+    int obstacle_count = grid_layout_count(world->layout, CELL_OBSTACLE);
     printf("Obstacles: %d walls, %d obstacles\n", wall_count, obstacle_count);
+    printf("Layout memory: %zu bytes%s\n", grid_layout_bytes(world->layout),
+           grid_layout_is_shared(world->layout) ? " (shared)" : "");
 }
 
 // Validate environment configuration
@@ -0,0 +1,235 @@
+#include "grid_layout.h"
+#include "memory_arena.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+static inline bool cell_blocks(CellType type) {
+    return type == CELL_WALL || type == CELL_OBSTACLE;
+}
+
+// Types that cannot be recovered from the bitset alone
+static inline bool cell_is_special(CellType type) {
+    return type != CELL_EMPTY && type != CELL_WALL;
+}
+
+// Source of layout revisions, shared by all layouts so a revision never repeats
+static uint64_t last_layout_revision = 0;
+
+static inline uint64_t next_layout_revision(void) {
+    return __atomic_add_fetch(&last_layout_revision, 1, __ATOMIC_RELAXED);
+}
+
+static inline size_t bitset_words(const GridLayout* layout) {
+    return (size_t)layout->words_per_row * layout->height;
+}
+
+// Position of index in the sorted side table, or where it would be inserted
+static int find_special(const GridLayout* layout, int index, bool* found) {
+    int lo = 0;
+    int hi = layout->num_specials;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (layout->specials[mid].index < index) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    *found = lo < layout->num_specials && layout->specials[lo].index == index;
+    return lo;
+}
+
+// Create an all-empty layout
+GridLayout* create_grid_layout(int width, int height) {
+    if (width <= 0 || height <= 0) {
+        fprintf(stderr, "Error: Grid dimensions must be positive (width=%d, height=%d)\n", width, height);
+        return NULL;
+    }
+
+    GridLayout* layout = (GridLayout*)memory_calloc(MEMORY_ENVIRONMENT, 1, sizeof(GridLayout));
+    if (!layout) {
+        fprintf(stderr, "Error: Failed to allocate memory for grid layout\n");
+        return NULL;
+    }
+
+    layout->width = width;
+    layout->height = height;
+    layout->words_per_row = (width + 63) / 64;
+    layout->blocked = (uint64_t*)memory_calloc(MEMORY_ENVIRONMENT, bitset_words(layout), sizeof(uint64_t));
+    if (!layout->blocked) {
+        fprintf(stderr, "Error: Failed to allocate memory for grid bitset\n");
+        memory_free(layout);
+        return NULL;
+    }
+    layout->ref_count = 1;
+    layout->revision = next_layout_revision();
+    return layout;
+}
+
+// Deep copy with a single owner
+GridLayout* copy_grid_layout(const GridLayout* layout) {
+    if (!layout) return NULL;
+
+    GridLayout* copy = create_grid_layout(layout->width, layout->height);
+    if (!copy) return NULL;
+
+    memcpy(copy->blocked, layout->blocked, bitset_words(layout) * sizeof(uint64_t));
+    if (layout->num_specials > 0) {
+        copy->specials = (GridSpecialCell*)memory_alloc(MEMORY_ENVIRONMENT, layout->num_specials * sizeof(GridSpecialCell));
+        if (!copy->specials) {
+            fprintf(stderr, "Error: Failed to allocate memory for grid special cells\n");
+            release_grid_layout(copy);
+            return NULL;
+        }
+        memcpy(copy->specials, layout->specials, layout->num_specials * sizeof(GridSpecialCell));
+        copy->num_specials = layout->num_specials;
+        copy->special_capacity = layout->num_specials;
+    }
+    copy->revision = layout->revision;
+    return copy;
+}
+
+GridLayout* retain_grid_layout(GridLayout* layout) {
+    if (layout) {
+        __atomic_add_fetch(&layout->ref_count, 1, __ATOMIC_RELAXED);
+    }
+    return layout;
+}
+
+void release_grid_layout(GridLayout* layout) {
+    if (!layout) return;
+
+    if (__atomic_sub_fetch(&layout->ref_count, 1, __ATOMIC_ACQ_REL) == 0) {
+        memory_free(layout->blocked);
+        memory_free(layout->specials);
+        memory_free(layout);
+    }
+}
+
+bool grid_layout_is_shared(const GridLayout* layout) {
+    return layout && __atomic_load_n(&layout->ref_count, __ATOMIC_ACQUIRE) > 1;
+}
+
+// Update the bitset and the side table for one cell
+void grid_layout_set(GridLayout* layout, int x, int y, CellType type) {
+    layout->revision = next_layout_revision();
+    size_t word = (size_t)y * layout->words_per_row + (x >> 6);
+    uint64_t mask = (uint64_t)1 << (x & 63);
+    if (cell_blocks(type)) {
+        layout->blocked[word] |= mask;
+    } else {
+        layout->blocked[word] &= ~mask;
+    }
+
+    int index = y * layout->width + x;
+    bool found = false;
+    int pos = find_special(layout, index, &found);
+
+    if (!cell_is_special(type)) {
+        if (found) {
+            memmove(&layout->specials[pos], &layout->specials[pos + 1],
+                    (layout->num_specials - pos - 1) * sizeof(GridSpecialCell));
+            layout->num_specials--;
+        }
+        return;
+    }
+    if (found) {
+        layout->specials[pos].type = type;
+        return;
+    }
+
+    if (layout->num_specials == layout->special_capacity) {
+        int capacity = layout->special_capacity > 0 ? layout->special_capacity * 2 : 8;
+        GridSpecialCell* grown = (GridSpecialCell*)memory_realloc(MEMORY_ENVIRONMENT, layout->specials, capacity * sizeof(GridSpecialCell));
+        if (!grown) {
+            fprintf(stderr, "Error: Failed to grow grid special cell table\n");
+            return;  // Walkability is already correct; only the exact type is lost
+        }
+        layout->specials = grown;
+        layout->special_capacity = capacity;
+    }
+    memmove(&layout->specials[pos + 1], &layout->specials[pos],
+            (layout->num_specials - pos) * sizeof(GridSpecialCell));
+    layout->specials[pos].index = index;
+    layout->specials[pos].type = type;
+    layout->num_specials++;
+}
+
+CellType grid_layout_get(const GridLayout* layout, int x, int y) {
+    bool found = false;
+    int pos = find_special(layout, y * layout->width + x, &found);
+    if (found) {
+        return layout->specials[pos].type;
+    }
+    return grid_layout_blocked(layout, x, y) ? CELL_WALL : CELL_EMPTY;
+}
+
+// Reset every cell to empty or wall; padding bits past width stay clear
+void grid_layout_fill(GridLayout* layout, CellType type) {
+    if (!layout) return;
+
+    layout->revision = next_layout_revision();
+    layout->num_specials = 0;
+    if (!cell_blocks(type)) {
+        memset(layout->blocked, 0, bitset_words(layout) * sizeof(uint64_t));
+        return;
+    }
+
+    int tail = layout->width & 63;
+    uint64_t last_word = tail ? ((uint64_t)1 << tail) - 1 : ~(uint64_t)0;
+    for (int y = 0; y < layout->height; y++) {
+        uint64_t* row = &layout->blocked[(size_t)y * layout->words_per_row];
+        for (int w = 0; w < layout->words_per_row - 1; w++) {
+            row[w] = ~(uint64_t)0;
+        }
+        row[layout->words_per_row - 1] = last_word;
+    }
+}
+
+// New revision after bulk bit writes
+void grid_layout_mark_changed(GridLayout* layout) {
+    if (layout) {
+        layout->revision = next_layout_revision();
+    }
+}
+
+// Number of cells of the given type
+int grid_layout_count(const GridLayout* layout, CellType type) {
+    if (!layout) return 0;
+
+    int specials_of_type = 0;
+    int blocking_specials = 0;
+    for (int i = 0; i < layout->num_specials; i++) {
+        if (layout->specials[i].type == type) specials_of_type++;
+        if (cell_blocks(layout->specials[i].type)) blocking_specials++;
+    }
+
+    int blocked = (int)((long long)layout->width * layout->height) - grid_layout_walkable_count(layout);
+    switch (type) {
+        case CELL_WALL:
+            return blocked - blocking_specials;
+        case CELL_EMPTY:
+            return layout->width * layout->height - blocked - (layout->num_specials - blocking_specials);
+        default:
+            return specials_of_type;
+    }
+}
+
+int grid_layout_walkable_count(const GridLayout* layout) {
+    if (!layout) return 0;
+
+    long long blocked = 0;
+    size_t words = bitset_words(layout);
+    for (size_t i = 0; i < words; i++) {
+        blocked += __builtin_popcountll(layout->blocked[i]);
+    }
+    return (int)((long long)layout->width * layout->height - blocked);
+}
+
+// Heap bytes held by the layout
+size_t grid_layout_bytes(const GridLayout* layout) {
+    if (!layout) return 0;
+    return sizeof(GridLayout) + bitset_words(layout) * sizeof(uint64_t) +
+           (size_t)layout->special_capacity * sizeof(GridSpecialCell);
+}
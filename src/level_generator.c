@@ -0,0 +1,117 @@
+#include "level_generator.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Work shared by the batch threads; worlds are claimed through next_world
+typedef struct {
+    GridWorld** worlds;
+    int count;
+    const LevelBatchConfig* config;
+    int next_world;             // Modified atomically
+} LevelBatchContext;
+
+LevelBatchConfig create_default_level_batch_config(LevelType type) {
+    LevelBatchConfig config = {
+        .type = type,
+        .parameter = 0.3f,
+        .seed = 42,
+        .num_threads = 1,
+        .random_endpoints = false
+    };
+    return config;
+}
+
+const char* level_type_name(LevelType type) {
+    switch (type) {
+        case LEVEL_SIMPLE_MAZE:  return "simple";
+        case LEVEL_RANDOM_MAZE:  return "maze";
+        case LEVEL_CORRIDORS:    return "corridors";
+        case LEVEL_RANDOM_WALLS: return "walls";
+        default:                 return "unknown";
+    }
+}
+
+bool parse_level_type(const char* name, LevelType* type) {
+    if (!name || !type) return false;
+    for (int t = LEVEL_SIMPLE_MAZE; t <= LEVEL_RANDOM_WALLS; t++) {
+        if (strcmp(name, level_type_name((LevelType)t)) == 0) {
+            *type = (LevelType)t;
+            return true;
+        }
+    }
+    return false;
+}
+
+void generate_level(GridWorld* world, LevelType type, float parameter, bool random_endpoints) {
+    if (!world) return;
+
+    switch (type) {
+        case LEVEL_SIMPLE_MAZE:
+            generate_simple_maze(world);
+            break;
+        case LEVEL_RANDOM_MAZE:
+            generate_random_maze(world, parameter);
+            break;
+        case LEVEL_CORRIDORS:
+            create_corridor_maze(world);
+            break;
+        case LEVEL_RANDOM_WALLS:
+            clear_environment(world);
+            add_random_walls(world, parameter);
+            break;
+        default:
+            return;
+    }
+    // Every generator leaves all free cells connected, so any endpoints stay reachable
+    if (random_endpoints) {
+        set_random_goal(world);
+        set_random_start(world);
+        world->agent_pos = world->start_pos;
+    }
+}
+
+static void* level_batch_worker_main(void* arg) {
+    LevelBatchContext* ctx = (LevelBatchContext*)arg;
+    const LevelBatchConfig* config = ctx->config;
+
+    for (;;) {
+        int i = __atomic_fetch_add(&ctx->next_world, 1, __ATOMIC_RELAXED);
+        if (i >= ctx->count) break;
+        seed_environment(ctx->worlds[i], config->seed + (unsigned int)i);
+        generate_level(ctx->worlds[i], config->type, config->parameter, config->random_endpoints);
+    }
+    return NULL;
+}
+
+bool generate_level_batch(GridWorld** worlds, int count, const LevelBatchConfig* config) {
+    if (!worlds || !config || count < 0 || config->num_threads < 1) {
+        fprintf(stderr, "Error: Invalid parameters for level batch generation\n");
+        return false;
+    }
+    for (int i = 0; i < count; i++) {
+        if (!worlds[i]) {
+            fprintf(stderr, "Error: Level batch world %d is NULL\n", i);
+            return false;
+        }
+    }
+
+    LevelBatchContext ctx = {worlds, count, config, 0};
+    int threads = config->num_threads < count ? config->num_threads : count;
+    pthread_t* helpers = threads > 1 ? (pthread_t*)malloc((threads - 1) * sizeof(pthread_t)) : NULL;
+    int started = 0;
+    if (helpers) {
+        // Worlds are claimed dynamically, so a helper that fails to start costs only speed
+        while (started < threads - 1 &&
+               pthread_create(&helpers[started], NULL, level_batch_worker_main, &ctx) == 0) {
+            started++;
+        }
+    }
+    level_batch_worker_main(&ctx);
+    for (int i = 0; i < started; i++) {
+        pthread_join(helpers[i], NULL);
+    }
+    free(helpers);
+    return true;
+}
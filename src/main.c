@@ -1,6 +1,18 @@
+#define _POSIX_C_SOURCE 200809L  // clock_gettime, nanosleep
+
 #include "rendering.h"
 #include "environment.h"
 #include "agent.h"
+#include "parallel_training.h"
+#include "training.h"
+#include "planning.h"
+#include "render_snapshot.h"
+#include "stats_sink.h"
+#include "checkpoint.h"
+#include "profiler.h"
+#include "policy.h"
+#include "sweep.h"
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
@@ -16,8 +28,34 @@ typedef struct {
     bool print_progress;
     int progress_interval;
     const char* policy_filename;
+    bool use_optimized_qtable;  // Back the agent with the flat OptimizedQTable
+    const char* mapped_qtable_filename; // Keep the Q-table in this mmap'd file (NULL = in memory)
+    int num_threads;            // Worker threads for headless training (1 = classic loop)
+    ParallelTrainingMode parallel_mode; // Q-table sharing strategy when num_threads > 1
+    int merge_interval;         // Episodes per worker between table merges
+    bool scaling_report;        // Benchmark 1..num_threads workers instead of training once
+    int relayout_interval;      // Episodes between visit-frequency Q-table relayouts (0 = off)
+    bool transition_table;      // Step through a precompiled transition table
+    float action_noise;         // Probability of a random action per step (0 = deterministic)
+    bool plan_first;            // Warm-start the Q-table with value iteration before training
+    bool render_thread;         // Train on a separate thread and draw snapshots (with visualization)
+    bool batched_rendering;     // Draw the grid and Q heatmap as textures
+    const char* stats_filename; // Per-episode log streamed during training
+    StatsSinkFormat stats_format;
+    bool compress_qtable;       // Save Q-table checkpoints run-length encoded
+    const char* checkpoint_filename; // Periodic background checkpoints (rotated as FILE.1, FILE.2, ...)
+    int checkpoint_interval;    // Episodes between checkpoints (0 = off)
+    double checkpoint_seconds;  // Seconds between checkpoints (0 = off)
+    int checkpoint_keep;        // Checkpoints kept, including the newest
+    const char* profile_trace_filename; // Chrome trace of the run (builds with PROFILE=1)
+    const char* compiled_policy_filename; // Packed 2-bit greedy policy written after training (NULL = none)
+    const char* sweep_filename; // Hyperparameter sweep spec run instead of training (NULL = none)
+    float trace_lambda;         // Watkins Q(lambda) trace decay (< 0 = one-step Q-learning)
 } TrainingConfig;
 
+// Timed events kept per thread for --profile-trace (16 bytes each)
+#define PROFILE_TRACE_EVENTS (1 << 20)
+
 // Training control state
 typedef struct {
     bool is_paused;
@@ -67,20 +105,71 @@ void save_policy_to_file(QLearningAgent* agent, GridWorld* world, const char* fi
     printf("Policy saved to %s\n", filename);
 }
 
+// Packed greedy policy for policy_act() serving, next to the text policy
+static void save_compiled_policy_file(QLearningAgent* agent, const char* filename) {
+    CompiledPolicy* policy = compile_policy(agent);
+    if (policy && save_compiled_policy(policy, filename)) {
+        printf("Compiled policy saved to %s (%zu bytes)\n", filename, compiled_policy_bytes(policy));
+    }
+    destroy_compiled_policy(policy);
+}
+
+// Independent trials of the spec on the configured world; --episodes,
+// --max-steps and the Q-table layout are the defaults for keys it leaves out
+static bool run_sweep_from_file(GridWorld* world, const TrainingConfig* config) {
+    SweepSpec spec = create_default_sweep_spec();
+    spec.num_episodes = config->num_episodes;
+    spec.max_steps_per_episode = config->max_steps_per_episode;
+    spec.storage = config->use_optimized_qtable ? QTABLE_STORAGE_OPTIMIZED : QTABLE_STORAGE_ROWS;
+    if (!load_sweep_spec(config->sweep_filename, &spec)) {
+        return false;
+    }
+    
+    FILE* output = stdout;
+    if (spec.output_filename[0] != '\0') {
+        output = fopen(spec.output_filename, "w");
+        if (!output) {
+            printf("Error: Could not open sweep results file %s\n", spec.output_filename);
+            return false;
+        }
+    }
+    int num_trials = sweep_trial_count(&spec);
+    SweepTrialResult* results = (SweepTrialResult*)malloc((size_t)num_trials * sizeof(SweepTrialResult));
+    if (!results) {
+        printf("Error: Failed to allocate sweep results\n");
+        if (output != stdout) fclose(output);
+        return false;
+    }
+    
+    printf("Sweep: %d %s-search trials of up to %d episodes\n", num_trials,
+           spec.search == SWEEP_SEARCH_RANDOM ? "random" : "grid", spec.num_episodes);
+    SweepSummary summary = run_sweep(world, &spec, output, results);
+    if (output != stdout) {
+        fclose(output);
+        printf("Sweep results written to %s\n", spec.output_filename);
+    }
+    
+    printf("Sweep finished: %d trials on %d threads in %.2f s (%d converged, %d completed, %d diverged, %d failed)\n",
+           summary.num_trials, summary.num_threads, summary.elapsed_seconds,
+           summary.status_counts[SWEEP_TRIAL_CONVERGED], summary.status_counts[SWEEP_TRIAL_COMPLETED],
+           summary.status_counts[SWEEP_TRIAL_DIVERGED], summary.status_counts[SWEEP_TRIAL_FAILED]);
+    if (summary.best_trial >= 0) {
+        const SweepTrialResult* best = &results[summary.best_trial];
+        printf("Best trial %d: learning_rate=%g discount_factor=%g epsilon_decay=%g (%s after %d episodes, "
+               "final avg reward %.2f)\n", best->trial, best->parameters[SWEEP_LEARNING_RATE],
+               best->parameters[SWEEP_DISCOUNT_FACTOR], best->parameters[SWEEP_EPSILON_DECAY],
+               sweep_trial_status_name(best->status), best->episodes_run, best->final_avg_reward);
+    }
+    free(results);
+    return summary.num_trials > 0;
+}
+
 // Function to print training progress
 void print_episode_progress(int episode, EpisodeStats* stats, QLearningAgent* agent) {
     printf("Episode %d: Reward=%.2f, Steps=%d, Epsilon=%.3f, Avg Q=%.3f\n",
            stats->episode, stats->total_reward, stats->steps_taken, 
            stats->epsilon_used, stats->avg_q_value);
-}
-
-// Function to calculate average Q-value for current state
-float calculate_avg_q_value(QLearningAgent* agent, int state) {
-    float sum = 0.0f;
-    for (int action = 0; action < agent->num_actions; action++) {
-        sum += get_q_value(agent, state, action);
-    }
-    return sum / agent->num_actions;
+    PROFILE_INTERVAL_REPORT();
 }
 
 // Initialize training control state
@@ -166,6 +255,12 @@ void handle_training_input(TrainingControl* control, VisualizationState* vis_sta
         vis_state->config.show_fps = !vis_state->config.show_fps;
         printf("FPS display: %s\n", vis_state->config.show_fps ? "ON" : "OFF");
     }
+    
+    // B: Toggle batched (texture) rendering
+    if (IsKeyPressed(KEY_B) && vis_state) {
+        vis_state->config.batched_rendering = !vis_state->config.batched_rendering;
+        printf("Batched rendering: %s\n", vis_state->config.batched_rendering ? "ON" : "OFF");
+    }
 }
 
 // Display control instructions
@@ -181,10 +276,179 @@ void display_control_instructions() {
     printf("Q       : Toggle Q-value display\n");
     printf("G       : Toggle grid lines\n");
     printf("F       : Toggle FPS display\n");
+    printf("B       : Toggle batched (texture) rendering\n");
     printf("ESC     : Exit training\n");
     printf("========================\n\n");
 }
 
+// Visit counts that drive periodic Q-table relayout (flat storage only)
+static int* create_relayout_visit_counts(QLearningAgent* agent, TrainingConfig* config) {
+    if (config->relayout_interval <= 0) {
+        return NULL;
+    }
+    if (agent->storage != QTABLE_STORAGE_OPTIMIZED) {
+        printf("Note: --relayout-interval needs --optimized-qtable; ignoring it\n");
+        return NULL;
+    }
+    return (int*)calloc(agent->num_states, sizeof(int));
+}
+
+// Streaming per-episode log; without one only the retained history is saved at the end
+static StatsSink* open_stats_log(TrainingConfig* config) {
+    StatsSink* sink = create_stats_sink(config->stats_filename, config->stats_format, 4096);
+    if (!sink) {
+        printf("Note: streaming stats log unavailable; saving the last %d episodes at the end\n",
+               TRAINING_STATS_HISTORY);
+    }
+    return sink;
+}
+
+// Save the Q-table in the checkpoint format chosen on the command line
+static bool save_training_q_table(QLearningAgent* agent, const char* filename, const TrainingConfig* config) {
+    return config->compress_qtable ? save_q_table_compressed(agent, filename) : save_q_table(agent, filename);
+}
+
+// Periodic background checkpoints, when --checkpoint-every or --checkpoint-seconds is given
+static Checkpointer* open_checkpoints(TrainingConfig* config) {
+    if (config->checkpoint_interval <= 0 && config->checkpoint_seconds <= 0.0) return NULL;
+    
+    Checkpointer* checkpoints = create_checkpointer(config->checkpoint_filename, config->checkpoint_keep,
+                                                    config->compress_qtable, config->checkpoint_interval,
+                                                    config->checkpoint_seconds);
+    if (checkpoints) {
+        printf("Checkpointing to %s (keeping %d)\n", config->checkpoint_filename, config->checkpoint_keep);
+    } else {
+        printf("Note: periodic checkpoints unavailable\n");
+    }
+    return checkpoints;
+}
+
+// Checkpoint the finished run, then stop the writer
+static void close_checkpoints(Checkpointer* checkpoints, QLearningAgent* agent, int episode) {
+    if (!checkpoints) return;
+    
+    wait_for_checkpoint(checkpoints);
+    request_checkpoint(checkpoints, agent, episode);
+    bool ok = wait_for_checkpoint(checkpoints);
+    printf("%lld checkpoints written to %s%s\n", checkpoints_written(checkpoints), checkpoints->filename,
+           ok ? "" : " (some writes failed)");
+    close_checkpointer(checkpoints);
+}
+
+// S key: snapshot the table and write it in the background so training does not wait on the disk
+static void save_q_table_in_background(Checkpointer* saver, QLearningAgent* agent, const char* filename,
+                                       const TrainingConfig* config, int episode) {
+    if (!saver) {
+        if (save_training_q_table(agent, filename, config)) {
+            printf("Q-table saved successfully!\n");
+        }
+    } else if (request_checkpoint(saver, agent, episode)) {
+        printf("Saving Q-table to %s...\n", filename);
+    } else {
+        printf("Previous save still in progress, try again shortly\n");
+    }
+}
+
+// L key: finish any save first so the file read is the newest one
+static void load_saved_q_table(Checkpointer* saver, QLearningAgent* agent, const char* filename) {
+    if (saver) {
+        wait_for_checkpoint(saver);
+    }
+    if (load_q_table(agent, filename)) {
+        printf("Q-table loaded successfully!\n");
+    }
+}
+
+// Episode bookkeeping shared by the interactive and render-thread loops:
+// statistics, periodic relayout, checkpoints and progress output
+static void complete_training_episode(GridWorld* world, QLearningAgent* agent, TrainingConfig* config,
+                                      TrainingStats* stats, StatsSink* sink, Checkpointer* checkpoints,
+                                      int* visit_counts, int episode, EpisodeProgress* progress) {
+    // Decay epsilon and record episode statistics and metrics
+    bool converged = finish_training_episode(world, agent, stats, episode, progress);
+    if (sink) {
+        PROFILE_BEGIN(PROFILE_STATS);
+        stats_sink_record_episode(sink, stats, episode);
+        PROFILE_END(PROFILE_STATS);
+    }
+    checkpoint_if_due(checkpoints, agent, episode + 1);
+    
+    // Pack frequently visited states into neighbouring rows
+    if (visit_counts && (episode + 1) % config->relayout_interval == 0) {
+        optimize_agent_memory_layout(agent, visit_counts);
+    }
+    
+    if (converged && !config->enable_visualization) {
+        printf("Training converged at episode %d!\n", episode + 1);
+    }
+    
+    // Print progress with enhanced metrics
+    if (config->print_progress && (episode + 1) % config->progress_interval == 0) {
+        EpisodeStats* episode_stats = get_episode_stats(stats, episode);
+        print_episode_progress(episode + 1, episode_stats, agent);
+        
+        // Print learning curves every 200 episodes
+        if ((episode + 1) % (config->progress_interval * 2) == 0) {
+            print_learning_curves(stats, 20);
+        }
+        
+        // Print convergence analysis every 100 episodes
+        if ((episode + 1) % config->progress_interval == 0) {
+            print_convergence_analysis(stats->metrics, episode);
+        }
+    }
+}
+
+// Final analysis, performance data and saved artifacts of a training run
+static void report_training_results(GridWorld* world, QLearningAgent* agent, TrainingConfig* config,
+                                    TrainingStats* stats, StatsSink* sink, int episode,
+                                    const char* qtable_filename) {
+    // Print final performance analysis
+    print_training_summary(stats);
+    print_learning_curves(stats, 50);  // Show last 50 episodes
+    print_convergence_analysis(stats->metrics, episode - 1);
+    
+    // Performance data was streamed during training; make sure it is on disk
+    if (sink) {
+        if (stats_sink_flush(sink)) {
+            printf("Performance data saved to %s (%lld episodes)\n", sink->filename,
+                   stats_sink_records_written(sink));
+        }
+    } else {
+        save_performance_data(stats, config->stats_filename);
+    }
+    
+    // Save policy if requested
+    if (config->save_policy && config->policy_filename) {
+        save_policy_to_file(agent, world, config->policy_filename);
+    }
+    
+    // Auto-save Q-table at end
+    if (config->enable_visualization) {
+        if (save_training_q_table(agent, qtable_filename, config)) {
+            printf("Q-table auto-saved to %s\n", qtable_filename);
+        }
+    }
+    
+    // Final performance summary
+    if (stats->metrics && stats->current_episode > 0) {
+        printf("\n=== Final Performance Summary ===\n");
+        printf("Episodes completed: %d\n", stats->current_episode);
+        printf("Best episode: %d (reward: %.2f)\n", stats->best_episode + 1, stats->best_reward);
+        printf("Training converged: %s\n", stats->metrics->has_converged ? "Yes" : "No");
+        if (stats->metrics->has_converged) {
+            printf("Convergence episode: %d\n", stats->metrics->convergence_episode + 1);
+        }
+        
+        // Calculate final success rate
+        int successful_episodes = stats->total_successful_episodes;
+        float final_success_rate = (float)successful_episodes / stats->current_episode * 100.0f;
+        printf("Overall success rate: %.1f%% (%d/%d episodes)\n", 
+               final_success_rate, successful_episodes, stats->current_episode);
+        printf("==================================\n");
+    }
+}
+
 // Main training function with enhanced controls
 void run_training(GridWorld* world, QLearningAgent* agent, TrainingConfig* config) {
     printf("Starting Q-Learning Training with Enhanced Controls...\n");
@@ -207,6 +471,14 @@ void run_training(GridWorld* world, QLearningAgent* agent, TrainingConfig* confi
         return;
     }
     
+    StatsSink* sink = open_stats_log(config);
+    Checkpointer* checkpoints = open_checkpoints(config);
+    Checkpointer* saver = config->enable_visualization ?
+        create_checkpointer(control.qtable_filename, 1, config->compress_qtable, 0, 0.0) : NULL;
+    
+    // Visit counts that drive periodic Q-table relayout (flat storage only)
+    int* visit_counts = create_relayout_visit_counts(agent, config);
+    
     // Initialize visualization if enabled
     VisualizationState* vis_state = NULL;
     if (config->enable_visualization) {
@@ -216,6 +488,9 @@ void run_training(GridWorld* world, QLearningAgent* agent, TrainingConfig* confi
         
         init_graphics(SCREEN_WIDTH, SCREEN_HEIGHT);
         vis_state = get_visualization_state();
+        if (vis_state) {
+            vis_state->config.batched_rendering = config->batched_rendering;
+        }
     }
     
     clock_t start_time = clock();
@@ -229,11 +504,7 @@ void run_training(GridWorld* world, QLearningAgent* agent, TrainingConfig* confi
             episode = 0;
             
             // Reset agent (clear Q-table)
-            for (int s = 0; s < agent->num_states; s++) {
-                for (int a = 0; a < agent->num_actions; a++) {
-                    agent->q_table[s][a] = 0.0f;
-                }
-            }
+            reset_q_table(agent);
             
             // Reset epsilon
             agent->epsilon = 1.0f;
@@ -248,32 +519,23 @@ void run_training(GridWorld* world, QLearningAgent* agent, TrainingConfig* confi
         }
         
         // Reset environment for new episode
-        reset_environment(world);
-        
-        float episode_reward = 0.0f;
-        int steps_taken = 0;
-        float total_q_value = 0.0f;
-        int q_value_count = 0;
+        EpisodeProgress progress = begin_training_episode(world);
         
         // Episode loop
-        while (!world->episode_done && steps_taken < config->max_steps_per_episode && !control.should_exit) {
+        while (training_episode_running(world, &progress, config->max_steps_per_episode) && !control.should_exit) {
             // Handle user input
             if (config->enable_visualization) {
                 handle_training_input(&control, vis_state);
                 
                 // Handle save request
                 if (control.save_requested) {
-                    if (save_q_table(agent, control.qtable_filename)) {
-                        printf("Q-table saved successfully!\n");
-                    }
+                    save_q_table_in_background(saver, agent, control.qtable_filename, config, episode);
                     control.save_requested = false;
                 }
                 
                 // Handle load request
                 if (control.load_requested) {
-                    if (load_q_table(agent, control.qtable_filename)) {
-                        printf("Q-table loaded successfully!\n");
-                    }
+                    load_saved_q_table(saver, agent, control.qtable_filename);
                     control.load_requested = false;
                 }
                 
@@ -285,6 +547,7 @@ void run_training(GridWorld* world, QLearningAgent* agent, TrainingConfig* confi
                 
                 // Skip training step if paused, but continue rendering
                 if (control.is_paused) {
+                    PROFILE_BEGIN(PROFILE_RENDER);
                     BeginDrawing();
                     ClearBackground(RAYWHITE);
                     
@@ -312,35 +575,18 @@ void run_training(GridWorld* world, QLearningAgent* agent, TrainingConfig* confi
                     draw_fps_counter(vis_state);
                     
                     EndDrawing();
+                    PROFILE_END(PROFILE_RENDER);
                     WaitTime(0.016f); // ~60 FPS for smooth UI
                     continue;
                 }
             }
             
-            // Get current state
-            int current_state = get_state_index(world);
-            
-            // Select action using epsilon-greedy policy
-            Action action = select_action(agent, current_state);
-            
-            // Take action and get result
-            StepResult result = step_environment(world, action);
-            
-            // Update Q-value
-            update_q_value(agent, current_state, action, result.reward, 
-                          position_to_state(world, result.next_state.position), result.done);
-            
-            // Accumulate statistics
-            episode_reward += result.reward;
-            steps_taken++;
-            
-            // Calculate average Q-value for statistics
-            float avg_q = calculate_avg_q_value(agent, current_state);
-            total_q_value += avg_q;
-            q_value_count++;
+            // Select, act and learn
+            Action action = training_step(world, agent, &progress, visit_counts);
             
             // Render if visualization is enabled
             if (config->enable_visualization) {
+                PROFILE_BEGIN(PROFILE_RENDER);
                 BeginDrawing();
                 ClearBackground(RAYWHITE);
                 
@@ -359,7 +605,7 @@ void run_training(GridWorld* world, QLearningAgent* agent, TrainingConfig* confi
                 char info_text[512];
                 snprintf(info_text, sizeof(info_text), 
                         "Episode: %d/%d | Step: %d | Reward: %.1f | Epsilon: %.3f | Speed: %.1fx",
-                        episode + 1, config->num_episodes, steps_taken, episode_reward, 
+                        episode + 1, config->num_episodes, progress.steps_taken, progress.total_reward, 
                         agent->epsilon, control.training_speed);
                 DrawText(info_text, 10, 10, 16, BLACK);
                 
@@ -378,6 +624,7 @@ void run_training(GridWorld* world, QLearningAgent* agent, TrainingConfig* confi
                 draw_fps_counter(vis_state);
                 
                 EndDrawing();
+                PROFILE_END(PROFILE_RENDER);
                 
                 // Control training speed
                 float delay = 0.05f / control.training_speed;
@@ -385,44 +632,7 @@ void run_training(GridWorld* world, QLearningAgent* agent, TrainingConfig* confi
             }
         }
         
-        // Decay epsilon after each episode
-        decay_epsilon(agent);
-        
-        // Calculate Q-value variance for performance metrics
-        float q_variance = calculate_q_value_variance(agent);
-        
-        // Check if goal was reached
-        bool goal_reached = (world->agent_pos.x == world->goal_pos.x && 
-                            world->agent_pos.y == world->goal_pos.y);
-        
-        // Record episode statistics
-        float avg_q_episode = q_value_count > 0 ? total_q_value / q_value_count : 0.0f;
-        record_episode(stats, episode, episode_reward, steps_taken, agent->epsilon, avg_q_episode);
-        
-        // Update performance metrics
-        update_performance_metrics(stats->metrics, stats, episode, goal_reached, q_variance);
-        
-        // Check for convergence
-        bool converged = check_convergence(stats->metrics, episode);
-        if (converged && !config->enable_visualization) {
-            printf("Training converged at episode %d!\n", episode + 1);
-        }
-        
-        // Print progress with enhanced metrics
-        if (config->print_progress && (episode + 1) % config->progress_interval == 0) {
-            EpisodeStats* episode_stats = &stats->episodes[episode];
-            print_episode_progress(episode + 1, episode_stats, agent);
-            
-            // Print learning curves every 200 episodes
-            if ((episode + 1) % (config->progress_interval * 2) == 0) {
-                print_learning_curves(stats, 20);
-            }
-            
-            // Print convergence analysis every 100 episodes
-            if ((episode + 1) % config->progress_interval == 0) {
-                print_convergence_analysis(stats->metrics, episode);
-            }
-        }
+        complete_training_episode(world, agent, config, stats, sink, checkpoints, visit_counts, episode, &progress);
         
         episode++;
     }
@@ -436,55 +646,314 @@ void run_training(GridWorld* world, QLearningAgent* agent, TrainingConfig* confi
         printf("Total training time: %.2f seconds\n", training_time);
         printf("Final training speed: %.1fx\n", control.training_speed);
         
-        // Print final performance analysis
-        print_training_summary(stats);
-        print_learning_curves(stats, 50);  // Show last 50 episodes
-        print_convergence_analysis(stats->metrics, episode - 1);
-        
-        // Save performance data
-        save_performance_data(stats, "performance_data.csv");
-        
-        // Save policy if requested
-        if (config->save_policy && config->policy_filename) {
-            save_policy_to_file(agent, world, config->policy_filename);
-        }
+        // The final auto-save below must not race a save still in flight
+        close_checkpointer(saver);
+        close_checkpoints(checkpoints, agent, episode);
+        report_training_results(world, agent, config, stats, sink, episode, control.qtable_filename);
         
-        // Auto-save Q-table at end
+        // Cleanup
+        close_stats_sink(sink);
+        destroy_training_stats(stats);
+        free(visit_counts);
         if (config->enable_visualization) {
-            if (save_q_table(agent, control.qtable_filename)) {
-                printf("Q-table auto-saved to %s\n", control.qtable_filename);
-            }
+            cleanup_graphics();
+        }
+    }
+}
+
+// Training state shared with the raylib thread in --render-thread mode. Only
+// the training thread touches world, agent and stats until finished is set.
+typedef struct {
+    GridWorld* world;
+    QLearningAgent* agent;
+    TrainingConfig* config;
+    TrainingStats* stats;
+    StatsSink* sink;
+    Checkpointer* checkpoints;          // Periodic checkpoints (NULL = off)
+    Checkpointer* saver;                // S key saves to qtable_filename
+    int* visit_counts;
+    const char* qtable_filename;
+    SnapshotBuffer* snapshots;          // Training thread -> renderer
+    TrainingCommandQueue commands;      // Renderer -> training thread
+    int episodes_run;                   // Valid once finished is set
+    double elapsed_seconds;
+    bool finished;                      // Accessed atomically
+} RenderThreadTraining;
+
+// Trainer-side view of the forwarded controls
+typedef struct {
+    bool paused;
+    bool reset;
+    bool exit;
+} TrainerControl;
+
+// Steps between clock checks for snapshot publishing
+#define SNAPSHOT_CHECK_STEPS 64
+#define SNAPSHOT_INTERVAL_SECONDS (1.0 / 60.0)
+
+static double wall_time_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// Apply every queued command on the training thread
+static void drain_training_commands(RenderThreadTraining* shared, TrainerControl* control) {
+    TrainingCommand command;
+    while (pop_training_command(&shared->commands, &command)) {
+        switch (command.type) {
+            case TRAINING_CMD_SET_PAUSED:
+                control->paused = command.value != 0;
+                break;
+            case TRAINING_CMD_RESET:
+                control->reset = true;
+                break;
+            case TRAINING_CMD_SAVE:
+                save_q_table_in_background(shared->saver, shared->agent, shared->qtable_filename,
+                                           shared->config, 0);
+                break;
+            case TRAINING_CMD_LOAD:
+                load_saved_q_table(shared->saver, shared->agent, shared->qtable_filename);
+                break;
+            case TRAINING_CMD_EXIT:
+                control->exit = true;
+                break;
         }
+    }
+}
+
+static void publish_training_snapshot(RenderThreadTraining* shared, int episode, const EpisodeProgress* progress,
+                                      Action action, bool paused, long long total_steps, double steps_per_second) {
+    RenderSnapshot* snapshot = snapshot_begin_write(shared->snapshots);
+    snapshot->agent_pos = shared->world->agent_pos;
+    snapshot->last_action = action;
+    snapshot->episode = episode;
+    snapshot->step = progress->steps_taken;
+    snapshot->episode_reward = progress->total_reward;
+    snapshot->epsilon = shared->agent->epsilon;
+    snapshot->paused = paused;
+    snapshot->total_steps = total_steps;
+    snapshot->steps_per_second = steps_per_second;
+    snapshot_capture_q_values(snapshot, shared->agent);
+    snapshot_publish(shared->snapshots);
+}
+
+// Same loop as run_training without any drawing or frame pacing
+static void* render_thread_training_main(void* arg) {
+    RenderThreadTraining* shared = (RenderThreadTraining*)arg;
+    GridWorld* world = shared->world;
+    QLearningAgent* agent = shared->agent;
+    TrainingConfig* config = shared->config;
+    
+    TrainerControl control = {false, false, false};
+    double start_time = wall_time_seconds();
+    double last_publish = 0.0;
+    double rate_time = start_time;
+    long long rate_steps = 0;
+    double steps_per_second = 0.0;
+    long long total_steps = 0;
+    int episode = 0;
+    
+    while (episode < config->num_episodes && !control.exit) {
+        EpisodeProgress progress = begin_training_episode(world);
+        Action action = ACTION_UP;
         
-        // Final performance summary
-        if (stats->metrics && stats->current_episode > 0) {
-            printf("\n=== Final Performance Summary ===\n");
-            printf("Episodes completed: %d\n", stats->current_episode);
-            printf("Best episode: %d (reward: %.2f)\n", stats->best_episode + 1, stats->best_reward);
-            printf("Training converged: %s\n", stats->metrics->has_converged ? "Yes" : "No");
-            if (stats->metrics->has_converged) {
-                printf("Convergence episode: %d\n", stats->metrics->convergence_episode + 1);
-            }
-            
-            // Calculate final success rate
-            int successful_episodes = 0;
-            for (int i = 0; i < stats->current_episode; i++) {
-                if (stats->metrics->success_episodes[i]) {
-                    successful_episodes++;
+        while (training_episode_running(world, &progress, config->max_steps_per_episode)) {
+            if (total_steps % SNAPSHOT_CHECK_STEPS == 0 || control.paused) {
+                drain_training_commands(shared, &control);
+                if (control.exit || control.reset) break;
+                
+                double now = wall_time_seconds();
+                if (now - rate_time >= 0.5) {
+                    steps_per_second = (double)(total_steps - rate_steps) / (now - rate_time);
+                    rate_time = now;
+                    rate_steps = total_steps;
+                }
+                if (now - last_publish >= SNAPSHOT_INTERVAL_SECONDS) {
+                    publish_training_snapshot(shared, episode, &progress, action, control.paused,
+                                              total_steps, control.paused ? 0.0 : steps_per_second);
+                    last_publish = now;
+                }
+                if (control.paused) {
+                    struct timespec pause = {0, 5000000};
+                    nanosleep(&pause, NULL);
+                    continue;
                 }
             }
-            float final_success_rate = (float)successful_episodes / stats->current_episode * 100.0f;
-            printf("Overall success rate: %.1f%% (%d/%d episodes)\n", 
-                   final_success_rate, successful_episodes, stats->current_episode);
-            printf("==================================\n");
+            
+            action = training_step(world, agent, &progress, shared->visit_counts);
+            total_steps++;
         }
         
-        // Cleanup
-        destroy_training_stats(stats);
-        if (config->enable_visualization) {
-            cleanup_graphics();
+        if (control.exit) {
+            printf("Training interrupted by user\n");
+            break;
+        }
+        if (control.reset) {
+            printf("Resetting training...\n");
+            episode = 0;
+            reset_q_table(agent);
+            agent->epsilon = 1.0f;
+            destroy_training_stats(shared->stats);
+            shared->stats = create_training_stats(config->num_episodes);
+            total_steps = 0;
+            rate_steps = 0;
+            start_time = wall_time_seconds();
+            control.reset = false;
+            printf("Training reset complete!\n");
+            continue;
+        }
+        
+        complete_training_episode(world, agent, config, shared->stats, shared->sink, shared->checkpoints,
+                                  shared->visit_counts, episode, &progress);
+        episode++;
+    }
+    
+    shared->episodes_run = episode;
+    shared->elapsed_seconds = wall_time_seconds() - start_time;
+    __atomic_store_n(&shared->finished, true, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+// Forward the keys handled by handle_training_input to the training thread
+static void forward_training_input(RenderThreadTraining* shared, TrainingControl* control, bool* paused_sent) {
+    if (control->is_paused != *paused_sent) {
+        TrainingCommand command = {TRAINING_CMD_SET_PAUSED, control->is_paused ? 1 : 0};
+        if (push_training_command(&shared->commands, command)) {
+            *paused_sent = control->is_paused;
+        }
+    }
+    if (control->should_reset) {
+        TrainingCommand command = {TRAINING_CMD_RESET, 0};
+        control->should_reset = !push_training_command(&shared->commands, command);
+    }
+    if (control->save_requested) {
+        TrainingCommand command = {TRAINING_CMD_SAVE, 0};
+        control->save_requested = !push_training_command(&shared->commands, command);
+    }
+    if (control->load_requested) {
+        TrainingCommand command = {TRAINING_CMD_LOAD, 0};
+        control->load_requested = !push_training_command(&shared->commands, command);
+    }
+    if (control->should_exit) {
+        TrainingCommand command = {TRAINING_CMD_EXIT, 0};
+        push_training_command(&shared->commands, command);
+    }
+}
+
+// Training runs unthrottled on its own thread while this thread draws the
+// latest snapshot at the display rate (--render-thread)
+void run_training_with_render_thread(GridWorld* world, QLearningAgent* agent, TrainingConfig* config) {
+    printf("Starting Q-Learning Training with a separate render thread...\n");
+    printf("Episodes: %d, Max steps per episode: %d\n", 
+           config->num_episodes, config->max_steps_per_episode);
+    display_control_instructions();
+    printf("Training runs at full speed; +/- have no effect in this mode\n");
+    
+    RenderThreadTraining shared;
+    memset(&shared, 0, sizeof(shared));
+    shared.world = world;
+    shared.agent = agent;
+    shared.config = config;
+    shared.stats = create_training_stats(config->num_episodes);
+    shared.snapshots = create_snapshot_buffer(agent->num_states);
+    init_command_queue(&shared.commands);
+    
+    // The renderer draws a clone: it shares the (read-only) layout and only
+    // its agent position is updated from snapshots
+    GridWorld* view = clone_grid_world(world);
+    if (!shared.stats || !shared.snapshots || !view) {
+        printf("Error: Failed to set up render-thread training\n");
+        destroy_training_stats(shared.stats);
+        destroy_snapshot_buffer(shared.snapshots);
+        destroy_grid_world(view);
+        return;
+    }
+    
+    TrainingControl control = create_training_control();
+    shared.qtable_filename = control.qtable_filename;
+    shared.visit_counts = create_relayout_visit_counts(agent, config);
+    shared.sink = open_stats_log(config);
+    shared.checkpoints = open_checkpoints(config);
+    shared.saver = create_checkpointer(control.qtable_filename, 1, config->compress_qtable, 0, 0.0);
+    
+    init_graphics(800, 600);
+    VisualizationState* vis_state = get_visualization_state();
+    if (vis_state) {
+        vis_state->config.batched_rendering = config->batched_rendering;
+    }
+    
+    pthread_t trainer;
+    if (pthread_create(&trainer, NULL, render_thread_training_main, &shared) != 0) {
+        printf("Error: Failed to start the training thread\n");
+        cleanup_graphics();
+        destroy_training_stats(shared.stats);
+        destroy_snapshot_buffer(shared.snapshots);
+        destroy_grid_world(view);
+        free(shared.visit_counts);
+        close_stats_sink(shared.sink);
+        close_checkpointer(shared.checkpoints);
+        close_checkpointer(shared.saver);
+        return;
+    }
+    
+    bool paused_sent = false;
+    while (!__atomic_load_n(&shared.finished, __ATOMIC_ACQUIRE)) {
+        handle_training_input(&control, vis_state);
+        forward_training_input(&shared, &control, &paused_sent);
+        
+        const RenderSnapshot* snapshot = snapshot_acquire(shared.snapshots);
+        
+        // EndDrawing paces this loop to the target FPS (counted as render time)
+        PROFILE_BEGIN(PROFILE_RENDER);
+        BeginDrawing();
+        ClearBackground(RAYWHITE);
+        if (snapshot) {
+            view->agent_pos = snapshot->agent_pos;
+            if (control.show_q_values) {
+                draw_snapshot_q_values(vis_state, view, snapshot);
+            } else {
+                draw_grid_world(vis_state, view);
+            }
+            draw_walls(vis_state, view);
+            draw_goal(vis_state, view->goal_pos);
+            draw_agent(vis_state, view->agent_pos);
+            
+            char info_text[512];
+            snprintf(info_text, sizeof(info_text),
+                    "%sEpisode: %d/%d | Step: %d | Reward: %.1f | Epsilon: %.3f | %.0f steps/s",
+                    snapshot->paused ? "PAUSED - " : "", snapshot->episode + 1, config->num_episodes,
+                    snapshot->step, snapshot->episode_reward, snapshot->epsilon, snapshot->steps_per_second);
+            DrawText(info_text, 10, 10, 16, snapshot->paused ? RED : BLACK);
+            
+            snprintf(info_text, sizeof(info_text),
+                    "Agent: (%d,%d) | Total steps: %lld | Q-values: %s",
+                    snapshot->agent_pos.x, snapshot->agent_pos.y, snapshot->total_steps,
+                    control.show_q_values ? "ON" : "OFF");
+            DrawText(info_text, 10, 30, 14, DARKGRAY);
         }
+        DrawText("SPACE: Pause | R: Reset | V: Q-values | S: Save | L: Load | ESC: Exit", 
+                10, GetScreenHeight() - 30, 12, DARKBLUE);
+        draw_fps_counter(vis_state);
+        EndDrawing();
+        PROFILE_END(PROFILE_RENDER);
     }
+    pthread_join(trainer, NULL);
+    
+    printf("\nTraining completed!\n");
+    printf("Total training time: %.2f seconds\n", shared.elapsed_seconds);
+    
+    close_checkpointer(shared.saver);
+    close_checkpoints(shared.checkpoints, agent, shared.episodes_run);
+    report_training_results(world, agent, config, shared.stats, shared.sink, shared.episodes_run,
+                            shared.qtable_filename);
+    
+    close_stats_sink(shared.sink);
+    destroy_training_stats(shared.stats);
+    destroy_snapshot_buffer(shared.snapshots);
+    destroy_grid_world(view);
+    free(shared.visit_counts);
+    cleanup_graphics();
 }
 
 // Function to create default training configuration
@@ -496,7 +965,30 @@ TrainingConfig create_default_training_config() {
         .save_policy = true,
         .print_progress = true,
         .progress_interval = 100,
-        .policy_filename = "learned_policy.txt"
+        .policy_filename = "learned_policy.txt",
+        .use_optimized_qtable = (DEFAULT_QTABLE_STORAGE == QTABLE_STORAGE_OPTIMIZED),
+        .mapped_qtable_filename = NULL,
+        .num_threads = 1,
+        .parallel_mode = PARALLEL_MODE_HOGWILD,
+        .merge_interval = 10,
+        .scaling_report = false,
+        .relayout_interval = 0,
+        .transition_table = false,
+        .action_noise = 0.0f,
+        .plan_first = false,
+        .render_thread = false,
+        .batched_rendering = false,
+        .stats_filename = "performance_data.csv",
+        .stats_format = STATS_SINK_CSV,
+        .compress_qtable = false,
+        .checkpoint_filename = "qtable.ckpt",
+        .checkpoint_interval = 0,
+        .checkpoint_seconds = 0.0,
+        .checkpoint_keep = 3,
+        .profile_trace_filename = NULL,
+        .compiled_policy_filename = NULL,
+        .sweep_filename = NULL,
+        .trace_lambda = -1.0f
     };
     return config;
 }
@@ -518,6 +1010,71 @@ TrainingConfig parse_arguments(int argc, char* argv[]) {
             config.print_progress = false;
         } else if (strcmp(argv[i], "--policy-file") == 0 && i + 1 < argc) {
             config.policy_filename = argv[++i];
+        } else if (strcmp(argv[i], "--optimized-qtable") == 0) {
+            config.use_optimized_qtable = true;
+        } else if (strcmp(argv[i], "--row-qtable") == 0) {
+            config.use_optimized_qtable = false;
+        } else if (strcmp(argv[i], "--mapped-qtable") == 0 && i + 1 < argc) {
+            config.mapped_qtable_filename = argv[++i];
+        } else if (strcmp(argv[i], "--compress-qtable") == 0) {
+            config.compress_qtable = true;
+        } else if (strcmp(argv[i], "--checkpoint-every") == 0 && i + 1 < argc) {
+            config.checkpoint_interval = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--checkpoint-seconds") == 0 && i + 1 < argc) {
+            config.checkpoint_seconds = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--checkpoint-keep") == 0 && i + 1 < argc) {
+            config.checkpoint_keep = atoi(argv[++i]);
+            if (config.checkpoint_keep < 1) {
+                config.checkpoint_keep = 1;
+            }
+        } else if (strcmp(argv[i], "--checkpoint-file") == 0 && i + 1 < argc) {
+            config.checkpoint_filename = argv[++i];
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            config.num_threads = atoi(argv[++i]);
+            if (config.num_threads < 1) {
+                config.num_threads = 1;
+            }
+        } else if (strcmp(argv[i], "--parallel-mode") == 0 && i + 1 < argc) {
+            if (!parse_parallel_mode(argv[++i], &config.parallel_mode)) {
+                printf("Unknown parallel mode '%s' (expected hogwild or merge)\n", argv[i]);
+                exit(1);
+            }
+        } else if (strcmp(argv[i], "--merge-interval") == 0 && i + 1 < argc) {
+            config.merge_interval = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--scaling-report") == 0) {
+            config.scaling_report = true;
+        } else if (strcmp(argv[i], "--relayout-interval") == 0 && i + 1 < argc) {
+            config.relayout_interval = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--transition-table") == 0) {
+            config.transition_table = true;
+        } else if (strcmp(argv[i], "--action-noise") == 0 && i + 1 < argc) {
+            config.action_noise = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--plan") == 0) {
+            config.plan_first = true;
+        } else if (strcmp(argv[i], "--render-thread") == 0) {
+            config.render_thread = true;
+        } else if (strcmp(argv[i], "--batched-render") == 0) {
+            config.batched_rendering = true;
+        } else if (strcmp(argv[i], "--stats-file") == 0 && i + 1 < argc) {
+            config.stats_filename = argv[++i];
+        } else if (strcmp(argv[i], "--stats-format") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "csv") == 0) {
+                config.stats_format = STATS_SINK_CSV;
+            } else if (strcmp(argv[i], "binary") == 0) {
+                config.stats_format = STATS_SINK_BINARY;
+            } else {
+                printf("Unknown stats format '%s' (expected csv or binary)\n", argv[i]);
+                exit(1);
+            }
+        } else if (strcmp(argv[i], "--compiled-policy") == 0 && i + 1 < argc) {
+            config.compiled_policy_filename = argv[++i];
+        } else if (strcmp(argv[i], "--lambda") == 0 && i + 1 < argc) {
+            config.trace_lambda = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--sweep") == 0 && i + 1 < argc) {
+            config.sweep_filename = argv[++i];
+        } else if (strcmp(argv[i], "--profile-trace") == 0 && i + 1 < argc) {
+            config.profile_trace_filename = argv[++i];
         } else if (strcmp(argv[i], "--help") == 0) {
             printf("Q-Learning Training Options:\n");
             printf("  --episodes N        Number of training episodes (default: 1000)\n");
@@ -526,6 +1083,30 @@ TrainingConfig parse_arguments(int argc, char* argv[]) {
             printf("  --no-save           Don't save learned policy\n");
             printf("  --quiet             Don't print progress during training\n");
             printf("  --policy-file FILE  Filename for saved policy (default: learned_policy.txt)\n");
+            printf("  --optimized-qtable  Store Q-values in the flat, cached OptimizedQTable\n");
+            printf("  --row-qtable        Store Q-values in per-state rows (default unless built with OPTIMIZED_QTABLE=1)\n");
+            printf("  --mapped-qtable FILE Keep the Q-table in a memory-mapped file (reused if it exists)\n");
+            printf("  --compress-qtable   Save Q-table checkpoints run-length encoded (smaller, not mappable)\n");
+            printf("  --checkpoint-every N Write a background checkpoint every N episodes\n");
+            printf("  --checkpoint-seconds T Write a background checkpoint every T seconds\n");
+            printf("  --checkpoint-keep K Keep the newest K checkpoints (FILE, FILE.1, ...; default: 3)\n");
+            printf("  --checkpoint-file FILE Checkpoint filename (default: qtable.ckpt)\n");
+            printf("  --threads N         Train headless with N worker threads (default: 1)\n");
+            printf("  --parallel-mode M   hogwild (shared lock-free table) or merge (per-worker tables, default: hogwild)\n");
+            printf("  --merge-interval N  Episodes per worker between merges in merge mode (default: 10)\n");
+            printf("  --scaling-report    Report episodes/sec for 1, 2, 4, ... --threads workers\n");
+            printf("  --relayout-interval N Reorder Q-table rows by visit count every N episodes (optimized storage)\n");
+            printf("  --transition-table  Step the environment through a precompiled transition table\n");
+            printf("  --action-noise P    Replace the chosen action with a random one with probability P\n");
+            printf("  --plan              Solve the grid with value iteration first (--episodes 0 to only plan)\n");
+            printf("  --render-thread     With --visualize, train at full speed and render snapshots at 60 FPS\n");
+            printf("  --batched-render    With --visualize, draw the grid and Q heatmap as textures (large grids)\n");
+            printf("  --stats-file FILE   Per-episode statistics log (default: performance_data.csv)\n");
+            printf("  --stats-format F    csv or binary fixed-size records (default: csv)\n");
+            printf("  --compiled-policy FILE Save the greedy policy packed 2 bits per state for serving\n");
+            printf("  --lambda L          Q(lambda) with sparse eligibility traces decaying by gamma * L (single-threaded)\n");
+            printf("  --sweep FILE        Run the hyperparameter sweep in FILE on fresh agents instead of training\n");
+            printf("  --profile-trace FILE Write a Chrome trace of the hot paths (needs make PROFILE=1)\n");
             printf("  --help              Show this help message\n");
             exit(0);
         }
@@ -580,9 +1161,25 @@ int main(int argc, char* argv[]) {
     set_cell(world, world->goal_pos.x, world->goal_pos.y, CELL_GOAL);
     set_cell(world, world->start_pos.x, world->start_pos.y, CELL_START);
     
+    // Optional slippery moves and compiled stepping (built after the layout is final)
+    world->stochastic = config.action_noise > 0.0f;
+    world->action_noise = config.action_noise > 1.0f ? 1.0f : config.action_noise;
+    if (config.transition_table && !set_transition_table(world, true)) {
+        printf("Note: transition table unavailable; stepping directly\n");
+    }
+    
     // Create Q-learning agent
     int num_states = GRID_WIDTH * GRID_HEIGHT;
-    QLearningAgent* agent = create_agent(num_states, NUM_ACTIONS, 0.1f, 0.9f, 1.0f);
+    QTableStorage storage = config.use_optimized_qtable ? QTABLE_STORAGE_OPTIMIZED : QTABLE_STORAGE_ROWS;
+    QLearningAgent* agent = NULL;
+    if (config.mapped_qtable_filename) {
+        // Reopen an existing table in place (pages load on demand) or start a new zero-filled one
+        bool create_new = !file_exists(config.mapped_qtable_filename);
+        agent = create_agent_mapped(config.mapped_qtable_filename, num_states, NUM_ACTIONS, 0.1f, 0.9f, 1.0f,
+                                    create_new);
+    } else {
+        agent = create_agent_with_storage(num_states, NUM_ACTIONS, 0.1f, 0.9f, 1.0f, storage);
+    }
     if (!agent) {
         printf("Error: Failed to create agent\n");
         destroy_grid_world(world);
@@ -593,12 +1190,28 @@ int main(int argc, char* argv[]) {
     agent->epsilon_decay = 0.995f;
     agent->epsilon_min = 0.01f;
     
+    // Traces belong to one trainer thread; hogwild workers would race on them
+    if (config.trace_lambda >= 0.0f) {
+        if (config.num_threads > 1 || config.scaling_report) {
+            printf("Note: eligibility traces are single-threaded; ignoring --lambda with --threads\n");
+        } else if (!enable_eligibility_traces(agent, config.trace_lambda, 0)) {
+            destroy_agent(agent);
+            destroy_grid_world(world);
+            return -1;
+        }
+    }
+    
     printf("Agent created with parameters:\n");
     printf("  Learning rate: %.3f\n", agent->learning_rate);
     printf("  Discount factor: %.3f\n", agent->discount_factor);
     printf("  Initial epsilon: %.3f\n", agent->epsilon);
     printf("  Epsilon decay: %.3f\n", agent->epsilon_decay);
     printf("  Minimum epsilon: %.3f\n", agent->epsilon_min);
+    if (agent->traces) {
+        printf("  Eligibility traces: lambda %.3f, up to %d active\n", agent->traces->lambda, agent->traces->capacity);
+    }
+    printf("  Q-table storage: %s\n", agent->mapped_table ? "memory-mapped file" :
+                                    agent->optimized_table ? "optimized (flat, cached)" : "rows");
     
     // Validate environment
     if (!validate_environment(world)) {
@@ -610,8 +1223,85 @@ int main(int argc, char* argv[]) {
     
     print_environment_info(world);
     
+    // A sweep trains its own agents; the one created above is left untouched
+    if (config.sweep_filename) {
+        bool swept = run_sweep_from_file(world, &config);
+        destroy_agent(agent);
+        destroy_grid_world(world);
+        return swept ? 0 : -1;
+    }
+    
+    // Warm start from the exact solution of the known grid (uses --threads for the sweeps)
+    if (config.plan_first) {
+        PlanningConfig planning_config = create_default_planning_config(agent);
+        planning_config.num_threads = config.num_threads;
+        planning_config.print_progress = true;
+        run_value_iteration(world, agent, &planning_config);
+    }
+    
+    // Hot-path counters (and the trace buffers) start with the training run
+    if (PROFILE_ENABLED) {
+        profile_init(config.profile_trace_filename ? PROFILE_TRACE_EVENTS : 0);
+    } else if (config.profile_trace_filename) {
+        printf("Note: built without profiling (make PROFILE=1); ignoring --profile-trace\n");
+    }
+    
     // Run training
-    run_training(world, agent, &config);
+    if (config.num_threads > 1 && config.enable_visualization) {
+        printf("Note: visualization runs single-threaded; ignoring --threads %d\n", config.num_threads);
+        config.num_threads = 1;
+    }
+    
+    if (config.num_episodes <= 0) {
+        // Nothing to train (e.g. --plan --episodes 0); keep whatever the table holds
+        if (config.plan_first && config.save_policy && config.policy_filename) {
+            save_policy_to_file(agent, world, config.policy_filename);
+        }
+    } else if (config.scaling_report || config.num_threads > 1) {
+        ParallelTrainingConfig parallel_config = create_default_parallel_config();
+        parallel_config.num_threads = config.num_threads;
+        parallel_config.num_episodes = config.num_episodes;
+        parallel_config.max_steps_per_episode = config.max_steps_per_episode;
+        parallel_config.mode = config.parallel_mode;
+        parallel_config.merge_interval = config.merge_interval;
+        parallel_config.seed = (unsigned int)time(NULL);
+        parallel_config.print_progress = config.print_progress;
+        
+        if (config.scaling_report) {
+            run_parallel_scaling_report(world, agent, &parallel_config, config.num_threads);
+        } else {
+            run_parallel_training(world, agent, &parallel_config);
+        }
+        
+        if (config.save_policy && config.policy_filename) {
+            save_policy_to_file(agent, world, config.policy_filename);
+        }
+    } else if (config.enable_visualization && config.render_thread) {
+        run_training_with_render_thread(world, agent, &config);
+    } else {
+        if (config.render_thread) {
+            printf("Note: --render-thread only applies with --visualize; ignoring it\n");
+        }
+        run_training(world, agent, &config);
+    }
+    
+    if (config.compiled_policy_filename) {
+        save_compiled_policy_file(agent, config.compiled_policy_filename);
+    }
+    
+    if (agent->mapped_table) {
+        if (sync_agent_q_table(agent)) {
+            printf("Mapped Q-table checkpointed to %s\n", config.mapped_qtable_filename);
+        }
+    }
+    
+    if (PROFILE_ENABLED) {
+        profile_print_summary("Run profile", false);
+        if (config.profile_trace_filename && profile_write_trace(config.profile_trace_filename)) {
+            printf("Profile trace written to %s\n", config.profile_trace_filename);
+        }
+        profile_shutdown();
+    }
     
     printf("\nTraining session completed successfully!\n");
     
@@ -0,0 +1,278 @@
+#define _POSIX_C_SOURCE 200809L  // posix_memalign
+
+#include "memory_arena.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MEMORY_DEFAULT_BLOCK_SIZE ((size_t)1 << 20)
+#define MEMORY_MIN_ALIGNMENT 16
+
+// Precedes every pointer handed out, so memory_free needs no other context
+typedef struct {
+    size_t size;                // Bytes requested
+    uint32_t offset;            // Heap: user pointer minus the malloc'd base
+    uint16_t subsystem;
+    uint16_t in_arena;
+} MemoryHeader;
+
+static __thread MemoryArena* current_arena = NULL;
+static size_t heap_bytes[NUM_MEMORY_SUBSYSTEMS];    // Modified atomically
+
+static inline MemoryHeader* header_of(const void* ptr) {
+    return (MemoryHeader*)((unsigned char*)ptr - sizeof(MemoryHeader));
+}
+
+static inline uintptr_t align_up(uintptr_t value, size_t alignment) {
+    return (value + alignment - 1) & ~(uintptr_t)(alignment - 1);
+}
+
+MemoryArena* create_memory_arena(size_t block_size, size_t limit) {
+    MemoryArena* arena = (MemoryArena*)calloc(1, sizeof(MemoryArena));
+    if (!arena) {
+        fprintf(stderr, "Error: Failed to allocate memory arena\n");
+        return NULL;
+    }
+    arena->block_size = block_size > 0 ? block_size : MEMORY_DEFAULT_BLOCK_SIZE;
+    arena->limit = limit;
+    return arena;
+}
+
+void destroy_memory_arena(MemoryArena* arena) {
+    if (!arena) return;
+
+    if (current_arena == arena) {
+        current_arena = NULL;
+    }
+    MemoryArenaBlock* block = arena->first;
+    while (block) {
+        MemoryArenaBlock* next = block->next;
+        free(block);
+        block = next;
+    }
+    free(arena);
+}
+
+void reset_memory_arena(MemoryArena* arena) {
+    if (!arena) return;
+
+    for (MemoryArenaBlock* block = arena->first; block; block = block->next) {
+        block->used = 0;
+    }
+    arena->current = arena->first;
+    memset(arena->used, 0, sizeof(arena->used));
+    arena->allocations = 0;
+}
+
+MemoryArena* set_memory_arena(MemoryArena* arena) {
+    MemoryArena* previous = current_arena;
+    current_arena = arena;
+    return previous;
+}
+
+MemoryArena* get_memory_arena(void) {
+    return current_arena;
+}
+
+// Header and aligned payload from the unused tail of block, or NULL
+static void* carve_block(MemoryArenaBlock* block, size_t size, size_t alignment) {
+    uintptr_t base = (uintptr_t)block->data;
+    uintptr_t user = align_up(base + block->used + sizeof(MemoryHeader), alignment);
+    if (user - base > block->size || size > block->size - (user - base)) {
+        return NULL;
+    }
+    block->used = user - base + size;
+    return (void*)user;
+}
+
+static void* arena_alloc(MemoryArena* arena, MemorySubsystem subsystem, size_t size, size_t alignment) {
+    void* user = NULL;
+    for (MemoryArenaBlock* block = arena->current; block && !user; block = block->next) {
+        user = carve_block(block, size, alignment);
+        if (user) arena->current = block;
+    }
+
+    if (!user) {
+        size_t needed = size + alignment + sizeof(MemoryHeader);
+        size_t block_bytes = needed > arena->block_size ? needed : arena->block_size;
+        if (arena->limit > 0 && arena->reserved + block_bytes > arena->limit) {
+            fprintf(stderr, "Error: Memory arena limit of %zu bytes exceeded (%s needs %zu more)\n",
+                    arena->limit, memory_subsystem_name(subsystem), size);
+            return NULL;
+        }
+        MemoryArenaBlock* block = (MemoryArenaBlock*)malloc(sizeof(MemoryArenaBlock) + block_bytes);
+        if (!block) {
+            fprintf(stderr, "Error: Failed to allocate memory arena block\n");
+            return NULL;
+        }
+        block->size = block_bytes;
+        block->used = 0;
+        // Insert after the current block so the empty blocks behind it stay in line
+        if (arena->current) {
+            block->next = arena->current->next;
+            arena->current->next = block;
+        } else {
+            block->next = arena->first;
+            arena->first = block;
+        }
+        arena->current = block;
+        arena->reserved += block_bytes;
+        user = carve_block(block, size, alignment);
+    }
+
+    MemoryHeader* header = header_of(user);
+    header->size = size;
+    header->offset = 0;
+    header->subsystem = (uint16_t)subsystem;
+    header->in_arena = 1;
+
+    arena->used[subsystem] += size;
+    arena->allocations++;
+    size_t total = memory_arena_used(arena);
+    if (total > arena->peak_used) {
+        arena->peak_used = total;
+    }
+    return user;
+}
+
+static void* heap_alloc(MemorySubsystem subsystem, size_t size, size_t alignment, bool zero) {
+    size_t offset = alignment > sizeof(MemoryHeader) ? alignment : sizeof(MemoryHeader);
+    if (size > SIZE_MAX - offset) return NULL;
+
+    void* base = NULL;
+    if (alignment > MEMORY_MIN_ALIGNMENT) {
+        if (posix_memalign(&base, alignment, offset + size) != 0) {
+            base = NULL;
+        } else if (zero) {
+            memset(base, 0, offset + size);
+        }
+    } else {
+        base = zero ? calloc(1, offset + size) : malloc(offset + size);
+    }
+    if (!base) return NULL;
+
+    void* user = (unsigned char*)base + offset;
+    MemoryHeader* header = header_of(user);
+    header->size = size;
+    header->offset = (uint32_t)offset;
+    header->subsystem = (uint16_t)subsystem;
+    header->in_arena = 0;
+    __atomic_add_fetch(&heap_bytes[subsystem], size, __ATOMIC_RELAXED);
+    return user;
+}
+
+void* memory_alloc_aligned(MemorySubsystem subsystem, size_t size, size_t alignment) {
+    if ((int)subsystem < 0 || subsystem >= NUM_MEMORY_SUBSYSTEMS || (alignment & (alignment - 1)) != 0) {
+        return NULL;
+    }
+    if (alignment < MEMORY_MIN_ALIGNMENT) {
+        alignment = MEMORY_MIN_ALIGNMENT;
+    }
+    if (current_arena) {
+        return arena_alloc(current_arena, subsystem, size, alignment);
+    }
+    return heap_alloc(subsystem, size, alignment, false);
+}
+
+void* memory_alloc(MemorySubsystem subsystem, size_t size) {
+    return memory_alloc_aligned(subsystem, size, MEMORY_MIN_ALIGNMENT);
+}
+
+void* memory_calloc(MemorySubsystem subsystem, size_t count, size_t size) {
+    if (size > 0 && count > SIZE_MAX / size) return NULL;
+    if ((int)subsystem < 0 || subsystem >= NUM_MEMORY_SUBSYSTEMS) return NULL;
+
+    if (current_arena) {
+        // Blocks are reused after a reset, so arena memory is not zero
+        void* ptr = arena_alloc(current_arena, subsystem, count * size, MEMORY_MIN_ALIGNMENT);
+        if (ptr) memset(ptr, 0, count * size);
+        return ptr;
+    }
+    return heap_alloc(subsystem, count * size, MEMORY_MIN_ALIGNMENT, true);
+}
+
+void* memory_realloc(MemorySubsystem subsystem, void* ptr, size_t size) {
+    if (!ptr) return memory_alloc(subsystem, size);
+
+    MemoryHeader* header = header_of(ptr);
+    size_t old_size = header->size;
+    void* user = NULL;
+    if (header->in_arena) {
+        user = memory_alloc(subsystem, size);   // Wherever this thread allocates now
+    } else if (header->offset == sizeof(MemoryHeader)) {
+        // Heap memory stays on the heap, so it never ends up tied to an arena's lifetime
+        MemorySubsystem owner = (MemorySubsystem)header->subsystem;
+        if (size > SIZE_MAX - sizeof(MemoryHeader)) return NULL;
+        void* base = realloc((unsigned char*)ptr - sizeof(MemoryHeader), sizeof(MemoryHeader) + size);
+        if (!base) return NULL;
+        user = (unsigned char*)base + sizeof(MemoryHeader);
+        header_of(user)->size = size;
+        __atomic_add_fetch(&heap_bytes[owner], size, __ATOMIC_RELAXED);
+        __atomic_sub_fetch(&heap_bytes[owner], old_size, __ATOMIC_RELAXED);
+        return user;
+    } else {
+        user = heap_alloc(subsystem, size, header->offset, false);
+    }
+
+    if (!user) return NULL;
+    memcpy(user, ptr, old_size < size ? old_size : size);
+    memory_free(ptr);
+    return user;
+}
+
+void memory_free(void* ptr) {
+    if (!ptr) return;
+
+    MemoryHeader* header = header_of(ptr);
+    if (header->in_arena) return;   // Reclaimed when the arena is reset
+    __atomic_sub_fetch(&heap_bytes[header->subsystem], header->size, __ATOMIC_RELAXED);
+    free((unsigned char*)ptr - header->offset);
+}
+
+bool memory_from_arena(const void* ptr) {
+    return ptr && header_of(ptr)->in_arena;
+}
+
+size_t memory_heap_bytes(MemorySubsystem subsystem) {
+    if ((int)subsystem < 0 || subsystem >= NUM_MEMORY_SUBSYSTEMS) return 0;
+    return __atomic_load_n(&heap_bytes[subsystem], __ATOMIC_RELAXED);
+}
+
+size_t memory_arena_used(const MemoryArena* arena) {
+    if (!arena) return 0;
+
+    size_t total = 0;
+    for (int s = 0; s < NUM_MEMORY_SUBSYSTEMS; s++) {
+        total += arena->used[s];
+    }
+    return total;
+}
+
+const char* memory_subsystem_name(MemorySubsystem subsystem) {
+    switch (subsystem) {
+        case MEMORY_AGENT:       return "agent";
+        case MEMORY_ENVIRONMENT: return "environment";
+        case MEMORY_STATS:       return "stats";
+        case MEMORY_REPLAY:      return "replay";
+        case MEMORY_VISITS:      return "visits";
+        default:                 return "unknown";
+    }
+}
+
+void print_memory_usage(const MemoryArena* arena) {
+    printf("\nMemory Usage:\n");
+    printf("=============\n");
+    printf("%-12s %14s%s\n", "Subsystem", "Heap bytes", arena ? "    Arena bytes" : "");
+    for (int s = 0; s < NUM_MEMORY_SUBSYSTEMS; s++) {
+        printf("%-12s %14zu", memory_subsystem_name((MemorySubsystem)s), memory_heap_bytes((MemorySubsystem)s));
+        if (arena) {
+            printf(" %14zu", arena->used[s]);
+        }
+        printf("\n");
+    }
+    if (arena) {
+        printf("Arena: %zu allocations, %zu bytes reserved, peak %zu bytes used\n",
+               arena->allocations, arena->reserved, arena->peak_used);
+    }
+}
@@ -0,0 +1,472 @@
+#define _POSIX_C_SOURCE 200809L  // clock_gettime
+
+#include "parallel_training.h"
+#include "profiler.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+// State shared by all workers of one run
+typedef struct {
+    QLearningAgent* shared;             // Table being trained
+    QLearningAgent** local_tables;      // Per-worker tables (PARALLEL_MODE_MERGE only)
+    const ParallelTrainingConfig* config;
+    int num_threads;
+    int next_episode;                   // Global episode counter, drives the epsilon schedule
+    float epsilon_start;
+    WorkerBarrier barrier;
+} ParallelContext;
+
+// Per-thread state; statistics are only read after the thread is joined
+typedef struct {
+    ParallelContext* ctx;
+    int id;
+    pthread_t thread;
+    GridWorld* world;           // Private copy of the environment
+    QLearningAgent* table;      // Shared table (Hogwild) or private table (merge)
+    RandomState rng;            // Private stream (jumped from the run seed), no shared rand() state
+    int episodes;
+    int successes;
+    long long steps;
+    double reward_sum;
+} TrainingWorker;
+
+void worker_barrier_init(WorkerBarrier* barrier, int count) {
+    pthread_mutex_init(&barrier->mutex, NULL);
+    pthread_cond_init(&barrier->cond, NULL);
+    barrier->count = count;
+    barrier->waiting = 0;
+    barrier->generation = 0;
+    barrier->aborted = false;
+}
+
+void worker_barrier_destroy(WorkerBarrier* barrier) {
+    pthread_cond_destroy(&barrier->cond);
+    pthread_mutex_destroy(&barrier->mutex);
+}
+
+// Block until count threads have arrived; the last arrival releases everyone
+bool worker_barrier_wait(WorkerBarrier* barrier) {
+    pthread_mutex_lock(&barrier->mutex);
+    unsigned int generation = barrier->generation;
+    if (!barrier->aborted) {
+        if (++barrier->waiting == barrier->count) {
+            barrier->waiting = 0;
+            barrier->generation++;
+            pthread_cond_broadcast(&barrier->cond);
+        } else {
+            while (generation == barrier->generation && !barrier->aborted) {
+                pthread_cond_wait(&barrier->cond, &barrier->mutex);
+            }
+        }
+    }
+    bool released = !barrier->aborted;
+    pthread_mutex_unlock(&barrier->mutex);
+    return released;
+}
+
+void worker_barrier_abort(WorkerBarrier* barrier) {
+    pthread_mutex_lock(&barrier->mutex);
+    barrier->aborted = true;
+    pthread_cond_broadcast(&barrier->cond);
+    pthread_mutex_unlock(&barrier->mutex);
+}
+
+static double wall_time_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// Epsilon after `episode` global episodes, matching repeated decay_epsilon() calls
+static float epsilon_for_episode(QLearningAgent* agent, float epsilon_start, int episode) {
+    float epsilon = epsilon_start * powf(agent->epsilon_decay, (float)episode);
+    return epsilon > agent->epsilon_min ? epsilon : agent->epsilon_min;
+}
+
+// Row scans go through get_q_value() rather than the agent's max/argmax caches:
+// under Hogwild other threads write the row concurrently, and filling a cache
+// entry from a torn read would leave it marked valid with a stale value.
+static int worker_greedy_action(QLearningAgent* table, int state) {
+    int best_action = 0;
+    float best_q = get_q_value(table, state, 0);
+    for (int a = 1; a < table->num_actions; a++) {
+        float q = get_q_value(table, state, (Action)a);
+        if (q > best_q) {
+            best_q = q;
+            best_action = a;
+        }
+    }
+    return best_action;
+}
+
+static float worker_max_q(QLearningAgent* table, int state) {
+    return get_q_value(table, state, (Action)worker_greedy_action(table, state));
+}
+
+static Action worker_select_action(TrainingWorker* worker, int state, float epsilon) {
+    if (random_next_float(&worker->rng) < epsilon) {
+        return (Action)random_next_bounded(&worker->rng, (uint32_t)worker->table->num_actions);
+    }
+    return (Action)worker_greedy_action(worker->table, state);
+}
+
+// Same update as update_q_value(), without touching shared agent fields
+static void worker_update(QLearningAgent* table, int state, Action action, float reward, int next_state, bool done) {
+    float current_q = get_q_value(table, state, action);
+    float max_next_q = done ? 0.0f : worker_max_q(table, next_state);
+    float td_error = reward + table->discount_factor * max_next_q - current_q;
+    set_q_value(table, state, action, current_q + table->learning_rate * td_error);
+}
+
+static int claim_episode(ParallelContext* ctx) {
+    return __atomic_fetch_add(&ctx->next_episode, 1, __ATOMIC_RELAXED);
+}
+
+// Run one episode; `episode` is the global episode index used for the epsilon schedule
+static void worker_run_episode(TrainingWorker* worker, int episode) {
+    ParallelContext* ctx = worker->ctx;
+    GridWorld* world = worker->world;
+    float epsilon = epsilon_for_episode(ctx->shared, ctx->epsilon_start, episode);
+
+    reset_environment(world);
+
+    float episode_reward = 0.0f;
+    int steps_taken = 0;
+    while (!world->episode_done && steps_taken < ctx->config->max_steps_per_episode) {
+        int state = get_state_index(world);
+        PROFILE_BEGIN(PROFILE_ACTION_SELECT);
+        Action action = worker_select_action(worker, state, epsilon);
+        PROFILE_END(PROFILE_ACTION_SELECT);
+
+        PROFILE_BEGIN(PROFILE_ENV_STEP);
+        StepResult result = step_environment(world, action);
+        PROFILE_END(PROFILE_ENV_STEP);
+
+        PROFILE_BEGIN(PROFILE_Q_UPDATE);
+        worker_update(worker->table, state, action, result.reward, result.next_state.state_index, result.done);
+        PROFILE_END(PROFILE_Q_UPDATE);
+
+        episode_reward += result.reward;
+        steps_taken++;
+    }
+
+    worker->episodes++;
+    worker->steps += steps_taken;
+    worker->reward_sum += episode_reward;
+    if (world->agent_pos.x == world->goal_pos.x && world->agent_pos.y == world->goal_pos.y) {
+        worker->successes++;
+    }
+}
+
+// Hogwild: claim episodes from the global counter until the budget is spent
+static void* hogwild_worker_main(void* arg) {
+    TrainingWorker* worker = (TrainingWorker*)arg;
+    ParallelContext* ctx = worker->ctx;
+    int total = ctx->config->num_episodes;
+
+    for (int episode = claim_episode(ctx); episode < total; episode = claim_episode(ctx)) {
+        worker_run_episode(worker, episode);
+    }
+    return NULL;
+}
+
+// Merge: fixed per-worker quota split into rounds. After each round every
+// worker averages its slice of states into the shared table, then reloads its
+// private table from the merged result.
+static void* merge_worker_main(void* arg) {
+    TrainingWorker* worker = (TrainingWorker*)arg;
+    ParallelContext* ctx = worker->ctx;
+    int total = ctx->config->num_episodes;
+    int threads = ctx->num_threads;
+
+    int quota = total / threads + (worker->id < total % threads ? 1 : 0);
+    int max_quota = total / threads + (total % threads ? 1 : 0);
+    int interval = ctx->config->merge_interval > 0 ? ctx->config->merge_interval : max_quota;
+    int rounds = max_quota > 0 ? (max_quota + interval - 1) / interval : 0;
+
+    int num_states = ctx->shared->num_states;
+    int state_begin = (int)((long long)num_states * worker->id / threads);
+    int state_end = (int)((long long)num_states * (worker->id + 1) / threads);
+
+    int done = 0;
+    for (int round = 0; round < rounds; round++) {
+        int round_episodes = quota - done < interval ? quota - done : interval;
+        for (int i = 0; i < round_episodes; i++) {
+            worker_run_episode(worker, claim_episode(ctx));
+        }
+        done += round_episodes;
+
+        if (!worker_barrier_wait(&ctx->barrier)) break;
+        average_q_tables(ctx->shared, ctx->local_tables, threads, state_begin, state_end);
+        if (!worker_barrier_wait(&ctx->barrier)) break;
+        copy_q_table(worker->table, ctx->shared);
+    }
+    return NULL;
+}
+
+// Configuration helpers
+ParallelTrainingConfig create_default_parallel_config(void) {
+    ParallelTrainingConfig config = {
+        .num_threads = 4,
+        .num_episodes = 1000,
+        .max_steps_per_episode = 200,
+        .mode = PARALLEL_MODE_HOGWILD,
+        .merge_interval = 10,
+        .seed = 12345,
+        .print_progress = true
+    };
+    return config;
+}
+
+const char* parallel_mode_name(ParallelTrainingMode mode) {
+    switch (mode) {
+        case PARALLEL_MODE_HOGWILD: return "hogwild";
+        case PARALLEL_MODE_MERGE:   return "merge";
+        default:                    return "unknown";
+    }
+}
+
+bool parse_parallel_mode(const char* name, ParallelTrainingMode* mode) {
+    if (!name || !mode) return false;
+    if (strcmp(name, "hogwild") == 0) {
+        *mode = PARALLEL_MODE_HOGWILD;
+        return true;
+    }
+    if (strcmp(name, "merge") == 0) {
+        *mode = PARALLEL_MODE_MERGE;
+        return true;
+    }
+    return false;
+}
+
+// Private tables and snapshots stay in memory even when the shared table is file-backed
+static QTableStorage in_memory_storage(QTableStorage storage) {
+    return storage == QTABLE_STORAGE_MAPPED ? QTABLE_STORAGE_OPTIMIZED : storage;
+}
+
+static void destroy_workers(TrainingWorker* workers, int count) {
+    for (int i = 0; i < count; i++) {
+        destroy_grid_world(workers[i].world);
+        if (workers[i].table && workers[i].table != workers[i].ctx->shared) {
+            destroy_agent(workers[i].table);
+        }
+    }
+    free(workers);
+}
+
+// Run parallel training and write the learned table and final epsilon back to agent
+ParallelTrainingResult run_parallel_training(GridWorld* world, QLearningAgent* agent,
+                                             const ParallelTrainingConfig* config) {
+    ParallelTrainingResult result;
+    memset(&result, 0, sizeof(result));
+
+    if (!world || !agent || !config) {
+        fprintf(stderr, "Error: Invalid parameters for parallel training\n");
+        return result;
+    }
+    if (config->num_threads < 1 || config->num_episodes < 0) {
+        fprintf(stderr, "Error: Parallel training needs at least one thread and a non-negative episode count\n");
+        return result;
+    }
+
+    int threads = config->num_threads;
+    bool merge_mode = (config->mode == PARALLEL_MODE_MERGE);
+    bool env_verbose = is_environment_verbose();
+    set_environment_verbose(false);
+
+    ParallelContext ctx = {
+        .shared = agent,
+        .local_tables = NULL,
+        .config = config,
+        .num_threads = threads,
+        .next_episode = 0,
+        .epsilon_start = agent->epsilon
+    };
+    worker_barrier_init(&ctx.barrier, threads);
+
+    TrainingWorker* workers = (TrainingWorker*)calloc(threads, sizeof(TrainingWorker));
+    if (merge_mode) {
+        ctx.local_tables = (QLearningAgent**)calloc(threads, sizeof(QLearningAgent*));
+    }
+    if (!workers || (merge_mode && !ctx.local_tables)) {
+        fprintf(stderr, "Error: Failed to allocate parallel training workers\n");
+        free(workers);
+        free(ctx.local_tables);
+        worker_barrier_destroy(&ctx.barrier);
+        set_environment_verbose(env_verbose);
+        return result;
+    }
+
+    // Worker i gets the run seed's stream jumped i times: non-overlapping and reproducible
+    RandomState stream;
+    seed_random(&stream, config->seed);
+
+    int prepared = 0;
+    for (int i = 0; i < threads; i++, prepared++) {
+        TrainingWorker* worker = &workers[i];
+        worker->ctx = &ctx;
+        worker->id = i;
+        worker->rng = stream;
+        random_jump(&stream);
+        worker->world = clone_grid_world(world);
+        if (!worker->world) break;
+        worker->world->max_steps = world->max_steps;
+        seed_environment(worker->world, config->seed + 0x9E3779B9u * (unsigned int)(i + 1));
+
+        if (merge_mode) {
+            worker->table = create_agent_with_storage(agent->num_states, agent->num_actions, agent->learning_rate,
+                                                      agent->discount_factor, agent->epsilon,
+                                                      in_memory_storage(agent->storage));
+            if (!worker->table) {
+                destroy_grid_world(worker->world);
+                break;
+            }
+            copy_q_table(worker->table, agent);
+            ctx.local_tables[i] = worker->table;
+        } else {
+            worker->table = agent;
+        }
+    }
+    if (prepared < threads) {
+        fprintf(stderr, "Error: Failed to prepare parallel training worker %d\n", prepared);
+        destroy_workers(workers, prepared);
+        free(ctx.local_tables);
+        worker_barrier_destroy(&ctx.barrier);
+        set_environment_verbose(env_verbose);
+        return result;
+    }
+
+    // Hogwild workers store into the shared table concurrently, so the
+    // agent's running bounds and moments are switched off while they run and
+    // rebuilt by the next get_q_value_bounds / calculate_q_value_variance
+    bool track_bounds = agent->q_bounds.tracking;
+    bool track_moments = agent->q_moments.tracking;
+    if (!merge_mode) {
+        agent->q_bounds.tracking = false;
+        agent->q_moments.tracking = false;
+    }
+
+    double start_time = wall_time_seconds();
+
+    int started = 0;
+    for (int i = 0; i < threads; i++) {
+        if (pthread_create(&workers[i].thread, NULL, merge_mode ? merge_worker_main : hogwild_worker_main,
+                           &workers[i]) != 0) {
+            break;
+        }
+        started++;
+    }
+    if (started < threads && merge_mode) {
+        // Merge workers rendezvous at barriers, so a partial team would deadlock
+        fprintf(stderr, "Error: Failed to start all parallel training threads\n");
+        worker_barrier_abort(&ctx.barrier);
+        for (int i = 0; i < started; i++) {
+            pthread_join(workers[i].thread, NULL);
+        }
+        destroy_workers(workers, threads);
+        free(ctx.local_tables);
+        worker_barrier_destroy(&ctx.barrier);
+        set_environment_verbose(env_verbose);
+        return result;
+    }
+    for (int i = 0; i < started; i++) {
+        pthread_join(workers[i].thread, NULL);
+    }
+
+    double elapsed = wall_time_seconds() - start_time;
+
+    // Aggregate worker statistics
+    double reward_sum = 0.0;
+    result.num_threads = threads;
+    for (int i = 0; i < started; i++) {
+        result.episodes_completed += workers[i].episodes;
+        result.successful_episodes += workers[i].successes;
+        result.total_steps += workers[i].steps;
+        reward_sum += workers[i].reward_sum;
+    }
+    result.avg_reward = result.episodes_completed > 0 ? (float)(reward_sum / result.episodes_completed) : 0.0f;
+    result.elapsed_seconds = elapsed;
+    result.episodes_per_second = elapsed > 0.0 ? result.episodes_completed / elapsed : 0.0;
+    result.steps_per_second = elapsed > 0.0 ? result.total_steps / elapsed : 0.0;
+
+    agent->epsilon = epsilon_for_episode(agent, ctx.epsilon_start, result.episodes_completed);
+    if (agent->optimized_table) {
+        invalidate_all_caches(agent->optimized_table->qtable);
+    }
+    if (!merge_mode) {
+        agent->q_bounds.tracking = track_bounds;
+        agent->q_bounds.stale = true;
+        agent->q_moments.tracking = track_moments;
+        agent->q_moments.stale = true;
+    }
+
+    if (config->print_progress) {
+        printf("Parallel training (%s, %d threads): %d episodes in %.2f s (%.0f episodes/s, %.0f steps/s)\n",
+               parallel_mode_name(config->mode), threads, result.episodes_completed, elapsed,
+               result.episodes_per_second, result.steps_per_second);
+        printf("  Success rate: %.1f%%, Avg reward: %.2f, Final epsilon: %.3f\n",
+               result.episodes_completed > 0 ? 100.0f * result.successful_episodes / result.episodes_completed : 0.0f,
+               result.avg_reward, agent->epsilon);
+    }
+
+    destroy_workers(workers, threads);
+    free(ctx.local_tables);
+    worker_barrier_destroy(&ctx.barrier);
+    set_environment_verbose(env_verbose);
+    return result;
+}
+
+// Print episodes/sec scaling for 1, 2, 4, ... max_threads workers
+void run_parallel_scaling_report(GridWorld* world, QLearningAgent* agent,
+                                 const ParallelTrainingConfig* config, int max_threads) {
+    if (!world || !agent || !config || max_threads < 1) {
+        fprintf(stderr, "Error: Invalid parameters for scaling report\n");
+        return;
+    }
+
+    // Every run starts from the same table and epsilon
+    QLearningAgent* initial = create_agent_with_storage(agent->num_states, agent->num_actions, agent->learning_rate,
+                                                        agent->discount_factor, agent->epsilon,
+                                                        in_memory_storage(agent->storage));
+    if (!initial) {
+        fprintf(stderr, "Error: Failed to snapshot Q-table for scaling report\n");
+        return;
+    }
+    copy_q_table(initial, agent);
+
+    ParallelTrainingConfig run_config = *config;
+    run_config.print_progress = false;
+
+    printf("\n=== Parallel Scaling Report (%s, %d episodes) ===\n",
+           parallel_mode_name(config->mode), config->num_episodes);
+    printf("Threads | Episodes/s | Steps/s     | Speedup | Efficiency | Success\n");
+    printf("--------|------------|-------------|---------|------------|--------\n");
+
+    double baseline = 0.0;
+    for (int threads = 1; ; threads = threads * 2 < max_threads ? threads * 2 : max_threads) {
+        copy_q_table(agent, initial);
+        agent->epsilon = initial->epsilon;
+        run_config.num_threads = threads;
+
+        ParallelTrainingResult result = run_parallel_training(world, agent, &run_config);
+        if (threads == 1) {
+            baseline = result.episodes_per_second;
+        }
+        double speedup = baseline > 0.0 ? result.episodes_per_second / baseline : 0.0;
+        float success = result.episodes_completed > 0
+                            ? 100.0f * result.successful_episodes / result.episodes_completed : 0.0f;
+
+        printf("%7d | %10.0f | %11.0f | %6.2fx | %9.1f%% | %5.1f%%\n",
+               threads, result.episodes_per_second, result.steps_per_second,
+               speedup, 100.0 * speedup / threads, success);
+
+        if (threads == max_threads) break;
+    }
+    printf("=================================================\n");
+
+    destroy_agent(initial);
+}
@@ -0,0 +1,300 @@
+#define _POSIX_C_SOURCE 200809L  // clock_gettime
+
+#include "planning.h"
+#include "parallel_training.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+// Read-only model plus the sweep state shared by all planning threads
+typedef struct {
+    const int32_t* next_state;  // From the world's transition table
+    float* reward;              // Per state-action reward (outcomes expanded)
+    uint8_t* pinned;            // 1 for walls, obstacles and the goal: value fixed at 0
+    float* values[2];           // Double-buffered state values (Jacobi sweeps)
+    float* q;                   // Q(s, a) from the final values
+    int num_states;
+    float discount;
+    float noise;                // Probability of a uniform random action
+    float tolerance;
+    int max_iterations;
+    int num_threads;
+    float* thread_delta;        // Per-thread max |dV| of the current sweep
+    WorkerBarrier barrier;
+    int iterations;             // Written by thread 0 between barriers
+    float max_delta;
+    bool stop;
+} PlanningContext;
+
+typedef struct {
+    PlanningContext* ctx;
+    int id;
+    int begin, end;             // State range owned by this thread
+    pthread_t thread;
+} PlanningWorker;
+
+static double planning_time_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+PlanningConfig create_default_planning_config(const QLearningAgent* agent) {
+    PlanningConfig config = {
+        .discount_factor = agent ? agent->discount_factor : 0.9f,
+        .tolerance = 1e-4f,
+        .max_iterations = 10000,
+        .num_threads = 1,
+        .print_progress = false
+    };
+    return config;
+}
+
+// Q(s, .) for one state; returns max_a Q(s, a)
+static inline float backup_state_scalar(const PlanningContext* ctx, const float* values, int state, float* q_out) {
+    size_t base = (size_t)state * NUM_ACTIONS;
+    float q[NUM_ACTIONS];
+    float sum = 0.0f;
+    for (int a = 0; a < NUM_ACTIONS; a++) {
+        q[a] = ctx->reward[base + a] + ctx->discount * values[ctx->next_state[base + a]];
+        sum += q[a];
+    }
+
+    // With probability noise the action taken is uniform over all actions
+    float spread = ctx->noise * sum / NUM_ACTIONS;
+    float best = -INFINITY;
+    for (int a = 0; a < NUM_ACTIONS; a++) {
+        q[a] = (1.0f - ctx->noise) * q[a] + spread;
+        if (q[a] > best) best = q[a];
+        if (q_out) q_out[base + a] = q[a];
+    }
+    return best;
+}
+
+#ifdef __SSE2__
+// Four actions per state fit one SSE register
+static inline float backup_state_sse(const PlanningContext* ctx, const float* values, int state, float* q_out) {
+    size_t base = (size_t)state * 4;
+#ifdef __AVX2__
+    __m128 next_values = _mm_i32gather_ps(values, _mm_loadu_si128((const __m128i*)(ctx->next_state + base)), 4);
+#else
+    const int32_t* next = ctx->next_state + base;
+    __m128 next_values = _mm_set_ps(values[next[3]], values[next[2]], values[next[1]], values[next[0]]);
+#endif
+    __m128 q = _mm_add_ps(_mm_loadu_ps(ctx->reward + base), _mm_mul_ps(_mm_set1_ps(ctx->discount), next_values));
+
+    // Broadcast horizontal sum for the noise term
+    __m128 sum = _mm_add_ps(q, _mm_shuffle_ps(q, q, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_ps(sum, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    q = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(1.0f - ctx->noise), q),
+                   _mm_mul_ps(_mm_set1_ps(ctx->noise * 0.25f), sum));
+    if (q_out) {
+        _mm_storeu_ps(q_out + base, q);
+    }
+
+    __m128 best = _mm_max_ps(q, _mm_shuffle_ps(q, q, _MM_SHUFFLE(1, 0, 3, 2)));
+    best = _mm_max_ps(best, _mm_shuffle_ps(best, best, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtss_f32(best);
+}
+#endif
+
+// Bellman backup of states [begin, end) from in into out (and Q into q_out
+// when non-NULL). Returns the largest value change.
+static float backup_range(const PlanningContext* ctx, const float* in, float* out, float* q_out,
+                          int begin, int end) {
+    float delta = 0.0f;
+    for (int s = begin; s < end; s++) {
+        if (ctx->pinned[s]) {
+            out[s] = 0.0f;
+            if (q_out) {
+                memset(q_out + (size_t)s * NUM_ACTIONS, 0, NUM_ACTIONS * sizeof(float));
+            }
+            continue;
+        }
+
+        float v;
+#ifdef __SSE2__
+        if (NUM_ACTIONS == 4) {
+            v = backup_state_sse(ctx, in, s, q_out);
+        } else
+#endif
+        {
+            v = backup_state_scalar(ctx, in, s, q_out);
+        }
+        float change = fabsf(v - in[s]);
+        if (change > delta) delta = change;
+        out[s] = v;
+    }
+    return delta;
+}
+
+// Sweep until every thread agrees the values converged, then emit Q
+static void run_planning_sweeps(PlanningContext* ctx, int id, int begin, int end) {
+    int current = 0;
+    for (int iteration = 0; iteration < ctx->max_iterations; iteration++) {
+        ctx->thread_delta[id] = backup_range(ctx, ctx->values[current], ctx->values[current ^ 1], NULL,
+                                             begin, end);
+        if (!worker_barrier_wait(&ctx->barrier)) return;
+        if (id == 0) {
+            float delta = 0.0f;
+            for (int t = 0; t < ctx->num_threads; t++) {
+                if (ctx->thread_delta[t] > delta) delta = ctx->thread_delta[t];
+            }
+            ctx->iterations = iteration + 1;
+            ctx->max_delta = delta;
+            ctx->stop = delta < ctx->tolerance;
+        }
+        if (!worker_barrier_wait(&ctx->barrier)) return;
+        current ^= 1;
+        if (ctx->stop) break;
+    }
+    backup_range(ctx, ctx->values[current], ctx->values[current ^ 1], ctx->q, begin, end);
+}
+
+static void* planning_worker_main(void* arg) {
+    PlanningWorker* worker = (PlanningWorker*)arg;
+    run_planning_sweeps(worker->ctx, worker->id, worker->begin, worker->end);
+    return NULL;
+}
+
+static void free_planning_context(PlanningContext* ctx) {
+    free(ctx->reward);
+    free(ctx->pinned);
+    free(ctx->values[0]);
+    free(ctx->values[1]);
+    free(ctx->q);
+    free(ctx->thread_delta);
+}
+
+PlanningResult run_value_iteration(GridWorld* world, QLearningAgent* agent, const PlanningConfig* config) {
+    PlanningResult result = {0};
+    if (!world || !agent || !config) {
+        fprintf(stderr, "Error: Invalid parameters for value iteration\n");
+        return result;
+    }
+
+    int num_states = world->width * world->height;
+    if (agent->num_states < num_states || agent->num_actions != NUM_ACTIONS) {
+        fprintf(stderr, "Error: Agent Q-table (%dx%d) does not cover the %dx%d grid\n",
+                agent->num_states, agent->num_actions, num_states, NUM_ACTIONS);
+        return result;
+    }
+    if (config->discount_factor < 0.0f || config->discount_factor >= 1.0f) {
+        fprintf(stderr, "Error: Value iteration needs a discount factor in [0, 1), got %.3f\n",
+                config->discount_factor);
+        return result;
+    }
+
+    // Plan over the compiled model, building a temporary one if needed
+    bool temporary_table = !has_transition_table(world);
+    if (temporary_table && !set_transition_table(world, true)) {
+        return result;
+    }
+    TransitionTable* table = get_transition_table(world);
+
+    int threads = config->num_threads < 1 ? 1 : config->num_threads;
+    if (threads > num_states) threads = num_states;
+
+    size_t transitions = (size_t)num_states * NUM_ACTIONS;
+    PlanningContext ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.next_state = table->next_state;
+    ctx.num_states = num_states;
+    ctx.discount = config->discount_factor;
+    ctx.noise = world->stochastic ? fminf(fmaxf(world->action_noise, 0.0f), 1.0f) : 0.0f;
+    ctx.tolerance = config->tolerance;
+    ctx.max_iterations = config->max_iterations > 0 ? config->max_iterations : 1;
+    ctx.num_threads = threads;
+    ctx.reward = (float*)malloc(transitions * sizeof(float));
+    ctx.pinned = (uint8_t*)malloc((size_t)num_states);
+    ctx.values[0] = (float*)calloc(num_states, sizeof(float));
+    ctx.values[1] = (float*)calloc(num_states, sizeof(float));
+    ctx.q = (float*)malloc(transitions * sizeof(float));
+    ctx.thread_delta = (float*)calloc(threads, sizeof(float));
+    PlanningWorker* workers = (PlanningWorker*)calloc(threads, sizeof(PlanningWorker));
+    if (!ctx.reward || !ctx.pinned || !ctx.values[0] || !ctx.values[1] || !ctx.q ||
+        !ctx.thread_delta || !workers) {
+        fprintf(stderr, "Error: Failed to allocate value iteration buffers\n");
+        free_planning_context(&ctx);
+        free(workers);
+        if (temporary_table) set_transition_table(world, false);
+        return result;
+    }
+
+    for (size_t i = 0; i < transitions; i++) {
+        ctx.reward[i] = table->outcome_reward[table->outcome[i]];
+    }
+    int goal_state = world->goal_pos.y * world->width + world->goal_pos.x;
+    for (int s = 0; s < num_states; s++) {
+        ctx.pinned[s] = (s == goal_state || !is_walkable(world, s % world->width, s / world->width)) ? 1 : 0;
+    }
+
+    double start_time = planning_time_seconds();
+    worker_barrier_init(&ctx.barrier, threads);
+
+    // Contiguous state ranges; the caller runs range 0
+    int chunk = (num_states + threads - 1) / threads;
+    for (int i = 0; i < threads; i++) {
+        workers[i].ctx = &ctx;
+        workers[i].id = i;
+        workers[i].begin = i * chunk < num_states ? i * chunk : num_states;
+        workers[i].end = (i + 1) * chunk < num_states ? (i + 1) * chunk : num_states;
+    }
+    for (int i = 1; i < threads; i++) {
+        if (pthread_create(&workers[i].thread, NULL, planning_worker_main, &workers[i]) != 0) {
+            // Sweeps rendezvous at barriers, so a partial team would deadlock
+            fprintf(stderr, "Error: Failed to start all planning threads\n");
+            worker_barrier_abort(&ctx.barrier);
+            for (int j = 1; j < i; j++) {
+                pthread_join(workers[j].thread, NULL);
+            }
+            worker_barrier_destroy(&ctx.barrier);
+            free_planning_context(&ctx);
+            free(workers);
+            if (temporary_table) set_transition_table(world, false);
+            return result;
+        }
+    }
+    run_planning_sweeps(&ctx, 0, workers[0].begin, workers[0].end);
+    for (int i = 1; i < threads; i++) {
+        pthread_join(workers[i].thread, NULL);
+    }
+    worker_barrier_destroy(&ctx.barrier);
+    double elapsed = planning_time_seconds() - start_time;
+
+    // Hand the planned values to the agent through its normal accessors
+    for (int s = 0; s < num_states; s++) {
+        for (int a = 0; a < NUM_ACTIONS; a++) {
+            set_q_value(agent, s, (Action)a, ctx.q[(size_t)s * NUM_ACTIONS + a]);
+        }
+    }
+
+    result.iterations = ctx.iterations;
+    result.max_delta = ctx.max_delta;
+    result.converged = ctx.stop;
+    result.elapsed_seconds = elapsed;
+    result.backups_per_second = elapsed > 0.0 ? (double)ctx.iterations * transitions / elapsed : 0.0;
+
+    if (config->print_progress) {
+        printf("Value iteration %s after %d sweeps (max delta %.2e, %.3f s, %d thread%s, %.1fM backups/s)\n",
+               result.converged ? "converged" : "stopped", result.iterations, result.max_delta,
+               elapsed, threads, threads == 1 ? "" : "s", result.backups_per_second / 1e6);
+    }
+
+    free_planning_context(&ctx);
+    free(workers);
+    if (temporary_table) {
+        set_transition_table(world, false);
+    }
+    return result;
+}
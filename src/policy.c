@@ -0,0 +1,143 @@
+#include "policy.h"
+#include "memory_arena.h"
+#include "q_table_optimized.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define POLICY_ALIGNMENT 64
+
+// Packed storage for num_states, zeroed, with the struct fields filled in
+static CompiledPolicy* allocate_policy(int num_states, int num_actions) {
+    CompiledPolicy* policy = (CompiledPolicy*)memory_calloc(MEMORY_AGENT, 1, sizeof(CompiledPolicy));
+    if (!policy) {
+        fprintf(stderr, "Error: Failed to allocate memory for compiled policy\n");
+        return NULL;
+    }
+
+    policy->num_states = num_states;
+    policy->num_actions = num_actions;
+    policy->packed_bytes = ((size_t)num_states + 3) / 4;
+    size_t padded = (policy->packed_bytes + POLICY_ALIGNMENT - 1) & ~(size_t)(POLICY_ALIGNMENT - 1);
+    policy->packed = (uint8_t*)memory_alloc_aligned(MEMORY_AGENT, padded, POLICY_ALIGNMENT);
+    if (!policy->packed) {
+        fprintf(stderr, "Error: Failed to allocate %zu bytes for compiled policy\n", padded);
+        memory_free(policy);
+        return NULL;
+    }
+    memset(policy->packed, 0, padded);
+    return policy;
+}
+
+CompiledPolicy* compile_policy(QLearningAgent* agent) {
+    if (!agent || agent->num_states <= 0 || agent->num_actions <= 0 || agent->num_actions > POLICY_MAX_ACTIONS) {
+        fprintf(stderr, "Error: Cannot compile a policy for this agent (at most %d actions)\n", POLICY_MAX_ACTIONS);
+        return NULL;
+    }
+
+    CompiledPolicy* policy = allocate_policy(agent->num_states, agent->num_actions);
+    if (!policy) return NULL;
+
+    // One byte per four states, assembled in a register
+    for (int base = 0; base < agent->num_states; base += 4) {
+        unsigned packed = 0;
+        for (int i = 0; i < 4 && base + i < agent->num_states; i++) {
+            packed |= ((unsigned)select_greedy_action(agent, base + i) & 3u) << (2 * i);
+        }
+        policy->packed[base >> 2] = (uint8_t)packed;
+    }
+    return policy;
+}
+
+void destroy_compiled_policy(CompiledPolicy* policy) {
+    if (!policy) return;
+
+    memory_free(policy->packed);
+    memory_free(policy);
+}
+
+size_t compiled_policy_bytes(const CompiledPolicy* policy) {
+    return policy ? policy->packed_bytes : 0;
+}
+
+void policy_act(const CompiledPolicy* policy, const int* states, int* actions, int n) {
+    if (!policy || !states || !actions) return;
+
+    const uint8_t* packed = policy->packed;
+    unsigned num_states = (unsigned)policy->num_states;
+
+    // Branch-free so the loop vectorizes: out-of-range states read byte 0
+    // and are masked to ACTION_UP
+    for (int i = 0; i < n; i++) {
+        unsigned state = (unsigned)states[i];
+        unsigned valid = state < num_states;
+        unsigned index = valid ? state : 0u;
+        unsigned action = (packed[index >> 2] >> ((index & 3u) << 1)) & 3u;
+        actions[i] = (int)(action & (0u - valid));
+    }
+}
+
+bool save_compiled_policy(const CompiledPolicy* policy, const char* filename) {
+    if (!policy || !filename) return false;
+
+    PolicyFileHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = POLICY_FILE_MAGIC;
+    header.version = POLICY_FILE_VERSION;
+    header.num_states = policy->num_states;
+    header.num_actions = policy->num_actions;
+    header.data_size = policy->packed_bytes;
+    header.data_crc = qtable_crc32(0, policy->packed, policy->packed_bytes);
+
+    FILE* file = fopen(filename, "wb");
+    if (!file) {
+        fprintf(stderr, "Error: Could not open file %s for writing\n", filename);
+        return false;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+              fwrite(policy->packed, 1, policy->packed_bytes, file) == policy->packed_bytes;
+    if (fclose(file) != 0) ok = false;
+    if (!ok) {
+        fprintf(stderr, "Error: Failed to write compiled policy to %s\n", filename);
+    }
+    return ok;
+}
+
+CompiledPolicy* load_compiled_policy(const char* filename) {
+    if (!filename) return NULL;
+
+    FILE* file = fopen(filename, "rb");
+    if (!file) {
+        fprintf(stderr, "Error: Could not open file %s for reading\n", filename);
+        return NULL;
+    }
+
+    PolicyFileHeader header;
+    memset(&header, 0, sizeof(header));
+    if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != POLICY_FILE_MAGIC) {
+        fprintf(stderr, "Error: %s is not a compiled policy file%s\n", filename,
+                header.magic == __builtin_bswap32(POLICY_FILE_MAGIC) ? " for this byte order" : "");
+        fclose(file);
+        return NULL;
+    }
+    if (header.version != POLICY_FILE_VERSION || header.num_states <= 0 || header.num_actions <= 0 ||
+        header.num_actions > POLICY_MAX_ACTIONS || header.data_size != ((uint64_t)header.num_states + 3) / 4) {
+        fprintf(stderr, "Error: Unsupported or corrupt compiled policy header in %s\n", filename);
+        fclose(file);
+        return NULL;
+    }
+
+    CompiledPolicy* policy = allocate_policy(header.num_states, header.num_actions);
+    if (!policy) {
+        fclose(file);
+        return NULL;
+    }
+    bool ok = fread(policy->packed, 1, policy->packed_bytes, file) == policy->packed_bytes;
+    fclose(file);
+    if (!ok || qtable_crc32(0, policy->packed, policy->packed_bytes) != header.data_crc) {
+        fprintf(stderr, "Error: Compiled policy data in %s is truncated or corrupt\n", filename);
+        destroy_compiled_policy(policy);
+        return NULL;
+    }
+    return policy;
+}
@@ -0,0 +1,262 @@
+#define _POSIX_C_SOURCE 200809L  // clock_gettime
+
+#include "profiler.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct {
+    uint64_t start;
+    uint32_t duration;          // Ticks, saturated at UINT32_MAX
+    uint32_t zone;
+} ProfileEvent;
+
+typedef struct {
+    ProfileCounter counters[NUM_PROFILE_ZONES];  // Stored only by the owning thread
+    ProfileCounter reported[NUM_PROFILE_ZONES];  // Counters at the last interval summary
+    ProfileEvent* events;
+    size_t capacity;
+    size_t num_events;          // Published with release ordering
+    uint64_t dropped;
+} ProfileThread;
+
+// Registration, summaries and traces take the lock; records never do
+static pthread_mutex_t registry_lock = PTHREAD_MUTEX_INITIALIZER;
+static ProfileThread* threads[PROFILE_MAX_THREADS];
+static int num_threads = 0;
+static size_t trace_capacity = 0;
+static bool epoch_set = false;
+static uint64_t epoch_ticks = 0;
+static uint64_t epoch_ns = 0;
+static uint64_t interval_start = 0;             // Ticks at the last interval summary
+static unsigned generation = 1;                 // Bumped by profile_shutdown
+
+static __thread ProfileThread* local_thread = NULL;
+static __thread unsigned local_generation = 0;  // Registry generation local_thread belongs to
+
+static const char* zone_names[NUM_PROFILE_ZONES] = {
+    "env_step", "action_select", "q_update", "replay", "render", "stats"
+};
+
+static uint64_t monotonic_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+uint64_t profile_clock_ticks(void) {
+    return monotonic_ns();
+}
+
+const char* profile_zone_name(ProfileZone zone) {
+    return (int)zone >= 0 && zone < NUM_PROFILE_ZONES ? zone_names[zone] : "unknown";
+}
+
+// Caller holds registry_lock
+static void set_epoch(void) {
+    if (epoch_set) return;
+    epoch_ticks = profile_ticks();
+    epoch_ns = monotonic_ns();
+    interval_start = epoch_ticks;
+    epoch_set = true;
+}
+
+// Tick rate measured against the monotonic clock since the epoch. Caller
+// holds registry_lock and the epoch is set.
+static double ticks_per_second(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    uint64_t ticks = profile_ticks();
+    uint64_t ns = monotonic_ns();
+    while (ns - epoch_ns < 1000000) {   // Too short a baseline for a stable rate
+        ticks = profile_ticks();
+        ns = monotonic_ns();
+    }
+    return (double)(ticks - epoch_ticks) * 1e9 / (double)(ns - epoch_ns);
+#else
+    return 1e9;
+#endif
+}
+
+void profile_init(size_t trace_events) {
+    pthread_mutex_lock(&registry_lock);
+    trace_capacity = trace_events;
+    set_epoch();
+    pthread_mutex_unlock(&registry_lock);
+}
+
+void profile_shutdown(void) {
+    pthread_mutex_lock(&registry_lock);
+    for (int i = 0; i < num_threads; i++) {
+        free(threads[i]->events);
+        free(threads[i]);
+        threads[i] = NULL;
+    }
+    num_threads = 0;
+    trace_capacity = 0;
+    epoch_set = false;
+    __atomic_store_n(&generation, generation + 1, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&registry_lock);
+    local_thread = NULL;
+}
+
+// Returns NULL when the registry is full or out of memory; the thread then records nothing
+static ProfileThread* register_thread(void) {
+    pthread_mutex_lock(&registry_lock);
+    set_epoch();
+    ProfileThread* thread = NULL;
+    if (num_threads < PROFILE_MAX_THREADS) {
+        thread = (ProfileThread*)calloc(1, sizeof(ProfileThread));
+        if (thread && trace_capacity > 0) {
+            thread->events = (ProfileEvent*)malloc(trace_capacity * sizeof(ProfileEvent));
+            thread->capacity = thread->events ? trace_capacity : 0;
+        }
+        if (thread) {
+            threads[num_threads++] = thread;
+        }
+    }
+    local_generation = generation;
+    pthread_mutex_unlock(&registry_lock);
+    return thread;
+}
+
+void profile_record(ProfileZone zone, uint64_t start, uint64_t end) {
+    if ((int)zone < 0 || zone >= NUM_PROFILE_ZONES) return;
+
+    ProfileThread* thread = local_thread;
+    if (local_generation != __atomic_load_n(&generation, __ATOMIC_ACQUIRE)) {
+        thread = local_thread = register_thread();
+    }
+    if (!thread) return;
+
+    // Only this thread stores the counters; relaxed stores keep readers from seeing torn values
+    uint64_t ticks = end > start ? end - start : 0;
+    ProfileCounter* counter = &thread->counters[zone];
+    __atomic_store_n(&counter->calls, counter->calls + 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&counter->ticks, counter->ticks + ticks, __ATOMIC_RELAXED);
+    if (ticks > counter->max_ticks) {
+        __atomic_store_n(&counter->max_ticks, ticks, __ATOMIC_RELAXED);
+    }
+
+    if (thread->capacity > 0) {
+        size_t count = thread->num_events;
+        if (count < thread->capacity) {
+            ProfileEvent* event = &thread->events[count];
+            event->start = start;
+            event->duration = ticks > UINT32_MAX ? UINT32_MAX : (uint32_t)ticks;
+            event->zone = (uint32_t)zone;
+            __atomic_store_n(&thread->num_events, count + 1, __ATOMIC_RELEASE);
+        } else {
+            __atomic_store_n(&thread->dropped, thread->dropped + 1, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+ProfileSummary profile_collect(bool interval) {
+    ProfileSummary summary;
+    memset(&summary, 0, sizeof(summary));
+
+    pthread_mutex_lock(&registry_lock);
+    if (!epoch_set) {
+        pthread_mutex_unlock(&registry_lock);
+        return summary;
+    }
+
+    double rate = ticks_per_second();
+    uint64_t now = profile_ticks();
+    uint64_t calls[NUM_PROFILE_ZONES] = {0};
+    uint64_t ticks[NUM_PROFILE_ZONES] = {0};
+    uint64_t max_ticks[NUM_PROFILE_ZONES] = {0};
+    for (int i = 0; i < num_threads; i++) {
+        ProfileThread* thread = threads[i];
+        for (int z = 0; z < NUM_PROFILE_ZONES; z++) {
+            ProfileCounter current = {
+                __atomic_load_n(&thread->counters[z].calls, __ATOMIC_RELAXED),
+                __atomic_load_n(&thread->counters[z].ticks, __ATOMIC_RELAXED),
+                __atomic_load_n(&thread->counters[z].max_ticks, __ATOMIC_RELAXED)
+            };
+            calls[z] += current.calls - (interval ? thread->reported[z].calls : 0);
+            ticks[z] += current.ticks - (interval ? thread->reported[z].ticks : 0);
+            if (current.max_ticks > max_ticks[z]) max_ticks[z] = current.max_ticks;
+            if (interval) {
+                thread->reported[z] = current;
+            }
+        }
+        summary.dropped_events += __atomic_load_n(&thread->dropped, __ATOMIC_RELAXED);
+    }
+
+    for (int z = 0; z < NUM_PROFILE_ZONES; z++) {
+        summary.calls[z] = calls[z];
+        summary.seconds[z] = (double)ticks[z] / rate;
+        summary.max_seconds[z] = (double)max_ticks[z] / rate;
+    }
+    summary.wall_seconds = (double)(now - (interval ? interval_start : epoch_ticks)) / rate;
+    summary.num_threads = num_threads;
+    if (interval) {
+        interval_start = now;
+    }
+    pthread_mutex_unlock(&registry_lock);
+    return summary;
+}
+
+void profile_print_summary(const char* title, bool interval) {
+    ProfileSummary summary = profile_collect(interval);
+
+    printf("=== %s: %.3f s, %d thread%s ===\n", title, summary.wall_seconds,
+           summary.num_threads, summary.num_threads == 1 ? "" : "s");
+    printf("%-14s %12s %12s %10s %10s %8s\n", "Zone", "Calls", "Total ms", "Avg ns", "Max us", "Wall %");
+    for (int z = 0; z < NUM_PROFILE_ZONES; z++) {
+        if (summary.calls[z] == 0) continue;
+        printf("%-14s %12llu %12.2f %10.1f %10.2f %7.1f%%\n", zone_names[z],
+               (unsigned long long)summary.calls[z], summary.seconds[z] * 1e3,
+               summary.seconds[z] * 1e9 / (double)summary.calls[z], summary.max_seconds[z] * 1e6,
+               summary.wall_seconds > 0.0 ? 100.0 * summary.seconds[z] / summary.wall_seconds : 0.0);
+    }
+    if (summary.dropped_events > 0) {
+        printf("(%llu trace events dropped: per-thread trace buffers are full)\n",
+               (unsigned long long)summary.dropped_events);
+    }
+}
+
+// Complete ("X") events in microseconds since the epoch, one track per thread
+bool profile_write_trace(const char* filename) {
+    if (!filename) return false;
+
+    FILE* file = fopen(filename, "w");
+    if (!file) {
+        fprintf(stderr, "Error: Could not open %s for writing\n", filename);
+        return false;
+    }
+
+    pthread_mutex_lock(&registry_lock);
+    double us_per_tick = epoch_set ? 1e6 / ticks_per_second() : 0.0;
+    uint64_t dropped = 0;
+    bool first = true;
+    fprintf(file, "{\"traceEvents\":[");
+    for (int i = 0; i < num_threads; i++) {
+        ProfileThread* thread = threads[i];
+        fprintf(file, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"thread %d\"}}",
+                first ? "" : ",", i, i);
+        first = false;
+
+        size_t count = __atomic_load_n(&thread->num_events, __ATOMIC_ACQUIRE);
+        for (size_t e = 0; e < count; e++) {
+            const ProfileEvent* event = &thread->events[e];
+            double ts = event->start >= epoch_ticks ? (double)(event->start - epoch_ticks) * us_per_tick : 0.0;
+            fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"training\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,"
+                    "\"ts\":%.3f,\"dur\":%.3f}", zone_names[event->zone], i, ts, event->duration * us_per_tick);
+        }
+        dropped += __atomic_load_n(&thread->dropped, __ATOMIC_RELAXED);
+    }
+    fprintf(file, "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"dropped_events\":%llu}}\n",
+            (unsigned long long)dropped);
+    pthread_mutex_unlock(&registry_lock);
+
+    bool ok = !ferror(file);
+    if (fclose(file) != 0) ok = false;
+    if (!ok) {
+        fprintf(stderr, "Error: Failed to write trace %s\n", filename);
+    }
+    return ok;
+}
@@ -0,0 +1,309 @@
+#include "q_table_optimized.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Code range [0, levels] for the given bit width
+static inline float quant_levels(int bits) {
+    return (float)((1u << bits) - 1u);
+}
+
+static inline const uint8_t* row_codes8(const CompressedQTable* qtable, int state) {
+    return (const uint8_t*)qtable->compressed_data + (size_t)state * qtable->num_actions;
+}
+
+static inline const uint16_t* row_codes16(const CompressedQTable* qtable, int state) {
+    return (const uint16_t*)qtable->compressed_data + (size_t)state * qtable->num_actions;
+}
+
+// Index of the first maximum code in a row; returns the max code via max_out
+static int argmax_codes8(const uint8_t* codes, int count, unsigned* max_out) {
+    int a = 0;
+    unsigned best = codes[0];
+    int best_index = 0;
+
+#ifdef __SSE2__
+    if (count >= 16) {
+        __m128i vmax = _mm_loadu_si128((const __m128i*)codes);
+        for (a = 16; a + 16 <= count; a += 16) {
+            vmax = _mm_max_epu8(vmax, _mm_loadu_si128((const __m128i*)(codes + a)));
+        }
+        // Horizontal max across the 16 lanes
+        vmax = _mm_max_epu8(vmax, _mm_srli_si128(vmax, 8));
+        vmax = _mm_max_epu8(vmax, _mm_srli_si128(vmax, 4));
+        vmax = _mm_max_epu8(vmax, _mm_srli_si128(vmax, 2));
+        vmax = _mm_max_epu8(vmax, _mm_srli_si128(vmax, 1));
+        best = (unsigned)(_mm_cvtsi128_si32(vmax) & 0xFF);
+        for (int t = a; t < count; t++) {
+            if (codes[t] > best) best = codes[t];
+        }
+
+        // First lane holding the maximum
+        __m128i target = _mm_set1_epi8((char)best);
+        for (int c = 0; c + 16 <= count; c += 16) {
+            int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(codes + c)), target));
+            if (mask) {
+                *max_out = best;
+                return c + __builtin_ctz((unsigned)mask);
+            }
+        }
+        for (int t = count & ~15; t < count; t++) {
+            if (codes[t] == best) {
+                *max_out = best;
+                return t;
+            }
+        }
+    }
+#endif
+
+    for (a = 1; a < count; a++) {
+        if (codes[a] > best) {
+            best = codes[a];
+            best_index = a;
+        }
+    }
+    *max_out = best;
+    return best_index;
+}
+
+static int argmax_codes16(const uint16_t* codes, int count, unsigned* max_out) {
+    int a = 0;
+    unsigned best = codes[0];
+    int best_index = 0;
+
+#ifdef __SSE2__
+    if (count >= 8) {
+        // SSE2 only has a signed 16-bit max; flipping the sign bit maps the
+        // unsigned order onto the signed one
+        const __m128i bias = _mm_set1_epi16((short)0x8000);
+        __m128i vmax = _mm_xor_si128(_mm_loadu_si128((const __m128i*)codes), bias);
+        for (a = 8; a + 8 <= count; a += 8) {
+            __m128i v = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(codes + a)), bias);
+            vmax = _mm_max_epi16(vmax, v);
+        }
+        vmax = _mm_max_epi16(vmax, _mm_srli_si128(vmax, 8));
+        vmax = _mm_max_epi16(vmax, _mm_srli_si128(vmax, 4));
+        vmax = _mm_max_epi16(vmax, _mm_srli_si128(vmax, 2));
+        best = (unsigned)((_mm_cvtsi128_si32(vmax) & 0xFFFF) ^ 0x8000);
+        for (int t = a; t < count; t++) {
+            if (codes[t] > best) best = codes[t];
+        }
+
+        __m128i target = _mm_set1_epi16((short)best);
+        for (int c = 0; c + 8 <= count; c += 8) {
+            int mask = _mm_movemask_epi8(_mm_cmpeq_epi16(_mm_loadu_si128((const __m128i*)(codes + c)), target));
+            if (mask) {
+                *max_out = best;
+                return c + __builtin_ctz((unsigned)mask) / 2;
+            }
+        }
+        for (int t = count & ~7; t < count; t++) {
+            if (codes[t] == best) {
+                *max_out = best;
+                return t;
+            }
+        }
+    }
+#endif
+
+    for (a = 1; a < count; a++) {
+        if (codes[a] > best) {
+            best = codes[a];
+            best_index = a;
+        }
+    }
+    *max_out = best;
+    return best_index;
+}
+
+// Quantize a Q-table with one scale/offset per block of states
+CompressedQTable* compress_qtable_blocked(OptimizedQTable* qtable, int target_bits, int states_per_block) {
+    if (!qtable || !qtable->data) {
+        fprintf(stderr, "Error: Cannot compress a NULL Q-table\n");
+        return NULL;
+    }
+    if (target_bits != 8 && target_bits != 16) {
+        fprintf(stderr, "Error: Unsupported compression width %d bits (use 8 or 16)\n", target_bits);
+        return NULL;
+    }
+    if (states_per_block <= 0 || states_per_block > qtable->num_states) {
+        states_per_block = qtable->num_states;
+    }
+
+    int num_states = qtable->num_states;
+    int num_actions = qtable->num_actions;
+    size_t code_size = target_bits == 8 ? sizeof(uint8_t) : sizeof(uint16_t);
+
+    CompressedQTable* compressed = (CompressedQTable*)calloc(1, sizeof(CompressedQTable));
+    if (!compressed) {
+        fprintf(stderr, "Error: Failed to allocate CompressedQTable structure\n");
+        return NULL;
+    }
+
+    compressed->compression_bits = target_bits;
+    compressed->num_states = num_states;
+    compressed->num_actions = num_actions;
+    compressed->states_per_block = states_per_block;
+    compressed->num_blocks = (num_states + states_per_block - 1) / states_per_block;
+    compressed->compressed_data = malloc((size_t)num_states * num_actions * code_size);
+    compressed->block_scales = (float*)malloc(compressed->num_blocks * sizeof(float));
+    compressed->block_offsets = (float*)malloc(compressed->num_blocks * sizeof(float));
+    if (!compressed->compressed_data || !compressed->block_scales || !compressed->block_offsets) {
+        fprintf(stderr, "Error: Failed to allocate compressed Q-table data\n");
+        destroy_compressed_qtable(compressed);
+        return NULL;
+    }
+
+    float levels = quant_levels(target_bits);
+    compressed->scale_factor = 0.0f;
+    compressed->offset = INFINITY;
+
+    for (int b = 0; b < compressed->num_blocks; b++) {
+        int s_begin = b * states_per_block;
+        int s_end = s_begin + states_per_block;
+        if (s_end > num_states) s_end = num_states;
+
+        float min_q = INFINITY;
+        float max_q = -INFINITY;
+        for (int s = s_begin; s < s_end; s++) {
+            const float* row = get_state_row_fast(qtable, s);
+            for (int a = 0; a < num_actions; a++) {
+                if (row[a] < min_q) min_q = row[a];
+                if (row[a] > max_q) max_q = row[a];
+            }
+        }
+
+        // A constant block still needs a positive step to stay invertible
+        float scale = (max_q > min_q) ? (max_q - min_q) / levels : 1.0f;
+        float inv_scale = 1.0f / scale;
+        compressed->block_scales[b] = scale;
+        compressed->block_offsets[b] = min_q;
+        if (max_q > min_q && scale > compressed->scale_factor) compressed->scale_factor = scale;
+        if (min_q < compressed->offset) compressed->offset = min_q;
+
+        for (int s = s_begin; s < s_end; s++) {
+            const float* row = get_state_row_fast(qtable, s);
+            for (int a = 0; a < num_actions; a++) {
+                float code = (row[a] - min_q) * inv_scale + 0.5f;
+                if (code < 0.0f) code = 0.0f;
+                if (code > levels) code = levels;
+                size_t i = (size_t)s * num_actions + a;
+                if (target_bits == 8) {
+                    ((uint8_t*)compressed->compressed_data)[i] = (uint8_t)code;
+                } else {
+                    ((uint16_t*)compressed->compressed_data)[i] = (uint16_t)code;
+                }
+            }
+        }
+    }
+
+    return compressed;
+}
+
+// Quantize a Q-table with a single table-wide scale/offset
+CompressedQTable* compress_qtable(OptimizedQTable* qtable, int target_bits) {
+    return compress_qtable_blocked(qtable, target_bits, qtable ? qtable->num_states : 0);
+}
+
+// Expand back into a regular OptimizedQTable (values within half a step of the original)
+OptimizedQTable* decompress_qtable(CompressedQTable* compressed) {
+    if (!compressed || !compressed->compressed_data) {
+        fprintf(stderr, "Error: Cannot decompress a NULL Q-table\n");
+        return NULL;
+    }
+
+    AccessPatternHints hints = {0};
+    hints.frequent_max_queries = true;
+    OptimizedQTable* qtable = create_optimized_qtable(compressed->num_states, compressed->num_actions,
+                                                      ALLOC_ALIGNED, hints);
+    if (!qtable) {
+        return NULL;
+    }
+
+    for (int s = 0; s < compressed->num_states; s++) {
+        float* row = qtable->data + (size_t)s * qtable->state_stride;
+        for (int a = 0; a < compressed->num_actions; a++) {
+            row[a] = compressed_get_q_value(compressed, s, a);
+        }
+    }
+    invalidate_all_caches(qtable);
+    return qtable;
+}
+
+void destroy_compressed_qtable(CompressedQTable* qtable) {
+    if (!qtable) return;
+
+    free(qtable->compressed_data);
+    free(qtable->block_scales);
+    free(qtable->block_offsets);
+    free(qtable);
+}
+
+// Dequantize one value
+float compressed_get_q_value(const CompressedQTable* qtable, int state, int action) {
+    if (!qtable || state < 0 || state >= qtable->num_states || action < 0 || action >= qtable->num_actions) {
+        return 0.0f;
+    }
+
+    int block = state / qtable->states_per_block;
+    unsigned code = qtable->compression_bits == 8 ? row_codes8(qtable, state)[action]
+                                                  : row_codes16(qtable, state)[action];
+    return qtable->block_offsets[block] + (float)code * qtable->block_scales[block];
+}
+
+// Max over a row, dequantizing only the winning code
+float compressed_get_max_q_value(const CompressedQTable* qtable, int state) {
+    if (!qtable || state < 0 || state >= qtable->num_states) {
+        return 0.0f;
+    }
+
+    unsigned max_code = 0;
+    if (qtable->compression_bits == 8) {
+        argmax_codes8(row_codes8(qtable, state), qtable->num_actions, &max_code);
+    } else {
+        argmax_codes16(row_codes16(qtable, state), qtable->num_actions, &max_code);
+    }
+    int block = state / qtable->states_per_block;
+    return qtable->block_offsets[block] + (float)max_code * qtable->block_scales[block];
+}
+
+// Greedy action straight from the codes. Ties (including values that
+// quantized to the same code) resolve to the lowest action index, matching
+// get_best_action_cached.
+int compressed_get_best_action(const CompressedQTable* qtable, int state) {
+    if (!qtable || state < 0 || state >= qtable->num_states) {
+        return 0;
+    }
+
+    unsigned max_code = 0;
+    if (qtable->compression_bits == 8) {
+        return argmax_codes8(row_codes8(qtable, state), qtable->num_actions, &max_code);
+    }
+    return argmax_codes16(row_codes16(qtable, state), qtable->num_actions, &max_code);
+}
+
+// Greedy actions for a batch of states (e.g. one per environment in a rollout)
+void compressed_batch_best_actions(const CompressedQTable* qtable, const int* states, int* actions, int count) {
+    if (!qtable || !states || !actions) return;
+
+    for (int i = 0; i < count; i++) {
+        if (i + 1 < count && states[i + 1] >= 0 && states[i + 1] < qtable->num_states) {
+            __builtin_prefetch((const char*)qtable->compressed_data +
+                               (size_t)states[i + 1] * qtable->num_actions * (qtable->compression_bits / 8));
+        }
+        actions[i] = compressed_get_best_action(qtable, states[i]);
+    }
+}
+
+// Bytes held by the compressed representation
+size_t compressed_qtable_bytes(const CompressedQTable* qtable) {
+    if (!qtable) return 0;
+
+    return (size_t)qtable->num_states * qtable->num_actions * (qtable->compression_bits / 8) +
+           (size_t)qtable->num_blocks * 2 * sizeof(float);
+}
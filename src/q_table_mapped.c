@@ -0,0 +1,383 @@
+#define _POSIX_C_SOURCE 200809L  // mmap, msync, ftruncate, pread, posix_madvise
+#define _FILE_OFFSET_BITS 64     // Tables beyond 2 GB on 32-bit hosts
+
+#include "q_table_optimized.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Point the embedded OptimizedQTable at the mapped rows and set up its caches.
+// Cache arrays come from calloc, so for huge tables they stay mostly
+// untouched zero pages until states are actually queried.
+static bool init_mapped_base(MappedQTable* qtable, const QTableFileHeader* header) {
+    OptimizedQTable* base = &qtable->base;
+    memset(base, 0, sizeof(OptimizedQTable));
+
+    base->data = (float*)((char*)qtable->mapped_memory + header->data_offset);
+    base->num_states = header->num_states;
+    base->num_actions = header->num_actions;
+    base->state_stride = header->state_stride;
+    base->last_state_id = -1;
+    base->last_state_ptr = NULL;
+    base->alloc_strategy = ALLOC_STANDARD;  // Rows belong to the mapping, not the allocator
+    base->numa_node = -1;
+
+    // Page-aligned data satisfies any SIMD alignment
+#ifdef __AVX2__
+    base->simd_enabled = true;
+    base->simd_alignment = 32;
+#elif defined(__SSE2__)
+    base->simd_enabled = true;
+    base->simd_alignment = 16;
+#else
+    base->simd_enabled = false;
+    base->simd_alignment = 16;
+#endif
+
+    base->max_q_cache = (float*)calloc(header->num_states, sizeof(float));
+    base->best_action_cache = (int*)calloc(header->num_states, sizeof(int));
+    base->cache_valid = (bool*)calloc(header->num_states, sizeof(bool));
+    if (!base->max_q_cache || !base->best_action_cache || !base->cache_valid) {
+        fprintf(stderr, "Error: Failed to allocate caches for mapped Q-table\n");
+        return false;
+    }
+
+    base->use_row_cache = (header->num_states <= 256);
+    if (base->use_row_cache) {
+        for (int i = 0; i < header->num_states; i++) {
+            base->state_rows[i] = base->data + (i * base->state_stride);
+        }
+    }
+    return true;
+}
+
+// CRC-32 (IEEE 802.3, as in zlib) over half-bytes: a 16-entry table keeps
+// the code small and still checks a checkpoint at several hundred MB/s
+static const uint32_t crc32_nibble_table[16] = {
+    0x00000000u, 0x1DB71064u, 0x3B6E20C8u, 0x26D930ACu, 0x76DC4190u, 0x6B6B51F4u, 0x4DB26158u, 0x5005713Cu,
+    0xEDB88320u, 0xF00F9344u, 0xD6D6A3E8u, 0xCB61B38Cu, 0x9B64C2B0u, 0x86D3D2D4u, 0xA00AE278u, 0xBDBDF21Cu
+};
+
+uint32_t qtable_crc32(uint32_t crc, const void* data, size_t size) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++) {
+        crc ^= bytes[i];
+        crc = (crc >> 4) ^ crc32_nibble_table[crc & 0xF];
+        crc = (crc >> 4) ^ crc32_nibble_table[crc & 0xF];
+    }
+    return ~crc;
+}
+
+void seal_qtable_file_header(QTableFileHeader* header) {
+    header->header_crc = 0;
+    header->header_crc = qtable_crc32(0, header, sizeof(QTableFileHeader));
+}
+
+// Validate a header read from an existing file against its size and the requested dimensions
+bool validate_qtable_file_header(QTableFileHeader* header, uint64_t file_size, const char* filename,
+                                 int num_states, int num_actions) {
+    if (header->magic != QTABLE_FILE_MAGIC) {
+        if (header->magic == __builtin_bswap32(QTABLE_FILE_MAGIC)) {
+            fprintf(stderr, "Error: %s was written on a host with the opposite byte order\n", filename);
+        } else {
+            fprintf(stderr, "Error: %s is not a Q-table file (bad magic)\n", filename);
+        }
+        return false;
+    }
+    if (header->version < 1 || header->version > QTABLE_FILE_VERSION) {
+        fprintf(stderr, "Error: %s has unsupported Q-table file version %u\n", filename, header->version);
+        return false;
+    }
+    if (header->version == 1) {
+        // Version 1 ended at checkpoint_count; the rest of the page is zero
+        header->flags = 0;
+        header->stored_size = header->data_size;
+    } else {
+        if (header->byte_order != QTABLE_FILE_BYTE_ORDER) {
+            fprintf(stderr, "Error: %s has an unrecognized byte order marker\n", filename);
+            return false;
+        }
+        if (header->flags & QTABLE_FILE_CRC) {
+            uint32_t expected = header->header_crc;
+            seal_qtable_file_header(header);
+            if (header->header_crc != expected) {
+                fprintf(stderr, "Error: %s has a corrupt header (checksum mismatch)\n", filename);
+                return false;
+            }
+        }
+    }
+    if (header->num_states <= 0 || header->num_actions <= 0 || header->state_stride < header->num_actions) {
+        fprintf(stderr, "Error: %s has invalid Q-table dimensions\n", filename);
+        return false;
+    }
+    if ((num_states > 0 && num_states != header->num_states) ||
+        (num_actions > 0 && num_actions != header->num_actions)) {
+        fprintf(stderr, "Error: %s holds a %dx%d Q-table, expected %dx%d\n", filename,
+                header->num_states, header->num_actions, num_states, num_actions);
+        return false;
+    }
+
+    uint64_t expected_data = (uint64_t)header->num_states * header->state_stride * sizeof(float);
+    bool compressed = (header->flags & QTABLE_FILE_RLE) != 0;
+    if (header->data_size != expected_data || header->data_offset < sizeof(QTableFileHeader) ||
+        header->data_offset % 64 != 0 || header->stored_size % sizeof(uint32_t) != 0 ||
+        (!compressed && header->stored_size != header->data_size)) {
+        fprintf(stderr, "Error: %s has an inconsistent Q-table header\n", filename);
+        return false;
+    }
+    if (file_size < header->data_offset + header->stored_size) {
+        fprintf(stderr, "Error: %s is truncated (%llu bytes, need %llu)\n", filename,
+                (unsigned long long)file_size, (unsigned long long)(header->data_offset + header->stored_size));
+        return false;
+    }
+    return true;
+}
+
+size_t qtable_rle_bound(size_t words) {
+    return words + words / 0x7FFFFFFFu + 1;
+}
+
+size_t qtable_rle_encode(const uint32_t* words, size_t count, uint32_t* out) {
+    size_t written = 0;
+    size_t literal_start = 0;   // First word not yet emitted
+    size_t i = 0;
+    for (;;) {
+        size_t run = 0;
+        if (i < count) {
+            run = 1;
+            while (i + run < count && words[i + run] == words[i] && run < 0x7FFFFFFFu) run++;
+            if (run < 3) {      // Too short to pay for a run token
+                i += run;
+                continue;
+            }
+        }
+
+        // A run or the end of the input: emit the pending literals first
+        while (literal_start < i) {
+            size_t n = i - literal_start;
+            if (n > 0x7FFFFFFFu) n = 0x7FFFFFFFu;
+            out[written++] = (uint32_t)n;
+            memcpy(out + written, words + literal_start, n * sizeof(uint32_t));
+            written += n;
+            literal_start += n;
+        }
+        if (i == count) break;
+
+        out[written++] = 0x80000000u | (uint32_t)run;
+        out[written++] = words[i];
+        i += run;
+        literal_start = i;
+    }
+    return written;
+}
+
+bool qtable_rle_decode(const uint32_t* in, size_t in_words, uint32_t* out, size_t out_words) {
+    size_t pos = 0;
+    size_t filled = 0;
+    while (pos < in_words) {
+        uint32_t token = in[pos++];
+        size_t n = token & 0x7FFFFFFFu;
+        if (n > out_words - filled) return false;
+        if (token & 0x80000000u) {
+            if (pos >= in_words) return false;
+            uint32_t word = in[pos++];
+            for (size_t k = 0; k < n; k++) out[filled + k] = word;
+        } else {
+            if (n > in_words - pos) return false;
+            memcpy(out + filled, in + pos, n * sizeof(uint32_t));
+            pos += n;
+        }
+        filled += n;
+    }
+    return filled == out_words;
+}
+
+// Create or open a file-backed Q-table
+MappedQTable* create_mapped_qtable(const char* filename, int num_states,
+                                  int num_actions, bool create_new) {
+    if (!filename) {
+        fprintf(stderr, "Error: Mapped Q-table needs a filename\n");
+        return NULL;
+    }
+    if (create_new && (num_states <= 0 || num_actions <= 0)) {
+        fprintf(stderr, "Error: Invalid Q-table dimensions\n");
+        return NULL;
+    }
+
+    MappedQTable* qtable = (MappedQTable*)calloc(1, sizeof(MappedQTable));
+    if (!qtable) {
+        fprintf(stderr, "Error: Failed to allocate MappedQTable structure\n");
+        return NULL;
+    }
+    qtable->filename = (char*)malloc(strlen(filename) + 1);
+    if (!qtable->filename) {
+        fprintf(stderr, "Error: Failed to allocate mapped Q-table filename\n");
+        free(qtable);
+        return NULL;
+    }
+    strcpy(qtable->filename, filename);
+
+    QTableFileHeader header;
+    int fd = -1;
+
+    if (create_new) {
+        fd = open(filename, O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            fprintf(stderr, "Error: Could not create %s: %s\n", filename, strerror(errno));
+            goto fail;
+        }
+
+        memset(&header, 0, sizeof(header));
+        header.magic = QTABLE_FILE_MAGIC;
+        header.version = QTABLE_FILE_VERSION;
+        header.header_size = sizeof(QTableFileHeader);
+        header.num_states = num_states;
+        header.num_actions = num_actions;
+        header.state_stride = num_actions;
+        header.byte_order = QTABLE_FILE_BYTE_ORDER;
+        header.data_offset = QTABLE_FILE_DATA_OFFSET;
+        header.data_size = (uint64_t)num_states * num_actions * sizeof(float);
+        header.stored_size = header.data_size;
+
+        // ftruncate zero-fills without writing, so creation is O(1) on sparse-capable filesystems
+        qtable->mapped_size = (size_t)(header.data_offset + header.data_size);
+        if (ftruncate(fd, (off_t)qtable->mapped_size) != 0) {
+            fprintf(stderr, "Error: Could not size %s to %zu bytes: %s\n",
+                    filename, qtable->mapped_size, strerror(errno));
+            goto fail;
+        }
+    } else {
+        fd = open(filename, O_RDWR);
+        if (fd < 0 && (errno == EACCES || errno == EROFS)) {
+            fd = open(filename, O_RDONLY);
+            qtable->read_only = true;
+        }
+        if (fd < 0) {
+            fprintf(stderr, "Error: Could not open %s: %s\n", filename, strerror(errno));
+            goto fail;
+        }
+
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(QTableFileHeader)) {
+            fprintf(stderr, "Error: %s is too small to be a mapped Q-table\n", filename);
+            goto fail;
+        }
+        if (pread(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header)) {
+            fprintf(stderr, "Error: Could not read header of %s\n", filename);
+            goto fail;
+        }
+        if (!validate_qtable_file_header(&header, (uint64_t)st.st_size, filename, num_states, num_actions)) {
+            goto fail;
+        }
+        if (header.flags & QTABLE_FILE_RLE) {
+            fprintf(stderr, "Error: %s is compressed and cannot be mapped; load it with load_q_table\n", filename);
+            goto fail;
+        }
+        qtable->mapped_size = (size_t)(header.data_offset + header.data_size);
+    }
+
+    int prot = qtable->read_only ? PROT_READ : (PROT_READ | PROT_WRITE);
+    qtable->mapped_memory = mmap(NULL, qtable->mapped_size, prot, MAP_SHARED, fd, 0);
+    if (qtable->mapped_memory == MAP_FAILED) {
+        fprintf(stderr, "Error: Could not map %s: %s\n", filename, strerror(errno));
+        qtable->mapped_memory = NULL;
+        goto fail;
+    }
+    close(fd);  // The mapping keeps the file referenced
+    fd = -1;
+
+    if (create_new) {
+        memcpy(qtable->mapped_memory, &header, sizeof(header));
+    } else if (!qtable->read_only && (header.flags & QTABLE_FILE_CRC)) {
+        // Training writes rows in place, so a saved checksum would go stale
+        ((QTableFileHeader*)qtable->mapped_memory)->flags &= ~QTABLE_FILE_CRC;
+        qtable->reseal_crc = true;
+    }
+
+    // Training touches states in no particular order; skip kernel readahead
+    posix_madvise((char*)qtable->mapped_memory + header.data_offset, (size_t)header.data_size,
+                  POSIX_MADV_RANDOM);
+
+    if (!init_mapped_base(qtable, &header)) {
+        goto fail;
+    }
+
+    printf("%s mapped Q-table %s: %dx%d (%.1f MB)%s\n", create_new ? "Created" : "Opened",
+           filename, header.num_states, header.num_actions,
+           header.data_size / (1024.0 * 1024.0), qtable->read_only ? " [read-only]" : "");
+    return qtable;
+
+fail:
+    if (fd >= 0) {
+        close(fd);
+    }
+    destroy_mapped_qtable(qtable);
+    return NULL;
+}
+
+// Checksum the rows once no more writes can come. The rows reach the file
+// before the header that vouches for them, so a crash in between leaves the
+// file unchecked rather than failing its checksum.
+static void reseal_mapped_qtable(MappedQTable* qtable) {
+    QTableFileHeader* header = (QTableFileHeader*)qtable->mapped_memory;
+    if (msync(qtable->mapped_memory, qtable->mapped_size, MS_SYNC) != 0) {
+        fprintf(stderr, "Error: msync of %s failed, leaving it without a checksum: %s\n",
+                qtable->filename, strerror(errno));
+        return;
+    }
+    header->data_crc = qtable_crc32(0, (const char*)qtable->mapped_memory + header->data_offset,
+                                    (size_t)header->data_size);
+    header->flags |= QTABLE_FILE_CRC;
+    seal_qtable_file_header(header);
+    if (msync(qtable->mapped_memory, sizeof(QTableFileHeader), MS_SYNC) != 0) {
+        fprintf(stderr, "Error: msync of %s header failed: %s\n", qtable->filename, strerror(errno));
+    }
+}
+
+// Unmap the table (dirty pages are written back by the kernel) and free its caches
+void destroy_mapped_qtable(MappedQTable* qtable) {
+    if (!qtable) return;
+
+    if (qtable->mapped_memory) {
+        if (qtable->reseal_crc) {
+            reseal_mapped_qtable(qtable);
+        }
+        munmap(qtable->mapped_memory, qtable->mapped_size);
+    }
+    free(qtable->base.max_q_cache);
+    free(qtable->base.best_action_cache);
+    free(qtable->base.cache_valid);
+    free(qtable->filename);
+    free(qtable);
+}
+
+// Bump the checkpoint counter and flush the mapping with the given msync mode
+static bool flush_mapped_qtable(MappedQTable* qtable, int flags) {
+    if (!qtable || !qtable->mapped_memory) return false;
+    if (qtable->read_only) return true;  // Nothing can be dirty
+
+    QTableFileHeader* header = (QTableFileHeader*)qtable->mapped_memory;
+    header->checkpoint_count++;
+
+    if (msync(qtable->mapped_memory, qtable->mapped_size, flags) != 0) {
+        fprintf(stderr, "Error: msync of %s failed: %s\n", qtable->filename, strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+// Checkpoint: returns once every modified page has reached the file
+bool sync_mapped_qtable(MappedQTable* qtable) {
+    return flush_mapped_qtable(qtable, MS_SYNC);
+}
+
+// Start writing modified pages back without waiting for completion
+bool sync_mapped_qtable_async(MappedQTable* qtable) {
+    return flush_mapped_qtable(qtable, MS_ASYNC);
+}
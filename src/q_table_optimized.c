@@ -1,4 +1,8 @@
+#define _GNU_SOURCE  // MAP_ANONYMOUS/MAP_HUGETLB, madvise, syscall
+
 #include "q_table_optimized.h"
+#include "memory_arena.h"
+#include "q_row4.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -13,29 +17,133 @@
 #include <immintrin.h>
 #endif
 
-// Platform-specific memory alignment
-#ifdef _WIN32
-#include <malloc.h>
-#define aligned_alloc(alignment, size) _aligned_malloc(size, alignment)
-#define aligned_free _aligned_free
-#else
-#include <stdlib.h>
-#define aligned_free free
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#define QTABLE_HUGE_PAGE_SIZE ((size_t)2 * 1024 * 1024)
+#define QTABLE_MPOL_PREFERRED 1     // From <numaif.h>; avoids a libnuma dependency
+#define QTABLE_MAX_NUMA_NODES 1024
+
+static size_t round_up_size(size_t size, size_t granularity) {
+    return (size + granularity - 1) / granularity * granularity;
+}
+
+// Huge pages: explicit MAP_HUGETLB first (needs a reserved hugetlbfs pool),
+// otherwise a 2 MB aligned anonymous region advised for transparent huge pages.
+static float* alloc_huge_pages(OptimizedQTable* qtable, size_t size) {
+    size_t huge_size = round_up_size(size, QTABLE_HUGE_PAGE_SIZE);
+
+    void* ptr = mmap(NULL, huge_size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (ptr != MAP_FAILED) {
+        qtable->alloc_base = ptr;
+        qtable->alloc_size = huge_size;
+        qtable->alloc_flags |= QTABLE_ALLOC_HUGETLB;
+        return (float*)ptr;
+    }
+
+    // THP only backs 2 MB aligned ranges; over-map and trim to an aligned window
+    size_t map_size = huge_size + QTABLE_HUGE_PAGE_SIZE;
+    ptr = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ptr == MAP_FAILED) {
+        return NULL;
+    }
+    char* aligned = (char*)round_up_size((size_t)ptr, QTABLE_HUGE_PAGE_SIZE);
+    size_t head = (size_t)(aligned - (char*)ptr);
+    size_t tail = map_size - head - huge_size;
+    if (head > 0) munmap(ptr, head);
+    if (tail > 0) munmap(aligned + huge_size, tail);
+
+    qtable->alloc_base = aligned;
+    qtable->alloc_size = huge_size;
+#ifdef MADV_HUGEPAGE
+    if (madvise(aligned, huge_size, MADV_HUGEPAGE) == 0) {
+        qtable->alloc_flags |= QTABLE_ALLOC_THP;
+    }
+#endif
+    return (float*)aligned;
+}
+
+// Node of the CPU the calling thread is running on
+static int current_numa_node(void) {
+    unsigned cpu = 0, node = 0;
+#ifdef SYS_getcpu
+    if (syscall(SYS_getcpu, &cpu, &node, NULL) == 0) {
+        return (int)node;
+    }
 #endif
+    return -1;
+}
+
+// NUMA-local: prefer numa_node (or the caller's node) via mbind, then fault
+// every page in from this thread. Without mbind the kernel's default
+// first-touch policy still places the pages on the creating thread's node.
+static float* alloc_numa_local(OptimizedQTable* qtable, size_t size, int numa_node) {
+    long page_size = sysconf(_SC_PAGESIZE);
+    size_t map_size = round_up_size(size, page_size > 0 ? (size_t)page_size : 4096);
+
+    void* ptr = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ptr == MAP_FAILED) {
+        return NULL;
+    }
+    qtable->alloc_base = ptr;
+    qtable->alloc_size = map_size;
+
+    if (numa_node < 0) {
+        numa_node = current_numa_node();
+    }
+#ifdef SYS_mbind
+    if (numa_node >= 0 && numa_node < QTABLE_MAX_NUMA_NODES) {
+        unsigned long mask[QTABLE_MAX_NUMA_NODES / (8 * sizeof(unsigned long))] = {0};
+        mask[numa_node / (8 * sizeof(unsigned long))] |= 1UL << (numa_node % (8 * sizeof(unsigned long)));
+        if (syscall(SYS_mbind, ptr, map_size, QTABLE_MPOL_PREFERRED, mask,
+                    (unsigned long)QTABLE_MAX_NUMA_NODES, 0) == 0) {
+            qtable->alloc_flags |= QTABLE_ALLOC_MBIND;
+        }
+    }
+#endif
+
+    size_t step = page_size > 0 ? (size_t)page_size : 4096;
+    for (size_t offset = 0; offset < map_size; offset += step) {
+        ((volatile char*)ptr)[offset] = 0;
+    }
+    qtable->alloc_flags |= QTABLE_ALLOC_FIRST_TOUCH;
+    qtable->numa_node = numa_node;
+    return (float*)ptr;
+}
+#endif // __linux__
 
 // Performance counters (thread-local for multi-threading support)
 static __thread QTablePerfCounters g_perf_counters = {0};
 
-// Create optimized Q-table with specified allocation strategy
-OptimizedQTable* create_optimized_qtable(int num_states, int num_actions, 
-                                         QTableAllocStrategy strategy,
-                                         AccessPatternHints hints) {
+// Controls the creation message
+static bool g_qtable_verbose = true;
+
+void set_qtable_verbose(bool verbose) {
+    g_qtable_verbose = verbose;
+}
+
+bool is_qtable_verbose(void) {
+    return g_qtable_verbose;
+}
+
+// Rows are single aligned 4-float vectors (mapped tables may be padded wider)
+static inline bool qtable_rows_are_vec4(const OptimizedQTable* qtable) {
+    return qtable->num_actions == Q_ROW4_WIDTH && qtable->state_stride == Q_ROW4_WIDTH;
+}
+
+// Shared constructor; numa_node only matters for ALLOC_NUMA_LOCAL (-1 = calling thread's node)
+static OptimizedQTable* create_qtable_internal(int num_states, int num_actions,
+                                               QTableAllocStrategy strategy,
+                                               AccessPatternHints hints, int numa_node) {
     if (num_states <= 0 || num_actions <= 0) {
         fprintf(stderr, "Error: Invalid Q-table dimensions\n");
         return NULL;
     }
 
-    OptimizedQTable* qtable = (OptimizedQTable*)malloc(sizeof(OptimizedQTable));
+    OptimizedQTable* qtable = (OptimizedQTable*)memory_alloc(MEMORY_AGENT, sizeof(OptimizedQTable));
     if (!qtable) {
         fprintf(stderr, "Error: Failed to allocate OptimizedQTable structure\n");
         return NULL;
@@ -46,6 +154,13 @@ OptimizedQTable* create_optimized_qtable(int num_states, int num_actions,
     qtable->state_stride = num_actions;  // Stride for row-major layout
     qtable->last_state_id = -1;
     qtable->last_state_ptr = NULL;
+    qtable->alloc_strategy = strategy;
+    qtable->alloc_flags = 0;
+    qtable->numa_node = -1;
+    qtable->alloc_base = NULL;
+    qtable->alloc_size = 0;
+    qtable->state_slots = NULL;
+    qtable->slot_states = NULL;
 
     // Determine SIMD capabilities and alignment
     qtable->simd_enabled = false;
@@ -60,33 +175,56 @@ OptimizedQTable* create_optimized_qtable(int num_states, int num_actions,
 #endif
 
     // Calculate total memory needed
-    size_t data_size = num_states * num_actions * sizeof(float);
+    size_t data_size = (size_t)num_states * num_actions * sizeof(float);
     
     // Allocate main data array based on strategy
+    qtable->data = NULL;
     switch (strategy) {
+        case ALLOC_HUGE_PAGES:
+#ifdef __linux__
+            qtable->data = alloc_huge_pages(qtable, data_size);
+#endif
+            break;
+        case ALLOC_NUMA_LOCAL:
+#ifdef __linux__
+            qtable->data = alloc_numa_local(qtable, data_size, numa_node);
+#endif
+            break;
         case ALLOC_ALIGNED:
-            qtable->data = (float*)aligned_alloc(qtable->simd_alignment, data_size);
+            qtable->data = (float*)memory_alloc_aligned(MEMORY_AGENT, data_size, qtable->simd_alignment);
             break;
         case ALLOC_STANDARD:
         default:
-            qtable->data = (float*)malloc(data_size);
+            qtable->data = (float*)memory_alloc(MEMORY_AGENT, data_size);
             break;
     }
 
+    // Huge page / NUMA requests that could not be honored fall back to aligned memory
+    if (!qtable->data && (strategy == ALLOC_HUGE_PAGES || strategy == ALLOC_NUMA_LOCAL)) {
+        qtable->alloc_strategy = ALLOC_ALIGNED;
+        qtable->data = (float*)memory_alloc_aligned(MEMORY_AGENT, data_size, qtable->simd_alignment);
+    }
+    if (strategy == ALLOC_HUGE_PAGES && qtable->alloc_base &&
+        !(qtable->alloc_flags & (QTABLE_ALLOC_HUGETLB | QTABLE_ALLOC_THP))) {
+        qtable->alloc_strategy = ALLOC_ALIGNED;  // Mapped, but with base pages only
+    }
+
     if (!qtable->data) {
         fprintf(stderr, "Error: Failed to allocate Q-table data array\n");
-        free(qtable);
+        memory_free(qtable);
         return NULL;
     }
 
-    // Initialize data to zero
-    memset(qtable->data, 0, data_size);
+    // Initialize data to zero (anonymous mappings already are)
+    if (!qtable->alloc_base) {
+        memset(qtable->data, 0, data_size);
+    }
 
     // Allocate cache structures if frequent max queries are expected
     if (hints.frequent_max_queries) {
-        qtable->max_q_cache = (float*)malloc(num_states * sizeof(float));
-        qtable->best_action_cache = (int*)malloc(num_states * sizeof(int));
-        qtable->cache_valid = (bool*)calloc(num_states, sizeof(bool));
+        qtable->max_q_cache = (float*)memory_alloc(MEMORY_AGENT, num_states * sizeof(float));
+        qtable->best_action_cache = (int*)memory_alloc(MEMORY_AGENT, num_states * sizeof(int));
+        qtable->cache_valid = (bool*)memory_calloc(MEMORY_AGENT, num_states, sizeof(bool));
 
         if (!qtable->max_q_cache || !qtable->best_action_cache || !qtable->cache_valid) {
             fprintf(stderr, "Error: Failed to allocate cache structures\n");
@@ -107,78 +245,117 @@ OptimizedQTable* create_optimized_qtable(int num_states, int num_actions,
         }
     }
 
-    printf("Created optimized Q-table: %dx%d, SIMD: %s, Cache: %s, RowCache: %s\n",
-           num_states, num_actions,
-           qtable->simd_enabled ? "enabled" : "disabled",
-           qtable->max_q_cache ? "enabled" : "disabled",
-           qtable->use_row_cache ? "enabled" : "disabled");
+    if (g_qtable_verbose) {
+        printf("Created optimized Q-table: %dx%d, SIMD: %s, Cache: %s, RowCache: %s, Alloc: %s\n",
+               num_states, num_actions,
+               qtable->simd_enabled ? "enabled" : "disabled",
+               qtable->max_q_cache ? "enabled" : "disabled",
+               qtable->use_row_cache ? "enabled" : "disabled",
+               qtable_alloc_description(qtable));
+    }
 
     return qtable;
 }
 
-// Destroy optimized Q-table
-void destroy_optimized_qtable(OptimizedQTable* qtable) {
-    if (!qtable) return;
+// Create optimized Q-table with specified allocation strategy
+OptimizedQTable* create_optimized_qtable(int num_states, int num_actions, 
+                                         QTableAllocStrategy strategy,
+                                         AccessPatternHints hints) {
+    return create_qtable_internal(num_states, num_actions, strategy, hints, -1);
+}
 
-    if (qtable->data) {
-        if (qtable->simd_alignment > 0) {
-            aligned_free(qtable->data);
-        } else {
-            free(qtable->data);
-        }
-    }
+// Create a NUMA-local Q-table whose pages prefer the given node
+OptimizedQTable* create_optimized_qtable_on_node(int num_states, int num_actions,
+                                                 AccessPatternHints hints, int numa_node) {
+    return create_qtable_internal(num_states, num_actions, ALLOC_NUMA_LOCAL, hints, numa_node);
+}
 
-    free(qtable->max_q_cache);
-    free(qtable->best_action_cache);
-    free(qtable->cache_valid);
-    free(qtable);
+const char* qtable_alloc_strategy_name(QTableAllocStrategy strategy) {
+    switch (strategy) {
+        case ALLOC_STANDARD:   return "standard";
+        case ALLOC_ALIGNED:    return "aligned";
+        case ALLOC_HUGE_PAGES: return "huge pages";
+        case ALLOC_NUMA_LOCAL: return "NUMA-local";
+        default:               return "unknown";
+    }
 }
 
-// Get max Q-value for a state with caching
-float get_max_q_value_cached(OptimizedQTable* qtable, int state) {
-    if (!qtable || state < 0 || state >= qtable->num_states) {
-        return 0.0f;
+// Strategy that was applied, with the mechanism that honored it
+const char* qtable_alloc_description(const OptimizedQTable* qtable) {
+    if (!qtable) return "none";
+
+    switch (qtable->alloc_strategy) {
+        case ALLOC_HUGE_PAGES:
+            return (qtable->alloc_flags & QTABLE_ALLOC_HUGETLB) ? "huge pages (hugetlbfs)" : "huge pages (THP)";
+        case ALLOC_NUMA_LOCAL:
+            return (qtable->alloc_flags & QTABLE_ALLOC_MBIND) ? "NUMA-local (mbind)" : "NUMA-local (first touch)";
+        default:
+            return qtable_alloc_strategy_name(qtable->alloc_strategy);
     }
+}
 
-    g_perf_counters.total_accesses++;
+// Destroy optimized Q-table
+void destroy_optimized_qtable(OptimizedQTable* qtable) {
+    if (!qtable) return;
 
-    // Check cache if available
-    if (qtable->cache_valid && qtable->cache_valid[state]) {
-        g_perf_counters.cache_hits++;
-        return qtable->max_q_cache[state];
+    if (qtable->alloc_base) {
+#ifdef __linux__
+        munmap(qtable->alloc_base, qtable->alloc_size);
+#endif
+    } else {
+        memory_free(qtable->data);
     }
 
-    g_perf_counters.cache_misses++;
+    memory_free(qtable->max_q_cache);
+    memory_free(qtable->best_action_cache);
+    memory_free(qtable->cache_valid);
+    memory_free(qtable->state_slots);
+    memory_free(qtable->slot_states);
+    memory_free(qtable);
+}
 
-    // Calculate max Q-value
+// Scan a state row once and refresh both cached max and argmax.
+// Caching only one of them would leave the other stale behind a valid flag.
+static float refresh_state_cache(OptimizedQTable* qtable, int state, int* best_action_out) {
     float* state_data = get_state_row_fast(qtable, state);
+    int best_action = 0;
     float max_q = state_data[0];
 
     // Use SIMD if available and beneficial
-    if (qtable->simd_enabled && qtable->num_actions >= 8) {
-        max_q = simd_max_in_row(qtable, state);
+    if (qtable_rows_are_vec4(qtable)) {
+        g_perf_counters.simd_operations++;
+        best_action = q_row4_argmax(state_data);
+        max_q = state_data[best_action];
+    } else if (qtable->simd_enabled && qtable->num_actions >= 8) {
+        best_action = simd_argmax_in_row(qtable, state);
+        max_q = state_data[best_action];
     } else {
         // Standard loop
         for (int a = 1; a < qtable->num_actions; a++) {
             if (state_data[a] > max_q) {
                 max_q = state_data[a];
+                best_action = a;
             }
         }
     }
 
-    // Cache the result
-    if (qtable->max_q_cache) {
+    // Cache the results
+    if (qtable->cache_valid) {
+        qtable->best_action_cache[state] = best_action;
         qtable->max_q_cache[state] = max_q;
         qtable->cache_valid[state] = true;
     }
 
+    if (best_action_out) {
+        *best_action_out = best_action;
+    }
     return max_q;
 }
 
-// Get best action for a state with caching
-int get_best_action_cached(OptimizedQTable* qtable, int state) {
+// Get max Q-value for a state with caching
+float get_max_q_value_cached(OptimizedQTable* qtable, int state) {
     if (!qtable || state < 0 || state >= qtable->num_states) {
-        return 0;
+        return 0.0f;
     }
 
     g_perf_counters.total_accesses++;
@@ -186,37 +363,32 @@ int get_best_action_cached(OptimizedQTable* qtable, int state) {
     // Check cache if available
     if (qtable->cache_valid && qtable->cache_valid[state]) {
         g_perf_counters.cache_hits++;
-        return qtable->best_action_cache[state];
+        return qtable->max_q_cache[state];
     }
 
     g_perf_counters.cache_misses++;
 
-    // Calculate best action
-    float* state_data = get_state_row_fast(qtable, state);
-    int best_action = 0;
-    float max_q = state_data[0];
+    return refresh_state_cache(qtable, state, NULL);
+}
 
-    // Use SIMD if available and beneficial
-    if (qtable->simd_enabled && qtable->num_actions >= 8) {
-        best_action = simd_argmax_in_row(qtable, state);
-        max_q = state_data[best_action];
-    } else {
-        // Standard loop
-        for (int a = 1; a < qtable->num_actions; a++) {
-            if (state_data[a] > max_q) {
-                max_q = state_data[a];
-                best_action = a;
-            }
-        }
+// Get best action for a state with caching
+int get_best_action_cached(OptimizedQTable* qtable, int state) {
+    if (!qtable || state < 0 || state >= qtable->num_states) {
+        return 0;
     }
 
-    // Cache the results
-    if (qtable->best_action_cache && qtable->max_q_cache) {
-        qtable->best_action_cache[state] = best_action;
-        qtable->max_q_cache[state] = max_q;
-        qtable->cache_valid[state] = true;
+    g_perf_counters.total_accesses++;
+
+    // Check cache if available
+    if (qtable->cache_valid && qtable->cache_valid[state]) {
+        g_perf_counters.cache_hits++;
+        return qtable->best_action_cache[state];
     }
 
+    g_perf_counters.cache_misses++;
+
+    int best_action = 0;
+    refresh_state_cache(qtable, state, &best_action);
     return best_action;
 }
 
@@ -296,6 +468,9 @@ float simd_max_in_row(OptimizedQTable* qtable, int state) {
 
     float* state_data = get_state_row_fast(qtable, state);
     int num_actions = qtable->num_actions;
+    if (qtable_rows_are_vec4(qtable)) {
+        return q_row4_max(state_data);
+    }
     
     // Process 8 floats at a time with AVX2
     __m256 max_vec = _mm256_load_ps(state_data);
@@ -336,6 +511,9 @@ float simd_max_in_row(OptimizedQTable* qtable, int state) {
 
     float* state_data = get_state_row_fast(qtable, state);
     int num_actions = qtable->num_actions;
+    if (qtable_rows_are_vec4(qtable)) {
+        return q_row4_max(state_data);
+    }
     
     // Process 4 floats at a time with SSE2
     __m128 max_vec = _mm_load_ps(state_data);
@@ -365,6 +543,9 @@ float simd_max_in_row(OptimizedQTable* qtable, int state) {
 float simd_max_in_row(OptimizedQTable* qtable, int state) {
     // Fallback to standard implementation
     float* state_data = get_state_row_fast(qtable, state);
+    if (qtable_rows_are_vec4(qtable)) {
+        return q_row4_max(state_data);
+    }
     float max_q = state_data[0];
     
     for (int a = 1; a < qtable->num_actions; a++) {
@@ -383,8 +564,13 @@ int simd_argmax_in_row(OptimizedQTable* qtable, int state) {
         return 0;
     }
 
-    // For now, use standard implementation (SIMD argmax is more complex)
     float* state_data = get_state_row_fast(qtable, state);
+    if (qtable_rows_are_vec4(qtable)) {
+        g_perf_counters.simd_operations++;
+        return q_row4_argmax(state_data);
+    }
+
+    // Wider rows use the standard loop
     int best_action = 0;
     float max_q = state_data[0];
     
@@ -430,6 +616,200 @@ void simd_update_state_row(OptimizedQTable* qtable, int state, float* new_values
     invalidate_state_cache(qtable, state);
 }
 
+// ============================================================================
+// MEMORY LAYOUT OPTIMIZATION
+// ============================================================================
+
+typedef struct {
+    int64_t key;
+    int state;
+} LayoutKey;
+
+// Ascending key, then ascending state so equal keys keep their natural order
+static int compare_layout_keys(const void* a, const void* b) {
+    const LayoutKey* ka = (const LayoutKey*)a;
+    const LayoutKey* kb = (const LayoutKey*)b;
+    if (ka->key != kb->key) return ka->key < kb->key ? -1 : 1;
+    return ka->state - kb->state;
+}
+
+// Install the permutation given by sorting keys: the state with the smallest key gets row 0
+static bool apply_sorted_layout(OptimizedQTable* qtable, LayoutKey* keys) {
+    int* slots = (int*)malloc(qtable->num_states * sizeof(int));
+    if (!slots) {
+        fprintf(stderr, "Error: Failed to allocate state layout\n");
+        return false;
+    }
+
+    qsort(keys, qtable->num_states, sizeof(LayoutKey), compare_layout_keys);
+    for (int slot = 0; slot < qtable->num_states; slot++) {
+        slots[keys[slot].state] = slot;
+    }
+
+    bool ok = apply_state_layout(qtable, slots);
+    free(slots);
+    return ok;
+}
+
+// Physically move every row to its new slot. Rows are moved along the
+// permutation's cycles, so only two spare rows are needed however large the table is.
+bool apply_state_layout(OptimizedQTable* qtable, const int* state_slots) {
+    if (!qtable || !qtable->data) return false;
+
+    int n = qtable->num_states;
+    bool identity = true;
+    if (state_slots) {
+        bool* taken = (bool*)calloc(n, sizeof(bool));
+        if (!taken) {
+            fprintf(stderr, "Error: Failed to allocate layout validation buffer\n");
+            return false;
+        }
+        for (int s = 0; s < n; s++) {
+            int slot = state_slots[s];
+            if (slot < 0 || slot >= n || taken[slot]) {
+                fprintf(stderr, "Error: State layout is not a permutation (state %d -> row %d)\n", s, slot);
+                free(taken);
+                return false;
+            }
+            taken[slot] = true;
+            identity = identity && slot == s;
+        }
+        free(taken);
+    }
+
+    size_t row_bytes = (size_t)qtable->state_stride * sizeof(float);
+    float* carry = (float*)malloc(row_bytes);
+    float* spare = (float*)malloc(row_bytes);
+    bool* moved = (bool*)calloc(n, sizeof(bool));
+    if (!carry || !spare || !moved) {
+        fprintf(stderr, "Error: Failed to allocate layout buffers\n");
+        free(carry);
+        free(spare);
+        free(moved);
+        return false;
+    }
+
+    for (int start = 0; start < n; start++) {
+        if (moved[start]) continue;
+
+        // Carry the row at 'start' to where its state belongs, picking up the displaced row each hop
+        int state = qtable->slot_states ? qtable->slot_states[start] : start;
+        memcpy(carry, qtable->data + (size_t)start * qtable->state_stride, row_bytes);
+        moved[start] = true;
+        for (;;) {
+            int dest = state_slots ? state_slots[state] : state;
+            float* dest_row = qtable->data + (size_t)dest * qtable->state_stride;
+            if (dest == start) {
+                memcpy(dest_row, carry, row_bytes);
+                break;
+            }
+            int displaced = qtable->slot_states ? qtable->slot_states[dest] : dest;
+            memcpy(spare, dest_row, row_bytes);
+            memcpy(dest_row, carry, row_bytes);
+            float* tmp = carry;
+            carry = spare;
+            spare = tmp;
+            moved[dest] = true;
+            state = displaced;
+        }
+    }
+    free(carry);
+    free(spare);
+    free(moved);
+
+    if (identity) {
+        memory_free(qtable->state_slots);
+        memory_free(qtable->slot_states);
+        qtable->state_slots = NULL;
+        qtable->slot_states = NULL;
+    } else {
+        if (!qtable->state_slots) {
+            qtable->state_slots = (int*)memory_alloc(MEMORY_AGENT, n * sizeof(int));
+            qtable->slot_states = (int*)memory_alloc(MEMORY_AGENT, n * sizeof(int));
+        }
+        if (!qtable->state_slots || !qtable->slot_states) {
+            // Rows already moved; without the maps the table would be scrambled
+            fprintf(stderr, "Error: Failed to allocate state layout maps\n");
+            abort();
+        }
+        for (int s = 0; s < n; s++) {
+            qtable->state_slots[s] = state_slots[s];
+            qtable->slot_states[state_slots[s]] = s;
+        }
+    }
+
+    if (qtable->use_row_cache) {
+        for (int i = 0; i < n && i < 256; i++) {
+            qtable->state_rows[i] = qtable->data + (size_t)qtable_state_slot(qtable, i) * qtable->state_stride;
+        }
+    }
+    qtable->last_state_ptr = NULL;
+    qtable->last_state_id = -1;
+    return true;
+}
+
+// Put the most frequently accessed states in the first rows (e.g. from
+// StateVisitTracker.visit_counts). NULL restores the identity layout.
+void optimize_memory_layout(OptimizedQTable* qtable, int* access_frequency) {
+    if (!qtable) return;
+    if (!access_frequency) {
+        apply_state_layout(qtable, NULL);
+        return;
+    }
+
+    LayoutKey* keys = (LayoutKey*)malloc(qtable->num_states * sizeof(LayoutKey));
+    if (!keys) {
+        fprintf(stderr, "Error: Failed to allocate layout keys\n");
+        return;
+    }
+    for (int s = 0; s < qtable->num_states; s++) {
+        keys[s].key = -(int64_t)access_frequency[s];
+        keys[s].state = s;
+    }
+    apply_sorted_layout(qtable, keys);
+    free(keys);
+}
+
+// Spread the low 16 bits of v over the even bit positions
+static uint32_t morton_spread(uint32_t v) {
+    v &= 0xFFFF;
+    v = (v | (v << 8)) & 0x00FF00FF;
+    v = (v | (v << 4)) & 0x0F0F0F0F;
+    v = (v | (v << 2)) & 0x33333333;
+    v = (v | (v << 1)) & 0x55555555;
+    return v;
+}
+
+// Order grid states (state = y * width + x) along a Z-order curve so 2x2,
+// 4x4, ... neighbourhoods share cache lines. States past width * height keep
+// their order after the grid.
+bool optimize_memory_layout_morton(OptimizedQTable* qtable, int width, int height) {
+    if (!qtable || width <= 0 || height <= 0 || width > 65536 || height > 65536) {
+        fprintf(stderr, "Error: Invalid grid for Morton layout\n");
+        return false;
+    }
+
+    LayoutKey* keys = (LayoutKey*)malloc(qtable->num_states * sizeof(LayoutKey));
+    if (!keys) {
+        fprintf(stderr, "Error: Failed to allocate layout keys\n");
+        return false;
+    }
+    int64_t grid_cells = (int64_t)width * height;
+    for (int s = 0; s < qtable->num_states; s++) {
+        if (s < grid_cells) {
+            uint32_t x = (uint32_t)(s % width);
+            uint32_t y = (uint32_t)(s / width);
+            keys[s].key = (int64_t)(morton_spread(x) | (morton_spread(y) << 1));
+        } else {
+            keys[s].key = ((int64_t)1 << 32) + s;
+        }
+        keys[s].state = s;
+    }
+    bool ok = apply_sorted_layout(qtable, keys);
+    free(keys);
+    return ok;
+}
+
 // Memory prefetching
 void prefetch_state_data(OptimizedQTable* qtable, int state) {
     if (!qtable || state < 0 || state >= qtable->num_states) {
@@ -473,12 +853,12 @@ void print_perf_stats(OptimizedQTable* qtable) {
     (void)qtable;  // Unused parameter
     
     printf("\n=== Q-Table Performance Statistics ===\n");
-    printf("Total accesses: %llu\n", g_perf_counters.total_accesses);
-    printf("Cache hits: %llu\n", g_perf_counters.cache_hits);
-    printf("Cache misses: %llu\n", g_perf_counters.cache_misses);
+    printf("Total accesses: %llu\n", (unsigned long long)g_perf_counters.total_accesses);
+    printf("Cache hits: %llu\n", (unsigned long long)g_perf_counters.cache_hits);
+    printf("Cache misses: %llu\n", (unsigned long long)g_perf_counters.cache_misses);
     printf("Cache hit ratio: %.2f%%\n", calculate_cache_hit_ratio(qtable));
-    printf("Batch operations: %llu\n", g_perf_counters.batch_operations);
-    printf("SIMD operations: %llu\n", g_perf_counters.simd_operations);
+    printf("Batch operations: %llu\n", (unsigned long long)g_perf_counters.batch_operations);
+    printf("SIMD operations: %llu\n", (unsigned long long)g_perf_counters.simd_operations);
     printf("=====================================\n");
 }
 
@@ -493,7 +873,7 @@ float calculate_cache_hit_ratio(OptimizedQTable* qtable) {
 
 // Compatibility wrapper for existing agent code
 QTableWrapper* wrap_qtable_for_agent(int num_states, int num_actions) {
-    QTableWrapper* wrapper = (QTableWrapper*)malloc(sizeof(QTableWrapper));
+    QTableWrapper* wrapper = (QTableWrapper*)memory_alloc(MEMORY_AGENT, sizeof(QTableWrapper));
     if (!wrapper) {
         fprintf(stderr, "Error: Failed to allocate QTableWrapper\n");
         return NULL;
@@ -507,16 +887,24 @@ QTableWrapper* wrap_qtable_for_agent(int num_states, int num_actions) {
         .cache_friendly_training = true
     };
 
-    wrapper->qtable = create_optimized_qtable(num_states, num_actions, ALLOC_ALIGNED, hints);
+    // Tables spanning at least one huge page are where TLB misses start to matter
+    QTableAllocStrategy strategy = ALLOC_ALIGNED;
+#ifdef __linux__
+    if ((size_t)num_states * num_actions * sizeof(float) >= QTABLE_HUGE_PAGE_SIZE) {
+        strategy = ALLOC_HUGE_PAGES;
+    }
+#endif
+
+    wrapper->qtable = create_optimized_qtable(num_states, num_actions, strategy, hints);
     if (!wrapper->qtable) {
-        free(wrapper);
+        memory_free(wrapper);
         return NULL;
     }
 
-    wrapper->counters = (QTablePerfCounters*)malloc(sizeof(QTablePerfCounters));
+    wrapper->counters = (QTablePerfCounters*)memory_alloc(MEMORY_AGENT, sizeof(QTablePerfCounters));
     if (!wrapper->counters) {
         destroy_optimized_qtable(wrapper->qtable);
-        free(wrapper);
+        memory_free(wrapper);
         return NULL;
     }
 
@@ -528,8 +916,8 @@ void destroy_qtable_wrapper(QTableWrapper* wrapper) {
     if (!wrapper) return;
     
     destroy_optimized_qtable(wrapper->qtable);
-    free(wrapper->counters);
-    free(wrapper);
+    memory_free(wrapper->counters);
+    memory_free(wrapper);
 }
 
 float qtable_get_value(QTableWrapper* wrapper, int state, int action) {
@@ -0,0 +1,106 @@
+#include "render_snapshot.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+SnapshotBuffer* create_snapshot_buffer(int num_states) {
+    if (num_states <= 0) {
+        fprintf(stderr, "Error: Snapshot buffer needs a positive state count (got %d)\n", num_states);
+        return NULL;
+    }
+
+    SnapshotBuffer* buffer = (SnapshotBuffer*)calloc(1, sizeof(SnapshotBuffer));
+    if (!buffer) {
+        fprintf(stderr, "Error: Failed to allocate memory for snapshot buffer\n");
+        return NULL;
+    }
+
+    for (int i = 0; i < 3; i++) {
+        RenderSnapshot* slot = &buffer->slots[i];
+        slot->num_states = num_states;
+        slot->state_max_q = (float*)calloc(num_states, sizeof(float));
+        slot->best_action = (uint8_t*)calloc(num_states, sizeof(uint8_t));
+        if (!slot->state_max_q || !slot->best_action) {
+            fprintf(stderr, "Error: Failed to allocate memory for render snapshot\n");
+            destroy_snapshot_buffer(buffer);
+            return NULL;
+        }
+    }
+    buffer->write_slot = 0;
+    buffer->ready = 1;
+    buffer->read_slot = 2;
+    return buffer;
+}
+
+void destroy_snapshot_buffer(SnapshotBuffer* buffer) {
+    if (!buffer) return;
+
+    for (int i = 0; i < 3; i++) {
+        free(buffer->slots[i].state_max_q);
+        free(buffer->slots[i].best_action);
+    }
+    free(buffer);
+}
+
+RenderSnapshot* snapshot_begin_write(SnapshotBuffer* buffer) {
+    return &buffer->slots[buffer->write_slot];
+}
+
+void snapshot_publish(SnapshotBuffer* buffer) {
+    RenderSnapshot* snapshot = &buffer->slots[buffer->write_slot];
+    snapshot->sequence = ++buffer->published;
+
+    // Release orders the snapshot contents before the slot becomes visible
+    int previous = __atomic_exchange_n(&buffer->ready, buffer->write_slot | SNAPSHOT_FRESH, __ATOMIC_ACQ_REL);
+    buffer->write_slot = previous & ~SNAPSHOT_FRESH;
+}
+
+const RenderSnapshot* snapshot_acquire(SnapshotBuffer* buffer) {
+    if (__atomic_load_n(&buffer->ready, __ATOMIC_ACQUIRE) & SNAPSHOT_FRESH) {
+        int previous = __atomic_exchange_n(&buffer->ready, buffer->read_slot, __ATOMIC_ACQ_REL);
+        buffer->read_slot = previous & ~SNAPSHOT_FRESH;
+    }
+
+    const RenderSnapshot* snapshot = &buffer->slots[buffer->read_slot];
+    return snapshot->sequence > 0 ? snapshot : NULL;
+}
+
+void snapshot_capture_q_values(RenderSnapshot* snapshot, QLearningAgent* agent) {
+    int states = agent->num_states < snapshot->num_states ? agent->num_states : snapshot->num_states;
+
+    // Bounds are tracked by the agent, so this is O(1) between rescans
+    get_q_value_bounds(agent, &snapshot->min_q, &snapshot->max_q);
+
+    // The greedy action comes from the argmax cache or one vector pass over the row
+    for (int s = 0; s < states; s++) {
+        Action best_action = select_greedy_action(agent, s);
+        snapshot->best_action[s] = (uint8_t)best_action;
+        snapshot->state_max_q[s] = get_q_value(agent, s, best_action);
+    }
+}
+
+void init_command_queue(TrainingCommandQueue* queue) {
+    memset(queue, 0, sizeof(*queue));
+}
+
+bool push_training_command(TrainingCommandQueue* queue, TrainingCommand command) {
+    unsigned int tail = queue->tail;
+    unsigned int head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+    if (tail - head == TRAINING_COMMAND_CAPACITY) {
+        return false;
+    }
+    queue->commands[tail & (TRAINING_COMMAND_CAPACITY - 1)] = command;
+    __atomic_store_n(&queue->tail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+bool pop_training_command(TrainingCommandQueue* queue, TrainingCommand* command) {
+    unsigned int head = queue->head;
+    unsigned int tail = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+    if (head == tail) {
+        return false;
+    }
+    *command = queue->commands[head & (TRAINING_COMMAND_CAPACITY - 1)];
+    __atomic_store_n(&queue->head, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
@@ -3,6 +3,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#include <string.h>
 
 // Global visualization state - simplified for core functions
 static VisualizationState* g_vis_state = NULL;
@@ -34,7 +35,7 @@ void init_graphics(int screen_width, int screen_height) {
     
     // Initialize global visualization state if not already done
     if (g_vis_state == NULL) {
-        g_vis_state = (VisualizationState*)malloc(sizeof(VisualizationState));
+        g_vis_state = (VisualizationState*)calloc(1, sizeof(VisualizationState));
         if (g_vis_state == NULL) {
             printf("Error: Failed to allocate visualization state\n");
             return;
@@ -48,6 +49,7 @@ void init_graphics(int screen_width, int screen_height) {
         g_vis_state->config.show_grid = true;
         g_vis_state->config.show_fps = true;  // Enable FPS display by default
         g_vis_state->config.fps_target = 60;
+        g_vis_state->config.batched_rendering = false;
         
         // Initialize color scheme
         g_vis_state->colors = create_default_color_scheme();
@@ -87,38 +89,31 @@ Rectangle get_cell_rect(VisualizationState* vis, int x, int y) {
     };
 }
 
-// Draw a single cell
-void draw_cell(VisualizationState* vis, int x, int y, CellType type) {
-    if (!vis) return;
-    
-    Rectangle cell_rect = get_cell_rect(vis, x, y);
-    Color cell_color;
-    
+// Fill colour of a cell type
+static Color cell_type_color(VisualizationState* vis, CellType type) {
     switch (type) {
-        case CELL_EMPTY:
-            cell_color = vis->colors.empty_cell;
-            break;
         case CELL_WALL:
-            cell_color = vis->colors.wall_cell;
-            break;
+            return vis->colors.wall_cell;
         case CELL_GOAL:
-            cell_color = vis->colors.goal_cell;
-            break;
+            return vis->colors.goal_cell;
         case CELL_AGENT:
-            cell_color = vis->colors.agent_color;
-            break;
+            return vis->colors.agent_color;
         case CELL_OBSTACLE:
-            cell_color = vis->colors.obstacle_color;
-            break;
+            return vis->colors.obstacle_color;
         case CELL_START:
-            cell_color = vis->colors.start_cell;
-            break;
+            return vis->colors.start_cell;
+        case CELL_EMPTY:
         default:
-            cell_color = vis->colors.empty_cell;
-            break;
+            return vis->colors.empty_cell;
     }
+}
+
+// Draw a single cell
+void draw_cell(VisualizationState* vis, int x, int y, CellType type) {
+    if (!vis) return;
     
-    DrawRectangleRec(cell_rect, cell_color);
+    Rectangle cell_rect = get_cell_rect(vis, x, y);
+    DrawRectangleRec(cell_rect, cell_type_color(vis, type));
     
     // Draw cell border if grid is enabled
     if (vis->config.show_grid) {
@@ -126,6 +121,272 @@ void draw_cell(VisualizationState* vis, int x, int y, CellType type) {
     }
 }
 
+// Grid cells that intersect the screen: [x0, x1) x [y0, y1)
+static void get_visible_cell_range(VisualizationState* vis, GridWorld* world, int* x0, int* y0, int* x1, int* y1) {
+    Vector2 top_left = {0.0f, 0.0f};
+    Vector2 bottom_right = {(float)vis->config.screen_width, (float)vis->config.screen_height};
+    if (vis->camera_enabled) {
+        top_left = GetScreenToWorld2D(top_left, vis->camera);
+        bottom_right = GetScreenToWorld2D(bottom_right, vis->camera);
+    }
+    
+    float cell_size = (float)vis->config.cell_size;
+    int first_x = (int)floorf((top_left.x - vis->layout.grid_area.x) / cell_size);
+    int first_y = (int)floorf((top_left.y - vis->layout.grid_area.y) / cell_size);
+    int last_x = (int)ceilf((bottom_right.x - vis->layout.grid_area.x) / cell_size);
+    int last_y = (int)ceilf((bottom_right.y - vis->layout.grid_area.y) / cell_size);
+    
+    *x0 = first_x < 0 ? 0 : first_x;
+    *y0 = first_y < 0 ? 0 : first_y;
+    *x1 = last_x > world->width ? world->width : last_x;
+    *y1 = last_y > world->height ? world->height : last_y;
+}
+
+// Batched rendering: each layer is a texture with one texel per cell, drawn
+// as a single scaled quad. Only rows whose colours changed are re-uploaded.
+// Policy arrows are quads from one atlas texture, which raylib batches into
+// a handful of draw calls instead of three line draws per cell.
+
+#define ARROW_TILE 32                // Atlas tile size in texels
+#define ARROW_MIN_PIXELS 12.0f       // Smaller cells on screen get no arrows
+#define GRID_LINE_MIN_PIXELS 6.0f    // Smaller cells on screen get no grid lines
+
+static const Color TRANSPARENT_TEXEL = {0, 0, 0, 0};
+
+static inline bool colors_equal(Color a, Color b) {
+    return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+}
+
+// On-screen size of one cell, including camera zoom
+static float screen_cell_size(VisualizationState* vis) {
+    float zoom = vis->camera_enabled ? vis->camera.zoom : 1.0f;
+    return (float)vis->config.cell_size * zoom;
+}
+
+static void release_layer(LayerTexture* layer) {
+    if (layer->loaded) {
+        UnloadTexture(layer->texture);
+    }
+    free(layer->pixels);
+    memset(layer, 0, sizeof(*layer));
+}
+
+// (Re)create the layer at the grid size, fully transparent
+static bool prepare_layer(LayerTexture* layer, int width, int height) {
+    if (layer->loaded && layer->width == width && layer->height == height) {
+        return true;
+    }
+    release_layer(layer);
+    
+    layer->pixels = (Color*)calloc((size_t)width * height, sizeof(Color));
+    if (!layer->pixels) {
+        fprintf(stderr, "Error: Failed to allocate %dx%d render layer\n", width, height);
+        return false;
+    }
+    Image image = {layer->pixels, width, height, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+    layer->texture = LoadTextureFromImage(image);
+    if (layer->texture.id == 0) {
+        // Usually a grid larger than the GPU's maximum texture size
+        fprintf(stderr, "Error: Failed to create %dx%d render layer texture\n", width, height);
+        free(layer->pixels);
+        layer->pixels = NULL;
+        return false;
+    }
+    SetTextureFilter(layer->texture, TEXTURE_FILTER_POINT);
+    layer->width = width;
+    layer->height = height;
+    layer->loaded = true;
+    layer->dirty_y0 = height;
+    layer->dirty_y1 = 0;
+    return true;
+}
+
+static inline void store_texel(LayerTexture* layer, int x, int y, Color color) {
+    Color* texel = &layer->pixels[(size_t)y * layer->width + x];
+    if (!colors_equal(*texel, color)) {
+        *texel = color;
+        if (y < layer->dirty_y0) layer->dirty_y0 = y;
+        if (y >= layer->dirty_y1) layer->dirty_y1 = y + 1;
+    }
+}
+
+// Upload the changed rows (contiguous in pixels) in one call
+static void upload_layer(LayerTexture* layer) {
+    if (layer->dirty_y0 >= layer->dirty_y1) return;
+    
+    Rectangle rows = {0.0f, (float)layer->dirty_y0, (float)layer->width, (float)(layer->dirty_y1 - layer->dirty_y0)};
+    UpdateTextureRec(layer->texture, rows, layer->pixels + (size_t)layer->dirty_y0 * layer->width);
+    layer->dirty_y0 = layer->height;
+    layer->dirty_y1 = 0;
+}
+
+static void draw_layer(VisualizationState* vis, LayerTexture* layer) {
+    float cell_size = (float)vis->config.cell_size;
+    Rectangle source = {0.0f, 0.0f, (float)layer->width, (float)layer->height};
+    Rectangle dest = {vis->layout.grid_area.x, vis->layout.grid_area.y,
+                      layer->width * cell_size, layer->height * cell_size};
+    DrawTexturePro(layer->texture, source, dest, (Vector2){0.0f, 0.0f}, 0.0f, WHITE);
+}
+
+// Rebuild the cell and wall layers when the grid layout changed
+static bool refresh_cell_layers(VisualizationState* vis, GridWorld* world) {
+    BatchedRenderCache* batch = &vis->batch;
+    bool resized = !batch->cells.loaded || batch->cells.width != world->width ||
+                   batch->cells.height != world->height;
+    if (!prepare_layer(&batch->cells, world->width, world->height) ||
+        !prepare_layer(&batch->walls, world->width, world->height)) {
+        return false;
+    }
+    
+    const GridLayout* layout = world->layout;
+    if (!resized && batch->layout_revision == layout->revision) {
+        return true;
+    }
+    
+    // Row-major walk of the bitset, merging the sorted side table as we go
+    int next_special = 0;
+    for (int y = 0; y < world->height; y++) {
+        for (int x = 0; x < world->width; x++) {
+            int index = y * world->width + x;
+            CellType type = grid_layout_blocked(layout, x, y) ? CELL_WALL : CELL_EMPTY;
+            if (next_special < layout->num_specials && layout->specials[next_special].index == index) {
+                type = layout->specials[next_special++].type;
+            }
+            store_texel(&batch->cells, x, y, cell_type_color(vis, type));
+            store_texel(&batch->walls, x, y, type == CELL_WALL ? vis->colors.wall_cell : TRANSPARENT_TEXEL);
+        }
+    }
+    upload_layer(&batch->cells);
+    upload_layer(&batch->walls);
+    batch->layout_revision = layout->revision;
+    return true;
+}
+
+static inline bool layer_is_wall(const BatchedRenderCache* batch, int x, int y) {
+    return batch->walls.pixels[(size_t)y * batch->walls.width + x].a != 0;
+}
+
+// Tile a of the atlas: an arrow from the tile centre towards action a,
+// matching the shaft and head proportions of draw_q_cell
+static bool prepare_arrow_atlas(VisualizationState* vis) {
+    BatchedRenderCache* batch = &vis->batch;
+    if (batch->arrows_loaded) return true;
+    
+    int width = ARROW_TILE * NUM_ACTIONS;
+    Color* pixels = (Color*)calloc((size_t)width * ARROW_TILE, sizeof(Color));
+    if (!pixels) {
+        fprintf(stderr, "Error: Failed to allocate policy arrow atlas\n");
+        return false;
+    }
+    
+    const float directions[NUM_ACTIONS][2] = {{0.0f, -1.0f}, {0.0f, 1.0f}, {-1.0f, 0.0f}, {1.0f, 0.0f}};
+    const float length = ARROW_TILE * 0.3f;
+    const float head = ARROW_TILE * 0.2f;
+    const float shaft_half_width = ARROW_TILE * 0.04f;
+    for (int a = 0; a < NUM_ACTIONS; a++) {
+        for (int py = 0; py < ARROW_TILE; py++) {
+            for (int px = 0; px < ARROW_TILE; px++) {
+                float dx = px + 0.5f - ARROW_TILE / 2.0f;
+                float dy = py + 0.5f - ARROW_TILE / 2.0f;
+                float along = dx * directions[a][0] + dy * directions[a][1];
+                float across = fabsf(dy * directions[a][0] - dx * directions[a][1]);
+                bool in_shaft = along >= 0.0f && along <= length - head && across <= shaft_half_width;
+                bool in_head = along > length - head && along <= length && across <= (length - along) * 0.5f;
+                if (in_shaft || in_head) {
+                    pixels[(size_t)py * width + a * ARROW_TILE + px] = BLACK;
+                }
+            }
+        }
+    }
+    
+    Image image = {pixels, width, ARROW_TILE, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+    batch->arrows = LoadTextureFromImage(image);
+    batch->arrows_loaded = true;
+    free(pixels);
+    return true;
+}
+
+static void release_batched_render_cache(VisualizationState* vis) {
+    release_layer(&vis->batch.cells);
+    release_layer(&vis->batch.walls);
+    release_layer(&vis->batch.q_values);
+    if (vis->batch.arrows_loaded) {
+        UnloadTexture(vis->batch.arrows);
+    }
+    memset(&vis->batch, 0, sizeof(vis->batch));
+}
+
+// Greedy value and action per state, from the live agent or a render snapshot
+typedef struct {
+    QLearningAgent* agent;
+    const RenderSnapshot* snapshot;
+} QValueSource;
+
+static inline int q_source_states(const QValueSource* source) {
+    return source->agent ? source->agent->num_states : source->snapshot->num_states;
+}
+
+static inline float q_source_value(const QValueSource* source, int state) {
+    return source->agent ? get_max_q_value(source->agent, state) : source->snapshot->state_max_q[state];
+}
+
+static inline Action q_source_action(const QValueSource* source, int state) {
+    return source->agent ? select_greedy_action(source->agent, state) : (Action)source->snapshot->best_action[state];
+}
+
+// Heatmap quad plus batched arrows for the cells on screen
+static bool draw_q_values_batched(VisualizationState* vis, GridWorld* world, const QValueSource* source,
+                                  float min_q, float max_q) {
+    BatchedRenderCache* batch = &vis->batch;
+    if (!refresh_cell_layers(vis, world) || !prepare_layer(&batch->q_values, world->width, world->height)) {
+        return false;
+    }
+    
+    int x0, y0, x1, y1;
+    get_visible_cell_range(vis, world, &x0, &y0, &x1, &y1);
+    int num_states = q_source_states(source);
+    for (int y = y0; y < y1; y++) {
+        for (int x = x0; x < x1; x++) {
+            int state = y * world->width + x;
+            Color color = TRANSPARENT_TEXEL;
+            if (!layer_is_wall(batch, x, y) && state < num_states) {
+                color = q_value_to_color(q_source_value(source, state), min_q, max_q);
+            }
+            store_texel(&batch->q_values, x, y, color);
+        }
+    }
+    upload_layer(&batch->q_values);
+    draw_layer(vis, &batch->q_values);
+    
+    // Arrows and labels only where they are legible
+    float cell_pixels = screen_cell_size(vis);
+    if (cell_pixels < ARROW_MIN_PIXELS || !prepare_arrow_atlas(vis)) {
+        return true;
+    }
+    for (int y = y0; y < y1; y++) {
+        for (int x = x0; x < x1; x++) {
+            int state = y * world->width + x;
+            if (layer_is_wall(batch, x, y) || state >= num_states) continue;
+            
+            Rectangle tile = {(float)(q_source_action(source, state) * ARROW_TILE), 0.0f,
+                              (float)ARROW_TILE, (float)ARROW_TILE};
+            Rectangle cell_rect = get_cell_rect(vis, x, y);
+            DrawTexturePro(batch->arrows, tile, cell_rect, (Vector2){0.0f, 0.0f}, 0.0f, WHITE);
+            
+            if (vis->config.cell_size > 60) {
+                char q_text[16];
+                snprintf(q_text, sizeof(q_text), "%.2f", q_source_value(source, state));
+                int text_width = MeasureText(q_text, 12);
+                DrawText(q_text,
+                        (int)(cell_rect.x + cell_rect.width / 2 - text_width / 2),
+                        (int)(cell_rect.y + cell_rect.height / 2 + vis->config.cell_size * 0.15f + 5),
+                        12, BLACK);
+            }
+        }
+    }
+    return true;
+}
+
 // Draw the entire grid world
 void draw_grid_world(VisualizationState* vis, GridWorld* world) {
     if (!world || !vis) return;
@@ -133,10 +394,20 @@ void draw_grid_world(VisualizationState* vis, GridWorld* world) {
     // Clear background
     ClearBackground(vis->colors.background);
     
-    // Draw all cells
-    for (int y = 0; y < world->height; y++) {
-        for (int x = 0; x < world->width; x++) {
-            CellType cell_type = world->grid[y][x];
+    if (vis->config.batched_rendering && refresh_cell_layers(vis, world)) {
+        draw_layer(vis, &vis->batch.cells);
+        if (vis->config.show_grid && screen_cell_size(vis) >= GRID_LINE_MIN_PIXELS) {
+            draw_grid_lines(vis, world);
+        }
+        return;
+    }
+    
+    // Draw the cells on screen
+    int x0, y0, x1, y1;
+    get_visible_cell_range(vis, world, &x0, &y0, &x1, &y1);
+    for (int y = y0; y < y1; y++) {
+        for (int x = x0; x < x1; x++) {
+            CellType cell_type = get_cell(world, x, y);
             draw_cell(vis, x, y, cell_type);
         }
     }
@@ -216,9 +487,14 @@ void draw_goal(VisualizationState* vis, Position pos) {
 void draw_walls(VisualizationState* vis, GridWorld* world) {
     if (!world || !vis) return;
     
+    if (vis->config.batched_rendering && refresh_cell_layers(vis, world)) {
+        draw_layer(vis, &vis->batch.walls);
+        return;
+    }
+    
     for (int y = 0; y < world->height; y++) {
         for (int x = 0; x < world->width; x++) {
-            if (world->grid[y][x] == CELL_WALL) {
+            if (get_cell(world, x, y) == CELL_WALL) {
                 Rectangle cell_rect = get_cell_rect(vis, x, y);
                 DrawRectangleRec(cell_rect, vis->colors.wall_cell);
                 
@@ -260,102 +536,117 @@ Color q_value_to_color(float q_value, float min_q, float max_q) {
     }
 }
 
+// Heatmap colour, greedy-policy arrow and (for large cells) value of one cell
+static void draw_q_cell(VisualizationState* vis, int x, int y, float max_q_state, Action best_action,
+                        float min_q, float max_q) {
+    // Draw Q-value as background color
+    Rectangle cell_rect = get_cell_rect(vis, x, y);
+    Color q_color = q_value_to_color(max_q_state, min_q, max_q);
+    DrawRectangleRec(cell_rect, q_color);
+    
+    // Draw policy arrow showing best action
+    float center_x = cell_rect.x + cell_rect.width / 2;
+    float center_y = cell_rect.y + cell_rect.height / 2;
+    float arrow_size = vis->config.cell_size * 0.3f;
+    
+    Vector2 start = {center_x, center_y};
+    Vector2 end = start;
+    
+    switch (best_action) {
+        case ACTION_UP:
+            end.y -= arrow_size;
+            break;
+        case ACTION_DOWN:
+            end.y += arrow_size;
+            break;
+        case ACTION_LEFT:
+            end.x -= arrow_size;
+            break;
+        case ACTION_RIGHT:
+            end.x += arrow_size;
+            break;
+    }
+    
+    // Draw arrow
+    DrawLineEx(start, end, 3.0f, BLACK);
+    
+    // Draw arrowhead
+    Vector2 direction = {end.x - start.x, end.y - start.y};
+    float length = sqrtf(direction.x * direction.x + direction.y * direction.y);
+    if (length > 0) {
+        direction.x /= length;
+        direction.y /= length;
+        
+        Vector2 arrowhead1 = {
+            end.x - direction.x * 8 + direction.y * 4,
+            end.y - direction.y * 8 - direction.x * 4
+        };
+        Vector2 arrowhead2 = {
+            end.x - direction.x * 8 - direction.y * 4,
+            end.y - direction.y * 8 + direction.x * 4
+        };
+        
+        DrawLineEx(end, arrowhead1, 2.0f, BLACK);
+        DrawLineEx(end, arrowhead2, 2.0f, BLACK);
+    }
+    
+    // Draw Q-value text if cell is large enough
+    if (vis->config.cell_size > 60) {
+        char q_text[16];
+        snprintf(q_text, sizeof(q_text), "%.2f", max_q_state);
+        int text_width = MeasureText(q_text, 12);
+        DrawText(q_text, 
+                (int)(center_x - text_width/2), 
+                (int)(center_y + arrow_size/2 + 5), 
+                12, BLACK);
+    }
+}
+
 // Draw Q-values visualization
 void draw_q_values(VisualizationState* vis, GridWorld* world, QLearningAgent* agent) {
     if (!agent || !world || !vis || !vis->config.show_q_values) return;
     
-    // Find min and max Q-values for normalization
-    float min_q = 999999.0f, max_q = -999999.0f;
+    // Global range for normalization, maintained by the agent's update path
+    float min_q, max_q;
+    get_q_value_bounds(agent, &min_q, &max_q);
+    
+    if (vis->config.batched_rendering) {
+        QValueSource source = {agent, NULL};
+        if (draw_q_values_batched(vis, world, &source, min_q, max_q)) return;
+    }
     
-    for (int state = 0; state < agent->num_states; state++) {
-        for (int action = 0; action < agent->num_actions; action++) {
-            float q_val = agent->q_table[state][action];
-            if (q_val < min_q) min_q = q_val;
-            if (q_val > max_q) max_q = q_val;
+    // Draw Q-value heatmap for the cells on screen
+    int x0, y0, x1, y1;
+    get_visible_cell_range(vis, world, &x0, &y0, &x1, &y1);
+    for (int y = y0; y < y1; y++) {
+        for (int x = x0; x < x1; x++) {
+            int state = y * world->width + x;
+            if (get_cell(world, x, y) != CELL_WALL && state < agent->num_states) {
+                // Maximum Q-value for this state (cached in optimized storage)
+                draw_q_cell(vis, x, y, get_max_q_value(agent, state), select_greedy_action(agent, state),
+                            min_q, max_q);
+            }
         }
     }
+}
+
+// Same heatmap from a render snapshot published by the training thread
+void draw_snapshot_q_values(VisualizationState* vis, GridWorld* world, const RenderSnapshot* snapshot) {
+    if (!snapshot || !world || !vis || !vis->config.show_q_values) return;
     
-    // Draw Q-value heatmap
-    for (int y = 0; y < world->height; y++) {
-        for (int x = 0; x < world->width; x++) {
-            if (world->grid[y][x] != CELL_WALL) {
-                int state = y * world->width + x;
-                
-                if (state < agent->num_states) {
-                    // Find maximum Q-value for this state
-                    float max_q_state = -999999.0f;
-                    Action best_action = ACTION_UP;
-                    
-                    for (int action = 0; action < agent->num_actions; action++) {
-                        float q_val = agent->q_table[state][action];
-                        if (q_val > max_q_state) {
-                            max_q_state = q_val;
-                            best_action = action;
-                        }
-                    }
-                    
-                    // Draw Q-value as background color
-                    Rectangle cell_rect = get_cell_rect(vis, x, y);
-                    Color q_color = q_value_to_color(max_q_state, min_q, max_q);
-                    DrawRectangleRec(cell_rect, q_color);
-                    
-                    // Draw policy arrow showing best action
-                    float center_x = cell_rect.x + cell_rect.width / 2;
-                    float center_y = cell_rect.y + cell_rect.height / 2;
-                    float arrow_size = vis->config.cell_size * 0.3f;
-                    
-                    Vector2 start = {center_x, center_y};
-                    Vector2 end = start;
-                    
-                    switch (best_action) {
-                        case ACTION_UP:
-                            end.y -= arrow_size;
-                            break;
-                        case ACTION_DOWN:
-                            end.y += arrow_size;
-                            break;
-                        case ACTION_LEFT:
-                            end.x -= arrow_size;
-                            break;
-                        case ACTION_RIGHT:
-                            end.x += arrow_size;
-                            break;
-                    }
-                    
-                    // Draw arrow
-                    DrawLineEx(start, end, 3.0f, BLACK);
-                    
-                    // Draw arrowhead
-                    Vector2 direction = {end.x - start.x, end.y - start.y};
-                    float length = sqrtf(direction.x * direction.x + direction.y * direction.y);
-                    if (length > 0) {
-                        direction.x /= length;
-                        direction.y /= length;
-                        
-                        Vector2 arrowhead1 = {
-                            end.x - direction.x * 8 + direction.y * 4,
-                            end.y - direction.y * 8 - direction.x * 4
-                        };
-                        Vector2 arrowhead2 = {
-                            end.x - direction.x * 8 - direction.y * 4,
-                            end.y - direction.y * 8 + direction.x * 4
-                        };
-                        
-                        DrawLineEx(end, arrowhead1, 2.0f, BLACK);
-                        DrawLineEx(end, arrowhead2, 2.0f, BLACK);
-                    }
-                    
-                    // Draw Q-value text if cell is large enough
-                    if (vis->config.cell_size > 60) {
-                        char q_text[16];
-                        snprintf(q_text, sizeof(q_text), "%.2f", max_q_state);
-                        int text_width = MeasureText(q_text, 12);
-                        DrawText(q_text, 
-                                (int)(center_x - text_width/2), 
-                                (int)(center_y + arrow_size/2 + 5), 
-                                12, BLACK);
-                    }
-                }
+    if (vis->config.batched_rendering) {
+        QValueSource source = {NULL, snapshot};
+        if (draw_q_values_batched(vis, world, &source, snapshot->min_q, snapshot->max_q)) return;
+    }
+    
+    int x0, y0, x1, y1;
+    get_visible_cell_range(vis, world, &x0, &y0, &x1, &y1);
+    for (int y = y0; y < y1; y++) {
+        for (int x = x0; x < x1; x++) {
+            int state = y * world->width + x;
+            if (get_cell(world, x, y) != CELL_WALL && state < snapshot->num_states) {
+                draw_q_cell(vis, x, y, snapshot->state_max_q[state], (Action)snapshot->best_action[state],
+                            snapshot->min_q, snapshot->max_q);
             }
         }
     }
@@ -369,6 +660,7 @@ VisualizationState* get_visualization_state(void) {
 // Cleanup function
 void cleanup_graphics(void) {
     if (g_vis_state) {
+        release_batched_render_cache(g_vis_state);
         free(g_vis_state);
         g_vis_state = NULL;
     }
@@ -0,0 +1,179 @@
+#include "replay_buffer.h"
+#include "memory_arena.h"
+#include "profiler.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+// Transitions decoded per call of the update kernel
+#define COMPACT_REPLAY_CHUNK 64
+
+CompactReplayBuffer* create_compact_replay_buffer(int capacity, int num_states, int num_actions, ReplayConfig config) {
+    if (capacity <= 0 || num_states <= 0 || num_actions <= 0 || num_actions > (int)COMPACT_REPLAY_ACTION_MASK) {
+        fprintf(stderr, "Error: Invalid parameters for compact replay buffer\n");
+        return NULL;
+    }
+
+    CompactReplayBuffer* buffer = (CompactReplayBuffer*)memory_calloc(MEMORY_REPLAY, 1, sizeof(CompactReplayBuffer));
+    if (!buffer) {
+        fprintf(stderr, "Error: Failed to allocate memory for compact replay buffer\n");
+        return NULL;
+    }
+
+    buffer->wide_states = num_states > COMPACT_REPLAY_NARROW_STATES;
+    size_t state_bytes = buffer->wide_states ? sizeof(uint32_t) : sizeof(uint16_t);
+    buffer->states = memory_alloc(MEMORY_REPLAY, capacity * state_bytes);
+    buffer->next_states = memory_alloc(MEMORY_REPLAY, capacity * state_bytes);
+    buffer->actions = (uint8_t*)memory_alloc(MEMORY_REPLAY, capacity * sizeof(uint8_t));
+    buffer->rewards = (float*)memory_alloc(MEMORY_REPLAY, capacity * sizeof(float));
+    buffer->priority_tree = create_sum_tree(capacity);
+    if (!buffer->states || !buffer->next_states || !buffer->actions || !buffer->rewards || !buffer->priority_tree) {
+        fprintf(stderr, "Error: Failed to allocate memory for compact replay buffer columns\n");
+        destroy_compact_replay_buffer(buffer);
+        return NULL;
+    }
+
+    buffer->capacity = capacity;
+    buffer->num_states = num_states;
+    buffer->num_actions = num_actions;
+    buffer->stratified = config.stratified_sampling;
+    buffer->alpha = config.priority_alpha;
+    buffer->beta = config.priority_beta_start;
+    buffer->beta_increment = (config.priority_beta_end - config.priority_beta_start) / config.beta_anneal_steps;
+    buffer->min_priority = config.min_priority;
+    seed_random(&buffer->rng, (unsigned int)rand());  // Like the other buffers, reproducible after srand()
+    return buffer;
+}
+
+void destroy_compact_replay_buffer(CompactReplayBuffer* buffer) {
+    if (!buffer) return;
+
+    memory_free(buffer->states);
+    memory_free(buffer->next_states);
+    memory_free(buffer->actions);
+    memory_free(buffer->rewards);
+    destroy_sum_tree(buffer->priority_tree);
+    memory_free(buffer);
+}
+
+void seed_compact_replay_buffer(CompactReplayBuffer* buffer, unsigned int seed) {
+    if (!buffer) return;
+    seed_random(&buffer->rng, seed);
+}
+
+size_t compact_replay_bytes(const CompactReplayBuffer* buffer) {
+    if (!buffer) return 0;
+
+    size_t state_bytes = buffer->wide_states ? sizeof(uint32_t) : sizeof(uint16_t);
+    size_t column_bytes = (size_t)buffer->capacity * (2 * state_bytes + sizeof(uint8_t) + sizeof(float));
+    size_t tree_nodes = (size_t)buffer->priority_tree->leaf_base * 2;
+    return column_bytes + tree_nodes * (sizeof(double) + 2 * sizeof(float));
+}
+
+static inline float compact_priority(const CompactReplayBuffer* buffer, float td_error) {
+    return powf(fabsf(td_error) + buffer->min_priority, buffer->alpha);
+}
+
+bool add_compact_experience(CompactReplayBuffer* buffer, int state, Action action, float reward,
+                            int next_state, bool done, float td_error) {
+    if (!buffer || state < 0 || state >= buffer->num_states || next_state < 0 ||
+        next_state >= buffer->num_states || (int)action < 0 || (int)action >= buffer->num_actions) {
+        return false;
+    }
+
+    int slot = buffer->current_index;
+    if (buffer->wide_states) {
+        ((uint32_t*)buffer->states)[slot] = (uint32_t)state;
+        ((uint32_t*)buffer->next_states)[slot] = (uint32_t)next_state;
+    } else {
+        ((uint16_t*)buffer->states)[slot] = (uint16_t)state;
+        ((uint16_t*)buffer->next_states)[slot] = (uint16_t)next_state;
+    }
+    buffer->actions[slot] = (uint8_t)action | (done ? COMPACT_REPLAY_DONE : 0);
+    buffer->rewards[slot] = reward;
+    sum_tree_update(buffer->priority_tree, slot, compact_priority(buffer, td_error));
+
+    buffer->current_index = (slot + 1) % buffer->capacity;
+    if (buffer->size < buffer->capacity) {
+        buffer->size++;
+    }
+    return true;
+}
+
+bool sample_compact_batch(CompactReplayBuffer* buffer, int batch_size, int* indices, float* weights) {
+    if (!buffer || !indices || buffer->size == 0 || batch_size <= 0) return false;
+
+    PROFILE_BEGIN(PROFILE_REPLAY);
+    double total_priority = sum_tree_total(buffer->priority_tree);
+    float min_priority = sum_tree_min(buffer->priority_tree);
+    for (int i = 0; i < batch_size; i++) {
+        int slot = sum_tree_sample(buffer->priority_tree, total_priority, random_double(&buffer->rng), i,
+                                   batch_size, buffer->stratified, buffer->size);
+        indices[i] = slot;
+
+        if (weights) {
+            // (N * p_i / total)^-beta / (N * p_min / total)^-beta
+            float priority = sum_tree_get(buffer->priority_tree, slot);
+            weights[i] = priority > 0.0f && min_priority > 0.0f ? powf(priority / min_priority, -buffer->beta) : 1.0f;
+        }
+    }
+    PROFILE_END(PROFILE_REPLAY);
+    return true;
+}
+
+void update_compact_priorities(CompactReplayBuffer* buffer, const int* indices, const float* td_errors, int count) {
+    if (!buffer || !indices || !td_errors) return;
+
+    for (int i = 0; i < count; i++) {
+        if (indices[i] >= 0 && indices[i] < buffer->size) {
+            sum_tree_update(buffer->priority_tree, indices[i], compact_priority(buffer, td_errors[i]));
+        }
+    }
+}
+
+void update_compact_beta(CompactReplayBuffer* buffer) {
+    if (!buffer) return;
+    buffer->beta = fminf(buffer->beta + buffer->beta_increment, 1.0f);
+}
+
+void replay_compact_batch(QLearningAgent* agent, CompactReplayBuffer* buffer, const int* indices,
+                          const float* weights, int count, float* td_errors) {
+    if (!agent || !buffer || !indices) return;
+
+    int states[COMPACT_REPLAY_CHUNK];
+    int actions[COMPACT_REPLAY_CHUNK];
+    float rewards[COMPACT_REPLAY_CHUNK];
+    int next_states[COMPACT_REPLAY_CHUNK];
+    bool dones[COMPACT_REPLAY_CHUNK];
+    float errors[COMPACT_REPLAY_CHUNK];
+
+    for (int begin = 0; begin < count; begin += COMPACT_REPLAY_CHUNK) {
+        int n = count - begin < COMPACT_REPLAY_CHUNK ? count - begin : COMPACT_REPLAY_CHUNK;
+        const int* slots = indices + begin;
+
+        // Decode only the sampled slots into the kernel's stack arrays
+        for (int i = 0; i < n; i++) {
+            int slot = slots[i] >= 0 && slots[i] < buffer->size ? slots[i] : -1;
+            if (slot < 0) {
+                states[i] = -1;  // The kernel skips it
+                actions[i] = 0;
+                rewards[i] = 0.0f;
+                next_states[i] = 0;
+                dones[i] = true;
+                continue;
+            }
+            states[i] = compact_replay_state(buffer, slot);
+            actions[i] = (int)compact_replay_action(buffer, slot);
+            rewards[i] = compact_replay_reward(buffer, slot);
+            next_states[i] = compact_replay_next_state(buffer, slot);
+            dones[i] = compact_replay_done(buffer, slot);
+        }
+
+        replay_update_batch(agent, states, actions, rewards, next_states, dones,
+                            weights ? weights + begin : NULL, n, errors);
+        update_compact_priorities(buffer, slots, errors, n);
+        if (td_errors) {
+            for (int i = 0; i < n; i++) td_errors[begin + i] = errors[i];
+        }
+    }
+}
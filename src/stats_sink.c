@@ -0,0 +1,207 @@
+#define _POSIX_C_SOURCE 200809L  // clock_gettime, strdup
+
+#include "stats_sink.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static void write_csv_header(FILE* file) {
+    fprintf(file, "# Q-Learning Performance Data\n");
+    fprintf(file, "# Episode,Reward,Steps,Success,MovAvgReward,MovAvgSteps,Epsilon,QVariance\n");
+}
+
+// Write records [first, first + count) of the ring; called without the lock
+static bool write_records(StatsSink* sink, long long first, long long count) {
+    for (long long i = 0; i < count; i++) {
+        const StatsRecord* r = &sink->ring[(first + i) % sink->capacity];
+        if (sink->format == STATS_SINK_BINARY) {
+            if (fwrite(r, sizeof(StatsRecord), 1, sink->file) != 1) return false;
+        } else if (fprintf(sink->file, "%d,%.2f,%d,%d,%.2f,%.2f,%.4f,%.4f\n",
+                           r->episode, r->total_reward, r->steps_taken, r->success,
+                           r->moving_avg_reward, r->moving_avg_steps, r->epsilon, r->q_variance) < 0) {
+            return false;
+        }
+    }
+    return fflush(sink->file) == 0;
+}
+
+static void* stats_writer_main(void* arg) {
+    StatsSink* sink = (StatsSink*)arg;
+
+    pthread_mutex_lock(&sink->mutex);
+    for (;;) {
+        // Sleep until the ring is half full, a flush is requested or the interval passes
+        while (!sink->closing && sink->flush_requested <= sink->tail &&
+               sink->head - sink->tail < sink->capacity / 2) {
+            struct timespec deadline;
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            long long nanos = deadline.tv_nsec + (long long)(sink->flush_interval * 1e9);
+            deadline.tv_sec += (time_t)(nanos / 1000000000LL);
+            deadline.tv_nsec = (long)(nanos % 1000000000LL);
+            if (pthread_cond_timedwait(&sink->has_work, &sink->mutex, &deadline) != 0) {
+                break;  // Interval elapsed: write whatever is queued
+            }
+        }
+
+        long long first = sink->tail;
+        long long count = sink->head - sink->tail;
+        bool closing = sink->closing;
+        pthread_mutex_unlock(&sink->mutex);
+
+        // The producer never touches slots between tail and head
+        bool ok = count == 0 || write_records(sink, first, count);
+
+        pthread_mutex_lock(&sink->mutex);
+        if (!ok && !sink->write_failed) {
+            fprintf(stderr, "Error: Failed to write training stats to %s\n", sink->filename);
+            sink->write_failed = true;
+        }
+        sink->tail = first + count;
+        pthread_cond_broadcast(&sink->has_space);
+        if (closing && sink->tail == sink->head) break;
+    }
+    pthread_mutex_unlock(&sink->mutex);
+    return NULL;
+}
+
+StatsSink* create_stats_sink(const char* filename, StatsSinkFormat format, int capacity) {
+    if (!filename || capacity < 2) {
+        fprintf(stderr, "Error: Invalid parameters for stats sink\n");
+        return NULL;
+    }
+
+    StatsSink* sink = (StatsSink*)calloc(1, sizeof(StatsSink));
+    if (!sink) {
+        fprintf(stderr, "Error: Failed to allocate memory for stats sink\n");
+        return NULL;
+    }
+    sink->ring = (StatsRecord*)malloc(capacity * sizeof(StatsRecord));
+    sink->filename = strdup(filename);
+    if (!sink->ring || !sink->filename) {
+        fprintf(stderr, "Error: Failed to allocate memory for stats sink ring\n");
+        free(sink->ring);
+        free(sink->filename);
+        free(sink);
+        return NULL;
+    }
+
+    sink->file = fopen(filename, format == STATS_SINK_BINARY ? "wb" : "w");
+    if (!sink->file) {
+        fprintf(stderr, "Error: Could not create performance data file %s\n", filename);
+        free(sink->ring);
+        free(sink->filename);
+        free(sink);
+        return NULL;
+    }
+    if (format == STATS_SINK_BINARY) {
+        StatsFileHeader header = {STATS_FILE_MAGIC, STATS_FILE_VERSION, sizeof(StatsRecord), 0};
+        fwrite(&header, sizeof(header), 1, sink->file);
+    } else {
+        write_csv_header(sink->file);
+    }
+    fflush(sink->file);
+
+    sink->format = format;
+    sink->capacity = capacity;
+    sink->flush_interval = 0.25;
+    pthread_mutex_init(&sink->mutex, NULL);
+    pthread_cond_init(&sink->has_work, NULL);
+    pthread_cond_init(&sink->has_space, NULL);
+    if (pthread_create(&sink->writer, NULL, stats_writer_main, sink) != 0) {
+        fprintf(stderr, "Error: Failed to start stats writer thread\n");
+        pthread_cond_destroy(&sink->has_space);
+        pthread_cond_destroy(&sink->has_work);
+        pthread_mutex_destroy(&sink->mutex);
+        fclose(sink->file);
+        free(sink->ring);
+        free(sink->filename);
+        free(sink);
+        return NULL;
+    }
+    return sink;
+}
+
+bool stats_sink_append(StatsSink* sink, const StatsRecord* record) {
+    if (!sink || !record) return false;
+
+    pthread_mutex_lock(&sink->mutex);
+    while (sink->head - sink->tail == sink->capacity && !sink->closing) {
+        pthread_cond_signal(&sink->has_work);
+        pthread_cond_wait(&sink->has_space, &sink->mutex);
+    }
+    bool ok = !sink->closing;
+    if (ok) {
+        sink->ring[sink->head % sink->capacity] = *record;
+        sink->head++;
+        if (sink->head - sink->tail == sink->capacity / 2) {
+            pthread_cond_signal(&sink->has_work);
+        }
+    }
+    pthread_mutex_unlock(&sink->mutex);
+    return ok;
+}
+
+bool stats_sink_record_episode(StatsSink* sink, TrainingStats* stats, int episode) {
+    if (!sink || !stats || !stats->metrics) return false;
+
+    EpisodeStats* ep = get_episode_stats(stats, episode);
+    if (!ep) return false;
+
+    const PerformanceMetrics* metrics = stats->metrics;
+    int slot = episode % metrics->history_size;
+    StatsRecord record = {
+        .episode = episode + 1,
+        .total_reward = ep->total_reward,
+        .steps_taken = ep->steps_taken,
+        .success = metrics->success_episodes[slot],
+        .moving_avg_reward = metrics->moving_avg_rewards[slot],
+        .moving_avg_steps = metrics->moving_avg_steps[slot],
+        .epsilon = metrics->epsilon_history[slot],
+        .q_variance = metrics->q_value_variance[slot]
+    };
+    return stats_sink_append(sink, &record);
+}
+
+bool stats_sink_flush(StatsSink* sink) {
+    if (!sink) return false;
+
+    pthread_mutex_lock(&sink->mutex);
+    long long target = sink->head;
+    if (target > sink->flush_requested) {
+        sink->flush_requested = target;
+    }
+    pthread_cond_signal(&sink->has_work);
+    while (sink->tail < target) {
+        pthread_cond_wait(&sink->has_space, &sink->mutex);
+    }
+    bool ok = !sink->write_failed;
+    pthread_mutex_unlock(&sink->mutex);
+    return ok;
+}
+
+void close_stats_sink(StatsSink* sink) {
+    if (!sink) return;
+
+    pthread_mutex_lock(&sink->mutex);
+    sink->closing = true;
+    pthread_cond_signal(&sink->has_work);
+    pthread_mutex_unlock(&sink->mutex);
+    pthread_join(sink->writer, NULL);
+
+    pthread_cond_destroy(&sink->has_space);
+    pthread_cond_destroy(&sink->has_work);
+    pthread_mutex_destroy(&sink->mutex);
+    fclose(sink->file);
+    free(sink->ring);
+    free(sink->filename);
+    free(sink);
+}
+
+long long stats_sink_records_written(StatsSink* sink) {
+    if (!sink) return 0;
+
+    pthread_mutex_lock(&sink->mutex);
+    long long written = sink->tail;
+    pthread_mutex_unlock(&sink->mutex);
+    return written;
+}
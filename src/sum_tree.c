@@ -0,0 +1,134 @@
+#include "sum_tree.h"
+#include "memory_arena.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <float.h>
+
+// Create a sum tree able to hold capacity items, all initially unused
+SumTree* create_sum_tree(int capacity) {
+    if (capacity <= 0) {
+        fprintf(stderr, "Error: Invalid sum tree capacity %d\n", capacity);
+        return NULL;
+    }
+
+    SumTree* tree = (SumTree*)memory_alloc(MEMORY_REPLAY, sizeof(SumTree));
+    if (!tree) {
+        fprintf(stderr, "Error: Failed to allocate memory for sum tree\n");
+        return NULL;
+    }
+
+    tree->capacity = capacity;
+    tree->leaf_base = 1;
+    while (tree->leaf_base < capacity) {
+        tree->leaf_base <<= 1;
+    }
+
+    size_t nodes = (size_t)tree->leaf_base * 2;
+    tree->sums = (double*)memory_alloc(MEMORY_REPLAY, nodes * sizeof(double));
+    tree->mins = (float*)memory_alloc(MEMORY_REPLAY, nodes * sizeof(float));
+    tree->maxs = (float*)memory_alloc(MEMORY_REPLAY, nodes * sizeof(float));
+    if (!tree->sums || !tree->mins || !tree->maxs) {
+        fprintf(stderr, "Error: Failed to allocate memory for sum tree nodes\n");
+        destroy_sum_tree(tree);
+        return NULL;
+    }
+
+    sum_tree_clear(tree);
+    return tree;
+}
+
+// Destroy a sum tree
+void destroy_sum_tree(SumTree* tree) {
+    if (!tree) return;
+
+    memory_free(tree->sums);
+    memory_free(tree->mins);
+    memory_free(tree->maxs);
+    memory_free(tree);
+}
+
+// Mark every leaf unused
+void sum_tree_clear(SumTree* tree) {
+    if (!tree) return;
+
+    size_t nodes = (size_t)tree->leaf_base * 2;
+    for (size_t i = 0; i < nodes; i++) {
+        tree->sums[i] = 0.0;
+        tree->mins[i] = FLT_MAX;
+        tree->maxs[i] = 0.0f;
+    }
+}
+
+// Set one leaf and refresh its ancestors
+void sum_tree_update(SumTree* tree, int index, float priority) {
+    if (!tree || index < 0 || index >= tree->capacity) return;
+
+    int node = tree->leaf_base + index;
+    if (priority > 0.0f) {
+        tree->sums[node] = priority;
+        tree->mins[node] = priority;
+        tree->maxs[node] = priority;
+    } else {
+        tree->sums[node] = 0.0;
+        tree->mins[node] = FLT_MAX;
+        tree->maxs[node] = 0.0f;
+    }
+
+    for (node >>= 1; node >= 1; node >>= 1) {
+        int left = node << 1;
+        int right = left + 1;
+        tree->sums[node] = tree->sums[left] + tree->sums[right];
+        tree->mins[node] = tree->mins[left] < tree->mins[right] ? tree->mins[left] : tree->mins[right];
+        tree->maxs[node] = tree->maxs[left] > tree->maxs[right] ? tree->maxs[left] : tree->maxs[right];
+    }
+}
+
+// Priority stored for one item (0 if unused)
+float sum_tree_get(SumTree* tree, int index) {
+    if (!tree || index < 0 || index >= tree->capacity) return 0.0f;
+    return (float)tree->sums[tree->leaf_base + index];
+}
+
+double sum_tree_total(SumTree* tree) {
+    return tree ? tree->sums[1] : 0.0;
+}
+
+float sum_tree_min(SumTree* tree) {
+    return tree ? tree->mins[1] : FLT_MAX;
+}
+
+float sum_tree_max(SumTree* tree) {
+    return tree ? tree->maxs[1] : 0.0f;
+}
+
+// Descend from the root following the prefix sum
+int sum_tree_find(SumTree* tree, double prefix) {
+    if (!tree || tree->sums[1] <= 0.0) return -1;
+
+    if (prefix < 0.0) prefix = 0.0;
+    int node = 1;
+    while (node < tree->leaf_base) {
+        int left = node << 1;
+        int right = left + 1;
+        // Rounding can push the prefix past the left subtree into an empty
+        // right one; stay left in that case so an unused leaf is never chosen
+        if (prefix < tree->sums[left] || tree->sums[right] <= 0.0) {
+            node = left;
+        } else {
+            prefix -= tree->sums[left];
+            node = right;
+        }
+    }
+    return node - tree->leaf_base;
+}
+
+// Shared by the priority and compact replay buffers so both draw identically
+int sum_tree_sample(SumTree* tree, double total, double u, int i, int batch_size, bool stratified, int size) {
+    double prefix = stratified ? (i + u) * (total / batch_size) : u * total;
+
+    int index = sum_tree_find(tree, prefix);
+    if (index < 0 || index >= size) {
+        index = size - 1;
+    }
+    return index;
+}
@@ -0,0 +1,484 @@
+#define _POSIX_C_SOURCE 200809L  // clock_gettime, sysconf
+
+#include "sweep.h"
+#include "training.h"
+#include "memory_arena.h"
+#include <pthread.h>
+#include <ctype.h>
+#include <errno.h>
+#include <limits.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// Work shared by the sweep threads; trials are claimed through next_trial
+typedef struct {
+    GridWorld* world;
+    const SweepSpec* spec;
+    FILE* output;
+    SweepTrialResult* results;
+    int num_trials;
+    int next_trial;             // Modified atomically
+    pthread_mutex_t output_mutex;
+} SweepContext;
+
+static const char* const SWEEP_KEYS[] = {
+    "search", "learning_rate", "discount_factor", "epsilon_decay", "trials", "episodes", "max_steps",
+    "epsilon", "epsilon_min", "stop_on_convergence", "threads", "seed", "output"
+};
+
+static double wall_time_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void single_value(SweepValues* values, float value) {
+    memset(values, 0, sizeof(*values));
+    values->values[0] = value;
+    values->count = 1;
+}
+
+SweepSpec create_default_sweep_spec(void) {
+    SweepSpec spec;
+    memset(&spec, 0, sizeof(spec));
+    spec.search = SWEEP_SEARCH_GRID;
+    single_value(&spec.parameters[SWEEP_LEARNING_RATE], 0.1f);
+    single_value(&spec.parameters[SWEEP_DISCOUNT_FACTOR], 0.9f);
+    single_value(&spec.parameters[SWEEP_EPSILON_DECAY], 0.995f);
+    spec.random_trials = 16;
+    spec.num_episodes = 1000;
+    spec.max_steps_per_episode = 200;
+    spec.epsilon = 1.0f;
+    spec.epsilon_min = 0.01f;
+    spec.storage = DEFAULT_QTABLE_STORAGE;
+    spec.stop_on_convergence = true;
+    spec.num_threads = 0;
+    spec.seed = 42;
+    return spec;
+}
+
+const char* sweep_parameter_name(SweepParameter parameter) {
+    switch (parameter) {
+        case SWEEP_LEARNING_RATE:   return "learning_rate";
+        case SWEEP_DISCOUNT_FACTOR: return "discount_factor";
+        case SWEEP_EPSILON_DECAY:   return "epsilon_decay";
+        default:                    return "unknown";
+    }
+}
+
+const char* sweep_trial_status_name(SweepTrialStatus status) {
+    switch (status) {
+        case SWEEP_TRIAL_COMPLETED: return "completed";
+        case SWEEP_TRIAL_CONVERGED: return "converged";
+        case SWEEP_TRIAL_DIVERGED:  return "diverged";
+        case SWEEP_TRIAL_FAILED:    return "failed";
+        default:                    return "unknown";
+    }
+}
+
+// "a, b, c" or "min:max"
+static bool parse_sweep_values(const char* key, const char* text, SweepValues* values) {
+    SweepValues parsed;
+    memset(&parsed, 0, sizeof(parsed));
+
+    char extra;
+    if (strchr(text, ':')) {
+        if (sscanf(text, "%f : %f %c", &parsed.min, &parsed.max, &extra) != 2 ||
+            !isfinite(parsed.min) || !isfinite(parsed.max) || parsed.min > parsed.max) {
+            fprintf(stderr, "Error: Sweep %s = '%s' is not a range min:max\n", key, text);
+            return false;
+        }
+        parsed.is_range = true;
+        *values = parsed;
+        return true;
+    }
+
+    const char* p = text;
+    for (;;) {
+        char* end;
+        float value = strtof(p, &end);
+        if (end == p || !isfinite(value) || parsed.count == SWEEP_MAX_VALUES) {
+            fprintf(stderr, "Error: Sweep %s = '%s' is not a list of up to %d numbers\n", key, text,
+                    SWEEP_MAX_VALUES);
+            return false;
+        }
+        parsed.values[parsed.count++] = value;
+        while (isspace((unsigned char)*end)) end++;
+        if (*end == '\0') break;
+        if (*end != ',') {
+            fprintf(stderr, "Error: Sweep %s = '%s' is not a list of numbers\n", key, text);
+            return false;
+        }
+        p = end + 1;
+    }
+    *values = parsed;
+    return true;
+}
+
+// Scalar keys are read strictly: a present but malformed value fails the
+// parse, where get_config_int and friends would fall back to the default
+static bool sweep_int(ConfigFile* config, const char* key, int* value) {
+    const char* text = get_config_value(config, key);
+    if (!text) return true;
+
+    char* end;
+    errno = 0;
+    long parsed = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || errno != 0 || parsed < INT_MIN || parsed > INT_MAX) {
+        fprintf(stderr, "Error: Sweep %s = '%s' is not an integer\n", key, text);
+        return false;
+    }
+    *value = (int)parsed;
+    return true;
+}
+
+static bool sweep_float(ConfigFile* config, const char* key, float* value) {
+    const char* text = get_config_value(config, key);
+    if (!text) return true;
+
+    char* end;
+    float parsed = strtof(text, &end);
+    if (end == text || *end != '\0' || !isfinite(parsed)) {
+        fprintf(stderr, "Error: Sweep %s = '%s' is not a number\n", key, text);
+        return false;
+    }
+    *value = parsed;
+    return true;
+}
+
+static bool sweep_bool(ConfigFile* config, const char* key, bool* value) {
+    const char* text = get_config_value(config, key);
+    if (!text) return true;
+
+    if (strcmp(text, "true") == 0 || strcmp(text, "yes") == 0 || strcmp(text, "on") == 0 ||
+        strcmp(text, "1") == 0) {
+        *value = true;
+        return true;
+    }
+    if (strcmp(text, "false") == 0 || strcmp(text, "no") == 0 || strcmp(text, "off") == 0 ||
+        strcmp(text, "0") == 0) {
+        *value = false;
+        return true;
+    }
+    fprintf(stderr, "Error: Sweep %s = '%s' is not a boolean\n", key, text);
+    return false;
+}
+
+bool parse_sweep_spec(ConfigFile* config, SweepSpec* spec) {
+    if (!config || !spec) return false;
+
+    // A mistyped key would silently sweep the default instead
+    for (int i = 0; i < config->count; i++) {
+        bool known = false;
+        for (size_t k = 0; k < sizeof(SWEEP_KEYS) / sizeof(SWEEP_KEYS[0]) && !known; k++) {
+            known = strcmp(config->pairs[i].key, SWEEP_KEYS[k]) == 0;
+        }
+        if (!known) {
+            fprintf(stderr, "Error: Unknown sweep key '%s'\n", config->pairs[i].key);
+            return false;
+        }
+    }
+
+    SweepSpec parsed = *spec;
+    const char* search = get_config_value(config, "search");
+    if (search) {
+        if (strcmp(search, "grid") == 0) {
+            parsed.search = SWEEP_SEARCH_GRID;
+        } else if (strcmp(search, "random") == 0) {
+            parsed.search = SWEEP_SEARCH_RANDOM;
+        } else {
+            fprintf(stderr, "Error: Unknown sweep search '%s' (expected grid or random)\n", search);
+            return false;
+        }
+    }
+
+    for (int p = 0; p < NUM_SWEEP_PARAMETERS; p++) {
+        const char* key = sweep_parameter_name((SweepParameter)p);
+        const char* text = get_config_value(config, key);
+        if (text && !parse_sweep_values(key, text, &parsed.parameters[p])) {
+            return false;
+        }
+        if (parsed.search == SWEEP_SEARCH_GRID && parsed.parameters[p].is_range) {
+            fprintf(stderr, "Error: Sweep %s: grid search needs a list, not a range\n", key);
+            return false;
+        }
+    }
+
+    int seed = (int)parsed.seed;
+    if (!sweep_int(config, "trials", &parsed.random_trials) ||
+        !sweep_int(config, "episodes", &parsed.num_episodes) ||
+        !sweep_int(config, "max_steps", &parsed.max_steps_per_episode) ||
+        !sweep_float(config, "epsilon", &parsed.epsilon) ||
+        !sweep_float(config, "epsilon_min", &parsed.epsilon_min) ||
+        !sweep_bool(config, "stop_on_convergence", &parsed.stop_on_convergence) ||
+        !sweep_int(config, "threads", &parsed.num_threads) ||
+        !sweep_int(config, "seed", &seed)) {
+        return false;
+    }
+    parsed.seed = (unsigned int)seed;
+    const char* output = get_config_value(config, "output");
+    if (output) {
+        snprintf(parsed.output_filename, sizeof(parsed.output_filename), "%s", output);
+    }
+
+    if (parsed.random_trials < 1 || parsed.num_episodes < 1 || parsed.max_steps_per_episode < 1 ||
+        parsed.num_threads < 0) {
+        fprintf(stderr, "Error: Sweep trials, episodes and max_steps must be positive, threads non-negative\n");
+        return false;
+    }
+    *spec = parsed;
+    return true;
+}
+
+bool load_sweep_spec(const char* filename, SweepSpec* spec) {
+    ConfigFile* config = load_config(filename);
+    if (!config) return false;
+
+    bool ok = parse_sweep_spec(config, spec);
+    destroy_config(config);
+    return ok;
+}
+
+int sweep_trial_count(const SweepSpec* spec) {
+    if (!spec) return 0;
+    if (spec->search == SWEEP_SEARCH_RANDOM) return spec->random_trials;
+
+    int count = 1;
+    for (int p = 0; p < NUM_SWEEP_PARAMETERS; p++) {
+        count *= spec->parameters[p].count;
+    }
+    return count;
+}
+
+// Seeds of trial i follow the parallel trainer's per-worker scheme
+static unsigned int trial_seed(const SweepSpec* spec, int trial) {
+    return spec->seed + 0x9E3779B9u * (unsigned int)(trial + 1);
+}
+
+void sweep_trial_parameters(const SweepSpec* spec, int trial, float parameters[NUM_SWEEP_PARAMETERS]) {
+    if (spec->search == SWEEP_SEARCH_GRID) {
+        // Mixed-radix index, the last parameter varying fastest
+        int index = trial;
+        for (int p = NUM_SWEEP_PARAMETERS - 1; p >= 0; p--) {
+            const SweepValues* values = &spec->parameters[p];
+            parameters[p] = values->values[index % values->count];
+            index /= values->count;
+        }
+        return;
+    }
+
+    RandomState rng;
+    seed_random(&rng, trial_seed(spec, trial) ^ 0x6A09E667u);
+    for (int p = 0; p < NUM_SWEEP_PARAMETERS; p++) {
+        const SweepValues* values = &spec->parameters[p];
+        parameters[p] = values->is_range ? random_range(&rng, values->min, values->max)
+                                         : values->values[random_int(&rng, 0, values->count - 1)];
+    }
+}
+
+SweepTrialResult run_sweep_trial(GridWorld* world, const SweepSpec* spec, int trial) {
+    SweepTrialResult result;
+    memset(&result, 0, sizeof(result));
+    result.trial = trial;
+    result.status = SWEEP_TRIAL_FAILED;
+    result.convergence_episode = -1;
+    if (!world || !spec) return result;
+
+    double start_time = wall_time_seconds();
+    sweep_trial_parameters(spec, trial, result.parameters);
+
+    GridWorld* trial_world = clone_grid_world(world);
+    QLearningAgent* agent = NULL;
+    TrainingStats* stats = NULL;
+    if (trial_world) {
+        agent = create_agent_with_storage(world->width * world->height, NUM_ACTIONS,
+                                          result.parameters[SWEEP_LEARNING_RATE],
+                                          result.parameters[SWEEP_DISCOUNT_FACTOR], spec->epsilon, spec->storage);
+    }
+    if (agent) {
+        stats = create_training_stats(spec->num_episodes);
+    }
+
+    if (stats) {
+        unsigned int seed = trial_seed(spec, trial);
+        seed_agent(agent, seed);
+        seed_environment(trial_world, seed ^ 0xBB67AE85u);
+        trial_world->max_steps = spec->max_steps_per_episode;
+        agent->epsilon_decay = result.parameters[SWEEP_EPSILON_DECAY];
+        agent->epsilon_min = spec->epsilon_min;
+        result.status = SWEEP_TRIAL_COMPLETED;
+
+        for (int episode = 0; episode < spec->num_episodes; episode++) {
+            EpisodeProgress progress = run_training_episode(trial_world, agent, spec->max_steps_per_episode, NULL);
+            bool converged = finish_training_episode(trial_world, agent, stats, episode, &progress);
+            result.episodes_run++;
+            result.total_steps += progress.steps_taken;
+
+            float avg_q = progress.q_value_count > 0 ? progress.total_q_value / progress.q_value_count : 0.0f;
+            if (!isfinite(avg_q) || fabsf(avg_q) > SWEEP_DIVERGENCE_LIMIT) {
+                result.status = SWEEP_TRIAL_DIVERGED;
+                break;
+            }
+            if (converged && result.convergence_episode < 0) {
+                result.convergence_episode = episode;
+                if (spec->stop_on_convergence) {
+                    result.status = SWEEP_TRIAL_CONVERGED;
+                    break;
+                }
+            }
+        }
+
+        PerformanceMetrics* metrics = stats->metrics;
+        result.success_rate = (float)stats->total_successful_episodes / result.episodes_run;
+        result.final_avg_reward = metrics->moving_avg_rewards[(result.episodes_run - 1) % metrics->history_size];
+    }
+
+    destroy_training_stats(stats);
+    destroy_agent(agent);
+    destroy_grid_world(trial_world);
+    result.elapsed_seconds = wall_time_seconds() - start_time;
+    return result;
+}
+
+static void write_sweep_header(FILE* output) {
+    fprintf(output, "trial");
+    for (int p = 0; p < NUM_SWEEP_PARAMETERS; p++) {
+        fprintf(output, ",%s", sweep_parameter_name((SweepParameter)p));
+    }
+    fprintf(output, ",status,episodes,convergence_episode,success_rate,final_avg_reward,steps,seconds\n");
+}
+
+static void write_sweep_result(FILE* output, const SweepTrialResult* result) {
+    fprintf(output, "%d", result->trial);
+    for (int p = 0; p < NUM_SWEEP_PARAMETERS; p++) {
+        fprintf(output, ",%.6g", result->parameters[p]);
+    }
+    fprintf(output, ",%s,%d,%d,%.4f,%.3f,%lld,%.4f\n", sweep_trial_status_name(result->status),
+            result->episodes_run, result->convergence_episode, result->success_rate, result->final_avg_reward,
+            result->total_steps, result->elapsed_seconds);
+}
+
+static void* sweep_worker_main(void* arg) {
+    SweepContext* ctx = (SweepContext*)arg;
+
+    // Trials are built and torn down in a private arena (the heap if it cannot be created)
+    MemoryArena* arena = create_memory_arena(0, 0);
+    MemoryArena* previous = set_memory_arena(arena);
+
+    for (;;) {
+        int trial = __atomic_fetch_add(&ctx->next_trial, 1, __ATOMIC_RELAXED);
+        if (trial >= ctx->num_trials) break;
+
+        SweepTrialResult result = run_sweep_trial(ctx->world, ctx->spec, trial);
+        if (arena) {
+            reset_memory_arena(arena);
+        }
+        ctx->results[trial] = result;
+
+        // One line per trial as soon as it finishes, so a long sweep can be watched or cut short
+        if (ctx->output) {
+            pthread_mutex_lock(&ctx->output_mutex);
+            write_sweep_result(ctx->output, &result);
+            fflush(ctx->output);
+            pthread_mutex_unlock(&ctx->output_mutex);
+        }
+    }
+
+    set_memory_arena(previous);
+    destroy_memory_arena(arena);
+    return NULL;
+}
+
+// Earliest convergence wins; without any, the highest final reward of a finished trial
+static int best_sweep_trial(const SweepTrialResult* results, int count) {
+    int best = -1;
+    for (int i = 0; i < count; i++) {
+        const SweepTrialResult* r = &results[i];
+        if (r->status != SWEEP_TRIAL_CONVERGED && r->status != SWEEP_TRIAL_COMPLETED) continue;
+        if (best < 0) {
+            best = i;
+            continue;
+        }
+        const SweepTrialResult* b = &results[best];
+        bool r_converged = r->convergence_episode >= 0;
+        bool b_converged = b->convergence_episode >= 0;
+        if (r_converged != b_converged) {
+            if (r_converged) best = i;
+        } else if (r_converged ? r->convergence_episode < b->convergence_episode
+                               : r->final_avg_reward > b->final_avg_reward) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+SweepSummary run_sweep(GridWorld* world, const SweepSpec* spec, FILE* output, SweepTrialResult* results) {
+    SweepSummary summary;
+    memset(&summary, 0, sizeof(summary));
+    summary.best_trial = -1;
+    if (!world || !spec || spec->storage == QTABLE_STORAGE_MAPPED) {
+        fprintf(stderr, "Error: Invalid parameters for sweep (trials need in-memory Q-tables)\n");
+        return summary;
+    }
+
+    int num_trials = sweep_trial_count(spec);
+    if (num_trials <= 0) {
+        fprintf(stderr, "Error: Sweep has no trials (a parameter has no values)\n");
+        return summary;
+    }
+    SweepTrialResult* all = results ? results : (SweepTrialResult*)malloc((size_t)num_trials * sizeof(SweepTrialResult));
+    if (!all) {
+        fprintf(stderr, "Error: Failed to allocate results for %d sweep trials\n", num_trials);
+        return summary;
+    }
+
+    int threads = spec->num_threads;
+    if (threads == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = online > 0 ? (int)online : 1;
+    }
+    if (threads > num_trials) threads = num_trials;
+
+    if (output) {
+        write_sweep_header(output);
+        fflush(output);
+    }
+
+    bool env_verbose = is_environment_verbose();
+    set_environment_verbose(false);
+    SweepContext ctx = {world, spec, output, all, num_trials, 0, PTHREAD_MUTEX_INITIALIZER};
+    double start_time = wall_time_seconds();
+
+    pthread_t* helpers = threads > 1 ? (pthread_t*)malloc((threads - 1) * sizeof(pthread_t)) : NULL;
+    int started = 0;
+    if (helpers) {
+        // Trials are claimed dynamically, so a helper that fails to start costs only speed
+        while (started < threads - 1 && pthread_create(&helpers[started], NULL, sweep_worker_main, &ctx) == 0) {
+            started++;
+        }
+    }
+    sweep_worker_main(&ctx);
+    for (int i = 0; i < started; i++) {
+        pthread_join(helpers[i], NULL);
+    }
+    free(helpers);
+
+    summary.elapsed_seconds = wall_time_seconds() - start_time;
+    summary.num_trials = num_trials;
+    summary.num_threads = started + 1;
+    for (int i = 0; i < num_trials; i++) {
+        summary.status_counts[all[i].status]++;
+        summary.total_steps += all[i].total_steps;
+    }
+    summary.best_trial = best_sweep_trial(all, num_trials);
+
+    pthread_mutex_destroy(&ctx.output_mutex);
+    set_environment_verbose(env_verbose);
+    if (!results) {
+        free(all);
+    }
+    return summary;
+}
@@ -0,0 +1,98 @@
+#include "training.h"
+#include "profiler.h"
+#include <stdio.h>
+#include <string.h>
+
+// Mean Q-value over all actions of a state
+float calculate_avg_q_value(QLearningAgent* agent, int state) {
+    float sum = 0.0f;
+    for (int action = 0; action < agent->num_actions; action++) {
+        sum += get_q_value(agent, state, action);
+    }
+    return sum / agent->num_actions;
+}
+
+// Reset the environment for a new episode
+EpisodeProgress begin_training_episode(GridWorld* world) {
+    EpisodeProgress progress;
+    memset(&progress, 0, sizeof(progress));
+    reset_environment(world);
+    return progress;
+}
+
+// Select, act, learn and accumulate statistics for one step
+Action training_step(GridWorld* world, QLearningAgent* agent, EpisodeProgress* progress, int* visit_counts) {
+    // Get current state
+    int current_state = get_state_index(world);
+    if (visit_counts) {
+        visit_counts[current_state]++;
+    }
+
+    // Select action using epsilon-greedy policy
+    PROFILE_BEGIN(PROFILE_ACTION_SELECT);
+    Action action = select_action(agent, current_state);
+    PROFILE_END(PROFILE_ACTION_SELECT);
+
+    // Take action and get result
+    PROFILE_BEGIN(PROFILE_ENV_STEP);
+    StepResult result = step_environment(world, action);
+    PROFILE_END(PROFILE_ENV_STEP);
+
+    // Update Q-value
+    PROFILE_BEGIN(PROFILE_Q_UPDATE);
+    update_q_value(agent, current_state, action, result.reward,
+                   position_to_state(world, result.next_state.position), result.done);
+    PROFILE_END(PROFILE_Q_UPDATE);
+
+    // Accumulate statistics
+    progress->total_reward += result.reward;
+    progress->steps_taken++;
+
+    // Average Q-value for statistics
+    progress->total_q_value += calculate_avg_q_value(agent, current_state);
+    progress->q_value_count++;
+
+    return action;
+}
+
+// Decay epsilon and record the finished episode
+bool finish_training_episode(GridWorld* world, QLearningAgent* agent, TrainingStats* stats,
+                             int episode, EpisodeProgress* progress) {
+    PROFILE_BEGIN(PROFILE_STATS);
+
+    // Decay epsilon after each episode; traces never span episodes
+    decay_epsilon(agent);
+    clear_eligibility_traces(agent);
+
+    // Calculate Q-value variance for performance metrics
+    float q_variance = calculate_q_value_variance(agent);
+
+    // Check if goal was reached
+    progress->goal_reached = (world->agent_pos.x == world->goal_pos.x &&
+                              world->agent_pos.y == world->goal_pos.y);
+
+    bool converged = false;
+    if (stats) {
+        // Record episode statistics
+        float avg_q_episode = progress->q_value_count > 0 ? progress->total_q_value / progress->q_value_count : 0.0f;
+        record_episode(stats, episode, progress->total_reward, progress->steps_taken, agent->epsilon, avg_q_episode);
+
+        // Update performance metrics
+        update_performance_metrics(stats->metrics, stats, episode, progress->goal_reached, q_variance);
+
+        // Check for convergence
+        converged = check_convergence(stats->metrics, episode);
+    }
+
+    PROFILE_END(PROFILE_STATS);
+    return converged;
+}
+
+// Run one episode without bookkeeping
+EpisodeProgress run_training_episode(GridWorld* world, QLearningAgent* agent, int max_steps, int* visit_counts) {
+    EpisodeProgress progress = begin_training_episode(world);
+    while (training_episode_running(world, &progress, max_steps)) {
+        training_step(world, agent, &progress, visit_counts);
+    }
+    return progress;
+}
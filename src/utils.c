@@ -0,0 +1,427 @@
+#include "utils.h"
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+
+// ============================================================================
+// RANDOM NUMBER GENERATION
+// ============================================================================
+
+// splitmix64 step, used to expand a 32-bit seed into the 256-bit state
+static uint64_t splitmix64(uint64_t* x) {
+    uint64_t z = (*x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Create a heap-allocated generator
+RandomState* init_random(unsigned int seed) {
+    RandomState* rng = (RandomState*)malloc(sizeof(RandomState));
+    if (!rng) {
+        fprintf(stderr, "Error: Failed to allocate memory for random state\n");
+        return NULL;
+    }
+    seed_random(rng, seed);
+    return rng;
+}
+
+void destroy_random(RandomState* rng) {
+    free(rng);
+}
+
+// (Re)seed an embedded generator; equal seeds give identical streams
+void seed_random(RandomState* rng, unsigned int seed) {
+    if (!rng) return;
+
+    uint64_t x = seed;
+    for (int i = 0; i < 4; i++) {
+        rng->s[i] = splitmix64(&x);
+    }
+    rng->seed = seed;
+    rng->initialized = true;
+}
+
+// Advance the state by 2^128 steps. Seeding once and jumping k times gives k
+// non-overlapping streams, one per worker thread.
+void random_jump(RandomState* rng) {
+    static const uint64_t JUMP[] = {
+        0x180EC6D33CFD0ABAULL, 0xD5A61266F0C9392CULL,
+        0xA9582618E03FC9AAULL, 0x39ABDC4529B1661CULL
+    };
+    if (!rng) return;
+
+    uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    for (int i = 0; i < 4; i++) {
+        for (int b = 0; b < 64; b++) {
+            if (JUMP[i] & (1ULL << b)) {
+                s0 ^= rng->s[0];
+                s1 ^= rng->s[1];
+                s2 ^= rng->s[2];
+                s3 ^= rng->s[3];
+            }
+            random_next_u64(rng);
+        }
+    }
+    rng->s[0] = s0;
+    rng->s[1] = s1;
+    rng->s[2] = s2;
+    rng->s[3] = s3;
+}
+
+// Uniform float in [0, 1)
+float random_float(RandomState* rng) {
+    return random_next_float(rng);
+}
+
+// Uniform double in [0, 1) with 53-bit resolution
+double random_double(RandomState* rng) {
+    return (double)(random_next_u64(rng) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// Uniform float in [min, max)
+float random_range(RandomState* rng, float min, float max) {
+    return min + (max - min) * random_next_float(rng);
+}
+
+// Uniform integer in [min, max] (inclusive)
+int random_int(RandomState* rng, int min, int max) {
+    if (max <= min) return min;
+    uint32_t span = (uint32_t)((int64_t)max - min + 1);
+    if (span == 0) {  // Full 32-bit range
+        return (int)(uint32_t)(random_next_u64(rng) >> 32);
+    }
+    return (int)((int64_t)min + random_next_bounded(rng, span));
+}
+
+// True with the given probability
+bool random_bool(RandomState* rng, float probability) {
+    return random_next_float(rng) < probability;
+}
+
+// Fisher-Yates shuffle of count elements of element_size bytes
+void shuffle_array(RandomState* rng, void* array, size_t element_size, size_t count) {
+    if (!rng || !array || count < 2 || element_size == 0) return;
+
+    unsigned char* bytes = (unsigned char*)array;
+    unsigned char stack_tmp[64];
+    unsigned char* tmp = element_size <= sizeof(stack_tmp) ? stack_tmp : (unsigned char*)malloc(element_size);
+    if (!tmp) return;
+
+    for (size_t i = count - 1; i > 0; i--) {
+        size_t j = (size_t)random_next_bounded(rng, (uint32_t)(i + 1));
+        if (j != i) {
+            memcpy(tmp, bytes + i * element_size, element_size);
+            memcpy(bytes + i * element_size, bytes + j * element_size, element_size);
+            memcpy(bytes + j * element_size, tmp, element_size);
+        }
+    }
+
+    if (tmp != stack_tmp) {
+        free(tmp);
+    }
+}
+
+// Fill out[0..count) with uniform floats in [0, 1). Two floats per 64-bit draw.
+void random_fill_floats(RandomState* rng, float* out, int count) {
+    if (!rng || !out) return;
+
+    int i = 0;
+    for (; i + 1 < count; i += 2) {
+        uint64_t bits = random_next_u64(rng);
+        out[i] = (float)(bits >> 40) * (1.0f / 16777216.0f);
+        out[i + 1] = (float)((bits >> 8) & 0xFFFFFF) * (1.0f / 16777216.0f);
+    }
+    if (i < count) {
+        out[i] = random_next_float(rng);
+    }
+}
+
+// Fill out[0..count) with uniform integers in [min, max] (inclusive)
+void random_fill_ints(RandomState* rng, int* out, int count, int min, int max) {
+    if (!rng || !out) return;
+
+    if (max <= min) {
+        for (int i = 0; i < count; i++) {
+            out[i] = min;
+        }
+        return;
+    }
+    uint32_t span = (uint32_t)((int64_t)max - min + 1);
+    for (int i = 0; i < count; i++) {
+        out[i] = span ? (int)((int64_t)min + random_next_bounded(rng, span))
+                      : (int)(uint32_t)(random_next_u64(rng) >> 32);
+    }
+}
+
+// ============================================================================
+// FILE I/O UTILITIES
+// ============================================================================
+
+bool file_exists(const char* filename) {
+    if (!filename) return false;
+
+    FILE* file = fopen(filename, "rb");
+    if (!file) return false;
+    fclose(file);
+    return true;
+}
+
+// ============================================================================
+// MEMORY TRACKING
+// ============================================================================
+
+MemoryTracker* create_memory_tracker(void) {
+    MemoryTracker* tracker = (MemoryTracker*)calloc(1, sizeof(MemoryTracker));
+    if (!tracker) {
+        fprintf(stderr, "Error: Failed to allocate memory tracker\n");
+    }
+    return tracker;
+}
+
+// Frees everything still tracked
+void destroy_memory_tracker(MemoryTracker* tracker) {
+    if (!tracker) return;
+
+    for (int i = 0; i < tracker->count; i++) {
+        free(tracker->allocations[i]);
+    }
+    free(tracker->allocations);
+    free(tracker->sizes);
+    free(tracker);
+}
+
+static bool track_allocation(MemoryTracker* tracker, void* ptr, size_t size) {
+    if (tracker->count == tracker->capacity) {
+        int capacity = tracker->capacity > 0 ? tracker->capacity * 2 : 64;
+        void** allocations = (void**)realloc(tracker->allocations, capacity * sizeof(void*));
+        if (!allocations) return false;
+        tracker->allocations = allocations;
+        size_t* sizes = (size_t*)realloc(tracker->sizes, capacity * sizeof(size_t));
+        if (!sizes) return false;
+        tracker->sizes = sizes;
+        tracker->capacity = capacity;
+    }
+    tracker->allocations[tracker->count] = ptr;
+    tracker->sizes[tracker->count] = size;
+    tracker->count++;
+    tracker->total_allocated += size;
+    return true;
+}
+
+void* tracked_malloc(MemoryTracker* tracker, size_t size) {
+    void* ptr = malloc(size);
+    if (ptr && tracker && !track_allocation(tracker, ptr, size)) {
+        fprintf(stderr, "Error: Failed to grow memory tracker\n");
+        free(ptr);
+        return NULL;
+    }
+    return ptr;
+}
+
+void* tracked_calloc(MemoryTracker* tracker, size_t count, size_t size) {
+    void* ptr = calloc(count, size);
+    if (ptr && tracker && !track_allocation(tracker, ptr, count * size)) {
+        fprintf(stderr, "Error: Failed to grow memory tracker\n");
+        free(ptr);
+        return NULL;
+    }
+    return ptr;
+}
+
+// Searches from the newest allocation, which is usually the one being freed
+void tracked_free(MemoryTracker* tracker, void* ptr) {
+    if (!ptr) return;
+    if (tracker) {
+        for (int i = tracker->count - 1; i >= 0; i--) {
+            if (tracker->allocations[i] != ptr) continue;
+            tracker->total_allocated -= tracker->sizes[i];
+            tracker->count--;
+            tracker->allocations[i] = tracker->allocations[tracker->count];
+            tracker->sizes[i] = tracker->sizes[tracker->count];
+            break;
+        }
+    }
+    free(ptr);
+}
+
+void print_memory_report(MemoryTracker* tracker) {
+    if (!tracker) return;
+
+    printf("Tracked memory: %zu bytes in %d live allocations\n", tracker->total_allocated, tracker->count);
+}
+
+// ============================================================================
+// CONFIGURATION FILES
+// ============================================================================
+
+// Strip leading and trailing whitespace in place
+static char* trim_whitespace(char* text) {
+    while (isspace((unsigned char)*text)) text++;
+    char* end = text + strlen(text);
+    while (end > text && isspace((unsigned char)end[-1])) end--;
+    *end = '\0';
+    return text;
+}
+
+static ConfigFile* create_config(void) {
+    ConfigFile* config = (ConfigFile*)calloc(1, sizeof(ConfigFile));
+    if (!config) {
+        fprintf(stderr, "Error: Failed to allocate configuration\n");
+    }
+    return config;
+}
+
+// "key = value" per line; '#' starts a comment, blank lines are skipped, and
+// a repeated key keeps its last value
+ConfigFile* load_config(const char* filename) {
+    if (!filename) return NULL;
+
+    FILE* file = fopen(filename, "r");
+    if (!file) {
+        fprintf(stderr, "Error: Could not open config file %s\n", filename);
+        return NULL;
+    }
+    ConfigFile* config = create_config();
+    if (!config) {
+        fclose(file);
+        return NULL;
+    }
+
+    char line[512];
+    int line_number = 0;
+    while (fgets(line, sizeof(line), file)) {
+        line_number++;
+        char* comment = strchr(line, '#');
+        if (comment) *comment = '\0';
+        char* text = trim_whitespace(line);
+        if (*text == '\0') continue;
+
+        char* equals = strchr(text, '=');
+        if (!equals) {
+            fprintf(stderr, "Error: %s:%d: expected key = value\n", filename, line_number);
+            destroy_config(config);
+            fclose(file);
+            return NULL;
+        }
+        *equals = '\0';
+        char* key = trim_whitespace(text);
+        char* value = trim_whitespace(equals + 1);
+        if (*key == '\0' || strlen(key) >= sizeof(config->pairs[0].key) ||
+            strlen(value) >= sizeof(config->pairs[0].value)) {
+            fprintf(stderr, "Error: %s:%d: empty or overlong key or value\n", filename, line_number);
+            destroy_config(config);
+            fclose(file);
+            return NULL;
+        }
+        set_config_value(config, key, value);
+    }
+    fclose(file);
+    return config;
+}
+
+void destroy_config(ConfigFile* config) {
+    if (!config) return;
+
+    free(config->pairs);
+    free(config);
+}
+
+const char* get_config_value(ConfigFile* config, const char* key) {
+    if (!config || !key) return NULL;
+
+    for (int i = 0; i < config->count; i++) {
+        if (strcmp(config->pairs[i].key, key) == 0) {
+            return config->pairs[i].value;
+        }
+    }
+    return NULL;
+}
+
+// Missing keys and values that do not parse completely give the default
+int get_config_int(ConfigFile* config, const char* key, int default_value) {
+    const char* value = get_config_value(config, key);
+    if (!value) return default_value;
+
+    char* end;
+    errno = 0;
+    long parsed = strtol(value, &end, 10);
+    if (end == value || *end != '\0' || errno != 0 || parsed < INT32_MIN || parsed > INT32_MAX) {
+        fprintf(stderr, "Error: Config value %s = '%s' is not an integer\n", key, value);
+        return default_value;
+    }
+    return (int)parsed;
+}
+
+float get_config_float(ConfigFile* config, const char* key, float default_value) {
+    const char* value = get_config_value(config, key);
+    if (!value) return default_value;
+
+    char* end;
+    float parsed = strtof(value, &end);
+    if (end == value || *end != '\0') {
+        fprintf(stderr, "Error: Config value %s = '%s' is not a number\n", key, value);
+        return default_value;
+    }
+    return parsed;
+}
+
+bool get_config_bool(ConfigFile* config, const char* key, bool default_value) {
+    const char* value = get_config_value(config, key);
+    if (!value) return default_value;
+
+    if (strcmp(value, "true") == 0 || strcmp(value, "yes") == 0 || strcmp(value, "on") == 0 ||
+        strcmp(value, "1") == 0) {
+        return true;
+    }
+    if (strcmp(value, "false") == 0 || strcmp(value, "no") == 0 || strcmp(value, "off") == 0 ||
+        strcmp(value, "0") == 0) {
+        return false;
+    }
+    fprintf(stderr, "Error: Config value %s = '%s' is not a boolean\n", key, value);
+    return default_value;
+}
+
+// Replaces an existing value; keys and values are truncated to their fields
+void set_config_value(ConfigFile* config, const char* key, const char* value) {
+    if (!config || !key || !value) return;
+
+    ConfigPair* pair = NULL;
+    for (int i = 0; i < config->count && !pair; i++) {
+        if (strcmp(config->pairs[i].key, key) == 0) {
+            pair = &config->pairs[i];
+        }
+    }
+    if (!pair) {
+        if (config->count == config->capacity) {
+            int capacity = config->capacity > 0 ? config->capacity * 2 : 16;
+            ConfigPair* pairs = (ConfigPair*)realloc(config->pairs, capacity * sizeof(ConfigPair));
+            if (!pairs) {
+                fprintf(stderr, "Error: Failed to grow configuration\n");
+                return;
+            }
+            config->pairs = pairs;
+            config->capacity = capacity;
+        }
+        pair = &config->pairs[config->count++];
+        snprintf(pair->key, sizeof(pair->key), "%s", key);
+    }
+    snprintf(pair->value, sizeof(pair->value), "%s", value);
+}
+
+bool save_config(ConfigFile* config, const char* filename) {
+    if (!config || !filename) return false;
+
+    FILE* file = fopen(filename, "w");
+    if (!file) {
+        fprintf(stderr, "Error: Could not open config file %s for writing\n", filename);
+        return false;
+    }
+    for (int i = 0; i < config->count; i++) {
+        fprintf(file, "%s = %s\n", config->pairs[i].key, config->pairs[i].value);
+    }
+    bool ok = !ferror(file);
+    if (fclose(file) != 0) ok = false;
+    return ok;
+}
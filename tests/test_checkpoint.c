@@ -0,0 +1,152 @@
+/*
+ * Checkpoint Test Suite
+ *
+ * Verifies background Q-table checkpoints:
+ * - Each checkpoint holds the table as it was when requested
+ * - Rotation keeps exactly the newest keep checkpoints, newest first
+ * - Requests made while the writer is busy are skipped, not waited on
+ * - Episode intervals trigger checkpoints and write failures are reported
+ */
+
+#include "../include/checkpoint.h"
+#include "../include/agent.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define ASSERT_TRUE(condition, message) \
+    if (!(condition)) { \
+        tests_failed++; \
+        printf("❌ FAIL: %s\n", message); \
+        return false; \
+    } else { \
+        tests_passed++; \
+        printf("✅ PASS: %s\n", message); \
+    }
+
+#define SMALL_STATES 64
+#define LARGE_STATES (1 << 20)
+
+// Value stored in state 0 of the checkpoint, or -1 if it cannot be loaded
+static float checkpoint_marker(const char* filename) {
+    QLearningAgent* agent = create_agent(SMALL_STATES, NUM_ACTIONS, 0.1f, 0.9f, 1.0f);
+    float marker = load_q_table(agent, filename) ? get_q_value(agent, 0, ACTION_UP) : -1.0f;
+    destroy_agent(agent);
+    return marker;
+}
+
+static void remove_checkpoints(const char* filename, int count) {
+    char name[256];
+    remove(filename);
+    for (int i = 1; i <= count; i++) {
+        snprintf(name, sizeof(name), "%s.%d", filename, i);
+        remove(name);
+    }
+}
+
+bool test_rotation() {
+    printf("\n--- Testing Rotation ---\n");
+
+    const char* filename = "test_checkpoint.bin";
+    remove_checkpoints(filename, 4);
+    ASSERT_TRUE(create_checkpointer(filename, 0, false, 0, 0.0) == NULL, "Keeping no checkpoints rejected");
+
+    Checkpointer* checkpointer = create_checkpointer(filename, 3, false, 0, 0.0);
+    QLearningAgent* agent = create_agent(SMALL_STATES, NUM_ACTIONS, 0.1f, 0.9f, 1.0f);
+    ASSERT_TRUE(checkpointer && agent, "Checkpointer created");
+
+    bool requested = true;
+    for (int k = 1; k <= 5; k++) {
+        set_q_value(agent, 0, ACTION_UP, (float)k);
+        requested = requested && request_checkpoint(checkpointer, agent, k);
+        // Later writes must not reach the snapshot being saved
+        set_q_value(agent, 0, ACTION_UP, -100.0f);
+        requested = requested && wait_for_checkpoint(checkpointer);
+    }
+    ASSERT_TRUE(requested && checkpoints_written(checkpointer) == 5, "Every idle request written");
+    ASSERT_TRUE(checkpoint_marker(filename) == 5.0f, "Newest checkpoint holds the snapshot, not later writes");
+    ASSERT_TRUE(checkpoint_marker("test_checkpoint.bin.1") == 4.0f &&
+                checkpoint_marker("test_checkpoint.bin.2") == 3.0f, "Older checkpoints rotated in order");
+    ASSERT_TRUE(access("test_checkpoint.bin.3", F_OK) != 0, "Only keep checkpoints retained");
+    ASSERT_TRUE(access("test_checkpoint.bin.tmp", F_OK) != 0, "Temporary file renamed into place");
+
+    close_checkpointer(checkpointer);
+    destroy_agent(agent);
+    remove_checkpoints(filename, 4);
+    return true;
+}
+
+bool test_busy_writer_skips() {
+    printf("\n--- Testing Busy Writer ---\n");
+
+    const char* filename = "test_checkpoint_large.bin";
+    Checkpointer* checkpointer = create_checkpointer(filename, 1, false, 0, 0.0);
+    QLearningAgent* agent = create_agent_with_storage(LARGE_STATES, NUM_ACTIONS, 0.1f, 0.9f, 1.0f,
+                                                      QTABLE_STORAGE_OPTIMIZED);
+    ASSERT_TRUE(checkpointer && agent, "Large table created");
+
+    // A synced 16 MB write is far slower than a second request
+    ASSERT_TRUE(request_checkpoint(checkpointer, agent, 1), "First request queued");
+    ASSERT_TRUE(!request_checkpoint(checkpointer, agent, 2) && checkpointer->skipped == 1,
+                "Request during a write is skipped");
+    ASSERT_TRUE(wait_for_checkpoint(checkpointer) && checkpoints_written(checkpointer) == 1,
+                "Skipped request wrote nothing");
+    ASSERT_TRUE(request_checkpoint(checkpointer, agent, 3), "Writer accepts work again once idle");
+
+    close_checkpointer(checkpointer);
+    ASSERT_TRUE(access(filename, F_OK) == 0, "Close finishes the queued checkpoint");
+    destroy_agent(agent);
+    remove(filename);
+    return true;
+}
+
+bool test_intervals_and_failures() {
+    printf("\n--- Testing Intervals and Failures ---\n");
+
+    const char* filename = "test_checkpoint_interval.bin";
+    Checkpointer* checkpointer = create_checkpointer(filename, 2, true, 10, 0.0);
+    QLearningAgent* agent = create_agent(SMALL_STATES, NUM_ACTIONS, 0.1f, 0.9f, 1.0f);
+    int triggered = 0;
+    for (int episode = 1; episode <= 35; episode++) {
+        set_q_value(agent, 0, ACTION_UP, (float)episode);
+        if (checkpoint_if_due(checkpointer, agent, episode)) {
+            triggered++;
+            wait_for_checkpoint(checkpointer);
+        }
+    }
+    ASSERT_TRUE(triggered == 3 && checkpoints_written(checkpointer) == 3, "One checkpoint per interval");
+    ASSERT_TRUE(checkpoint_marker(filename) == 30.0f && checkpoint_marker("test_checkpoint_interval.bin.1") == 20.0f,
+                "Compressed checkpoints load back");
+    close_checkpointer(checkpointer);
+    remove_checkpoints(filename, 2);
+
+    checkpointer = create_checkpointer("no_such_directory/checkpoint.bin", 2, false, 0, 0.0);
+    ASSERT_TRUE(request_checkpoint(checkpointer, agent, 1) && !wait_for_checkpoint(checkpointer),
+                "Write failure reported");
+    close_checkpointer(checkpointer);
+    destroy_agent(agent);
+    return true;
+}
+
+int main() {
+    printf("=== Checkpoint Test Suite ===\n");
+
+    test_rotation();
+    test_busy_writer_skips();
+    test_intervals_and_failures();
+
+    printf("\n=== Test Summary ===\n");
+    printf("Tests Passed: %d\n", tests_passed);
+    printf("Tests Failed: %d\n", tests_failed);
+
+    if (tests_failed > 0) {
+        printf("⚠️  Some tests failed.\n");
+        return 1;
+    }
+    printf("🎉 ALL TESTS PASSED!\n");
+    return 0;
+}
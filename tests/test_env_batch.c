@@ -0,0 +1,168 @@
+/*
+ * GridWorld Batch Stepping Test Suite
+ *
+ * Verifies that GridWorldBatch reproduces step_environment() exactly:
+ * - Movement, wall and border collisions
+ * - Goal and max-step termination
+ * - Behaviour of finished environments and invalid actions
+ * - SIMD lanes and scalar tail lanes agree
+ */
+
+#include "../include/env_batch.h"
+#include "../include/environment.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#define TEST_ENVS 11          // Not a multiple of the SIMD width to exercise the tail
+#define TEST_STEPS 400
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define ASSERT_TRUE(condition, message) \
+    if (!(condition)) { \
+        tests_failed++; \
+        printf("❌ FAIL: %s\n", message); \
+        return false; \
+    } else { \
+        tests_passed++; \
+        printf("✅ PASS: %s\n", message); \
+    }
+
+static GridWorld* create_test_world(void) {
+    GridWorld* world = create_grid_world(7, 5);
+    if (!world) return NULL;
+
+    set_cell(world, 2, 0, CELL_WALL);
+    set_cell(world, 2, 1, CELL_WALL);
+    set_cell(world, 4, 3, CELL_OBSTACLE);
+    set_cell(world, 5, 1, CELL_WALL);
+    world->max_steps = 30;
+    return world;
+}
+
+// Batch construction copies the template layout
+bool test_batch_creation() {
+    printf("\n--- Testing Batch Creation ---\n");
+
+    GridWorld* world = create_test_world();
+    GridWorldBatch* batch = create_grid_world_batch(world, TEST_ENVS);
+
+    ASSERT_TRUE(batch != NULL, "Batch creation");
+    ASSERT_TRUE(batch->num_envs == TEST_ENVS, "Environment count");
+    ASSERT_TRUE(batch->capacity % 4 == 0 && batch->capacity >= TEST_ENVS, "Lane arrays padded to SIMD width");
+    ASSERT_TRUE(!batch_is_walkable(batch, 2, 1), "Wall packed into bitmap");
+    ASSERT_TRUE(!batch_is_walkable(batch, 4, 3), "Obstacle packed into bitmap");
+    ASSERT_TRUE(batch_is_walkable(batch, 6, 4), "Goal is walkable");
+    ASSERT_TRUE(!batch_is_walkable(batch, -1, 0), "Out of bounds is not walkable");
+    ASSERT_TRUE(batch->agent_x[TEST_ENVS - 1] == world->start_pos.x, "Environments start at start position");
+
+    ASSERT_TRUE(create_grid_world_batch(NULL, 4) == NULL, "NULL template rejected");
+    ASSERT_TRUE(create_grid_world_batch(world, 0) == NULL, "Empty batch rejected");
+
+    destroy_grid_world_batch(batch);
+    destroy_grid_world(world);
+    return true;
+}
+
+// Random rollouts must match per-environment step_environment calls
+bool test_batch_matches_step_environment() {
+    printf("\n--- Testing Batch Equivalence with step_environment ---\n");
+
+    GridWorld* template_world = create_test_world();
+    GridWorldBatch* batch = create_grid_world_batch(template_world, TEST_ENVS);
+    GridWorld* worlds[TEST_ENVS];
+    for (int e = 0; e < TEST_ENVS; e++) {
+        worlds[e] = create_test_world();
+        reset_environment(worlds[e]);
+    }
+
+    int actions[TEST_ENVS];
+    float rewards[TEST_ENVS];
+    int next_states[TEST_ENVS];
+    bool dones[TEST_ENVS];
+    int mismatches = 0;
+    int finished_episodes = 0;
+
+    srand(1234);
+    for (int step = 0; step < TEST_STEPS; step++) {
+        for (int e = 0; e < TEST_ENVS; e++) {
+            actions[e] = rand() % NUM_ACTIONS;
+        }
+
+        step_grid_world_batch(batch, actions, rewards, next_states, dones);
+
+        for (int e = 0; e < TEST_ENVS; e++) {
+            StepResult expected = step_environment(worlds[e], (Action)actions[e]);
+            if (fabsf(expected.reward - rewards[e]) > 1e-6f ||
+                expected.next_state.state_index != next_states[e] ||
+                expected.done != dones[e]) {
+                mismatches++;
+            }
+            if (dones[e]) {
+                finished_episodes++;
+                reset_environment(worlds[e]);
+                reset_batch_env(batch, e);
+            }
+        }
+    }
+
+    ASSERT_TRUE(finished_episodes > 0, "Episodes terminated during rollout");
+    ASSERT_TRUE(mismatches == 0, "Rewards, next states and done flags match step_environment");
+
+    for (int e = 0; e < TEST_ENVS; e++) {
+        destroy_grid_world(worlds[e]);
+    }
+    destroy_grid_world_batch(batch);
+    destroy_grid_world(template_world);
+    return true;
+}
+
+// Finished environments and invalid actions are no-ops with zero reward
+bool test_batch_done_and_invalid_actions() {
+    printf("\n--- Testing Done Environments and Invalid Actions ---\n");
+
+    GridWorld* world = create_test_world();
+    GridWorldBatch* batch = create_grid_world_batch(world, 5);
+
+    int actions[5] = {ACTION_RIGHT, -1, NUM_ACTIONS, ACTION_UP, ACTION_DOWN};
+    float rewards[5];
+    int next_states[5];
+    bool dones[5];
+
+    batch->done[4] = 1;
+    step_grid_world_batch(batch, actions, rewards, next_states, dones);
+
+    ASSERT_TRUE(rewards[0] == world->step_penalty && next_states[0] == 1, "Valid move");
+    ASSERT_TRUE(rewards[1] == 0.0f && batch->episode_steps[1] == 0, "Negative action ignored");
+    ASSERT_TRUE(rewards[2] == 0.0f && batch->episode_steps[2] == 0, "Out-of-range action ignored");
+    ASSERT_TRUE(rewards[3] == world->wall_penalty && next_states[3] == 0, "Border collision penalized");
+    ASSERT_TRUE(rewards[4] == 0.0f && dones[4] && batch->episode_steps[4] == 0, "Finished environment untouched");
+
+    ASSERT_TRUE(count_done_envs(batch) == 1, "Done count");
+    ASSERT_TRUE(reset_done_envs(batch) == 1 && count_done_envs(batch) == 0, "Reset finished environments");
+
+    destroy_grid_world_batch(batch);
+    destroy_grid_world(world);
+    return true;
+}
+
+int main() {
+    printf("=== GridWorld Batch Test Suite ===\n");
+
+    test_batch_creation();
+    test_batch_matches_step_environment();
+    test_batch_done_and_invalid_actions();
+
+    printf("\n=== Test Summary ===\n");
+    printf("Tests Passed: %d\n", tests_passed);
+    printf("Tests Failed: %d\n", tests_failed);
+
+    if (tests_failed > 0) {
+        printf("⚠️  Some tests failed.\n");
+        return 1;
+    }
+    printf("🎉 ALL TESTS PASSED!\n");
+    return 0;
+}
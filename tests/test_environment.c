@@ -25,11 +25,11 @@ int main() {
     
     // Test 2: Check grid initialization
     printf("\nTest 2: Checking grid cell initialization...\n");
-    assert(world->grid[0][0] == CELL_START);
-    assert(world->grid[4][4] == CELL_GOAL);
+    assert(get_cell(world, 0, 0) == CELL_START);
+    assert(get_cell(world, 4, 4) == CELL_GOAL);
     // Check some empty cells
-    assert(world->grid[1][1] == CELL_EMPTY);
-    assert(world->grid[2][3] == CELL_EMPTY);
+    assert(get_cell(world, 1, 1) == CELL_EMPTY);
+    assert(get_cell(world, 3, 2) == CELL_EMPTY);
     printf("✓ Grid cells initialized correctly\n");
     
     // Test 3: Different grid size
@@ -59,21 +59,8 @@ int main() {
     printf("✓ Default rewards configured correctly\n");
     
     // Cleanup
-    // Note: We'll implement destroy_grid_world later, for now just free main structure
-    if (world) {
-        for (int y = 0; y < world->height; y++) {
-            free(world->grid[y]);
-        }
-        free(world->grid);
-        free(world);
-    }
-    if (world2) {
-        for (int y = 0; y < world2->height; y++) {
-            free(world2->grid[y]);
-        }
-        free(world2->grid);
-        free(world2);
-    }
+    destroy_grid_world(world);
+    destroy_grid_world(world2);
     
     printf("\n🎉 All tests passed! create_grid_world function is working correctly.\n");
     return 0;
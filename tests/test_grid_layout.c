@@ -0,0 +1,153 @@
+/*
+ * Grid Layout Test Suite
+ *
+ * Verifies the bit-packed GridLayout behind GridWorld:
+ * - Every cell type round-trips through set/get
+ * - Walkability comes straight from the bitset
+ * - Counts and memory footprint for large grids
+ * - Clones share the layout and copy it on first write
+ * - Revisions identify layout contents for derived caches
+ */
+
+#include "../include/grid_layout.h"
+#include "../include/environment.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define ASSERT_TRUE(condition, message) \
+    if (!(condition)) { \
+        tests_failed++; \
+        printf("❌ FAIL: %s\n", message); \
+        return false; \
+    } else { \
+        tests_passed++; \
+        printf("✅ PASS: %s\n", message); \
+    }
+
+bool test_cell_round_trip() {
+    printf("\n--- Testing Cell Round Trip ---\n");
+
+    ASSERT_TRUE(create_grid_layout(0, 4) == NULL, "Invalid dimensions rejected");
+
+    // Width past one 64-bit word exercises the row padding
+    GridLayout* layout = create_grid_layout(70, 3);
+    ASSERT_TRUE(layout != NULL && layout->words_per_row == 2, "Rows padded to whole words");
+    ASSERT_TRUE(grid_layout_get(layout, 69, 2) == CELL_EMPTY, "New layout is empty");
+
+    CellType types[] = {CELL_EMPTY, CELL_WALL, CELL_GOAL, CELL_AGENT, CELL_OBSTACLE, CELL_START};
+    bool round_trip = true;
+    for (int i = 0; i < 6; i++) {
+        grid_layout_set(layout, 63 + i, 1, types[i]);
+    }
+    for (int i = 0; i < 6; i++) {
+        round_trip = round_trip && grid_layout_get(layout, 63 + i, 1) == types[i];
+    }
+    ASSERT_TRUE(round_trip, "All cell types read back across a word boundary");
+
+    ASSERT_TRUE(grid_layout_blocked(layout, 64, 1) && grid_layout_blocked(layout, 67, 1),
+                "Walls and obstacles are blocked");
+    ASSERT_TRUE(!grid_layout_blocked(layout, 65, 1) && !grid_layout_blocked(layout, 68, 1),
+                "Goal and start are walkable");
+
+    grid_layout_set(layout, 67, 1, CELL_EMPTY);
+    ASSERT_TRUE(grid_layout_get(layout, 67, 1) == CELL_EMPTY && !grid_layout_blocked(layout, 67, 1),
+                "Overwriting an obstacle clears it");
+    ASSERT_TRUE(layout->num_specials == 3, "Side table holds only goal/agent/start");
+
+    release_grid_layout(layout);
+    return true;
+}
+
+bool test_counts_and_footprint() {
+    printf("\n--- Testing Counts and Footprint ---\n");
+
+    GridLayout* layout = create_grid_layout(4096, 4096);
+    ASSERT_TRUE(layout != NULL, "4096x4096 layout created");
+    ASSERT_TRUE(grid_layout_bytes(layout) < 2300000, "4096x4096 layout fits in about 2 MB");
+
+    for (int x = 0; x < 4096; x++) {
+        grid_layout_set(layout, x, 100, CELL_WALL);
+    }
+    grid_layout_set(layout, 7, 7, CELL_OBSTACLE);
+    grid_layout_set(layout, 0, 0, CELL_START);
+    grid_layout_set(layout, 4095, 4095, CELL_GOAL);
+
+    ASSERT_TRUE(grid_layout_count(layout, CELL_WALL) == 4096, "Wall count");
+    ASSERT_TRUE(grid_layout_count(layout, CELL_OBSTACLE) == 1, "Obstacle count");
+    ASSERT_TRUE(grid_layout_count(layout, CELL_GOAL) == 1 && grid_layout_count(layout, CELL_START) == 1,
+                "Goal and start counts");
+    ASSERT_TRUE(grid_layout_count(layout, CELL_EMPTY) == 4096 * 4096 - 4096 - 3, "Empty count");
+    ASSERT_TRUE(grid_layout_walkable_count(layout) == 4096 * 4096 - 4097, "Walkable count");
+
+    release_grid_layout(layout);
+    return true;
+}
+
+bool test_copy_on_write() {
+    printf("\n--- Testing Copy on Write ---\n");
+
+    GridWorld* world = create_grid_world(8, 8);
+    set_cell(world, 3, 3, CELL_WALL);
+    GridWorld* a = clone_grid_world(world);
+    GridWorld* b = clone_grid_world(world);
+    ASSERT_TRUE(a->layout == world->layout && b->layout == world->layout, "Clones share one layout");
+    ASSERT_TRUE(world->layout->ref_count == 3, "Reference count tracks clones");
+
+    set_cell(a, 4, 4, CELL_OBSTACLE);
+    ASSERT_TRUE(a->layout != world->layout && !is_walkable(a, 4, 4), "Writer gets a private copy");
+    ASSERT_TRUE(is_walkable(world, 4, 4) && is_walkable(b, 4, 4), "Other worlds are unaffected");
+    ASSERT_TRUE(!is_walkable(a, 3, 3), "Private copy keeps existing cells");
+
+    destroy_grid_world(world);
+    ASSERT_TRUE(!grid_layout_is_shared(b->layout) && get_cell(b, 3, 3) == CELL_WALL,
+                "Layout survives the original's destruction");
+
+    destroy_grid_world(a);
+    destroy_grid_world(b);
+    return true;
+}
+
+bool test_revisions() {
+    printf("\n--- Testing Revisions ---\n");
+
+    GridLayout* a = create_grid_layout(8, 8);
+    GridLayout* b = create_grid_layout(8, 8);
+    ASSERT_TRUE(a->revision != b->revision, "Every layout starts with a distinct revision");
+
+    uint64_t before = a->revision;
+    grid_layout_set(a, 1, 1, CELL_WALL);
+    ASSERT_TRUE(a->revision != before && a->revision != b->revision, "Writes change the revision");
+
+    GridLayout* copy = copy_grid_layout(a);
+    ASSERT_TRUE(copy->revision == a->revision, "Copies keep their source's revision");
+    grid_layout_set(copy, 2, 2, CELL_GOAL);
+    ASSERT_TRUE(copy->revision != a->revision, "Writing the copy gives it a new revision");
+
+    release_grid_layout(a);
+    release_grid_layout(b);
+    release_grid_layout(copy);
+    return true;
+}
+
+int main() {
+    printf("=== Grid Layout Test Suite ===\n");
+
+    test_cell_round_trip();
+    test_counts_and_footprint();
+    test_copy_on_write();
+    test_revisions();
+
+    printf("\n=== Test Summary ===\n");
+    printf("Tests Passed: %d\n", tests_passed);
+    printf("Tests Failed: %d\n", tests_failed);
+
+    if (tests_failed > 0) {
+        printf("⚠️  Some tests failed.\n");
+        return 1;
+    }
+    printf("🎉 ALL TESTS PASSED!\n");
+    return 0;
+}
@@ -0,0 +1,238 @@
+/*
+ * Level Generator Test Suite
+ *
+ * Verifies the procedural layouts and the threaded batch API:
+ * - Every generator is reproducible from the environment seed
+ * - Mazes are perfect (a spanning tree) unless braided by low complexity
+ * - Random walls keep the goal and every free cell reachable from the start
+ * - Batches give the same levels for any thread count and unshare clones
+ */
+
+#include "../include/level_generator.h"
+#include "../include/environment.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define ASSERT_TRUE(condition, message) \
+    if (!(condition)) { \
+        tests_failed++; \
+        printf("❌ FAIL: %s\n", message); \
+        return false; \
+    } else { \
+        tests_passed++; \
+        printf("✅ PASS: %s\n", message); \
+    }
+
+static bool same_layout(GridWorld* a, GridWorld* b) {
+    if (a->width != b->width || a->height != b->height) return false;
+    for (int y = 0; y < a->height; y++) {
+        for (int x = 0; x < a->width; x++) {
+            if (get_cell(a, x, y) != get_cell(b, x, y)) return false;
+        }
+    }
+    return true;
+}
+
+// Cells reachable from the start, or -1 if the goal is not among them
+static int count_reachable(GridWorld* world) {
+    int num_cells = world->width * world->height;
+    int* queue = (int*)malloc(num_cells * sizeof(int));
+    char* seen = (char*)calloc(num_cells, 1);
+    int head = 0, tail = 0;
+    int start = position_to_state(world, world->start_pos);
+    queue[tail++] = start;
+    seen[start] = 1;
+    while (head < tail) {
+        Position pos = state_to_position(world, queue[head++]);
+        for (int a = 0; a < NUM_ACTIONS; a++) {
+            Position next = get_new_position(pos, (Action)a);
+            int index = position_to_state(world, next);
+            if (is_walkable(world, next.x, next.y) && !seen[index]) {
+                seen[index] = 1;
+                queue[tail++] = index;
+            }
+        }
+    }
+    bool goal = seen[position_to_state(world, world->goal_pos)];
+    free(queue);
+    free(seen);
+    return goal ? tail : -1;
+}
+
+// Open cell pairs; a connected layout is a tree when this is cells - 1
+static int count_open_edges(GridWorld* world) {
+    int edges = 0;
+    for (int y = 0; y < world->height; y++) {
+        for (int x = 0; x < world->width; x++) {
+            if (!is_walkable(world, x, y)) continue;
+            edges += is_walkable(world, x + 1, y) + is_walkable(world, x, y + 1);
+        }
+    }
+    return edges;
+}
+
+static GridWorld* generated(int width, int height, LevelType type, float parameter, unsigned int seed) {
+    GridWorld* world = create_grid_world(width, height);
+    seed_environment(world, seed);
+    generate_level(world, type, parameter, false);
+    return world;
+}
+
+bool test_mazes() {
+    printf("\n--- Testing Mazes ---\n");
+
+    LevelType types[] = {LEVEL_SIMPLE_MAZE, LEVEL_RANDOM_MAZE, LEVEL_CORRIDORS};
+    int sizes[][2] = {{41, 31}, {40, 30}, {1, 9}, {64, 3}};
+    bool reproducible = true, connected = true, perfect = true, distinct = true;
+    for (int t = 0; t < 3; t++) {
+        for (int s = 0; s < 4; s++) {
+            GridWorld* a = generated(sizes[s][0], sizes[s][1], types[t], 1.0f, 7);
+            GridWorld* b = generated(sizes[s][0], sizes[s][1], types[t], 1.0f, 7);
+            GridWorld* c = generated(sizes[s][0], sizes[s][1], types[t], 1.0f, 8);
+            int open = grid_layout_walkable_count(a->layout);
+            reproducible = reproducible && same_layout(a, b);
+            connected = connected && count_reachable(a) == open && validate_environment(a);
+            perfect = perfect && count_open_edges(a) == open - 1;
+            if (s == 0) distinct = distinct && !same_layout(a, c);
+            destroy_grid_world(a);
+            destroy_grid_world(b);
+            destroy_grid_world(c);
+        }
+    }
+    ASSERT_TRUE(reproducible, "Same seed gives the same maze");
+    ASSERT_TRUE(distinct, "Different seeds give different mazes");
+    ASSERT_TRUE(connected, "Every open cell and the goal are reachable from the start");
+    ASSERT_TRUE(perfect, "Mazes and corridors have exactly one route between cells");
+
+    GridWorld* braided = generated(41, 31, LEVEL_RANDOM_MAZE, 0.0f, 7);
+    int open = grid_layout_walkable_count(braided->layout);
+    ASSERT_TRUE(count_reachable(braided) == open && count_open_edges(braided) > open - 1 + 20,
+                "Low complexity opens loops");
+    destroy_grid_world(braided);
+
+    // Eller's keeps one row of state, so tall thin grids cost nothing extra
+    GridWorld* large = generated(2001, 2001, LEVEL_RANDOM_MAZE, 1.0f, 3);
+    ASSERT_TRUE(large->goal_pos.x == 2000 && large->goal_pos.y == 2000 &&
+                get_cell(large, 2000, 2000) == CELL_GOAL && get_cell(large, 0, 0) == CELL_START,
+                "Start and goal at opposite corners");
+    ASSERT_TRUE(count_reachable(large) == grid_layout_walkable_count(large->layout), "Large maze is connected");
+    destroy_grid_world(large);
+    return true;
+}
+
+bool test_random_walls() {
+    printf("\n--- Testing Random Walls ---\n");
+
+    GridWorld* world = create_grid_world(50, 40);
+    set_cell(world, 10, 10, CELL_OBSTACLE);
+    seed_environment(world, 11);
+    add_random_walls(world, 0.3f);
+    int walls = grid_layout_count(world->layout, CELL_WALL);
+    ASSERT_TRUE(walls > 2000 * 0.2f && walls < 2000 * 0.4f, "Wall density close to the request");
+    ASSERT_TRUE(get_cell(world, 10, 10) == CELL_OBSTACLE && get_cell(world, 0, 0) == CELL_START &&
+                get_cell(world, 49, 39) == CELL_GOAL, "Marked cells left alone");
+    ASSERT_TRUE(count_reachable(world) == grid_layout_walkable_count(world->layout),
+                "Every free cell reachable from the start");
+
+    GridWorld* copy = create_grid_world(50, 40);
+    set_cell(copy, 10, 10, CELL_OBSTACLE);
+    seed_environment(copy, 11);
+    add_random_walls(copy, 0.3f);
+    ASSERT_TRUE(same_layout(world, copy), "Same seed gives the same walls");
+    destroy_grid_world(copy);
+
+    // Dense walls cut the grid into pockets; the goal must be carved back in
+    bool reachable = true;
+    for (unsigned int seed = 0; seed < 20; seed++) {
+        clear_environment(world);
+        seed_environment(world, seed);
+        add_random_walls(world, 0.9f);
+        reachable = reachable && count_reachable(world) == grid_layout_walkable_count(world->layout);
+    }
+    ASSERT_TRUE(reachable, "Goal reachable even at the maximum density");
+
+    // Compiled transitions see the new walls (a seed whose first gap is not below the start)
+    clear_environment(world);
+    set_transition_table(world, true);
+    for (unsigned int seed = 0; get_cell(world, 0, 1) != CELL_WALL; seed++) {
+        seed_environment(world, seed);
+        create_corridor_maze(world);
+    }
+    reset_environment(world);
+    float reward = 0.0f;
+    ASSERT_TRUE(step(world, ACTION_DOWN, &reward) == 0 && reward == world->wall_penalty,
+                "Transition table rebuilt after generation");
+
+    destroy_grid_world(world);
+    return true;
+}
+
+bool test_batch() {
+    printf("\n--- Testing Batch Generation ---\n");
+
+    const int count = 24;
+    GridWorld* serial[24];
+    GridWorld* parallel[24];
+    GridWorld* base = create_grid_world(33, 21);
+    for (int i = 0; i < count; i++) {
+        serial[i] = create_grid_world(33 + i % 3, 21);
+        parallel[i] = i % 3 == 0 ? clone_grid_world(base) : create_grid_world(33 + i % 3, 21);
+    }
+
+    ASSERT_TRUE(!generate_level_batch(NULL, count, NULL), "Invalid batch rejected");
+
+    LevelType types[] = {LEVEL_SIMPLE_MAZE, LEVEL_RANDOM_MAZE, LEVEL_CORRIDORS, LEVEL_RANDOM_WALLS};
+    bool matches = true, reachable = true;
+    for (int t = 0; t < 4; t++) {
+        LevelBatchConfig config = create_default_level_batch_config(types[t]);
+        config.random_endpoints = true;
+        ASSERT_TRUE(generate_level_batch(serial, count, &config), "Serial batch generated");
+        config.num_threads = 4;
+        ASSERT_TRUE(generate_level_batch(parallel, count, &config), "Threaded batch generated");
+        for (int i = 0; i < count; i++) {
+            matches = matches && same_layout(serial[i], parallel[i]) &&
+                      positions_equal(serial[i]->goal_pos, parallel[i]->goal_pos) &&
+                      positions_equal(serial[i]->start_pos, parallel[i]->start_pos);
+            reachable = reachable && count_reachable(parallel[i]) > 1;
+        }
+    }
+    ASSERT_TRUE(matches, "Threaded batch matches the serial one");
+    ASSERT_TRUE(reachable, "Random endpoints stay connected");
+    ASSERT_TRUE(grid_layout_walkable_count(base->layout) == 33 * 21 && !same_layout(parallel[0], parallel[3]),
+                "Cloned worlds get their own layouts");
+
+    LevelType parsed;
+    ASSERT_TRUE(parse_level_type("corridors", &parsed) && parsed == LEVEL_CORRIDORS &&
+                !parse_level_type("cave", &parsed), "Level type names parse");
+
+    for (int i = 0; i < count; i++) {
+        destroy_grid_world(serial[i]);
+        destroy_grid_world(parallel[i]);
+    }
+    destroy_grid_world(base);
+    return true;
+}
+
+int main() {
+    printf("=== Level Generator Test Suite ===\n");
+    set_environment_verbose(false);
+
+    test_mazes();
+    test_random_walls();
+    test_batch();
+
+    printf("\n=== Test Summary ===\n");
+    printf("Tests Passed: %d\n", tests_passed);
+    printf("Tests Failed: %d\n", tests_failed);
+
+    if (tests_failed > 0) {
+        printf("⚠️  Some tests failed.\n");
+        return 1;
+    }
+    printf("🎉 ALL TESTS PASSED!\n");
+    return 0;
+}
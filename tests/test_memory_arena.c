@@ -0,0 +1,262 @@
+/*
+ * Memory Arena Test Suite
+ *
+ * Verifies the per-run allocation layer:
+ * - Heap allocations are accounted per subsystem and released on destroy
+ * - With an arena set, a whole run is built without touching the heap
+ * - Resetting the arena reuses its blocks for the next run
+ * - Aligned, zeroed and resized allocations behave on both paths
+ * - The arena limit fails allocations and the current arena is per thread
+ */
+
+#include "../include/memory_arena.h"
+#include "../include/agent.h"
+#include "../include/environment.h"
+#include "../include/utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define ASSERT_TRUE(condition, message) \
+    if (!(condition)) { \
+        tests_failed++; \
+        printf("❌ FAIL: %s\n", message); \
+        return false; \
+    } else { \
+        tests_passed++; \
+        printf("✅ PASS: %s\n", message); \
+    }
+
+#define GRID_SIZE 32
+
+static size_t total_heap_bytes(void) {
+    size_t total = 0;
+    for (int i = 0; i < NUM_MEMORY_SUBSYSTEMS; i++) {
+        total += memory_heap_bytes((MemorySubsystem)i);
+    }
+    return total;
+}
+
+// One run's worth of objects: world, agent, stats, replay and visit tracking
+typedef struct {
+    GridWorld* world;
+    QLearningAgent* agent;
+    QLearningAgent* optimized;
+    TrainingStats* stats;
+    PriorityExperienceBuffer* replay;
+    StateVisitTracker* visits;
+} RunObjects;
+
+static bool create_run(RunObjects* run) {
+    run->world = create_grid_world(GRID_SIZE, GRID_SIZE);
+    int num_states = GRID_SIZE * GRID_SIZE;
+    run->agent = create_agent(num_states, NUM_ACTIONS, 0.1f, 0.9f, 0.1f);
+    run->optimized = create_agent_with_storage(num_states, NUM_ACTIONS, 0.1f, 0.9f, 0.1f, QTABLE_STORAGE_OPTIMIZED);
+    run->stats = create_training_stats(100);
+    run->replay = create_priority_buffer(1024, create_default_replay_config());
+    run->visits = create_state_visit_tracker(num_states, true, true);
+    return run->world && run->agent && run->optimized && run->stats && run->replay && run->visits;
+}
+
+// Exercise every object so a bad allocation would show up as wrong values
+static bool use_run(RunObjects* run) {
+    reset_environment(run->world);
+    for (int s = 0; s < 50; s++) {
+        update_q_value(run->agent, s, ACTION_RIGHT, 1.0f, s + 1, false);
+        update_q_value(run->optimized, s, ACTION_RIGHT, 1.0f, s + 1, false);
+        add_priority_experience(run->replay, s, ACTION_RIGHT, 1.0f, s + 1, false, 1.0f);
+        update_state_visit(run->visits, s);
+    }
+    return get_q_value(run->agent, 0, ACTION_RIGHT) > 0.0f &&
+           get_q_value(run->agent, 0, ACTION_RIGHT) == get_q_value(run->optimized, 0, ACTION_RIGHT) &&
+           run->replay->size == 50 && run->visits->visit_counts[0] == 1;
+}
+
+static void destroy_run(RunObjects* run) {
+    destroy_state_visit_tracker(run->visits);
+    destroy_priority_buffer(run->replay);
+    destroy_training_stats(run->stats);
+    destroy_agent(run->optimized);
+    destroy_agent(run->agent);
+    destroy_grid_world(run->world);
+}
+
+bool test_heap_accounting() {
+    printf("\n--- Testing Heap Accounting ---\n");
+
+    size_t baseline = total_heap_bytes();
+    size_t agent_baseline = memory_heap_bytes(MEMORY_AGENT);
+    RunObjects run;
+    ASSERT_TRUE(create_run(&run) && use_run(&run), "Run built on the heap");
+    ASSERT_TRUE(memory_heap_bytes(MEMORY_AGENT) - agent_baseline >= GRID_SIZE * GRID_SIZE * NUM_ACTIONS * sizeof(float),
+                "Q-table bytes charged to the agent subsystem");
+    ASSERT_TRUE(memory_heap_bytes(MEMORY_ENVIRONMENT) > 0 && memory_heap_bytes(MEMORY_STATS) > 0 &&
+                memory_heap_bytes(MEMORY_REPLAY) > 0 && memory_heap_bytes(MEMORY_VISITS) > 0,
+                "Every subsystem accounted");
+    ASSERT_TRUE(!memory_from_arena(run.agent) && !memory_from_arena(run.world), "Objects come from the heap");
+
+    destroy_run(&run);
+    ASSERT_TRUE(total_heap_bytes() == baseline, "Destroy returns heap accounting to the baseline");
+    return true;
+}
+
+bool test_arena_runs() {
+    printf("\n--- Testing Arena Runs ---\n");
+
+    MemoryArena* arena = create_memory_arena(64 * 1024, 0);
+    ASSERT_TRUE(arena != NULL, "Arena created");
+    ASSERT_TRUE(set_memory_arena(arena) == NULL && get_memory_arena() == arena, "Arena set for this thread");
+
+    size_t baseline = total_heap_bytes();
+    RunObjects run;
+    bool ok = create_run(&run) && use_run(&run);
+    ASSERT_TRUE(ok, "Run built in the arena");
+    ASSERT_TRUE(total_heap_bytes() == baseline, "No heap bytes allocated for the run");
+    ASSERT_TRUE(memory_from_arena(run.agent) && memory_from_arena(run.optimized->optimized_table) &&
+                memory_from_arena(run.world) && memory_from_arena(run.visits), "Objects come from the arena");
+
+    bool every_subsystem = true;
+    for (int i = 0; i < NUM_MEMORY_SUBSYSTEMS; i++) {
+        every_subsystem = every_subsystem && arena->used[i] > 0;
+    }
+    ASSERT_TRUE(every_subsystem, "Arena usage recorded per subsystem");
+
+    // Destroying arena objects is allowed and frees nothing
+    destroy_run(&run);
+    size_t used = memory_arena_used(arena);
+    size_t reserved = arena->reserved;
+    ASSERT_TRUE(used > 0 && arena->peak_used == used, "Destroy leaves arena usage alone");
+
+    reset_memory_arena(arena);
+    ASSERT_TRUE(memory_arena_used(arena) == 0 && arena->allocations == 0 && arena->reserved == reserved,
+                "Reset empties the arena and keeps its blocks");
+
+    // The second run fits in the blocks kept from the first
+    ok = create_run(&run) && use_run(&run);
+    ASSERT_TRUE(ok && arena->reserved == reserved && memory_arena_used(arena) == used,
+                "Second run reuses the blocks");
+    destroy_run(&run);
+
+    ASSERT_TRUE(set_memory_arena(NULL) == arena && get_memory_arena() == NULL, "Heap restored");
+    destroy_memory_arena(arena);
+    return true;
+}
+
+bool test_allocation_paths() {
+    printf("\n--- Testing Allocation Paths ---\n");
+
+    MemoryArena* arena = create_memory_arena(4096, 0);
+    ASSERT_TRUE(arena != NULL, "Arena created");
+
+    for (int in_arena = 0; in_arena <= 1; in_arena++) {
+        set_memory_arena(in_arena ? arena : NULL);
+
+        void* aligned = memory_alloc_aligned(MEMORY_AGENT, 1000, 64);
+        void* plain = memory_alloc(MEMORY_AGENT, 24);
+        ASSERT_TRUE(aligned && plain && (uintptr_t)aligned % 64 == 0 && (uintptr_t)plain % 16 == 0,
+                    in_arena ? "Arena pointers aligned" : "Heap pointers aligned");
+        ASSERT_TRUE(memory_from_arena(aligned) == (bool)in_arena, "Pointer reports its allocator");
+
+        // Dirty memory, reset, then expect calloc to hand back zeroes
+        memset(aligned, 0xAB, 1000);
+        memory_free(aligned);
+        memory_free(plain);
+        if (in_arena) reset_memory_arena(arena);
+        unsigned char* zeroed = (unsigned char*)memory_calloc(MEMORY_STATS, 250, 4);
+        bool all_zero = zeroed != NULL;
+        for (int i = 0; all_zero && i < 1000; i++) all_zero = zeroed[i] == 0;
+        ASSERT_TRUE(all_zero, "Calloc memory is zeroed");
+        memory_free(zeroed);
+
+        // Growth past the block size copies the old contents
+        int* values = (int*)memory_alloc(MEMORY_STATS, 16 * sizeof(int));
+        for (int i = 0; values && i < 16; i++) values[i] = i * 3;
+        values = (int*)memory_realloc(MEMORY_STATS, values, 4096 * sizeof(int));
+        bool kept = values != NULL;
+        for (int i = 0; kept && i < 16; i++) kept = values[i] == i * 3;
+        ASSERT_TRUE(kept, "Realloc preserves contents");
+        memory_free(values);
+    }
+    ASSERT_TRUE(arena->first && arena->first->next, "Large requests get their own block");
+
+    set_memory_arena(NULL);
+    destroy_memory_arena(arena);
+    return true;
+}
+
+static void* read_thread_arena(void* arg) {
+    *(MemoryArena**)arg = get_memory_arena();
+    return NULL;
+}
+
+bool test_limit_and_threads() {
+    printf("\n--- Testing Limit and Threads ---\n");
+
+    MemoryArena* arena = create_memory_arena(64 * 1024, 256 * 1024);
+    ASSERT_TRUE(arena != NULL, "Limited arena created");
+    set_memory_arena(arena);
+
+    QLearningAgent* small = create_agent(256, NUM_ACTIONS, 0.1f, 0.9f, 0.1f);
+    ASSERT_TRUE(small != NULL, "Allocation within the limit succeeds");
+    QLearningAgent* large = create_agent(1 << 16, NUM_ACTIONS, 0.1f, 0.9f, 0.1f);
+    ASSERT_TRUE(large == NULL && arena->reserved <= 256 * 1024, "Allocation past the limit fails");
+
+    MemoryArena* seen = arena;
+    pthread_t thread;
+    pthread_create(&thread, NULL, read_thread_arena, &seen);
+    pthread_join(thread, NULL);
+    ASSERT_TRUE(seen == NULL && get_memory_arena() == arena, "Other threads keep allocating from the heap");
+
+    set_memory_arena(NULL);
+    destroy_memory_arena(arena);
+    return true;
+}
+
+bool test_memory_tracker() {
+    printf("\n--- Testing Memory Tracker ---\n");
+
+    MemoryTracker* tracker = create_memory_tracker();
+    ASSERT_TRUE(tracker != NULL, "Tracker created");
+
+    void* blocks[100];
+    for (int i = 0; i < 100; i++) {
+        blocks[i] = i % 2 ? tracked_calloc(tracker, 4, 8) : tracked_malloc(tracker, 16);
+    }
+    ASSERT_TRUE(tracker->count == 100 && tracker->total_allocated == 50 * 32 + 50 * 16,
+                "Allocations and bytes tracked");
+
+    for (int i = 0; i < 100; i += 2) {
+        tracked_free(tracker, blocks[i]);
+    }
+    ASSERT_TRUE(tracker->count == 50 && tracker->total_allocated == 50 * 32, "Freed allocations untracked");
+
+    // Destroy releases whatever is still tracked
+    destroy_memory_tracker(tracker);
+    return true;
+}
+
+int main() {
+    printf("=== Memory Arena Test Suite ===\n");
+
+    test_heap_accounting();
+    test_arena_runs();
+    test_allocation_paths();
+    test_limit_and_threads();
+    test_memory_tracker();
+
+    printf("\n=== Test Summary ===\n");
+    printf("Tests Passed: %d\n", tests_passed);
+    printf("Tests Failed: %d\n", tests_failed);
+
+    if (tests_failed > 0) {
+        printf("⚠️  Some tests failed.\n");
+        return 1;
+    }
+    printf("🎉 ALL TESTS PASSED!\n");
+    return 0;
+}
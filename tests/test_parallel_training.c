@@ -0,0 +1,244 @@
+/*
+ * Parallel Training Test Suite
+ *
+ * Covers the multi-threaded trainer:
+ * - GridWorld cloning and Q-table copy/average helpers
+ * - Hogwild and merge modes learn a policy that reaches the goal
+ * - Episode accounting and the shared epsilon schedule
+ * - Hogwild leaves the agent's tracked Q bounds and variance matching the table
+ * - An aborted barrier releases a partial thread team
+ */
+
+#include "../include/parallel_training.h"
+#include "../include/agent.h"
+#include "../include/environment.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define ASSERT_TRUE(condition, message) \
+    if (!(condition)) { \
+        tests_failed++; \
+        printf("❌ FAIL: %s\n", message); \
+        return false; \
+    } else { \
+        tests_passed++; \
+        printf("✅ PASS: %s\n", message); \
+    }
+
+static GridWorld* create_test_world(void) {
+    GridWorld* world = create_grid_world(6, 6);
+    if (!world) return NULL;
+
+    world->start_pos = (Position){0, 0};
+    world->goal_pos = (Position){5, 5};
+    world->max_steps = 100;
+    set_cell(world, 2, 1, CELL_WALL);
+    set_cell(world, 2, 2, CELL_WALL);
+    set_cell(world, 4, 3, CELL_WALL);
+    set_cell(world, 5, 5, CELL_GOAL);
+    return world;
+}
+
+// Follow the greedy policy from the start and report whether it reaches the goal
+static bool greedy_policy_reaches_goal(GridWorld* world, QLearningAgent* agent) {
+    reset_environment(world);
+    for (int step = 0; step < world->max_steps && !world->episode_done; step++) {
+        step_environment(world, select_greedy_action(agent, get_state_index(world)));
+    }
+    return world->agent_pos.x == world->goal_pos.x && world->agent_pos.y == world->goal_pos.y;
+}
+
+bool test_clone_and_table_helpers() {
+    printf("\n--- Testing Clone and Q-table Helpers ---\n");
+
+    GridWorld* world = create_test_world();
+    GridWorld* copy = clone_grid_world(world);
+    ASSERT_TRUE(copy != NULL && copy->layout == world->layout, "Clone shares the layout until written");
+    ASSERT_TRUE(get_cell(copy, 2, 1) == CELL_WALL && copy->goal_pos.x == 5, "Clone copies layout");
+    set_cell(copy, 0, 3, CELL_WALL);
+    ASSERT_TRUE(get_cell(world, 0, 3) == CELL_EMPTY, "Clone is independent of the original");
+    ASSERT_TRUE(copy->layout != world->layout && !grid_layout_is_shared(world->layout),
+                "First write gives the clone its own layout");
+    ASSERT_TRUE(clone_grid_world(NULL) == NULL, "NULL clone rejected");
+
+    QLearningAgent* a = create_agent_with_storage(36, NUM_ACTIONS, 0.1f, 0.9f, 1.0f, QTABLE_STORAGE_ROWS);
+    QLearningAgent* b = create_agent_with_storage(36, NUM_ACTIONS, 0.1f, 0.9f, 1.0f, QTABLE_STORAGE_OPTIMIZED);
+    set_q_value(a, 7, ACTION_LEFT, 4.0f);
+    ASSERT_TRUE(copy_q_table(b, a) && get_q_value(b, 7, ACTION_LEFT) == 4.0f, "Copy across storage backends");
+    ASSERT_TRUE(select_greedy_action(b, 7) == ACTION_LEFT, "Copy invalidates argmax cache");
+
+    set_q_value(b, 7, ACTION_LEFT, 2.0f);
+    QLearningAgent* tables[2] = {a, b};
+    ASSERT_TRUE(average_q_tables(a, tables, 2, 0, 36), "Average succeeds");
+    ASSERT_TRUE(fabsf(get_q_value(a, 7, ACTION_LEFT) - 3.0f) < 1e-6f, "Average is element-wise mean");
+
+    QLearningAgent* small = create_agent_with_storage(10, NUM_ACTIONS, 0.1f, 0.9f, 1.0f, QTABLE_STORAGE_ROWS);
+    ASSERT_TRUE(!copy_q_table(small, a), "Mismatched dimensions rejected");
+
+    destroy_agent(small);
+    destroy_agent(a);
+    destroy_agent(b);
+    destroy_grid_world(copy);
+    destroy_grid_world(world);
+    return true;
+}
+
+static bool check_mode_learns(ParallelTrainingMode mode, QTableStorage storage, const char* label) {
+    GridWorld* world = create_test_world();
+    QLearningAgent* agent = create_agent_with_storage(36, NUM_ACTIONS, 0.2f, 0.95f, 1.0f, storage);
+    agent->epsilon_decay = 0.99f;
+    agent->epsilon_min = 0.05f;
+
+    ParallelTrainingConfig config = create_default_parallel_config();
+    config.num_threads = 4;
+    config.num_episodes = 1203;   // Not a multiple of the thread count
+    config.max_steps_per_episode = 100;
+    config.mode = mode;
+    config.merge_interval = 7;
+    config.print_progress = false;
+
+    ParallelTrainingResult result = run_parallel_training(world, agent, &config);
+    char message[128];
+
+    snprintf(message, sizeof(message), "%s: every episode runs exactly once", label);
+    ASSERT_TRUE(result.episodes_completed == config.num_episodes, message);
+    snprintf(message, sizeof(message), "%s: throughput measured", label);
+    ASSERT_TRUE(result.total_steps > 0 && result.episodes_per_second > 0.0, message);
+    snprintf(message, sizeof(message), "%s: epsilon decayed to minimum", label);
+    ASSERT_TRUE(fabsf(agent->epsilon - agent->epsilon_min) < 1e-6f, message);
+    snprintf(message, sizeof(message), "%s: greedy policy reaches the goal", label);
+    ASSERT_TRUE(greedy_policy_reaches_goal(world, agent), message);
+
+    destroy_agent(agent);
+    destroy_grid_world(world);
+    return true;
+}
+
+bool test_parallel_modes() {
+    printf("\n--- Testing Parallel Training Modes ---\n");
+
+    check_mode_learns(PARALLEL_MODE_HOGWILD, QTABLE_STORAGE_ROWS, "Hogwild/rows");
+    check_mode_learns(PARALLEL_MODE_HOGWILD, QTABLE_STORAGE_OPTIMIZED, "Hogwild/optimized");
+    check_mode_learns(PARALLEL_MODE_MERGE, QTABLE_STORAGE_ROWS, "Merge/rows");
+    check_mode_learns(PARALLEL_MODE_MERGE, QTABLE_STORAGE_OPTIMIZED, "Merge/optimized");
+    return true;
+}
+
+bool test_hogwild_tracking() {
+    printf("\n--- Testing Tracked Statistics After Hogwild ---\n");
+
+    GridWorld* world = create_test_world();
+    QLearningAgent* agent = create_agent(36, NUM_ACTIONS, 0.2f, 0.95f, 1.0f);
+    agent->epsilon_decay = 0.99f;
+
+    // Switch tracking on before the run, as the UI does on its first frame
+    float min_q, max_q;
+    get_q_value_bounds(agent, &min_q, &max_q);
+    calculate_q_value_variance(agent);
+
+    ParallelTrainingConfig config = create_default_parallel_config();
+    config.num_threads = 4;
+    config.num_episodes = 800;
+    config.max_steps_per_episode = 100;
+    config.mode = PARALLEL_MODE_HOGWILD;
+    config.print_progress = false;
+    run_parallel_training(world, agent, &config);
+
+    float lo = INFINITY, hi = -INFINITY;
+    double sum = 0.0, sum_sq = 0.0;
+    int entries = agent->num_states * agent->num_actions;
+    for (int s = 0; s < agent->num_states; s++) {
+        for (int a = 0; a < agent->num_actions; a++) {
+            float q = get_q_value(agent, s, (Action)a);
+            lo = fminf(lo, q);
+            hi = fmaxf(hi, q);
+            sum += q;
+            sum_sq += (double)q * q;
+        }
+    }
+    double mean = sum / entries;
+    float scanned = (float)(sum_sq / entries - mean * mean);
+
+    get_q_value_bounds(agent, &min_q, &max_q);
+    ASSERT_TRUE(min_q == lo && max_q == hi, "Tracked bounds match a full scan");
+    float tracked = calculate_q_value_variance(agent);
+    ASSERT_TRUE(fabsf(tracked - scanned) <= 1e-4f * fmaxf(1.0f, scanned), "Tracked variance matches a full scan");
+    ASSERT_TRUE(agent->q_bounds.tracking && agent->q_moments.tracking, "Tracking stays enabled");
+
+    // Later single-threaded writes keep both current
+    set_q_value(agent, 0, ACTION_UP, hi + 5.0f);
+    get_q_value_bounds(agent, &min_q, &max_q);
+    ASSERT_TRUE(max_q == hi + 5.0f, "Bounds follow writes after the run");
+
+    destroy_agent(agent);
+    destroy_grid_world(world);
+    return true;
+}
+
+bool test_config_helpers() {
+    printf("\n--- Testing Configuration Helpers ---\n");
+
+    ParallelTrainingMode mode = PARALLEL_MODE_HOGWILD;
+    ASSERT_TRUE(parse_parallel_mode("merge", &mode) && mode == PARALLEL_MODE_MERGE, "Parse merge");
+    ASSERT_TRUE(parse_parallel_mode("hogwild", &mode) && mode == PARALLEL_MODE_HOGWILD, "Parse hogwild");
+    ASSERT_TRUE(!parse_parallel_mode("locked", &mode), "Unknown mode rejected");
+
+    ParallelTrainingConfig config = create_default_parallel_config();
+    config.num_threads = 0;
+    ParallelTrainingResult result = run_parallel_training(NULL, NULL, &config);
+    ASSERT_TRUE(result.episodes_completed == 0, "Invalid parameters rejected");
+    return true;
+}
+
+static void* barrier_waiter_main(void* arg) {
+    static bool released;
+    released = worker_barrier_wait((WorkerBarrier*)arg);
+    return &released;
+}
+
+bool test_barrier_abort() {
+    printf("\n--- Testing Barrier Abort ---\n");
+
+    // Only one of three threads arrives, as when pthread_create fails part way
+    WorkerBarrier barrier;
+    worker_barrier_init(&barrier, 3);
+    pthread_t waiter;
+    ASSERT_TRUE(pthread_create(&waiter, NULL, barrier_waiter_main, &barrier) == 0, "Waiter started");
+    worker_barrier_abort(&barrier);
+    void* released = NULL;
+    pthread_join(waiter, &released);
+    ASSERT_TRUE(!*(bool*)released, "Blocked waiter released with false");
+    ASSERT_TRUE(!worker_barrier_wait(&barrier), "Waits after the abort return immediately");
+    worker_barrier_destroy(&barrier);
+
+    worker_barrier_init(&barrier, 1);
+    ASSERT_TRUE(worker_barrier_wait(&barrier) && worker_barrier_wait(&barrier), "Complete team passes");
+    worker_barrier_destroy(&barrier);
+    return true;
+}
+
+int main() {
+    printf("=== Parallel Training Test Suite ===\n");
+    set_environment_verbose(false);
+
+    test_clone_and_table_helpers();
+    test_parallel_modes();
+    test_hogwild_tracking();
+    test_config_helpers();
+    test_barrier_abort();
+
+    printf("\n=== Test Summary ===\n");
+    printf("Tests Passed: %d\n", tests_passed);
+    printf("Tests Failed: %d\n", tests_failed);
+
+    if (tests_failed > 0) {
+        printf("⚠️  Some tests failed.\n");
+        return 1;
+    }
+    printf("🎉 ALL TESTS PASSED!\n");
+    return 0;
+}
@@ -0,0 +1,228 @@
+/*
+ * Planning Test Suite
+ *
+ * Verifies value iteration over the compiled transition model:
+ * - Planned values match the closed form on an open grid
+ * - Greedy policies follow shortest paths around walls
+ * - Multi-threaded sweeps give bit-identical tables
+ * - Action noise is reflected in the Bellman fixed point
+ */
+
+#include "../include/planning.h"
+#include "../include/environment.h"
+#include "../include/agent.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define ASSERT_TRUE(condition, message) \
+    if (!(condition)) { \
+        tests_failed++; \
+        printf("❌ FAIL: %s\n", message); \
+        return false; \
+    } else { \
+        tests_passed++; \
+        printf("✅ PASS: %s\n", message); \
+    }
+
+// Walls splitting the grid so the shortest path has to detour
+static GridWorld* create_walled_world(int size) {
+    GridWorld* world = create_grid_world(size, size);
+    for (int y = 0; y < size - 2; y++) {
+        set_cell(world, size / 2, y, CELL_WALL);
+    }
+    for (int y = 2; y < size; y++) {
+        set_cell(world, size / 4, y, CELL_OBSTACLE);
+    }
+    return world;
+}
+
+// Shortest path length from start to goal (BFS), -1 if unreachable
+static int shortest_path(GridWorld* world) {
+    int n = world->width * world->height;
+    int* dist = (int*)malloc(n * sizeof(int));
+    int* queue = (int*)malloc(n * sizeof(int));
+    for (int i = 0; i < n; i++) dist[i] = -1;
+
+    int head = 0, tail = 0;
+    int start = position_to_state(world, world->start_pos);
+    dist[start] = 0;
+    queue[tail++] = start;
+    while (head < tail) {
+        int s = queue[head++];
+        Position here = state_to_position(world, s);
+        for (int a = 0; a < NUM_ACTIONS; a++) {
+            Position next = get_new_position(here, (Action)a);
+            int t = next.y * world->width + next.x;
+            if (is_walkable(world, next.x, next.y) && dist[t] < 0) {
+                dist[t] = dist[s] + 1;
+                queue[tail++] = t;
+            }
+        }
+    }
+    int result = dist[position_to_state(world, world->goal_pos)];
+    free(dist);
+    free(queue);
+    return result;
+}
+
+static int greedy_steps_to_goal(GridWorld* world, QLearningAgent* agent) {
+    reset_environment(world);
+    int steps = 0;
+    while (!world->episode_done) {
+        step_environment(world, select_greedy_action(agent, get_state_index(world)));
+        steps++;
+    }
+    return positions_equal(world->agent_pos, world->goal_pos) ? steps : -1;
+}
+
+bool test_open_grid_closed_form() {
+    printf("\n--- Testing Open Grid Closed Form ---\n");
+
+    GridWorld* world = create_grid_world(6, 6);
+    QLearningAgent* agent = create_agent(36, NUM_ACTIONS, 0.1f, 0.9f, 1.0f);
+    PlanningConfig config = create_default_planning_config(agent);
+    config.tolerance = 1e-6f;
+    ASSERT_TRUE(config.discount_factor == agent->discount_factor, "Defaults use the agent's discount");
+
+    PlanningResult result = run_value_iteration(world, agent, &config);
+    ASSERT_TRUE(result.converged && result.iterations > 0, "Value iteration converges");
+    ASSERT_TRUE(!has_transition_table(world), "Temporary transition table is dropped");
+
+    // From distance d: d-1 step penalties, then the goal reward
+    int d = 10;
+    float expected = 0.0f;
+    for (int k = 0; k < d - 1; k++) {
+        expected += powf(0.9f, (float)k) * world->step_penalty;
+    }
+    expected += powf(0.9f, (float)(d - 1)) * world->goal_reward;
+    float planned = fmaxf(get_q_value(agent, 0, ACTION_RIGHT), get_q_value(agent, 0, ACTION_DOWN));
+    ASSERT_TRUE(fabsf(planned - expected) < 1e-3f, "Start value matches the closed form");
+    ASSERT_TRUE(fabsf(get_q_value(agent, 0, ACTION_UP) - (world->wall_penalty + 0.9f * planned)) < 1e-3f,
+                "Bumping the border costs the wall penalty");
+    ASSERT_TRUE(greedy_steps_to_goal(world, agent) == d, "Greedy policy takes the shortest path");
+
+    destroy_agent(agent);
+    destroy_grid_world(world);
+    return true;
+}
+
+bool test_walls_and_threads() {
+    printf("\n--- Testing Walls and Threads ---\n");
+
+    GridWorld* world = create_walled_world(16);
+    ASSERT_TRUE(set_transition_table(world, true), "World compiled");
+    QLearningAgent* single = create_agent_with_storage(256, NUM_ACTIONS, 0.1f, 0.95f, 1.0f, QTABLE_STORAGE_ROWS);
+    QLearningAgent* multi = create_agent_with_storage(256, NUM_ACTIONS, 0.1f, 0.95f, 1.0f, QTABLE_STORAGE_OPTIMIZED);
+
+    PlanningConfig config = create_default_planning_config(single);
+    PlanningResult a = run_value_iteration(world, single, &config);
+    config.num_threads = 4;
+    PlanningResult b = run_value_iteration(world, multi, &config);
+    ASSERT_TRUE(a.converged && b.converged && a.iterations == b.iterations, "Threaded sweeps converge identically");
+    ASSERT_TRUE(has_transition_table(world), "Existing transition table is kept");
+
+    bool identical = true;
+    for (int s = 0; s < 256; s++) {
+        for (int act = 0; act < NUM_ACTIONS; act++) {
+            identical = identical && get_q_value(single, s, (Action)act) == get_q_value(multi, s, (Action)act);
+        }
+    }
+    ASSERT_TRUE(identical, "Threaded Q-table is bit-identical");
+    ASSERT_TRUE(get_q_value(single, 8, ACTION_DOWN) == 0.0f, "Wall cells keep zero Q-values");
+
+    int optimal = shortest_path(world);
+    ASSERT_TRUE(optimal > 0 && greedy_steps_to_goal(world, multi) == optimal, "Greedy policy detours optimally");
+
+    destroy_agent(single);
+    destroy_agent(multi);
+    destroy_grid_world(world);
+    return true;
+}
+
+bool test_action_noise_fixed_point() {
+    printf("\n--- Testing Action Noise ---\n");
+
+    GridWorld* world = create_walled_world(10);
+    QLearningAgent* clean = create_agent(100, NUM_ACTIONS, 0.1f, 0.9f, 1.0f);
+    QLearningAgent* noisy = create_agent(100, NUM_ACTIONS, 0.1f, 0.9f, 1.0f);
+    PlanningConfig config = create_default_planning_config(clean);
+    config.tolerance = 1e-6f;
+    run_value_iteration(world, clean, &config);
+
+    world->stochastic = true;
+    world->action_noise = 0.2f;
+    PlanningResult result = run_value_iteration(world, noisy, &config);
+    ASSERT_TRUE(result.converged, "Noisy value iteration converges");
+    ASSERT_TRUE(get_max_q_value(noisy, 0) < get_max_q_value(clean, 0), "Noise lowers the start value");
+
+    // Q(s,a) = 0.8 * backup(a) + 0.2 * mean_b backup(b), backup(a) = r + gamma * V(s')
+    set_transition_table(world, true);
+    TransitionTable* table = get_transition_table(world);
+    int goal = position_to_state(world, world->goal_pos);
+    float worst = 0.0f;
+    for (int s = 0; s < 100; s++) {
+        if (s == goal || !is_walkable(world, s % 10, s / 10)) continue;
+        float backup[NUM_ACTIONS];
+        float mean = 0.0f;
+        for (int a = 0; a < NUM_ACTIONS; a++) {
+            int i = s * NUM_ACTIONS + a;
+            int next = table->next_state[i];
+            backup[a] = table->outcome_reward[table->outcome[i]] + 0.9f * (next == goal ? 0.0f : get_max_q_value(noisy, next));
+            mean += backup[a] / NUM_ACTIONS;
+        }
+        for (int a = 0; a < NUM_ACTIONS; a++) {
+            float residual = fabsf(get_q_value(noisy, s, (Action)a) - (0.8f * backup[a] + 0.2f * mean));
+            if (residual > worst) worst = residual;
+        }
+    }
+    ASSERT_TRUE(worst < 1e-3f, "Noisy Q-table satisfies the Bellman equation");
+
+    destroy_agent(clean);
+    destroy_agent(noisy);
+    destroy_grid_world(world);
+    return true;
+}
+
+bool test_invalid_inputs() {
+    printf("\n--- Testing Invalid Inputs ---\n");
+
+    GridWorld* world = create_grid_world(8, 8);
+    QLearningAgent* small = create_agent(10, NUM_ACTIONS, 0.1f, 0.9f, 1.0f);
+    PlanningConfig config = create_default_planning_config(small);
+    ASSERT_TRUE(run_value_iteration(world, small, &config).iterations == 0, "Undersized Q-table rejected");
+    ASSERT_TRUE(run_value_iteration(NULL, small, &config).iterations == 0, "NULL world rejected");
+    config.discount_factor = 1.0f;
+    QLearningAgent* agent = create_agent(64, NUM_ACTIONS, 0.1f, 0.9f, 1.0f);
+    ASSERT_TRUE(run_value_iteration(world, agent, &config).iterations == 0, "Undiscounted planning rejected");
+
+    destroy_agent(small);
+    destroy_agent(agent);
+    destroy_grid_world(world);
+    return true;
+}
+
+int main() {
+    printf("=== Planning Test Suite ===\n");
+    set_environment_verbose(false);
+
+    test_open_grid_closed_form();
+    test_walls_and_threads();
+    test_action_noise_fixed_point();
+    test_invalid_inputs();
+
+    printf("\n=== Test Summary ===\n");
+    printf("Tests Passed: %d\n", tests_passed);
+    printf("Tests Failed: %d\n", tests_failed);
+
+    if (tests_failed > 0) {
+        printf("⚠️  Some tests failed.\n");
+        return 1;
+    }
+    printf("🎉 ALL TESTS PASSED!\n");
+    return 0;
+}
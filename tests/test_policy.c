@@ -0,0 +1,205 @@
+/*
+ * Compiled Policy Test Suite
+ *
+ * Verifies the packed 2-bit greedy policy:
+ * - Every state acts as select_greedy_action, for row and optimized tables
+ * - Out-of-range states act ACTION_UP, as select_greedy_action does
+ * - The artifact round-trips through a file and corruption is detected
+ * - Concurrent batch inference from several threads returns the same actions
+ */
+
+#include "../include/policy.h"
+#include "../include/agent.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <limits.h>
+#include <pthread.h>
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define ASSERT_TRUE(condition, message) \
+    if (!(condition)) { \
+        tests_failed++; \
+        printf("❌ FAIL: %s\n", message); \
+        return false; \
+    } else { \
+        tests_passed++; \
+        printf("✅ PASS: %s\n", message); \
+    }
+
+#define NUM_STATES 1001         // Not a multiple of four: the last byte is partial
+#define NUM_THREADS 4
+#define QUERIES 100000
+
+// Random Q-values, with every fifth state tied so tie-breaking is exercised
+static QLearningAgent* create_trained_agent(QTableStorage storage) {
+    QLearningAgent* agent = create_agent_with_storage(NUM_STATES, NUM_ACTIONS, 0.1f, 0.9f, 0.1f, storage);
+    if (!agent) return NULL;
+
+    RandomState rng;
+    seed_random(&rng, 17);
+    for (int s = 0; s < NUM_STATES; s++) {
+        for (int a = 0; a < NUM_ACTIONS; a++) {
+            float q = s % 5 == 0 ? 1.0f : random_range(&rng, -5.0f, 5.0f);
+            set_q_value(agent, s, (Action)a, q);
+        }
+    }
+    return agent;
+}
+
+bool test_matches_greedy() {
+    printf("\n--- Testing Greedy Equivalence ---\n");
+
+    QTableStorage storages[2] = {QTABLE_STORAGE_ROWS, QTABLE_STORAGE_OPTIMIZED};
+    for (int k = 0; k < 2; k++) {
+        QLearningAgent* agent = create_trained_agent(storages[k]);
+        CompiledPolicy* policy = compile_policy(agent);
+        ASSERT_TRUE(agent && policy, "Policy compiled");
+        ASSERT_TRUE(compiled_policy_bytes(policy) == (NUM_STATES + 3) / 4 &&
+                    (uintptr_t)policy->packed % 64 == 0, "Four states per byte, cache-line aligned");
+
+        int states[NUM_STATES];
+        int actions[NUM_STATES];
+        for (int s = 0; s < NUM_STATES; s++) states[s] = s;
+        policy_act(policy, states, actions, NUM_STATES);
+
+        bool same = true;
+        for (int s = 0; s < NUM_STATES; s++) {
+            Action expected = select_greedy_action(agent, s);
+            same = same && policy_action(policy, s) == expected && actions[s] == (int)expected;
+        }
+        ASSERT_TRUE(same, k == 0 ? "Row table: every state matches select_greedy_action"
+                                 : "Optimized table: every state matches select_greedy_action");
+        ASSERT_TRUE(policy_action(policy, 0) == ACTION_UP, "Ties go to the lowest action");
+
+        int bad_states[4] = {-1, NUM_STATES, INT_MAX, INT_MIN};
+        int bad_actions[4] = {9, 9, 9, 9};
+        policy_act(policy, bad_states, bad_actions, 4);
+        ASSERT_TRUE(bad_actions[0] == ACTION_UP && bad_actions[1] == ACTION_UP &&
+                    bad_actions[2] == ACTION_UP && bad_actions[3] == ACTION_UP,
+                    "Out-of-range states act ACTION_UP");
+
+        destroy_compiled_policy(policy);
+        destroy_agent(agent);
+    }
+
+    QLearningAgent* wide = create_agent(16, 8, 0.1f, 0.9f, 0.1f);
+    ASSERT_TRUE(compile_policy(wide) == NULL, "More than four actions rejected");
+    destroy_agent(wide);
+    return true;
+}
+
+bool test_file_round_trip() {
+    printf("\n--- Testing File Round Trip ---\n");
+
+    const char* filename = "test_policy.bin";
+    QLearningAgent* agent = create_trained_agent(QTABLE_STORAGE_ROWS);
+    CompiledPolicy* policy = compile_policy(agent);
+    ASSERT_TRUE(policy && save_compiled_policy(policy, filename), "Policy saved");
+
+    CompiledPolicy* loaded = load_compiled_policy(filename);
+    ASSERT_TRUE(loaded && loaded->num_states == NUM_STATES && loaded->num_actions == NUM_ACTIONS,
+                "Policy loaded with its dimensions");
+    bool same = true;
+    for (int s = 0; s < NUM_STATES; s++) {
+        same = same && policy_action(loaded, s) == policy_action(policy, s);
+    }
+    ASSERT_TRUE(same, "Loaded policy acts like the saved one");
+    destroy_compiled_policy(loaded);
+
+    // Flip one packed byte behind the header
+    FILE* file = fopen(filename, "r+b");
+    fseek(file, (long)sizeof(PolicyFileHeader) + 10, SEEK_SET);
+    int byte = fgetc(file);
+    fseek(file, (long)sizeof(PolicyFileHeader) + 10, SEEK_SET);
+    fputc(byte ^ 0x5A, file);
+    fclose(file);
+    ASSERT_TRUE(load_compiled_policy(filename) == NULL, "Corrupt data rejected");
+
+    ASSERT_TRUE(save_q_table(agent, filename) && load_compiled_policy(filename) == NULL,
+                "Other file types rejected");
+    remove(filename);
+
+    destroy_compiled_policy(policy);
+    destroy_agent(agent);
+    return true;
+}
+
+typedef struct {
+    const CompiledPolicy* policy;
+    const int* states;
+    const int* expected;
+    int mismatches;
+} InferenceWorker;
+
+static void* inference_main(void* arg) {
+    InferenceWorker* worker = (InferenceWorker*)arg;
+    int actions[256];
+    for (int round = 0; round < 20; round++) {
+        for (int begin = 0; begin < QUERIES; begin += 256) {
+            int n = QUERIES - begin < 256 ? QUERIES - begin : 256;
+            policy_act(worker->policy, worker->states + begin, actions, n);
+            for (int i = 0; i < n; i++) {
+                worker->mismatches += actions[i] != worker->expected[begin + i];
+            }
+        }
+    }
+    return NULL;
+}
+
+bool test_concurrent_inference() {
+    printf("\n--- Testing Concurrent Inference ---\n");
+
+    QLearningAgent* agent = create_trained_agent(QTABLE_STORAGE_OPTIMIZED);
+    CompiledPolicy* policy = compile_policy(agent);
+    int* states = (int*)malloc(QUERIES * sizeof(int));
+    int* expected = (int*)malloc(QUERIES * sizeof(int));
+    ASSERT_TRUE(policy && states && expected, "Policy and queries ready");
+
+    RandomState rng;
+    seed_random(&rng, 99);
+    for (int i = 0; i < QUERIES; i++) {
+        states[i] = (int)random_next_bounded(&rng, NUM_STATES);
+        expected[i] = (int)select_greedy_action(agent, states[i]);
+    }
+
+    pthread_t threads[NUM_THREADS];
+    InferenceWorker workers[NUM_THREADS];
+    for (int t = 0; t < NUM_THREADS; t++) {
+        workers[t] = (InferenceWorker){policy, states, expected, 0};
+        pthread_create(&threads[t], NULL, inference_main, &workers[t]);
+    }
+    int mismatches = 0;
+    for (int t = 0; t < NUM_THREADS; t++) {
+        pthread_join(threads[t], NULL);
+        mismatches += workers[t].mismatches;
+    }
+    ASSERT_TRUE(mismatches == 0, "Every thread gets the greedy actions");
+
+    free(states);
+    free(expected);
+    destroy_compiled_policy(policy);
+    destroy_agent(agent);
+    return true;
+}
+
+int main() {
+    printf("=== Compiled Policy Test Suite ===\n");
+
+    test_matches_greedy();
+    test_file_round_trip();
+    test_concurrent_inference();
+
+    printf("\n=== Test Summary ===\n");
+    printf("Tests Passed: %d\n", tests_passed);
+    printf("Tests Failed: %d\n", tests_failed);
+
+    if (tests_failed > 0) {
+        printf("⚠️  Some tests failed.\n");
+        return 1;
+    }
+    printf("🎉 ALL TESTS PASSED!\n");
+    return 0;
+}
@@ -7,6 +7,8 @@
  * - Importance sampling weights
  * - Batch replay functionality
  * - TD error calculation and priority updates
+ * - Sum-tree aggregates, prefix lookups and stratified sampling
+ * - Structure-of-arrays batch sampling and the batched update kernel
  */
 
 #include "../include/agent.h"
@@ -345,6 +347,99 @@ bool test_priority_updates() {
     return true;
 }
 
+// Test sum-tree totals, min/max and prefix lookups
+bool test_sum_tree() {
+    printf("\n--- Testing Sum Tree ---\n");
+    
+    SumTree* tree = create_sum_tree(5);  // Non power of two leaves
+    ASSERT_TRUE(tree != NULL, "Sum tree created");
+    ASSERT_TRUE(sum_tree_find(tree, 0.0) == -1, "Empty tree has no samples");
+    
+    float values[] = {1.0f, 3.0f, 0.5f, 2.0f, 3.5f};
+    for (int i = 0; i < 5; i++) {
+        sum_tree_update(tree, i, values[i]);
+    }
+    ASSERT_FLOAT_NEAR((float)sum_tree_total(tree), 10.0f, 1e-6f, "Total priority");
+    ASSERT_FLOAT_NEAR(sum_tree_min(tree), 0.5f, 1e-6f, "Minimum priority");
+    ASSERT_FLOAT_NEAR(sum_tree_max(tree), 3.5f, 1e-6f, "Maximum priority");
+    
+    ASSERT_TRUE(sum_tree_find(tree, 0.0) == 0, "Prefix 0 maps to first leaf");
+    ASSERT_TRUE(sum_tree_find(tree, 3.99) == 1, "Prefix inside second range");
+    ASSERT_TRUE(sum_tree_find(tree, 4.0) == 2, "Prefix on range boundary");
+    ASSERT_TRUE(sum_tree_find(tree, 9.99) == 4, "Prefix in last range");
+    ASSERT_TRUE(sum_tree_find(tree, 50.0) == 4, "Prefix past total clamps to a used leaf");
+    
+    sum_tree_update(tree, 4, 0.25f);
+    ASSERT_FLOAT_NEAR((float)sum_tree_total(tree), 6.75f, 1e-6f, "Total after update");
+    ASSERT_FLOAT_NEAR(sum_tree_min(tree), 0.25f, 1e-6f, "Minimum after update");
+    ASSERT_FLOAT_NEAR(sum_tree_max(tree), 3.0f, 1e-6f, "Maximum after update");
+    
+    destroy_sum_tree(tree);
+    return true;
+}
+
+// Test that sampling frequencies follow P(i) = p_i / sum(p) in both modes
+bool test_sampling_distribution() {
+    printf("\n--- Testing Sampling Distribution ---\n");
+    
+    ReplayConfig config = create_default_replay_config();
+    config.priority_alpha = 1.0f;
+    
+    for (int mode = 0; mode < 2; mode++) {
+        config.stratified_sampling = (mode == 1);
+        PriorityExperienceBuffer* buffer = create_priority_buffer(4, config);
+        float td_errors[] = {1.0f, 2.0f, 3.0f, 4.0f};
+        for (int i = 0; i < 4; i++) {
+            add_priority_experience(buffer, i, ACTION_UP, 0.0f, i, false, td_errors[i]);
+        }
+        
+        int counts[4] = {0, 0, 0, 0};
+        int indices[TEST_BATCH_SIZE];
+        float weights[TEST_BATCH_SIZE];
+        const int rounds = 2000;
+        for (int r = 0; r < rounds; r++) {
+            sample_priority_batch(buffer, TEST_BATCH_SIZE, indices, weights);
+            for (int i = 0; i < TEST_BATCH_SIZE; i++) {
+                counts[indices[i]]++;
+            }
+        }
+        
+        float total_samples = (float)rounds * TEST_BATCH_SIZE;
+        for (int i = 0; i < 4; i++) {
+            ASSERT_FLOAT_NEAR(counts[i] / total_samples, td_errors[i] / 10.0f, 0.01f,
+                              mode ? "Stratified frequency matches priority" : "Frequency matches priority");
+        }
+        
+        // Lowest priority gets the normalized weight 1, others (p_min / p_i)^beta
+        ASSERT_FLOAT_NEAR(calculate_importance_weight(buffer, 0), 1.0f, 1e-5f, "Max weight normalized to 1");
+        ASSERT_FLOAT_NEAR(calculate_importance_weight(buffer, 3), powf(0.25f, buffer->beta), 1e-4f,
+                          "Weight follows (N * P(i))^-beta");
+        
+        destroy_priority_buffer(buffer);
+    }
+    return true;
+}
+
+// Test that overwriting the maximum slot keeps max_priority exact
+bool test_priority_overwrite() {
+    printf("\n--- Testing Priority Overwrite ---\n");
+    
+    ReplayConfig config = create_default_replay_config();
+    PriorityExperienceBuffer* buffer = create_priority_buffer(3, config);
+    
+    add_priority_experience(buffer, 0, ACTION_UP, 0.0f, 0, false, 5.0f);
+    add_priority_experience(buffer, 1, ACTION_UP, 0.0f, 1, false, 0.2f);
+    add_priority_experience(buffer, 2, ACTION_UP, 0.0f, 2, false, 0.3f);
+    add_priority_experience(buffer, 3, ACTION_UP, 0.0f, 3, false, 0.1f);  // Replaces slot 0
+    
+    float expected = powf(0.3f + buffer->min_priority, buffer->alpha);
+    ASSERT_FLOAT_NEAR(buffer->max_priority, expected, 1e-6f, "Max priority drops after overwrite");
+    ASSERT_TRUE(buffer->size == 3 && buffer->current_index == 1, "Ring buffer wrapped");
+    
+    destroy_priority_buffer(buffer);
+    return true;
+}
+
 // Test beta annealing
 bool test_beta_annealing() {
     printf("\n--- Testing Beta Annealing ---\n");
@@ -531,6 +626,127 @@ bool test_performance_comparison() {
     return true;
 }
 
+// Scalar reference for replay_update_batch: targets from a copy of the table
+// taken before the batch, updates applied in order to the live table
+static bool check_replay_kernel(QTableStorage storage) {
+    const int num_states = 200;
+    const int count = 150;  // Two full passes plus a tail that is not a multiple of four
+    QLearningAgent* agent = create_agent_with_storage(num_states, NUM_ACTIONS, 0.3f, 0.9f, 0.1f, storage);
+    QLearningAgent* reference = create_agent_with_storage(num_states, NUM_ACTIONS, 0.3f, 0.9f, 0.1f, storage);
+    QLearningAgent* before = create_agent_with_storage(num_states, NUM_ACTIONS, 0.3f, 0.9f, 0.1f, storage);
+    if (!agent || !reference || !before) return false;
+
+    RandomState rng;
+    seed_random(&rng, 99);
+    for (int s = 0; s < num_states; s++) {
+        for (int a = 0; a < NUM_ACTIONS; a++) {
+            float q = random_range(&rng, -5.0f, 5.0f);
+            set_q_value(agent, s, a, q);
+            set_q_value(reference, s, a, q);
+        }
+    }
+
+    int states[150], actions[150], next_states[150];
+    float rewards[150], weights[150], td_errors[150], expected_errors[150];
+    bool dones[150];
+    for (int i = 0; i < count; i++) {
+        states[i] = (int)random_next_bounded(&rng, 20);  // Few states, so (s, a) pairs repeat
+        actions[i] = (int)random_next_bounded(&rng, NUM_ACTIONS);
+        next_states[i] = (int)random_next_bounded(&rng, num_states);
+        rewards[i] = random_range(&rng, -1.0f, 1.0f);
+        weights[i] = random_range(&rng, 0.1f, 1.0f);
+        dones[i] = i % 9 == 0;
+    }
+    states[5] = -1;             // Invalid transitions are skipped
+    next_states[6] = num_states;
+    dones[6] = false;
+
+    bool matches = true;
+    for (int begin = 0; begin < count; begin += 64) {
+        copy_q_table(before, reference);
+        int end = begin + 64 < count ? begin + 64 : count;
+        for (int i = begin; i < end; i++) {
+            bool valid = states[i] >= 0 && (dones[i] || next_states[i] < num_states);
+            float expected_error = 0.0f;
+            if (valid) {
+                float target = rewards[i] + (dones[i] ? 0.0f : 0.9f * get_max_q_value(before, next_states[i]));
+                float current = get_q_value(reference, states[i], (Action)actions[i]);
+                expected_error = target - current;
+                set_q_value(reference, states[i], (Action)actions[i], current + 0.3f * weights[i] * expected_error);
+            }
+            expected_errors[i] = expected_error;
+        }
+    }
+
+    replay_update_batch(agent, states, actions, rewards, next_states, dones, weights, count, td_errors);
+    for (int i = 0; i < count; i++) {
+        if (fabsf(td_errors[i] - expected_errors[i]) > 1e-4f) matches = false;
+    }
+    for (int s = 0; s < num_states; s++) {
+        for (int a = 0; a < NUM_ACTIONS; a++) {
+            if (fabsf(get_q_value(agent, s, (Action)a) - get_q_value(reference, s, (Action)a)) > 1e-4f) matches = false;
+        }
+    }
+
+    destroy_agent(agent);
+    destroy_agent(reference);
+    destroy_agent(before);
+    return matches;
+}
+
+// Test structure-of-arrays sampling and the batched replay kernel
+bool test_soa_replay_kernel() {
+    printf("\n--- Testing SoA Replay Kernel ---\n");
+    
+    ASSERT_TRUE(check_replay_kernel(QTABLE_STORAGE_ROWS), "Kernel matches scalar replay (row storage)");
+    ASSERT_TRUE(check_replay_kernel(QTABLE_STORAGE_OPTIMIZED), "Kernel matches scalar replay (flat storage)");
+    
+    // Both samplers consume the generator identically
+    ReplayConfig config = create_default_replay_config();
+    PriorityExperienceBuffer* aos = create_priority_buffer(TEST_BUFFER_SIZE, config);
+    PriorityExperienceBuffer* soa = create_priority_buffer(TEST_BUFFER_SIZE, config);
+    ReplayBatch* batch = create_replay_batch(TEST_BATCH_SIZE);
+    ASSERT_TRUE(aos && soa && batch, "Buffers and batch created");
+    ASSERT_TRUE(create_replay_batch(0) == NULL, "Empty batch rejected");
+    for (int i = 0; i < 500; i++) {
+        float td_error = (float)(i % 17) * 0.3f;
+        add_priority_experience(aos, i % 64, (Action)(i % NUM_ACTIONS), 0.5f, (i + 3) % 64, i % 11 == 0, td_error);
+        add_priority_experience(soa, i % 64, (Action)(i % NUM_ACTIONS), 0.5f, (i + 3) % 64, i % 11 == 0, td_error);
+    }
+    seed_priority_buffer(aos, 7);
+    seed_priority_buffer(soa, 7);
+    
+    int indices[TEST_BATCH_SIZE];
+    float weights[TEST_BATCH_SIZE];
+    PriorityExperience* records = sample_priority_batch(aos, TEST_BATCH_SIZE, indices, weights);
+    ASSERT_TRUE(sample_replay_batch(soa, TEST_BATCH_SIZE, batch) && batch->size == TEST_BATCH_SIZE,
+                "SoA batch sampled");
+    ASSERT_TRUE(!sample_replay_batch(soa, TEST_BATCH_SIZE + 1, batch), "Batch larger than capacity rejected");
+    bool same = true;
+    for (int i = 0; i < TEST_BATCH_SIZE; i++) {
+        same = same && batch->indices[i] == indices[i] && batch->weights[i] == weights[i] &&
+               batch->states[i] == records[i].state && batch->actions[i] == (int)records[i].action &&
+               batch->next_states[i] == records[i].next_state && batch->dones[i] == records[i].done;
+    }
+    ASSERT_TRUE(same, "SoA batch holds the same draws as the record batch");
+    
+    // replay_priority_batch writes the kernel's TD errors back as priorities
+    QLearningAgent* agent = create_agent(64, NUM_ACTIONS, 0.1f, 0.9f, 0.1f);
+    replay_priority_batch(agent, soa, batch);
+    int slot = batch->indices[0];
+    float expected_priority = powf(fabsf(batch->td_errors[0]) + soa->min_priority, soa->alpha);
+    bool later_duplicate = false;
+    for (int i = 1; i < TEST_BATCH_SIZE; i++) later_duplicate = later_duplicate || batch->indices[i] == slot;
+    ASSERT_TRUE(later_duplicate || fabsf(soa->experiences[slot].priority - expected_priority) < 1e-5f,
+                "Priorities updated from kernel TD errors");
+    
+    destroy_agent(agent);
+    destroy_replay_batch(batch);
+    destroy_priority_buffer(aos);
+    destroy_priority_buffer(soa);
+    return true;
+}
+
 // Main test runner
 int main() {
     printf("Priority Experience Replay Test Suite\n");
@@ -548,8 +764,12 @@ int main() {
         test_td_error_calculation,
         test_batch_replay,
         test_priority_updates,
+        test_sum_tree,
+        test_sampling_distribution,
+        test_priority_overwrite,
         test_beta_annealing,
-        test_performance_comparison
+        test_performance_comparison,
+        test_soa_replay_kernel
     };
     
     const char* test_names[] = {
@@ -561,8 +781,12 @@ int main() {
         "TD Error Calculation",
         "Batch Replay",
         "Priority Updates",
+        "Sum Tree",
+        "Sampling Distribution",
+        "Priority Overwrite",
         "Beta Annealing",
-        "Performance Comparison"
+        "Performance Comparison",
+        "SoA Replay Kernel"
     };
     
     int num_tests = sizeof(tests) / sizeof(tests[0]);
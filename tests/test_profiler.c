@@ -0,0 +1,188 @@
+/*
+ * Profiler Test Suite
+ *
+ * Verifies the hot-path instrumentation (built with ENABLE_PROFILING):
+ * - Scoped timers count calls and convert ticks to wall-clock time
+ * - Interval summaries report only what happened since the last one
+ * - Every thread records into its own counters and all are summed
+ * - Training steps are attributed to the env step, action and update zones
+ * - Chrome traces hold the buffered events and count the dropped ones
+ */
+
+#include "../include/profiler.h"
+#include "../include/training.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define ASSERT_TRUE(condition, message) \
+    if (!(condition)) { \
+        tests_failed++; \
+        printf("❌ FAIL: %s\n", message); \
+        return false; \
+    } else { \
+        tests_passed++; \
+        printf("✅ PASS: %s\n", message); \
+    }
+
+#define NUM_WORKERS 4
+#define RECORDS_PER_WORKER 10000
+#define TRACE_EVENTS 1000
+
+static void spin_for_ms(double ms) {
+    uint64_t start = profile_clock_ticks();
+    while ((double)(profile_clock_ticks() - start) < ms * 1e6) {
+    }
+}
+
+// Number of non-overlapping occurrences of needle in the file
+static int count_in_file(const char* filename, const char* needle) {
+    FILE* file = fopen(filename, "r");
+    if (!file) return -1;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char* text = (char*)malloc(size + 1);
+    size_t read = fread(text, 1, size, file);
+    text[read] = '\0';
+    fclose(file);
+
+    int count = 0;
+    for (const char* p = strstr(text, needle); p; p = strstr(p + strlen(needle), needle)) {
+        count++;
+    }
+    free(text);
+    return count;
+}
+
+bool test_timers() {
+    printf("\n--- Testing Timers ---\n");
+
+    ASSERT_TRUE(PROFILE_ENABLED, "Profiling macros enabled");
+    profile_init(TRACE_EVENTS);
+
+    PROFILE_BEGIN(PROFILE_REPLAY);
+    spin_for_ms(5.0);
+    PROFILE_END(PROFILE_REPLAY);
+    profile_record((ProfileZone)NUM_PROFILE_ZONES, 0, 100);
+
+    ProfileSummary summary = profile_collect(false);
+    ASSERT_TRUE(summary.calls[PROFILE_REPLAY] == 1 && summary.num_threads == 1, "Call counted on this thread");
+    ASSERT_TRUE(summary.seconds[PROFILE_REPLAY] > 0.004 && summary.seconds[PROFILE_REPLAY] < 0.05,
+                "Ticks converted to wall-clock time");
+    ASSERT_TRUE(summary.max_seconds[PROFILE_REPLAY] == summary.seconds[PROFILE_REPLAY] &&
+                summary.wall_seconds >= summary.seconds[PROFILE_REPLAY], "Max and wall time consistent");
+    ASSERT_TRUE(strcmp(profile_zone_name(PROFILE_ENV_STEP), "env_step") == 0 &&
+                strcmp(profile_zone_name((ProfileZone)NUM_PROFILE_ZONES), "unknown") == 0, "Zone names");
+
+    // Intervals start where the previous summary left off
+    profile_collect(true);
+    for (int i = 0; i < 3; i++) {
+        PROFILE_BEGIN(PROFILE_REPLAY);
+        PROFILE_END(PROFILE_REPLAY);
+    }
+    ProfileSummary interval = profile_collect(true);
+    ProfileSummary total = profile_collect(false);
+    ASSERT_TRUE(interval.calls[PROFILE_REPLAY] == 3 && total.calls[PROFILE_REPLAY] == 4,
+                "Interval summary holds only the new calls");
+    ASSERT_TRUE(interval.wall_seconds < total.wall_seconds, "Interval covers less time than the run");
+    return true;
+}
+
+static void* worker_main(void* arg) {
+    (void)arg;
+    for (int i = 0; i < RECORDS_PER_WORKER; i++) {
+        PROFILE_BEGIN(PROFILE_Q_UPDATE);
+        PROFILE_END(PROFILE_Q_UPDATE);
+    }
+    return NULL;
+}
+
+bool test_threads_and_trace() {
+    printf("\n--- Testing Threads and Trace ---\n");
+
+    pthread_t workers[NUM_WORKERS];
+    for (int i = 0; i < NUM_WORKERS; i++) {
+        pthread_create(&workers[i], NULL, worker_main, NULL);
+    }
+    for (int i = 0; i < NUM_WORKERS; i++) {
+        pthread_join(workers[i], NULL);
+    }
+
+    ProfileSummary summary = profile_collect(false);
+    ASSERT_TRUE(summary.num_threads == NUM_WORKERS + 1, "Each thread registered once");
+    ASSERT_TRUE(summary.calls[PROFILE_Q_UPDATE] == (uint64_t)NUM_WORKERS * RECORDS_PER_WORKER,
+                "Calls from every thread summed");
+    ASSERT_TRUE(summary.dropped_events == (uint64_t)NUM_WORKERS * (RECORDS_PER_WORKER - TRACE_EVENTS),
+                "Events past the trace buffer dropped");
+
+    const char* filename = "test_profile_trace.json";
+    ASSERT_TRUE(profile_write_trace(filename), "Trace written");
+    ASSERT_TRUE(count_in_file(filename, "{\"traceEvents\":[") == 1, "Chrome trace header");
+    ASSERT_TRUE(count_in_file(filename, "\"ph\":\"X\"") == NUM_WORKERS * TRACE_EVENTS + 4,
+                "Every buffered event in the trace");
+    ASSERT_TRUE(count_in_file(filename, "\"name\":\"thread_name\"") == NUM_WORKERS + 1 &&
+                count_in_file(filename, "\"name\":\"q_update\"") == NUM_WORKERS * TRACE_EVENTS,
+                "One named track per thread");
+    remove(filename);
+    ASSERT_TRUE(!profile_write_trace("no_such_directory/trace.json"), "Unwritable trace reported");
+    return true;
+}
+
+bool test_training_zones() {
+    printf("\n--- Testing Training Zones ---\n");
+
+    profile_shutdown();
+    ASSERT_TRUE(profile_collect(false).num_threads == 0, "Shutdown clears the registry");
+    profile_init(0);
+
+    set_environment_verbose(false);
+    GridWorld* world = create_grid_world(8, 8);
+    QLearningAgent* agent = create_agent(64, NUM_ACTIONS, 0.1f, 0.9f, 0.5f);
+    TrainingStats* stats = create_training_stats(10);
+    ASSERT_TRUE(world && agent && stats, "Training objects created");
+
+    int steps = 0;
+    for (int episode = 0; episode < 5; episode++) {
+        EpisodeProgress progress = run_training_episode(world, agent, 100, NULL);
+        finish_training_episode(world, agent, stats, episode, &progress);
+        steps += progress.steps_taken;
+    }
+
+    ProfileSummary summary = profile_collect(false);
+    ASSERT_TRUE(summary.calls[PROFILE_ENV_STEP] == (uint64_t)steps &&
+                summary.calls[PROFILE_ACTION_SELECT] == (uint64_t)steps &&
+                summary.calls[PROFILE_Q_UPDATE] == (uint64_t)steps, "One call per zone per step");
+    ASSERT_TRUE(summary.calls[PROFILE_STATS] == 5 && summary.calls[PROFILE_RENDER] == 0,
+                "Episode bookkeeping counted as stats");
+    profile_print_summary("Test profile", false);
+
+    destroy_training_stats(stats);
+    destroy_agent(agent);
+    destroy_grid_world(world);
+    profile_shutdown();
+    return true;
+}
+
+int main() {
+    printf("=== Profiler Test Suite ===\n");
+
+    test_timers();
+    test_threads_and_trace();
+    test_training_zones();
+
+    printf("\n=== Test Summary ===\n");
+    printf("Tests Passed: %d\n", tests_passed);
+    printf("Tests Failed: %d\n", tests_failed);
+
+    if (tests_failed > 0) {
+        printf("⚠️  Some tests failed.\n");
+        return 1;
+    }
+    printf("🎉 ALL TESTS PASSED!\n");
+    return 0;
+}
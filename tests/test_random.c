@@ -0,0 +1,151 @@
+/*
+ * Random Number Generator Test Suite
+ *
+ * Verifies the xoshiro256** RandomState API:
+ * - Identical seeds give identical streams, jumps give distinct ones
+ * - Range, bulk-fill and shuffle behaviour
+ * - Seeded agents and replay buffers sample reproducibly
+ */
+
+#include "../include/utils.h"
+#include "../include/agent.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define ASSERT_TRUE(condition, message) \
+    if (!(condition)) { \
+        tests_failed++; \
+        printf("❌ FAIL: %s\n", message); \
+        return false; \
+    } else { \
+        tests_passed++; \
+        printf("✅ PASS: %s\n", message); \
+    }
+
+bool test_determinism_and_jump() {
+    printf("\n--- Testing Determinism and Jump ---\n");
+
+    RandomState* a = init_random(42);
+    RandomState* b = init_random(42);
+    ASSERT_TRUE(a != NULL && b != NULL && a->initialized, "Generators created");
+
+    bool same = true;
+    for (int i = 0; i < 1000; i++) {
+        same = same && (random_next_u64(a) == random_next_u64(b));
+    }
+    ASSERT_TRUE(same, "Equal seeds produce equal streams");
+
+    random_jump(b);
+    int matches = 0;
+    for (int i = 0; i < 1000; i++) {
+        matches += (random_next_u64(a) == random_next_u64(b));
+    }
+    ASSERT_TRUE(matches == 0, "Jumped stream differs");
+
+    destroy_random(a);
+    destroy_random(b);
+    return true;
+}
+
+bool test_ranges_and_bulk() {
+    printf("\n--- Testing Ranges and Bulk Fill ---\n");
+
+    RandomState rng;
+    seed_random(&rng, 7);
+
+    bool floats_ok = true;
+    double sum = 0.0;
+    for (int i = 0; i < 100000; i++) {
+        float f = random_float(&rng);
+        floats_ok = floats_ok && f >= 0.0f && f < 1.0f;
+        sum += f;
+    }
+    ASSERT_TRUE(floats_ok, "random_float in [0, 1)");
+    ASSERT_TRUE(sum / 100000.0 > 0.49 && sum / 100000.0 < 0.51, "random_float mean near 0.5");
+
+    int counts[4] = {0, 0, 0, 0};
+    bool ints_ok = true;
+    for (int i = 0; i < 40000; i++) {
+        int v = random_int(&rng, -1, 2);
+        ints_ok = ints_ok && v >= -1 && v <= 2;
+        if (v >= -1 && v <= 2) counts[v + 1]++;
+    }
+    ASSERT_TRUE(ints_ok, "random_int inclusive range respected");
+    ASSERT_TRUE(counts[0] > 9000 && counts[3] > 9000, "random_int reaches both endpoints uniformly");
+
+    float floats[257];
+    int ints[257];
+    random_fill_floats(&rng, floats, 257);
+    random_fill_ints(&rng, ints, 257, 10, 12);
+    bool bulk_ok = true;
+    for (int i = 0; i < 257; i++) {
+        bulk_ok = bulk_ok && floats[i] >= 0.0f && floats[i] < 1.0f && ints[i] >= 10 && ints[i] <= 12;
+    }
+    ASSERT_TRUE(bulk_ok, "Bulk fills stay in range (odd count)");
+
+    int values[16];
+    for (int i = 0; i < 16; i++) values[i] = i;
+    shuffle_array(&rng, values, sizeof(int), 16);
+    int seen = 0;
+    for (int i = 0; i < 16; i++) seen |= 1 << values[i];
+    ASSERT_TRUE(seen == 0xFFFF, "Shuffle is a permutation");
+    return true;
+}
+
+bool test_seeded_sampling() {
+    printf("\n--- Testing Seeded Agent and Buffer Sampling ---\n");
+
+    QLearningAgent* a = create_agent(16, NUM_ACTIONS, 0.1f, 0.9f, 1.0f);
+    QLearningAgent* b = create_agent(16, NUM_ACTIONS, 0.1f, 0.9f, 1.0f);
+    seed_agent(a, 99);
+    seed_agent(b, 99);
+    bool same_actions = true;
+    for (int i = 0; i < 200; i++) {
+        same_actions = same_actions && (select_action(a, i % 16) == select_action(b, i % 16));
+    }
+    ASSERT_TRUE(same_actions, "Seeded agents explore identically");
+
+    ReplayConfig config = create_default_replay_config();
+    PriorityExperienceBuffer* pa = create_priority_buffer(64, config);
+    PriorityExperienceBuffer* pb = create_priority_buffer(64, config);
+    for (int i = 0; i < 64; i++) {
+        add_priority_experience(pa, i, ACTION_UP, 0.0f, i, false, i * 0.1f);
+        add_priority_experience(pb, i, ACTION_UP, 0.0f, i, false, i * 0.1f);
+    }
+    seed_priority_buffer(pa, 5);
+    seed_priority_buffer(pb, 5);
+    int ia[16], ib[16];
+    float wa[16], wb[16];
+    sample_priority_batch(pa, 16, ia, wa);
+    sample_priority_batch(pb, 16, ib, wb);
+    ASSERT_TRUE(memcmp(ia, ib, sizeof(ia)) == 0, "Seeded priority buffers sample identically");
+
+    destroy_priority_buffer(pa);
+    destroy_priority_buffer(pb);
+    destroy_agent(a);
+    destroy_agent(b);
+    return true;
+}
+
+int main() {
+    printf("=== Random Number Generator Test Suite ===\n");
+
+    test_determinism_and_jump();
+    test_ranges_and_bulk();
+    test_seeded_sampling();
+
+    printf("\n=== Test Summary ===\n");
+    printf("Tests Passed: %d\n", tests_passed);
+    printf("Tests Failed: %d\n", tests_failed);
+
+    if (tests_failed > 0) {
+        printf("⚠️  Some tests failed.\n");
+        return 1;
+    }
+    printf("🎉 ALL TESTS PASSED!\n");
+    return 0;
+}
@@ -8,6 +8,7 @@
  * - Exploration bonus calculation and decay
  * - State priority updates and analysis
  * - Enhanced action selection and Q-value updates
+ * - Bucketed selection and lazy decay agree with a full rescan
  */
 
 #include "../include/agent.h"
@@ -216,10 +217,10 @@ bool test_state_priorities() {
     // State 3 remains unvisited                                   // No visits
     
     // Check that less visited states have higher priorities
-    float priority_unvisited = tracker->visit_priorities[3];
-    float priority_low = tracker->visit_priorities[2];
-    float priority_medium = tracker->visit_priorities[1];
-    float priority_high = tracker->visit_priorities[0];
+    float priority_unvisited = get_state_priority(tracker, 3);
+    float priority_low = get_state_priority(tracker, 2);
+    float priority_medium = get_state_priority(tracker, 1);
+    float priority_high = get_state_priority(tracker, 0);
     
     ASSERT_TRUE(priority_unvisited >= priority_low, "Unvisited state has higher priority than low visited");
     ASSERT_TRUE(priority_low >= priority_medium, "Low visited state has higher priority than medium visited");
@@ -227,7 +228,7 @@ bool test_state_priorities() {
     
     // Test priority state selection
     int highest_priority_state = select_priority_state(tracker);
-    ASSERT_TRUE(highest_priority_state == 3 || tracker->visit_priorities[highest_priority_state] >= priority_unvisited, 
+    ASSERT_TRUE(highest_priority_state == 3 || get_state_priority(tracker, highest_priority_state) >= priority_unvisited, 
                "Highest priority state selection is correct");
     
     destroy_state_visit_tracker(tracker);
@@ -242,14 +243,14 @@ bool test_exploration_bonus_decay() {
     
     // Visit a state to set its exploration bonus
     update_state_visit(tracker, 0);
-    float initial_bonus = tracker->exploration_bonuses[0];
+    float initial_bonus = get_exploration_bonus(tracker, 0);
     
     // Apply decay multiple times
     for (int i = 0; i < 10; i++) {
         decay_exploration_bonuses(tracker);
     }
     
-    float decayed_bonus = tracker->exploration_bonuses[0];
+    float decayed_bonus = get_exploration_bonus(tracker, 0);
     ASSERT_TRUE(decayed_bonus < initial_bonus, "Exploration bonus decreased after decay");
     ASSERT_TRUE(decayed_bonus >= tracker->min_exploration_bonus, "Bonus doesn't go below minimum");
     
@@ -258,7 +259,7 @@ bool test_exploration_bonus_decay() {
         decay_exploration_bonuses(tracker);
     }
     
-    ASSERT_FLOAT_NEAR(tracker->exploration_bonuses[0], tracker->min_exploration_bonus, EPSILON,
+    ASSERT_FLOAT_NEAR(get_exploration_bonus(tracker, 0), tracker->min_exploration_bonus, EPSILON,
                      "Bonus clamped to minimum after extensive decay");
     
     destroy_state_visit_tracker(tracker);
@@ -633,6 +634,96 @@ bool test_performance_comparison() {
     return true;
 }
 
+// Priority of a state recomputed from every visit count, as the tracker once did on each visit
+static float brute_force_priority(StateVisitTracker* tracker, int state) {
+    int min_visits = tracker->visit_counts[0];
+    int max_visits = tracker->visit_counts[0];
+    for (int i = 1; i < tracker->num_states; i++) {
+        if (tracker->visit_counts[i] < min_visits) min_visits = tracker->visit_counts[i];
+        if (tracker->visit_counts[i] > max_visits) max_visits = tracker->visit_counts[i];
+    }
+    if (max_visits == min_visits) return 1.0f;
+    return 1.0f - ((float)(tracker->visit_counts[state] - min_visits) / (max_visits - min_visits)) +
+           get_exploration_bonus(tracker, state);
+}
+
+// Test bucketed selection and lazy decay against a full rescan
+bool test_indexed_priority_selection() {
+    printf("\n--- Testing Indexed Priority Selection ---\n");
+    
+    const int num_states = 300;
+    StateVisitTracker* tracker = create_state_visit_tracker(num_states, true, true);
+    float* bonuses = (float*)malloc(num_states * sizeof(float));
+    ASSERT_TRUE(tracker != NULL && bonuses != NULL, "Tracker creation");
+    ASSERT_TRUE(create_state_visit_tracker(0, true, true) == NULL, "Empty tracker rejected");
+    for (int i = 0; i < num_states; i++) bonuses[i] = 1.0f;
+    
+    bool selection_matches = true;
+    bool bonuses_match = true;
+    bool extremes_match = true;
+    unsigned int seed = 12345;
+    for (int step = 0; step < 20000; step++) {
+        // Skewed visits: low states far more often, so counts spread widely
+        seed = seed * 1103515245u + 12345u;
+        int state = (int)((seed >> 8) % num_states);
+        state = state * state / num_states;
+        update_state_visit(tracker, state);
+        bonuses[state] = fmaxf(tracker->min_exploration_bonus, 1.0f / sqrtf((float)tracker->visit_counts[state] + 1));
+        if (step % 7 == 0) {
+            decay_exploration_bonuses(tracker);
+            for (int i = 0; i < num_states; i++) {
+                bonuses[i] = fmaxf(bonuses[i] * tracker->exploration_bonus_decay, tracker->min_exploration_bonus);
+            }
+        }
+        if (step % 97 != 0) continue;
+        
+        float best = brute_force_priority(tracker, 0);
+        int min_visits = tracker->visit_counts[0];
+        int max_visits = tracker->visit_counts[0];
+        for (int i = 0; i < num_states; i++) {
+            float priority = brute_force_priority(tracker, i);
+            if (priority > best) best = priority;
+            if (fabsf(get_exploration_bonus(tracker, i) - bonuses[i]) > 1e-4f) bonuses_match = false;
+            if (tracker->visit_counts[i] < min_visits) min_visits = tracker->visit_counts[i];
+            if (tracker->visit_counts[i] > max_visits) max_visits = tracker->visit_counts[i];
+        }
+        int selected = select_priority_state(tracker);
+        if (fabsf(get_state_priority(tracker, selected) - best) > 1e-5f ||
+            fabsf(brute_force_priority(tracker, selected) - best) > 1e-5f) {
+            selection_matches = false;
+        }
+        if (tracker->visit_counts[get_least_visited_state(tracker)] != min_visits ||
+            tracker->visit_counts[get_most_visited_state(tracker)] != max_visits) {
+            extremes_match = false;
+        }
+    }
+    ASSERT_TRUE(selection_matches, "Selected state has the highest priority");
+    ASSERT_TRUE(bonuses_match, "Lazy decay matches decaying every bonus");
+    ASSERT_TRUE(extremes_match, "Least and most visited states match a full scan");
+    
+    int visited = 0;
+    for (int i = 0; i < num_states; i++) visited += tracker->visit_counts[i] > 0;
+    ASSERT_FLOAT_NEAR(calculate_exploration_coverage(tracker), (float)visited / num_states * 100.0f, 1e-3f,
+                      "Coverage from the lowest bucket");
+    
+    // Enough decays to fold the scale back into the stored bonuses
+    for (int i = 0; i < 50000; i++) decay_exploration_bonuses(tracker);
+    ASSERT_TRUE(tracker->bonus_scale > 1e-20f, "Decay scale stays representable");
+    ASSERT_FLOAT_NEAR(get_exploration_bonus(tracker, 0), tracker->min_exploration_bonus, EPSILON,
+                      "Folded bonuses keep the minimum");
+    
+    update_state_priorities(tracker);
+    bool reported = true;
+    for (int i = 0; i < num_states; i++) {
+        if (fabsf(tracker->visit_priorities[i] - brute_force_priority(tracker, i)) > 1e-5f) reported = false;
+    }
+    ASSERT_TRUE(reported, "Reported priorities match a full rescan");
+    
+    free(bonuses);
+    destroy_state_visit_tracker(tracker);
+    return true;
+}
+
 // Main test runner
 int main() {
     printf("State Visit Tracking Test Suite\n");
@@ -653,7 +744,8 @@ int main() {
         test_state_visit_analysis,
         test_state_visit_reset,
         test_integration_with_environment,
-        test_performance_comparison
+        test_performance_comparison,
+        test_indexed_priority_selection
     };
     
     const char* test_names[] = {
@@ -668,7 +760,8 @@ int main() {
         "State Visit Analysis",
         "State Visit Reset",
         "Integration with Environment",
-        "Performance Comparison"
+        "Performance Comparison",
+        "Indexed Priority Selection"
     };
     
     int num_tests = sizeof(tests) / sizeof(tests[0]);
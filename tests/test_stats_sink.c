@@ -0,0 +1,248 @@
+/*
+ * Stats Sink Test Suite
+ *
+ * Verifies bounded training statistics and the streaming episode log:
+ * - TrainingStats memory no longer grows with the episode count
+ * - Run-wide totals and convergence detection survive the rolling history
+ * - CSV and binary sinks write every record, in order, through a small ring
+ * - Flushed records are on disk before the sink is closed
+ * - Rolling window sums agree with recomputing each window from scratch
+ */
+
+#include "../include/stats_sink.h"
+#include "../include/agent.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define ASSERT_TRUE(condition, message) \
+    if (!(condition)) { \
+        tests_failed++; \
+        printf("❌ FAIL: %s\n", message); \
+        return false; \
+    } else { \
+        tests_passed++; \
+        printf("✅ PASS: %s\n", message); \
+    }
+
+#define LONG_RUN 20000
+
+static void record_synthetic_episode(TrainingStats* stats, int episode, float reward, bool success) {
+    record_episode(stats, episode, reward, 10 + episode % 7, 0.5f, 1.0f);
+    update_performance_metrics(stats->metrics, stats, episode, success, 0.25f);
+}
+
+static int count_lines(const char* filename) {
+    FILE* file = fopen(filename, "r");
+    if (!file) return -1;
+    int lines = 0;
+    int c;
+    while ((c = fgetc(file)) != EOF) {
+        if (c == '\n') lines++;
+    }
+    fclose(file);
+    return lines;
+}
+
+bool test_bounded_history() {
+    printf("\n--- Testing Bounded History ---\n");
+
+    TrainingStats* stats = create_training_stats(LONG_RUN);
+    ASSERT_TRUE(stats && stats->history_size == TRAINING_STATS_HISTORY, "Stats keep a fixed history");
+
+    double reward_sum = 0.0;
+    int successes = 0;
+    for (int e = 0; e < LONG_RUN; e++) {
+        float reward = (float)(e % 13) - 4.0f;
+        bool success = e % 3 != 0;
+        record_synthetic_episode(stats, e, reward, success);
+        reward_sum += reward;
+        successes += success ? 1 : 0;
+    }
+
+    ASSERT_TRUE(stats->current_episode == LONG_RUN, "Every episode counted");
+    ASSERT_TRUE(get_episode_stats(stats, 0) == NULL, "Old episodes leave the history");
+    EpisodeStats* last = get_episode_stats(stats, LONG_RUN - 1);
+    ASSERT_TRUE(last && last->episode == LONG_RUN - 1, "Recent episodes are kept");
+    ASSERT_TRUE(get_episode_stats(stats, LONG_RUN - TRAINING_STATS_HISTORY) != NULL &&
+                get_episode_stats(stats, LONG_RUN - TRAINING_STATS_HISTORY - 1) == NULL,
+                "History holds exactly TRAINING_STATS_HISTORY episodes");
+    ASSERT_TRUE(fabsf(stats->avg_reward_all_episodes - (float)(reward_sum / LONG_RUN)) < 1e-3f,
+                "Run-wide average reward from running totals");
+    ASSERT_TRUE(stats->total_successful_episodes == successes, "Run-wide success count");
+
+    // Moving average over the last window_size raw rewards
+    float expected = 0.0f;
+    for (int e = LONG_RUN - 100; e < LONG_RUN; e++) {
+        expected += (float)(e % 13) - 4.0f;
+    }
+    expected /= 100.0f;
+    int slot = (LONG_RUN - 1) % stats->metrics->history_size;
+    ASSERT_TRUE(fabsf(stats->metrics->moving_avg_rewards[slot] - expected) < 1e-3f,
+                "Moving average matches the window");
+
+    destroy_training_stats(stats);
+    ASSERT_TRUE(create_performance_metrics(10, 100, 50) == NULL, "History shorter than the window rejected");
+    return true;
+}
+
+bool test_convergence_on_ring() {
+    printf("\n--- Testing Convergence on the Ring ---\n");
+
+    TrainingStats* stats = create_training_stats(LONG_RUN);
+    int converged_at = -1;
+    for (int e = 0; e < 1000 && converged_at < 0; e++) {
+        // Noisy failures first, then a long stable stretch well past the history length
+        bool stable = e >= 600;
+        record_synthetic_episode(stats, e, stable ? 50.0f : (float)((e * 37) % 200) - 100.0f, stable);
+        if (check_convergence(stats->metrics, e)) converged_at = e;
+    }
+    ASSERT_TRUE(converged_at > 600 && converged_at < 800, "Convergence detected after the stable stretch");
+    ASSERT_TRUE(stats->metrics->convergence_episode == converged_at, "Convergence episode recorded");
+
+    destroy_training_stats(stats);
+    return true;
+}
+
+bool test_rolling_windows() {
+    printf("\n--- Testing Rolling Window Sums ---\n");
+
+    TrainingStats* stats = create_training_stats(LONG_RUN);
+    PerformanceMetrics* metrics = stats->metrics;
+    bool averages_match = true;
+    bool sums_match = true;
+    for (int e = 0; e < 5000; e++) {
+        float reward = (float)((e * 7919) % 211) * 0.37f - 30.0f;
+        record_synthetic_episode(stats, e, reward, (e * 31) % 5 != 0);
+
+        int start = e >= metrics->window_size ? e - metrics->window_size + 1 : 0;
+        double reward_sum = 0.0, steps_sum = 0.0;
+        for (int i = start; i <= e; i++) {
+            reward_sum += get_episode_stats(stats, i)->total_reward;
+            steps_sum += get_episode_stats(stats, i)->steps_taken;
+        }
+        int slot = e % metrics->history_size;
+        averages_match = averages_match &&
+                         fabs(metrics->moving_avg_rewards[slot] - reward_sum / (e - start + 1)) < 1e-3 &&
+                         fabs(metrics->moving_avg_steps[slot] - steps_sum / (e - start + 1)) < 1e-3;
+
+        int conv_start = e >= metrics->convergence_threshold ? e - metrics->convergence_threshold + 1 : 0;
+        double avg_sum = 0.0;
+        int successes = 0;
+        for (int i = conv_start; i <= e; i++) {
+            avg_sum += metrics->moving_avg_rewards[i % metrics->history_size];
+            successes += metrics->success_episodes[i % metrics->history_size];
+        }
+        sums_match = sums_match && fabs(metrics->conv_avg_sum - avg_sum) < 1e-2 &&
+                     metrics->conv_success_count == successes;
+    }
+    ASSERT_TRUE(averages_match, "Rolling moving averages match the full window");
+    ASSERT_TRUE(sums_match, "Convergence window sums match the full window");
+
+    // Re-recording an episode falls back to a rebuild and stays consistent
+    double before = metrics->window_reward_sum;
+    update_performance_metrics(metrics, stats, 4999, true, 0.25f);
+    ASSERT_TRUE(fabs(metrics->window_reward_sum - before) < 1e-3, "Repeated episode rebuilds the same sums");
+
+    destroy_training_stats(stats);
+    ASSERT_TRUE(create_performance_metrics(100, 100, 50) == NULL, "History must hold one episode past the window");
+    return true;
+}
+
+bool test_csv_sink() {
+    printf("\n--- Testing CSV Sink ---\n");
+
+    const char* filename = "test_stats_sink.csv";
+    ASSERT_TRUE(create_stats_sink(filename, STATS_SINK_CSV, 1) == NULL, "Ring needs at least two slots");
+
+    // A tiny ring makes the producer wait for the writer
+    StatsSink* sink = create_stats_sink(filename, STATS_SINK_CSV, 8);
+    ASSERT_TRUE(sink != NULL, "CSV sink created");
+
+    TrainingStats* stats = create_training_stats(LONG_RUN);
+    bool appended = true;
+    for (int e = 0; e < 5000; e++) {
+        record_synthetic_episode(stats, e, (float)e, true);
+        appended = appended && stats_sink_record_episode(sink, stats, e);
+    }
+    ASSERT_TRUE(appended, "Every record accepted");
+    ASSERT_TRUE(stats_sink_flush(sink) && stats_sink_records_written(sink) == 5000, "Flush writes everything");
+    ASSERT_TRUE(count_lines(filename) == 5000 + 2, "Flushed records are on disk before close");
+    close_stats_sink(sink);
+
+    FILE* file = fopen(filename, "r");
+    char line[256];
+    fgets(line, sizeof(line), file);
+    fgets(line, sizeof(line), file);
+    ASSERT_TRUE(strstr(line, "Episode,Reward,Steps") != NULL, "CSV header matches save_performance_data");
+    bool in_order = true;
+    for (int e = 0; e < 5000 && fgets(line, sizeof(line), file); e++) {
+        int episode;
+        float reward;
+        in_order = in_order && sscanf(line, "%d,%f", &episode, &reward) == 2 &&
+                   episode == e + 1 && reward == (float)e;
+    }
+    fclose(file);
+    ASSERT_TRUE(in_order, "Records are complete and in order");
+
+    destroy_training_stats(stats);
+    remove(filename);
+    return true;
+}
+
+bool test_binary_sink() {
+    printf("\n--- Testing Binary Sink ---\n");
+
+    const char* filename = "test_stats_sink.bin";
+    StatsSink* sink = create_stats_sink(filename, STATS_SINK_BINARY, 64);
+    ASSERT_TRUE(sink != NULL, "Binary sink created");
+    for (int i = 0; i < 1000; i++) {
+        StatsRecord record = {i + 1, (float)i * 0.5f, i % 50, i % 2, 1.0f, 2.0f, 0.1f, 0.2f};
+        stats_sink_append(sink, &record);
+    }
+    close_stats_sink(sink);
+
+    FILE* file = fopen(filename, "rb");
+    StatsFileHeader header;
+    ASSERT_TRUE(fread(&header, sizeof(header), 1, file) == 1 && header.magic == STATS_FILE_MAGIC &&
+                header.version == STATS_FILE_VERSION && header.record_size == sizeof(StatsRecord),
+                "Binary header identifies the record layout");
+    StatsRecord record;
+    int count = 0;
+    bool matches = true;
+    while (fread(&record, sizeof(record), 1, file) == 1) {
+        matches = matches && record.episode == count + 1 && record.total_reward == (float)count * 0.5f &&
+                  record.steps_taken == count % 50;
+        count++;
+    }
+    fclose(file);
+    ASSERT_TRUE(count == 1000 && matches, "Close writes every fixed-size record");
+
+    remove(filename);
+    return true;
+}
+
+int main() {
+    printf("=== Stats Sink Test Suite ===\n");
+
+    test_bounded_history();
+    test_convergence_on_ring();
+    test_rolling_windows();
+    test_csv_sink();
+    test_binary_sink();
+
+    printf("\n=== Test Summary ===\n");
+    printf("Tests Passed: %d\n", tests_passed);
+    printf("Tests Failed: %d\n", tests_failed);
+
+    if (tests_failed > 0) {
+        printf("⚠️  Some tests failed.\n");
+        return 1;
+    }
+    printf("🎉 ALL TESTS PASSED!\n");
+    return 0;
+}
@@ -122,6 +122,66 @@ int main() {
     
     printf("✓ State conversion functions working correctly\n");
     
+    // Test 7: Compiled transition table matches direct stepping
+    printf("\nTest 7: Testing compiled transition table...\n");
+    GridWorld* direct = create_grid_world(6, 6);
+    set_cell(direct, 2, 1, CELL_WALL);
+    set_cell(direct, 2, 2, CELL_OBSTACLE);
+    GridWorld* compiled = clone_grid_world(direct);
+    assert(!has_transition_table(direct));
+    assert(set_transition_table(compiled, true) && has_transition_table(compiled));
+    
+    srand(7);
+    for (int i = 0; i < 5000; i++) {
+        if (i == 1000) {
+            // Layout edits mark the table dirty
+            set_cell(direct, 4, 4, CELL_WALL);
+            set_cell(compiled, 4, 4, CELL_WALL);
+        } else if (i == 2000) {
+            // Goal and reward edits are picked up without a rebuild call
+            direct->goal_pos = compiled->goal_pos = (Position){0, 5};
+            direct->step_penalty = compiled->step_penalty = -0.5f;
+        }
+        Action action = (Action)(rand() % NUM_ACTIONS);
+        StepResult a = step_environment(direct, action);
+        StepResult b = step_environment(compiled, action);
+        assert(a.next_state.state_index == b.next_state.state_index);
+        assert(a.valid_action == b.valid_action && a.done == b.done);
+        assert(float_equals(a.reward, b.reward, 1e-6f));
+        if (a.done) {
+            reset_environment(direct);
+            reset_environment(compiled);
+        }
+    }
+    printf("✓ Transition table matches direct stepping through layout, goal and reward changes\n");
+    
+    // Test 8: Action noise with and without the table
+    printf("\nTest 8: Testing stochastic transitions...\n");
+    direct->stochastic = compiled->stochastic = true;
+    direct->action_noise = compiled->action_noise = 0.3f;
+    seed_environment(direct, 99);
+    seed_environment(compiled, 99);
+    reset_environment(direct);
+    reset_environment(compiled);
+    int slipped = 0;
+    for (int i = 0; i < 2000; i++) {
+        Position before = compiled->agent_pos;
+        StepResult a = step_environment(direct, ACTION_RIGHT);
+        StepResult b = step_environment(compiled, ACTION_RIGHT);
+        assert(a.next_state.state_index == b.next_state.state_index);
+        assert(float_equals(a.reward, b.reward, 1e-6f));
+        if (b.valid_action && compiled->agent_pos.x != before.x + 1) slipped++;
+        if (a.done) {
+            reset_environment(direct);
+            reset_environment(compiled);
+        }
+    }
+    assert(slipped > 0);
+    assert(set_transition_table(compiled, false) && !has_transition_table(compiled));
+    printf("✓ Noisy grids step identically through the table (%d slips)\n", slipped);
+    destroy_grid_world(direct);
+    destroy_grid_world(compiled);
+    
     // Cleanup
     destroy_grid_world(world);
     
@@ -133,6 +193,7 @@ int main() {
     printf("  ✅ Error handling and edge cases\n");
     printf("  ✅ Consistency with original step function\n");
     printf("  ✅ State conversion utilities\n");
+    printf("  ✅ Compiled transition table (deterministic and noisy)\n");
     
     return 0;
 }
\ No newline at end of file
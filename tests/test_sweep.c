@@ -0,0 +1,271 @@
+/*
+ * Hyperparameter Sweep Test Suite
+ *
+ * Covers the sweep runner and the configuration files it reads:
+ * - ConfigFile parsing, typed getters and the save/load round trip
+ * - Grid and random search specs, and the errors a bad spec reports
+ * - Trials stop early on convergence and on diverging Q-values
+ * - A threaded sweep streams one line per trial and matches a serial one
+ */
+
+#include "../include/sweep.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define ASSERT_TRUE(condition, message) \
+    if (!(condition)) { \
+        tests_failed++; \
+        printf("❌ FAIL: %s\n", message); \
+        return false; \
+    } else { \
+        tests_passed++; \
+        printf("✅ PASS: %s\n", message); \
+    }
+
+#define SPEC_FILE "test_sweep.cfg"
+#define RESULTS_FILE "test_sweep_results.csv"
+
+static void write_file(const char* filename, const char* text) {
+    FILE* file = fopen(filename, "w");
+    fputs(text, file);
+    fclose(file);
+}
+
+static int count_lines(const char* filename) {
+    FILE* file = fopen(filename, "r");
+    if (!file) return -1;
+    int lines = 0;
+    for (int c = fgetc(file); c != EOF; c = fgetc(file)) {
+        lines += c == '\n';
+    }
+    fclose(file);
+    return lines;
+}
+
+// Open 5x5 grid, goal in the far corner
+static GridWorld* create_test_world(void) {
+    GridWorld* world = create_grid_world(5, 5);
+    if (!world) return NULL;
+
+    world->start_pos = (Position){0, 0};
+    world->goal_pos = (Position){4, 4};
+    world->max_steps = 100;
+    set_cell(world, 4, 4, CELL_GOAL);
+    return world;
+}
+
+bool test_config_file() {
+    printf("\n--- Testing Config Files ---\n");
+
+    write_file(SPEC_FILE,
+               "# comment line\n"
+               "\n"
+               "  name = sweep one   # trailing comment\n"
+               "count=12\n"
+               "rate = 0.25\n"
+               "flag = yes\n"
+               "count = 13\n"
+               "bad_int = 12x\n");
+    ConfigFile* config = load_config(SPEC_FILE);
+    ASSERT_TRUE(config && config->count == 5, "Comments and blank lines skipped, repeated key kept once");
+    ASSERT_TRUE(strcmp(get_config_value(config, "name"), "sweep one") == 0, "Keys and values trimmed");
+    ASSERT_TRUE(get_config_int(config, "count", 0) == 13, "Last value of a repeated key wins");
+    ASSERT_TRUE(get_config_float(config, "rate", 0.0f) == 0.25f && get_config_bool(config, "flag", false),
+                "Float and boolean values");
+    ASSERT_TRUE(get_config_int(config, "missing", 7) == 7 && get_config_int(config, "bad_int", 7) == 7,
+                "Missing and malformed values give the default");
+
+    set_config_value(config, "added", "1");
+    ASSERT_TRUE(save_config(config, SPEC_FILE), "Config saved");
+    destroy_config(config);
+    config = load_config(SPEC_FILE);
+    ASSERT_TRUE(config && config->count == 6 && get_config_bool(config, "added", false) &&
+                strcmp(get_config_value(config, "name"), "sweep one") == 0, "Saved config loads back");
+    destroy_config(config);
+
+    write_file(SPEC_FILE, "no equals sign\n");
+    ASSERT_TRUE(load_config(SPEC_FILE) == NULL && load_config("no_such_file.cfg") == NULL,
+                "Malformed and missing files rejected");
+    remove(SPEC_FILE);
+    return true;
+}
+
+bool test_sweep_specs() {
+    printf("\n--- Testing Sweep Specs ---\n");
+
+    write_file(SPEC_FILE,
+               "search = grid\n"
+               "learning_rate = 0.1, 0.2, 0.3\n"
+               "discount_factor = 0.9,0.99\n"
+               "episodes = 300\n");
+    SweepSpec spec = create_default_sweep_spec();
+    ASSERT_TRUE(load_sweep_spec(SPEC_FILE, &spec), "Grid spec loaded");
+    ASSERT_TRUE(sweep_trial_count(&spec) == 6 && spec.num_episodes == 300 && spec.max_steps_per_episode == 200,
+                "Grid covers every combination; missing keys keep their defaults");
+
+    float parameters[NUM_SWEEP_PARAMETERS];
+    sweep_trial_parameters(&spec, 5, parameters);
+    ASSERT_TRUE(parameters[SWEEP_LEARNING_RATE] == 0.3f && parameters[SWEEP_DISCOUNT_FACTOR] == 0.99f &&
+                parameters[SWEEP_EPSILON_DECAY] == 0.995f, "Last grid trial takes the last values");
+
+    write_file(SPEC_FILE,
+               "search = random\n"
+               "trials = 20\n"
+               "learning_rate = 0.01 : 0.5\n"
+               "epsilon_decay = 0.99, 0.995\n");
+    spec = create_default_sweep_spec();
+    ASSERT_TRUE(load_sweep_spec(SPEC_FILE, &spec) && sweep_trial_count(&spec) == 20, "Random spec loaded");
+    bool in_range = true;
+    float again[NUM_SWEEP_PARAMETERS];
+    for (int trial = 0; trial < 20; trial++) {
+        sweep_trial_parameters(&spec, trial, parameters);
+        sweep_trial_parameters(&spec, trial, again);
+        in_range = in_range && parameters[SWEEP_LEARNING_RATE] >= 0.01f && parameters[SWEEP_LEARNING_RATE] <= 0.5f &&
+                   (parameters[SWEEP_EPSILON_DECAY] == 0.99f || parameters[SWEEP_EPSILON_DECAY] == 0.995f) &&
+                   memcmp(parameters, again, sizeof(parameters)) == 0;
+    }
+    ASSERT_TRUE(in_range, "Random trials drawn from their ranges and lists, reproducibly");
+
+    const char* bad_specs[] = {
+        "search = grid\nlearning_rate = 0.01 : 0.5\n",
+        "learning_rate = 0.1, fast\n",
+        "learnig_rate = 0.1\n",
+        "search = bayesian\n",
+        "episodes = 0\n"
+    };
+    bool rejected = true;
+    for (size_t i = 0; i < sizeof(bad_specs) / sizeof(bad_specs[0]); i++) {
+        write_file(SPEC_FILE, bad_specs[i]);
+        spec = create_default_sweep_spec();
+        rejected = rejected && !load_sweep_spec(SPEC_FILE, &spec);
+    }
+    ASSERT_TRUE(rejected, "Ranges in a grid, bad numbers, unknown keys and empty trials rejected");
+
+    // Malformed scalars must not fall back to the defaults
+    const char* bad_scalars[] = {
+        "episodes = 10o\n",
+        "stop_on_convergence = ture\n",
+        "epsilon = 0.1.5\n",
+        "seed = 99999999999\n"
+    };
+    rejected = true;
+    for (size_t i = 0; i < sizeof(bad_scalars) / sizeof(bad_scalars[0]); i++) {
+        write_file(SPEC_FILE, bad_scalars[i]);
+        spec = create_default_sweep_spec();
+        rejected = rejected && !load_sweep_spec(SPEC_FILE, &spec);
+    }
+    ASSERT_TRUE(rejected, "Malformed integer, boolean and number values rejected");
+    remove(SPEC_FILE);
+
+    GridWorld* world = create_test_world();
+    spec = create_default_sweep_spec();
+    spec.parameters[SWEEP_LEARNING_RATE].count = 0;
+    SweepSummary empty = run_sweep(world, &spec, NULL, NULL);
+    ASSERT_TRUE(sweep_trial_count(&spec) == 0 && empty.best_trial == -1, "Empty sweep rejected before allocating");
+    destroy_grid_world(world);
+    return true;
+}
+
+bool test_early_stopping() {
+    printf("\n--- Testing Early Stopping ---\n");
+
+    GridWorld* world = create_test_world();
+    SweepSpec spec = create_default_sweep_spec();
+    spec.num_episodes = 2000;
+    spec.max_steps_per_episode = 100;
+    spec.parameters[SWEEP_LEARNING_RATE].values[0] = 0.5f;
+    spec.parameters[SWEEP_EPSILON_DECAY].values[0] = 0.95f;
+
+    SweepTrialResult result = run_sweep_trial(world, &spec, 0);
+    ASSERT_TRUE(result.status == SWEEP_TRIAL_CONVERGED && result.episodes_run < spec.num_episodes &&
+                result.convergence_episode == result.episodes_run - 1, "Converged trial stops early");
+    ASSERT_TRUE(result.success_rate > 0.5f && result.final_avg_reward > 0.0f, "Converged trial reaches the goal");
+
+    spec.stop_on_convergence = false;
+    spec.num_episodes = result.episodes_run + 20;
+    SweepTrialResult full = run_sweep_trial(world, &spec, 0);
+    ASSERT_TRUE(full.status == SWEEP_TRIAL_COMPLETED && full.episodes_run == spec.num_episodes &&
+                full.convergence_episode == result.convergence_episode,
+                "Without early stopping the trial runs on and still records convergence");
+
+    spec.parameters[SWEEP_LEARNING_RATE].values[0] = 50.0f;
+    SweepTrialResult diverged = run_sweep_trial(world, &spec, 0);
+    ASSERT_TRUE(diverged.status == SWEEP_TRIAL_DIVERGED && diverged.episodes_run < 20,
+                "Diverging trial stops within a few episodes");
+
+    destroy_grid_world(world);
+    return true;
+}
+
+bool test_parallel_sweep() {
+    printf("\n--- Testing Parallel Sweep ---\n");
+
+    GridWorld* world = create_test_world();
+    write_file(SPEC_FILE,
+               "learning_rate = 0.2, 0.5, 50\n"
+               "discount_factor = 0.9, 0.95\n"
+               "epsilon_decay = 0.9, 0.95\n"
+               "episodes = 1000\n"
+               "max_steps = 100\n"
+               "seed = 7\n");
+    SweepSpec spec = create_default_sweep_spec();
+    ASSERT_TRUE(load_sweep_spec(SPEC_FILE, &spec), "Spec loaded");
+    int trials = sweep_trial_count(&spec);
+
+    SweepTrialResult serial[12];
+    SweepTrialResult threaded[12];
+    spec.num_threads = 1;
+    SweepSummary serial_summary = run_sweep(world, &spec, NULL, serial);
+
+    FILE* output = fopen(RESULTS_FILE, "w");
+    spec.num_threads = 4;
+    SweepSummary summary = run_sweep(world, &spec, output, threaded);
+    fclose(output);
+    ASSERT_TRUE(trials == 12 && summary.num_trials == trials && summary.num_threads == 4, "Every trial run on 4 threads");
+    ASSERT_TRUE(count_lines(RESULTS_FILE) == trials + 1, "Header plus one results line per trial");
+
+    bool same = true;
+    for (int i = 0; i < trials; i++) {
+        same = same && threaded[i].trial == i && threaded[i].status == serial[i].status &&
+               threaded[i].episodes_run == serial[i].episodes_run &&
+               threaded[i].final_avg_reward == serial[i].final_avg_reward;
+    }
+    ASSERT_TRUE(same && summary.total_steps == serial_summary.total_steps, "Threaded sweep matches the serial one");
+    ASSERT_TRUE(summary.status_counts[SWEEP_TRIAL_DIVERGED] == 4 &&
+                summary.status_counts[SWEEP_TRIAL_FAILED] == 0, "Learning rate 50 diverges in every combination");
+    ASSERT_TRUE(summary.best_trial >= 0 && threaded[summary.best_trial].status == SWEEP_TRIAL_CONVERGED &&
+                threaded[summary.best_trial].parameters[SWEEP_LEARNING_RATE] < 1.0f, "Best trial is a converged one");
+
+    spec.storage = QTABLE_STORAGE_MAPPED;
+    ASSERT_TRUE(run_sweep(world, &spec, NULL, NULL).num_trials == 0, "File-backed Q-tables rejected");
+
+    remove(SPEC_FILE);
+    remove(RESULTS_FILE);
+    destroy_grid_world(world);
+    return true;
+}
+
+int main() {
+    printf("=== Hyperparameter Sweep Test Suite ===\n");
+    set_environment_verbose(false);
+
+    test_config_file();
+    test_sweep_specs();
+    test_early_stopping();
+    test_parallel_sweep();
+
+    printf("\n=== Test Summary ===\n");
+    printf("Tests Passed: %d\n", tests_passed);
+    printf("Tests Failed: %d\n", tests_failed);
+
+    if (tests_failed > 0) {
+        printf("⚠️  Some tests failed.\n");
+        return 1;
+    }
+    printf("🎉 ALL TESTS PASSED!\n");
+    return 0;
+}
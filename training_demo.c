@@ -11,6 +11,7 @@
 #include "rendering.h"
 #include "environment.h"
 #include "agent.h"
+#include "training.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
@@ -121,26 +122,15 @@ void run_performance_demo() {
         int successful_episodes = 0;
         float total_reward = 0.0f;
         
+        // Same episode loop as run_training and the episodes benchmark
         for (int episode = 0; episode < DEMO_EPISODES; episode++) {
-            reset_environment(world);
-            float episode_reward = 0.0f;
-            
-            while (!world->episode_done && world->episode_steps < world->max_steps) {
-                int state = get_state_index(world);
-                Action action = select_action(agent, state);
-                StepResult result = step_environment(world, action);
-                
-                update_q_value(agent, state, action, result.reward,
-                             position_to_state(world, result.next_state.position), result.done);
-                
-                episode_reward += result.reward;
-            }
+            EpisodeProgress progress = run_training_episode(world, agent, world->max_steps, NULL);
             
             if (positions_equal(world->agent_pos, world->goal_pos)) {
                 successful_episodes++;
             }
             
-            total_reward += episode_reward;
+            total_reward += progress.total_reward;
             decay_epsilon(agent);
         }
         